@@ -39,12 +39,14 @@
 #include "opencl/context.hpp"
 
 #include "opencl/program.hpp"
+#include "opencl/elementwise.hpp"
 #include "opencl/kernel.hpp"
 #include "opencl/ndrange.hpp"
 #include "opencl/event.hpp"
 #include "opencl/queue.hpp"
 
 #include "opencl/memory.hpp"
+#include "opencl/ringbuffer.hpp"
 #include "opencl/sampler.hpp"
 #include "opencl/interop.hpp"
 
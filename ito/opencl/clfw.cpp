@@ -14,6 +14,7 @@
 #include "context.hpp"
 #include "device.hpp"
 #include "queue.hpp"
+#include "program.hpp"
 #include "interop.hpp"
 #include "clfw.hpp"
 
@@ -90,6 +91,7 @@ void Terminate(void)
 {
     ito_assert(IsInit(), "OpenCL context is not initialized");
 
+    cl::ReleaseProgramCache();
     cl::ReleaseCommandQueue(gQueue);
     cl::ReleaseDevice(gDevice);
     cl::ReleaseContext(gContext);
@@ -17,9 +17,9 @@ namespace ito {
 namespace cl {
 
 /**
- * @brief Context error callback function.
+ * @brief Context error callback function, logging the error information.
  */
-static void CL_CALLBACK ContextCallback(
+void CL_CALLBACK ContextCallback(
     const char *error_info,
     const void *private_info,
     size_t cb,
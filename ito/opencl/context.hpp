@@ -19,6 +19,15 @@
 namespace ito {
 namespace cl {
 
+/**
+ * @brief Context error callback function, logging the error information.
+ */
+void CL_CALLBACK ContextCallback(
+    const char *error_info,
+    const void *private_info,
+    size_t cb,
+    void *user_data);
+
 /**
  * @brief Create a context with the list of devices on the specified platform.
  */
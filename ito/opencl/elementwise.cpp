@@ -0,0 +1,262 @@
+/*
+ * elementwise.cpp
+ *
+ * Copyright (c) 2020 Carlos Braga
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the MIT License.
+ *
+ * See accompanying LICENSE.md or https://opensource.org/licenses/MIT.
+ */
+
+#include <sstream>
+#include "program.hpp"
+#include "kernel.hpp"
+#include "ndrange.hpp"
+#include "queue.hpp"
+#include "elementwise.hpp"
+
+namespace ito {
+namespace cl {
+
+/** ---------------------------------------------------------------------------
+ * @brief Append a statement assigning the expression to a new register and
+ * return its index.
+ */
+static size_t Assign(Elementwise &expr, const std::string &value)
+{
+    ito_assert(expr.kernel == NULL, "expression is already compiled");
+    size_t x = expr.n_registers++;
+    expr.statements.push_back(ito::str::format(
+        "const %s r%lu = %s;", expr.type.c_str(), x, value.c_str()));
+    return x;
+}
+
+/**
+ * @brief Add a scalar kernel argument and return its name.
+ */
+static std::string Scalar(Elementwise &expr, cl_float value)
+{
+    expr.scalars.push_back(value);
+    return ito::str::format("s%lu", expr.scalars.size() - 1);
+}
+
+/**
+ * @brief Add a buffer kernel argument, unless the buffer is already an
+ * argument of the kernel, and return its index.
+ */
+static size_t Buffer(Elementwise &expr, const cl_mem &buffer, bool is_output)
+{
+    ito_assert(buffer != NULL, "invalid buffer");
+    for (size_t i = 0; i < expr.buffers.size(); ++i) {
+        if (expr.buffers[i] == buffer) {
+            expr.is_output[i] = expr.is_output[i] || is_output;
+            return i;
+        }
+    }
+    expr.buffers.push_back(buffer);
+    expr.is_output.push_back(is_output);
+    return expr.buffers.size() - 1;
+}
+
+/** ---------------------------------------------------------------------------
+ * @brief Create an empty expression over buffers with the specified element
+ * type (float, float2, float3 or float4) and number of elements.
+ */
+Elementwise Elementwise::Make(const std::string &type, const size_t size)
+{
+    ito_assert(
+        type == "float"  ||
+        type == "float2" ||
+        type == "float3" ||
+        type == "float4",
+        "invalid element type");
+    ito_assert(size > 0, "invalid expression size");
+
+    Elementwise expr;
+    expr.type = type;
+    expr.size = size;
+    expr.n_registers = 0;
+    expr.kernel = NULL;
+    return expr;
+}
+
+/**
+ * @brief Release the expression kernel. The program is owned by the cache.
+ */
+void Elementwise::Destroy(Elementwise &expr)
+{
+    if (expr.kernel != NULL) {
+        ReleaseKernel(expr.kernel);
+        expr.kernel = NULL;
+    }
+    expr.buffers.clear();
+    expr.is_output.clear();
+    expr.scalars.clear();
+    expr.statements.clear();
+    expr.n_registers = 0;
+}
+
+/** ---------------------------------------------------------------------------
+ * @brief Load the buffer element into a new register.
+ */
+size_t Elementwise::Load(Elementwise &expr, const cl_mem &buffer)
+{
+    size_t b = Buffer(expr, buffer, false);
+    return Assign(expr, ito::str::format("b%lu[i]", b));
+}
+
+/**
+ * @brief Store the register into the buffer element.
+ */
+void Elementwise::Store(Elementwise &expr, const cl_mem &buffer, size_t x)
+{
+    ito_assert(expr.kernel == NULL, "expression is already compiled");
+    ito_assert(x < expr.n_registers, "invalid register");
+    size_t b = Buffer(expr, buffer, true);
+    expr.statements.push_back(ito::str::format("b%lu[i] = r%lu;", b, x));
+}
+
+/** ---------------------------------------------------------------------------
+ * @brief Return the register holding x + y.
+ */
+size_t Elementwise::Add(Elementwise &expr, size_t x, size_t y)
+{
+    ito_assert(x < expr.n_registers && y < expr.n_registers, "invalid register");
+    return Assign(expr, ito::str::format("r%lu + r%lu", x, y));
+}
+
+/**
+ * @brief Return the register holding x * y.
+ */
+size_t Elementwise::Mul(Elementwise &expr, size_t x, size_t y)
+{
+    ito_assert(x < expr.n_registers && y < expr.n_registers, "invalid register");
+    return Assign(expr, ito::str::format("r%lu * r%lu", x, y));
+}
+
+/**
+ * @brief Return the register holding a * x.
+ */
+size_t Elementwise::Scale(Elementwise &expr, cl_float a, size_t x)
+{
+    ito_assert(x < expr.n_registers, "invalid register");
+    std::string s = Scalar(expr, a);
+    return Assign(expr, ito::str::format("%s * r%lu", s.c_str(), x));
+}
+
+/**
+ * @brief Return the register holding a * x + y.
+ */
+size_t Elementwise::Axpy(Elementwise &expr, cl_float a, size_t x, size_t y)
+{
+    ito_assert(x < expr.n_registers && y < expr.n_registers, "invalid register");
+    std::string s = Scalar(expr, a);
+    return Assign(expr, ito::str::format(
+        "mad((%s) %s, r%lu, r%lu)", expr.type.c_str(), s.c_str(), x, y));
+}
+
+/**
+ * @brief Return the register holding x clamped to the range [lo, hi].
+ */
+size_t Elementwise::Clamp(Elementwise &expr, size_t x, cl_float lo, cl_float hi)
+{
+    ito_assert(x < expr.n_registers, "invalid register");
+    ito_assert(lo <= hi, "invalid clamp range");
+    std::string s_lo = Scalar(expr, lo);
+    std::string s_hi = Scalar(expr, hi);
+    return Assign(expr, ito::str::format(
+        "clamp(r%lu, %s, %s)", x, s_lo.c_str(), s_hi.c_str()));
+}
+
+/**
+ * @brief Return the register holding the element x normalized to unit length.
+ */
+size_t Elementwise::Normalize(Elementwise &expr, size_t x)
+{
+    ito_assert(x < expr.n_registers, "invalid register");
+    return Assign(expr, ito::str::format("normalize(r%lu)", x));
+}
+
+/** ---------------------------------------------------------------------------
+ * @brief Return the source of the fused kernel. The kernel arguments are the
+ * number of elements, followed by the buffers and the scalars.
+ */
+std::string Elementwise::Source(const Elementwise &expr)
+{
+    std::ostringstream ss;
+    ss << "__kernel void elementwise(\n";
+    ss << "    const ulong n";
+    for (size_t b = 0; b < expr.buffers.size(); ++b) {
+        ss << ",\n    __global "
+           << (expr.is_output[b] ? "" : "const ")
+           << expr.type << " *b" << b;
+    }
+    for (size_t s = 0; s < expr.scalars.size(); ++s) {
+        ss << ",\n    const float s" << s;
+    }
+    ss << ")\n{\n";
+    ss << "    const size_t i = get_global_id(0);\n";
+    ss << "    if (i >= n) {\n";
+    ss << "        return;\n";
+    ss << "    }\n";
+    for (auto &statement : expr.statements) {
+        ss << "    " << statement << "\n";
+    }
+    ss << "}\n";
+    return ss.str();
+}
+
+/**
+ * @brief Build the fused kernel through the program cache and create the
+ * expression kernel object, once.
+ */
+cl_kernel Elementwise::Compile(
+    Elementwise &expr,
+    const cl_context &context,
+    const cl_device_id &device)
+{
+    if (expr.kernel == NULL) {
+        ito_assert(!expr.statements.empty(), "empty expression");
+        cl_program program = GetCachedProgram(context, device, Source(expr));
+        expr.kernel = CreateKernel(program, "elementwise");
+    }
+    return expr.kernel;
+}
+
+/**
+ * @brief Compile the expression if necessary, set the kernel arguments and
+ * enqueue the fused kernel over all elements.
+ */
+cl_int Elementwise::Enqueue(
+    Elementwise &expr,
+    const cl_context &context,
+    const cl_device_id &device,
+    const cl_command_queue &queue,
+    const std::vector<cl_event> *event_wait_list,
+    cl_event *event)
+{
+    cl_kernel kernel = Compile(expr, context, device);
+
+    cl_uint arg_index = 0;
+    cl_ulong size = static_cast<cl_ulong>(expr.size);
+    SetKernelArg(kernel, arg_index++, sizeof(cl_ulong), &size);
+    for (auto &buffer : expr.buffers) {
+        SetKernelArg(kernel, arg_index++, sizeof(cl_mem), &buffer);
+    }
+    for (auto &scalar : expr.scalars) {
+        SetKernelArg(kernel, arg_index++, sizeof(cl_float), &scalar);
+    }
+
+    return EnqueueNDRangeKernel(
+        queue,
+        kernel,
+        NDRange::Null,
+        NDRange::Make(expr.size),
+        NDRange::Null,
+        event_wait_list,
+        event);
+}
+
+} /* cl */
+} /* ito */
@@ -0,0 +1,87 @@
+/*
+ * elementwise.hpp
+ *
+ * Copyright (c) 2020 Carlos Braga
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the MIT License.
+ *
+ * See accompanying LICENSE.md or https://opensource.org/licenses/MIT.
+ */
+
+#ifndef ITO_OPENCL_ELEMENTWISE_H_
+#define ITO_OPENCL_ELEMENTWISE_H_
+
+#include <string>
+#include <vector>
+#include "base.hpp"
+
+namespace ito {
+namespace cl {
+
+/**
+ * Elementwise
+ * @brief Fused element-wise expression over buffers of the same size.
+ *
+ * Each operation appends a statement to the kernel body and returns the index
+ * of the register holding its result. The whole chain is emitted as a single
+ * kernel, so intermediate values never leave the device registers:
+ *
+ *  Elementwise expr = Elementwise::Make("float4", n);
+ *  size_t x = Elementwise::Load(expr, x_buffer);
+ *  size_t y = Elementwise::Load(expr, y_buffer);
+ *  size_t r = Elementwise::Axpy(expr, 2.0f, x, y);
+ *  Elementwise::Store(expr, y_buffer, Elementwise::Normalize(expr, r));
+ *  Elementwise::Enqueue(expr, context, device, queue);
+ *
+ * Scalar values are passed as kernel arguments, so expressions differing only
+ * in their scalars share the same program in the program cache.
+ */
+struct Elementwise {
+    /* Element type and number of elements of the buffer operands. */
+    std::string type;
+    size_t size;
+
+    /* Kernel arguments and body. */
+    std::vector<cl_mem> buffers;
+    std::vector<bool> is_output;
+    std::vector<cl_float> scalars;
+    std::vector<std::string> statements;
+    size_t n_registers;
+    cl_kernel kernel;
+
+    /* Expression factory functions. */
+    static Elementwise Make(const std::string &type, const size_t size);
+    static void Destroy(Elementwise &expr);
+
+    /* Buffer load and store operations. */
+    static size_t Load(Elementwise &expr, const cl_mem &buffer);
+    static void Store(Elementwise &expr, const cl_mem &buffer, size_t x);
+
+    /* Element-wise operations returning the result register. */
+    static size_t Add(Elementwise &expr, size_t x, size_t y);
+    static size_t Mul(Elementwise &expr, size_t x, size_t y);
+    static size_t Scale(Elementwise &expr, cl_float a, size_t x);
+    static size_t Axpy(Elementwise &expr, cl_float a, size_t x, size_t y);
+    static size_t Clamp(Elementwise &expr, size_t x, cl_float lo, cl_float hi);
+    static size_t Normalize(Elementwise &expr, size_t x);
+
+    /* Kernel source, compilation and execution. */
+    static std::string Source(const Elementwise &expr);
+    static cl_kernel Compile(
+        Elementwise &expr,
+        const cl_context &context,
+        const cl_device_id &device);
+    static cl_int Enqueue(
+        Elementwise &expr,
+        const cl_context &context,
+        const cl_device_id &device,
+        const cl_command_queue &queue,
+        const std::vector<cl_event> *event_wait_list = NULL,
+        cl_event *event = NULL);
+};
+
+} /* cl */
+} /* ito */
+
+#endif /* ITO_OPENCL_ELEMENTWISE_H_ */
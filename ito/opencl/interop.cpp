@@ -9,8 +9,14 @@
  * See accompanying LICENSE.md or https://opensource.org/licenses/MIT.
  */
 
+#include <algorithm>
+#include <cstring>
+#include <string>
 #include "interop.hpp"
+#include "platform.hpp"
 #include "context.hpp"
+#include "event.hpp"
+#include "queue.hpp"
 
 #if defined(ITO_ENABLE_CL_GL_INTEROP)
 
@@ -25,6 +31,54 @@
 namespace ito {
 namespace cl {
 
+#if defined(__linux__)
+/**
+ * @brief Function pointer type of the cl_khr_gl_sharing context query.
+ */
+typedef cl_int (CL_API_CALL *GetGLContextInfoKHRFunc)(
+    const cl_context_properties *properties,
+    cl_gl_context_info param_name,
+    size_t param_value_size,
+    void *param_value,
+    size_t *param_value_size_ret);
+
+/**
+ * @brief Return the platform with a device associated with the current GLX
+ * context, queried with clGetGLContextInfoKHR on each platform.
+ */
+static cl_platform_id GetGLContextPlatform(void)
+{
+    std::vector<cl_platform_id> platforms = GetPlatformIDs();
+    for (auto &platform : platforms) {
+        GetGLContextInfoKHRFunc get_gl_context_info =
+            reinterpret_cast<GetGLContextInfoKHRFunc>(
+                clGetExtensionFunctionAddressForPlatform(
+                    platform, "clGetGLContextInfoKHR"));
+        if (get_gl_context_info == NULL) {
+            continue;
+        }
+
+        const cl_context_properties context_properties[] = {
+            CL_GL_CONTEXT_KHR, (cl_context_properties) glXGetCurrentContext(),
+            CL_GLX_DISPLAY_KHR, (cl_context_properties) glXGetCurrentDisplay(),
+            CL_CONTEXT_PLATFORM, (cl_context_properties) platform,
+            (cl_context_properties) NULL};
+
+        cl_device_id device = NULL;
+        cl_int err = get_gl_context_info(
+            context_properties,
+            CL_CURRENT_DEVICE_FOR_GL_CONTEXT_KHR,
+            sizeof(cl_device_id),
+            &device,
+            NULL);
+        if (err == CL_SUCCESS && device != NULL) {
+            return platform;
+        }
+    }
+    ito_throw("no platform with a device for the current OpenGL context");
+}
+#endif
+
 /** ---------------------------------------------------------------------------
  * @brief Create a shared OpenCL/OpenGL context based on the active OpenGL
  * context associated with the specified device.
@@ -41,6 +95,15 @@ cl_context CreateFromGLContext(const cl_device_id &gl_device)
         (cl_context_properties) cgl_sharegroup,
         (cl_context_properties) NULL};
 #elif defined(__linux__)
+    cl_platform_id platform;
+    cl_int ret = clGetDeviceInfo(
+        gl_device,
+        CL_DEVICE_PLATFORM,
+        sizeof(cl_platform_id),
+        &platform,
+        NULL);
+    ito_assert(ret == CL_SUCCESS, "clGetDeviceInfo");
+
     const cl_context_properties context_properties[] = {
         CL_GL_CONTEXT_KHR, (cl_context_properties) glXGetCurrentContext(),
         CL_GLX_DISPLAY_KHR, (cl_context_properties) glXGetCurrentDisplay(),
@@ -77,6 +140,8 @@ cl_context CreateFromGLContext(void)
         (cl_context_properties) cgl_sharegroup,
         (cl_context_properties) NULL};
 #elif defined(__linux__)
+    cl_platform_id platform = GetGLContextPlatform();
+
     const cl_context_properties context_properties[] = {
         CL_GL_CONTEXT_KHR, (cl_context_properties) glXGetCurrentContext(),
         CL_GLX_DISPLAY_KHR, (cl_context_properties) glXGetCurrentDisplay(),
@@ -288,7 +353,7 @@ cl_int EnqueueReleaseGLObjects(
      * Ensure any OpenCL commands that might affect the shared OpenGL memory
      * objects are finished before releasing them.
      */
-    Queue::finish(queue);
+    Finish(queue);
 
     /* Release the shared OpenGL memory objects. */
     cl_event tmp;
@@ -324,6 +389,299 @@ cl_int EnqueueReleaseGLObjects(
         event);
 }
 
+/** ---------------------------------------------------------------------------
+ * @brief Function pointer type of the cl_khr_gl_event extension entry point.
+ */
+typedef cl_event (CL_API_CALL *CreateEventFromGLsyncKHRFunc)(
+    cl_context context,
+    GLsync sync,
+    cl_int *errcode_ret);
+
+/**
+ * @brief Return true if the device extension string contains the extension.
+ */
+static bool HasDeviceExtension(const cl_device_id &device, const char *name)
+{
+    size_t param_value_size;
+    cl_int err = clGetDeviceInfo(
+        device,
+        CL_DEVICE_EXTENSIONS,
+        0,
+        NULL,
+        &param_value_size);
+    ito_assert(err == CL_SUCCESS, "clGetDeviceInfo");
+
+    std::string param_value(param_value_size, '\0');
+    err = clGetDeviceInfo(
+        device,
+        CL_DEVICE_EXTENSIONS,
+        param_value_size,
+        (void *) &param_value[0],
+        NULL);
+    ito_assert(err == CL_SUCCESS, "clGetDeviceInfo");
+
+    return (param_value.find(name) != std::string::npos);
+}
+
+/**
+ * @brief Return true if the current OpenGL context supports the extension.
+ */
+static bool HasGLExtension(const char *name)
+{
+    GLint n_extensions = 0;
+    glGetIntegerv(GL_NUM_EXTENSIONS, &n_extensions);
+    for (GLint i = 0; i < n_extensions; ++i) {
+        const GLubyte *extension = glGetStringi(GL_EXTENSIONS, i);
+        if (extension != NULL &&
+            std::strcmp(reinterpret_cast<const char *>(extension), name) == 0) {
+            return true;
+        }
+    }
+    return false;
+}
+
+/**
+ * @brief Block the host until the OpenGL fence is signaled, flushing the
+ * OpenGL command stream on the first wait.
+ */
+static void ClientWaitSync(GLsync sync)
+{
+    static const GLuint64 kTimeout = 1000000;    /* 1 ms in nanoseconds */
+    GLbitfield flags = GL_SYNC_FLUSH_COMMANDS_BIT;
+    while (true) {
+        GLenum status = glClientWaitSync(sync, flags, kTimeout);
+        ito_assert(status != GL_WAIT_FAILED, "glClientWaitSync");
+        if (status == GL_ALREADY_SIGNALED ||
+            status == GL_CONDITION_SATISFIED) {
+            break;
+        }
+        flags = 0;
+    }
+}
+
+/** ---------------------------------------------------------------------------
+ * @brief Create a session over the shared context and command queue, and
+ * query the synchronization extensions supported by the device and the
+ * current OpenGL context.
+ */
+GLSession GLSession::Create(
+    const cl_context &context,
+    const cl_device_id &device,
+    const cl_command_queue &queue)
+{
+    GLSession session;
+    session.context = context;
+    session.queue = queue;
+    session.is_acquired = false;
+
+    session.has_cl_gl_event = false;
+    session.has_gl_cl_event = false;
+    session.acquire_sync = NULL;
+    session.acquire_event = NULL;
+    session.create_event_from_gl_sync = NULL;
+
+    if (HasDeviceExtension(device, "cl_khr_gl_event")) {
+        cl_platform_id platform;
+        cl_int err = clGetDeviceInfo(
+            device,
+            CL_DEVICE_PLATFORM,
+            sizeof(cl_platform_id),
+            &platform,
+            NULL);
+        ito_assert(err == CL_SUCCESS, "clGetDeviceInfo");
+
+        session.create_event_from_gl_sync =
+            clGetExtensionFunctionAddressForPlatform(
+                platform, "clCreateEventFromGLsyncKHR");
+        session.has_cl_gl_event = (session.create_event_from_gl_sync != NULL);
+    }
+
+#if defined(GL_ARB_cl_event)
+    session.has_gl_cl_event = HasGLExtension("GL_ARB_cl_event");
+#endif
+
+    return session;
+}
+
+/**
+ * @brief Release the session synchronization objects. The shared memory
+ * objects are owned by the caller and are not released.
+ */
+void GLSession::Destroy(GLSession &session)
+{
+    ito_assert(!session.is_acquired, "session is still acquired");
+    if (session.acquire_event != NULL) {
+        WaitForEvent(session.acquire_event);
+        ReleaseEvent(session.acquire_event);
+        session.acquire_event = NULL;
+    }
+    if (session.acquire_sync != NULL) {
+        glDeleteSync(session.acquire_sync);
+        session.acquire_sync = NULL;
+    }
+    session.mem_objects.clear();
+}
+
+/**
+ * @brief Add a shared memory object to the session batch.
+ */
+void GLSession::Attach(GLSession &session, const cl_mem &mem_object)
+{
+    ito_assert(!session.is_acquired, "session is acquired");
+    auto it = std::find(
+        session.mem_objects.begin(),
+        session.mem_objects.end(),
+        mem_object);
+    if (it == session.mem_objects.end()) {
+        session.mem_objects.push_back(mem_object);
+    }
+}
+
+/**
+ * @brief Remove a shared memory object from the session batch.
+ */
+void GLSession::Detach(GLSession &session, const cl_mem &mem_object)
+{
+    ito_assert(!session.is_acquired, "session is acquired");
+    session.mem_objects.erase(
+        std::remove(
+            session.mem_objects.begin(),
+            session.mem_objects.end(),
+            mem_object),
+        session.mem_objects.end());
+}
+
+/**
+ * @brief Acquire all shared memory objects in the session batch.
+ *
+ * A fence is inserted after the OpenGL commands already issued. With
+ * cl_khr_gl_event, the fence is converted to an OpenCL event and the acquire
+ * command waits on it on the device. Otherwise, the host waits on the fence,
+ * which only covers the commands issued before it.
+ */
+cl_int GLSession::Acquire(
+    GLSession &session,
+    const std::vector<cl_event> *event_wait_list,
+    cl_event *event)
+{
+    ito_assert(!session.is_acquired, "session is already acquired");
+
+    /* Release the synchronization objects of the previous frame. */
+    if (session.acquire_event != NULL) {
+        WaitForEvent(session.acquire_event);
+        ReleaseEvent(session.acquire_event);
+        session.acquire_event = NULL;
+    }
+    if (session.acquire_sync != NULL) {
+        glDeleteSync(session.acquire_sync);
+        session.acquire_sync = NULL;
+    }
+
+    /* Fence the OpenGL commands that might affect the shared objects. */
+    std::vector<cl_event> wait_list;
+    if (event_wait_list != NULL) {
+        wait_list = *event_wait_list;
+    }
+
+    GLsync sync = glFenceSync(GL_SYNC_GPU_COMMANDS_COMPLETE, 0);
+    ito_assert(sync != NULL, "glFenceSync");
+    if (session.has_cl_gl_event) {
+        glFlush();
+
+        CreateEventFromGLsyncKHRFunc create_event_from_gl_sync =
+            reinterpret_cast<CreateEventFromGLsyncKHRFunc>(
+                session.create_event_from_gl_sync);
+
+        cl_int err;
+        cl_event gl_event = create_event_from_gl_sync(
+            session.context,
+            sync,
+            &err);
+        ito_assert(err == CL_SUCCESS, "clCreateEventFromGLsyncKHR");
+
+        /* The fence must outlive the event created from it. */
+        session.acquire_sync = sync;
+        session.acquire_event = gl_event;
+        wait_list.push_back(gl_event);
+    } else {
+        ClientWaitSync(sync);
+        glDeleteSync(sync);
+    }
+
+    /* Acquire the shared OpenGL memory objects in a single command. */
+    bool has_event_wait_list = !wait_list.empty();
+    cl_event tmp;
+    cl_int err = clEnqueueAcquireGLObjects(
+        session.queue,
+        static_cast<cl_uint>(session.mem_objects.size()),
+        !session.mem_objects.empty() ? session.mem_objects.data() : NULL,
+        has_event_wait_list ? static_cast<cl_uint>(wait_list.size()) : 0,
+        has_event_wait_list ? wait_list.data() : NULL,
+        (event != NULL) ? &tmp : NULL);
+    ito_assert(err == CL_SUCCESS, "clEnqueueAcquireGLObjects");
+
+    session.is_acquired = true;
+    if (event != NULL && err == CL_SUCCESS) {
+        *event = tmp;
+    }
+    return err;
+}
+
+/**
+ * @brief Release all shared memory objects in the session batch.
+ *
+ * With GL_ARB_cl_event, the release event is converted to an OpenGL sync
+ * object and the OpenGL server waits on it without stalling the host.
+ * Otherwise, the host waits on the release event, which only covers the
+ * OpenCL commands the release depends on.
+ */
+cl_int GLSession::Release(
+    GLSession &session,
+    const std::vector<cl_event> *event_wait_list,
+    cl_event *event)
+{
+    ito_assert(session.is_acquired, "session is not acquired");
+
+    /* Release the shared OpenGL memory objects in a single command. */
+    bool has_event_wait_list = (event_wait_list && !event_wait_list->empty());
+    cl_event release_event;
+    cl_int err = clEnqueueReleaseGLObjects(
+        session.queue,
+        static_cast<cl_uint>(session.mem_objects.size()),
+        !session.mem_objects.empty() ? session.mem_objects.data() : NULL,
+        has_event_wait_list ? static_cast<cl_uint>(event_wait_list->size()) : 0,
+        has_event_wait_list ? event_wait_list->data() : NULL,
+        &release_event);
+    ito_assert(err == CL_SUCCESS, "clEnqueueReleaseGLObjects");
+    session.is_acquired = false;
+
+    /* Ensure OpenGL does not use the shared objects before the release. */
+    bool has_waited = false;
+#if defined(GL_ARB_cl_event)
+    if (session.has_gl_cl_event) {
+        Flush(session.queue);
+        GLsync sync = glCreateSyncFromCLeventARB(
+            session.context,
+            release_event,
+            0);
+        ito_assert(sync != NULL, "glCreateSyncFromCLeventARB");
+        glWaitSync(sync, 0, GL_TIMEOUT_IGNORED);
+        glDeleteSync(sync);
+        has_waited = true;
+    }
+#endif
+    if (!has_waited) {
+        WaitForEvent(release_event);
+    }
+
+    if (event != NULL) {
+        *event = release_event;
+    } else {
+        ReleaseEvent(release_event);
+    }
+    return err;
+}
+
 } /* cl */
 } /* ito */
 #endif /* ITO_ENABLE_CL_GL_INTEROP */
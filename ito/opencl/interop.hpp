@@ -16,6 +16,8 @@
 #include "base.hpp"
 
 #if defined(ITO_ENABLE_CL_GL_INTEROP)
+#include <glad/glad.h>
+
 namespace ito {
 namespace cl {
 
@@ -118,6 +120,54 @@ cl_int EnqueueReleaseGLObjects(
     const std::vector<cl_event> *event_wait_list,
     cl_event *event);
 
+/** ---------------------------------------------------------------------------
+ * GLSession
+ * @brief Batch of shared OpenCL/OpenGL memory objects acquired and released
+ * together once per frame.
+ *
+ * The session synchronizes with the narrowest available primitive instead of
+ * a glFinish/clFinish pair:
+ *  - acquire waits on an OpenCL event created from an OpenGL fence if the
+ *    device supports cl_khr_gl_event, otherwise the host waits on the fence.
+ *  - release inserts a server-side OpenGL wait on the OpenCL release event if
+ *    GL_ARB_cl_event is supported, otherwise the host waits on the event.
+ */
+struct GLSession {
+    /* Session state */
+    cl_context context;
+    cl_command_queue queue;
+    std::vector<cl_mem> mem_objects;
+    bool is_acquired;
+
+    /* Synchronization state */
+    bool has_cl_gl_event;               /* cl_khr_gl_event */
+    bool has_gl_cl_event;               /* GL_ARB_cl_event */
+    GLsync acquire_sync;                /* fence guarding the last acquire */
+    cl_event acquire_event;             /* event created from acquire_sync */
+    void *create_event_from_gl_sync;    /* clCreateEventFromGLsyncKHR */
+
+    /* Session factory functions */
+    static GLSession Create(
+        const cl_context &context,
+        const cl_device_id &device,
+        const cl_command_queue &queue);
+    static void Destroy(GLSession &session);
+
+    /* Add or remove a shared memory object from the session batch. */
+    static void Attach(GLSession &session, const cl_mem &mem_object);
+    static void Detach(GLSession &session, const cl_mem &mem_object);
+
+    /* Acquire and release all shared memory objects in a single command. */
+    static cl_int Acquire(
+        GLSession &session,
+        const std::vector<cl_event> *event_wait_list = NULL,
+        cl_event *event = NULL);
+    static cl_int Release(
+        GLSession &session,
+        const std::vector<cl_event> *event_wait_list = NULL,
+        cl_event *event = NULL);
+};
+
 } /* cl */
 } /* ito */
 #endif /* ITO_ENABLE_CL_GL_INTEROP */
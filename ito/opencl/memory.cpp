@@ -44,6 +44,29 @@ cl_mem CreateBuffer(
     return buffer;
 }
 
+/**
+ * @brief Create a sub-buffer memory object over a region of the buffer. The
+ * origin must be aligned to CL_DEVICE_MEM_BASE_ADDR_ALIGN.
+ */
+cl_mem CreateSubBuffer(
+    const cl_mem &buffer,
+    cl_mem_flags flags,
+    size_t origin,
+    size_t size)
+{
+    cl_buffer_region region = {origin, size};
+
+    cl_int err;
+    cl_mem sub_buffer = clCreateSubBuffer(
+        buffer,
+        flags,
+        CL_BUFFER_CREATE_TYPE_REGION,
+        &region,
+        &err);
+    ito_assert(err == CL_SUCCESS, "clCreateSubBuffer");
+    return sub_buffer;
+}
+
 /**
  * @brief Create a 1d-image of type CL_MEM_OBJECT_IMAGE1D.
  * @note Size of buffer that host_ptr points to >= row_pitch.
@@ -26,6 +26,16 @@ cl_mem CreateBuffer(
     size_t size,
     void *host_ptr);
 
+/**
+ * @brief Create a sub-buffer memory object over a region of the buffer. The
+ * origin must be aligned to CL_DEVICE_MEM_BASE_ADDR_ALIGN.
+ */
+cl_mem CreateSubBuffer(
+    const cl_mem &buffer,
+    cl_mem_flags flags,
+    size_t origin,
+    size_t size);
+
 /**
  * @brief Create a 1d-image of type CL_MEM_OBJECT_IMAGE1D.
  */
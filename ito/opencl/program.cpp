@@ -10,11 +10,23 @@
  */
 
 #include <fstream>
+#include <map>
+#include <tuple>
 #include "program.hpp"
 
 namespace ito {
 namespace cl {
 
+/**
+ * @brief Program cache keyed by context, device, build options and source.
+ */
+typedef std::tuple<
+    cl_context,
+    cl_device_id,
+    std::string,
+    std::string> ProgramCacheKey;
+static std::map<ProgramCacheKey, cl_program> gProgramCache;
+
 /**
  * @brief Load program source from the specified filename.
  */
@@ -251,5 +263,39 @@ std::string GetProgramKernelNames(const cl_program &program)
     return kernel_names;
 }
 
+/** ---------------------------------------------------------------------------
+ * @brief Return a program object built from the source for the specified
+ * device. Programs are built once per context, device, source and options,
+ * and owned by the program cache.
+ */
+cl_program GetCachedProgram(
+    const cl_context &context,
+    const cl_device_id &device,
+    const std::string &source,
+    const std::string &options)
+{
+    ProgramCacheKey key = std::make_tuple(context, device, options, source);
+    auto it = gProgramCache.find(key);
+    if (it != gProgramCache.end()) {
+        return it->second;
+    }
+
+    cl_program program = CreateProgramWithSource(context, source);
+    BuildProgram(program, device, options);
+    gProgramCache.emplace(std::move(key), program);
+    return program;
+}
+
+/**
+ * @brief Release all program objects in the program cache.
+ */
+void ReleaseProgramCache(void)
+{
+    for (auto &it : gProgramCache) {
+        ReleaseProgram(it.second);
+    }
+    gProgramCache.clear();
+}
+
 } /* cl */
 } /* ito */
@@ -83,6 +83,22 @@ size_t GetProgramNumKernels(const cl_program &program);
  */
 std::string GetProgramKernelNames(const cl_program &program);
 
+/** ---------------------------------------------------------------------------
+ * @brief Return a program object built from the source for the specified
+ * device. Programs are built once per context, device, source and options,
+ * and owned by the program cache.
+ */
+cl_program GetCachedProgram(
+    const cl_context &context,
+    const cl_device_id &device,
+    const std::string &source,
+    const std::string &options = "");
+
+/**
+ * @brief Release all program objects in the program cache.
+ */
+void ReleaseProgramCache(void);
+
 } /* cl */
 } /* ito */
 
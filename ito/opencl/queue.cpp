@@ -912,6 +912,151 @@ cl_int EnqueueNativeKernel(
     return err;
 }
 
+/**
+ * @brief Native kernel trampoline. The argument block holds a pointer to a
+ * heap allocated copy of the host callable, owned by the trampoline.
+ */
+static void NativeTaskFunc(void *args)
+{
+    std::function<void()> *task = *static_cast<std::function<void()> **>(args);
+    (*task)();
+    delete task;
+}
+
+/**
+ * @brief Execute a host callable as a native kernel. The device must report
+ * CL_EXEC_NATIVE_KERNEL in CL_DEVICE_EXECUTION_CAPABILITIES.
+ */
+cl_int EnqueueNativeKernel(
+    const cl_command_queue &queue,
+    const std::function<void()> &task,
+    const std::vector<cl_event> *event_wait_list,
+    cl_event *event)
+{
+    /* The runtime copies the argument block, ie the pointer to the task. */
+    std::function<void()> *task_ptr = new std::function<void()>(task);
+
+    bool has_event_wait_list = (event_wait_list && !event_wait_list->empty());
+    cl_event tmp;
+    cl_int err = clEnqueueNativeKernel(
+        queue,
+        NativeTaskFunc,
+        &task_ptr,
+        sizeof(task_ptr),
+        0,
+        NULL,
+        NULL,
+        has_event_wait_list ? static_cast<cl_uint>(event_wait_list->size()) : 0,
+        has_event_wait_list ? event_wait_list->data() : NULL,
+        (event != NULL) ? &tmp : NULL);
+    if (err != CL_SUCCESS) {
+        delete task_ptr;
+    }
+    ito_assert(err == CL_SUCCESS, "clEnqueueNativeKernel");
+
+    if (event != NULL && err == CL_SUCCESS) {
+        *event = tmp;
+    }
+    return err;
+}
+
+/**
+ * @brief Host task state passed to the marker event callback.
+ */
+struct HostTask {
+    std::function<void()> func;
+    cl_event user_event;
+};
+
+/**
+ * @brief Marker event callback. Run the host task if its dependencies
+ * completed successfully and signal the user event with the task status.
+ * No exception may unwind through the runtime callback frame.
+ */
+static void CL_CALLBACK HostTaskCallback(
+    cl_event,
+    cl_int event_command_exec_status,
+    void *user_data)
+{
+    HostTask *task = static_cast<HostTask *>(user_data);
+
+    cl_int status = event_command_exec_status;
+    if (status == CL_COMPLETE) {
+        try {
+            task->func();
+        } catch (std::exception &e) {
+            std::cerr << "host task error: " << e.what() << std::endl;
+            status = CL_INVALID_OPERATION;
+        } catch (...) {
+            std::cerr << "host task error: unknown exception" << std::endl;
+            status = CL_INVALID_OPERATION;
+        }
+    }
+
+    clSetUserEventStatus(task->user_event, status);
+    clReleaseEvent(task->user_event);
+    delete task;
+}
+
+/**
+ * @brief Execute a host callable once the commands in the event wait list, or
+ * all previous commands if the list is empty, have completed. The task runs
+ * on the runtime callback thread without blocking the host, and the following
+ * commands in the queue wait for it to complete. Works on any device.
+ */
+cl_int EnqueueHostTask(
+    const cl_command_queue &queue,
+    const std::function<void()> &task,
+    const std::vector<cl_event> *event_wait_list,
+    cl_event *event)
+{
+    cl_int err;
+
+    /* Get the queue context to create the user event signaling the task. */
+    cl_context context;
+    err = clGetCommandQueueInfo(
+        queue,
+        CL_QUEUE_CONTEXT,
+        sizeof(cl_context),
+        &context,
+        NULL);
+    ito_assert(err == CL_SUCCESS, "clGetCommandQueueInfo");
+
+    cl_event user_event = clCreateUserEvent(context, &err);
+    ito_assert(err == CL_SUCCESS, "clCreateUserEvent");
+
+    /* Marker completing with the task dependencies. */
+    cl_event marker;
+    EnqueueMarkerWithWaitList(queue, event_wait_list, &marker);
+
+    /*
+     * The callback may run before this function returns, and owns a reference
+     * to the user event it signals.
+     */
+    err = clRetainEvent(user_event);
+    ito_assert(err == CL_SUCCESS, "clRetainEvent");
+
+    HostTask *host_task = new HostTask{task, user_event};
+    err = clSetEventCallback(marker, CL_COMPLETE, HostTaskCallback, host_task);
+    if (err != CL_SUCCESS) {
+        clReleaseEvent(user_event);
+        delete host_task;
+    }
+    ito_assert(err == CL_SUCCESS, "clSetEventCallback");
+
+    err = clReleaseEvent(marker);
+    ito_assert(err == CL_SUCCESS, "clReleaseEvent");
+
+    /* Following commands in the queue wait for the host task. */
+    std::vector<cl_event> user_event_list{user_event};
+    EnqueueBarrierWithWaitList(queue, &user_event_list, event);
+    err = clReleaseEvent(user_event);
+    ito_assert(err == CL_SUCCESS, "clReleaseEvent");
+
+    /* Submit the marker so the callback can fire without a blocking call. */
+    return Flush(queue);
+}
+
 /** ---------------------------------------------------------------------------
  * @brief Issues all previously queued OpenCL commands in a command-queue to the
  * device associated with the command-queue.
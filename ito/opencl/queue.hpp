@@ -15,6 +15,7 @@
 #include <array>
 #include <vector>
 #include <utility>
+#include <functional>
 #include "base.hpp"
 #include "ndrange.hpp"
 
@@ -382,6 +383,28 @@ cl_int EnqueueNativeKernel(
     const std::vector<cl_event> *event_wait_list = NULL,
     cl_event *event = NULL);
 
+/**
+ * @brief Execute a host callable as a native kernel. The device must report
+ * CL_EXEC_NATIVE_KERNEL in CL_DEVICE_EXECUTION_CAPABILITIES.
+ */
+cl_int EnqueueNativeKernel(
+    const cl_command_queue &queue,
+    const std::function<void()> &task,
+    const std::vector<cl_event> *event_wait_list = NULL,
+    cl_event *event = NULL);
+
+/**
+ * @brief Execute a host callable once the commands in the event wait list, or
+ * all previous commands if the list is empty, have completed. The task runs
+ * on the runtime callback thread without blocking the host, and the following
+ * commands in the queue wait for it to complete. Works on any device.
+ */
+cl_int EnqueueHostTask(
+    const cl_command_queue &queue,
+    const std::function<void()> &task,
+    const std::vector<cl_event> *event_wait_list = NULL,
+    cl_event *event = NULL);
+
 /** ---------------------------------------------------------------------------
  * @brief Issues all previously queued OpenCL commands in a command-queue to the
  * device associated with the command-queue.
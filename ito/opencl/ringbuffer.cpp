@@ -0,0 +1,174 @@
+/*
+ * ringbuffer.cpp
+ *
+ * Copyright (c) 2020 Carlos Braga
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the MIT License.
+ *
+ * See accompanying LICENSE.md or https://opensource.org/licenses/MIT.
+ */
+
+#include <algorithm>
+#include "memory.hpp"
+#include "event.hpp"
+#include "queue.hpp"
+#include "ringbuffer.hpp"
+
+namespace ito {
+namespace cl {
+
+/** ---------------------------------------------------------------------------
+ * @brief Create a ring of n_slots slots with slot_size bytes each. Slots are
+ * aligned to CL_DEVICE_MEM_BASE_ADDR_ALIGN so they can be sub-buffers.
+ */
+RingBuffer RingBuffer::Create(
+    const cl_context &context,
+    const cl_device_id &device,
+    const size_t slot_size,
+    const size_t n_slots)
+{
+    ito_assert(slot_size > 0, "invalid slot size");
+    ito_assert(n_slots > 1, "invalid number of slots");
+
+    /* Query the sub-buffer alignment. */
+    cl_uint base_addr_align;
+    cl_int err = clGetDeviceInfo(
+        device,
+        CL_DEVICE_MEM_BASE_ADDR_ALIGN,
+        sizeof(cl_uint),
+        &base_addr_align,
+        NULL);
+    ito_assert(err == CL_SUCCESS, "clGetDeviceInfo");
+
+    /* Create the backing buffer and the slot sub-buffers. */
+    size_t align = std::max(base_addr_align / 8, (cl_uint) 1);
+
+    RingBuffer ring;
+    ring.slot_size = slot_size;
+    ring.slot_stride = align * ((slot_size + align - 1) / align);
+    ring.buffer = CreateBuffer(
+        context,
+        CL_MEM_READ_ONLY | CL_MEM_ALLOC_HOST_PTR,
+        n_slots * ring.slot_stride,
+        NULL);
+    for (size_t i = 0; i < n_slots; ++i) {
+        ring.slots.push_back(CreateSubBuffer(
+            ring.buffer,
+            CL_MEM_READ_ONLY,
+            i * ring.slot_stride,
+            slot_size));
+    }
+
+    /* Map the slots on a queue without consumer kernels. */
+    ring.map_queue = CreateCommandQueue(context, device);
+    ring.host_ptr = NULL;
+
+    ring.head = 0;
+    ring.is_writing = false;
+    ring.fences.resize(n_slots, NULL);
+    return ring;
+}
+
+/**
+ * @brief Wait for the consumers of all slots and release the buffer.
+ */
+void RingBuffer::Destroy(RingBuffer &ring)
+{
+    ito_assert(!ring.is_writing, "ring buffer slot is being written");
+
+    for (auto &fence : ring.fences) {
+        if (fence != NULL) {
+            WaitForEvent(fence);
+            ReleaseEvent(fence);
+            fence = NULL;
+        }
+    }
+
+    Finish(ring.map_queue);
+    ReleaseCommandQueue(ring.map_queue);
+    ring.host_ptr = NULL;
+
+    for (auto &slot : ring.slots) {
+        ReleaseMemObject(slot);
+    }
+    ReleaseMemObject(ring.buffer);
+    ring.slots.clear();
+    ring.fences.clear();
+}
+
+/** ---------------------------------------------------------------------------
+ * @brief Map the slot sub-buffer at the head of the ring and return a host
+ * pointer to it. Blocks only if the slot consumer, fenced when the ring last
+ * passed over the slot, has not completed yet.
+ */
+void *RingBuffer::Begin(RingBuffer &ring)
+{
+    ito_assert(!ring.is_writing, "ring buffer slot is already being written");
+
+    cl_event &fence = ring.fences[ring.head];
+    if (fence != NULL) {
+        WaitForEvent(fence);
+        ReleaseEvent(fence);
+        fence = NULL;
+    }
+
+    ring.is_writing = true;
+    ring.host_ptr = EnqueueMapBuffer(
+        ring.map_queue,
+        ring.slots[ring.head],
+        CL_TRUE,
+        CL_MAP_WRITE_INVALIDATE_REGION,
+        0,
+        ring.slot_size);
+    return ring.host_ptr;
+}
+
+/**
+ * @brief Unmap the slot at the head of the ring, advance the head and return
+ * the slot sub-buffer to pass to the consumer kernel. The commands enqueued
+ * on the consumer queue after End wait for the unmap to complete.
+ */
+cl_mem RingBuffer::End(RingBuffer &ring, const cl_command_queue &queue)
+{
+    ito_assert(ring.is_writing, "ring buffer slot is not being written");
+
+    cl_event unmap_event;
+    EnqueueUnmapMemObject(
+        ring.map_queue,
+        ring.slots[ring.head],
+        ring.host_ptr,
+        NULL,
+        &unmap_event);
+    Flush(ring.map_queue);
+    ring.host_ptr = NULL;
+
+    std::vector<cl_event> wait_list{unmap_event};
+    EnqueueBarrierWithWaitList(queue, &wait_list);
+    ReleaseEvent(unmap_event);
+
+    cl_mem slot = ring.slots[ring.head];
+    ring.head = (ring.head + 1) % ring.slots.size();
+    ring.is_writing = false;
+    return slot;
+}
+
+/**
+ * @brief Fence the slot last returned by End with the consumer event. The
+ * ring retains the event until the slot is reused.
+ */
+void RingBuffer::Fence(RingBuffer &ring, const cl_event &event)
+{
+    size_t n_slots = ring.slots.size();
+    cl_event &fence = ring.fences[(ring.head + n_slots - 1) % n_slots];
+    if (fence != NULL) {
+        ReleaseEvent(fence);
+    }
+
+    cl_int err = clRetainEvent(event);
+    ito_assert(err == CL_SUCCESS, "clRetainEvent");
+    fence = event;
+}
+
+} /* cl */
+} /* ito */
@@ -0,0 +1,84 @@
+/*
+ * ringbuffer.hpp
+ *
+ * Copyright (c) 2020 Carlos Braga
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the MIT License.
+ *
+ * See accompanying LICENSE.md or https://opensource.org/licenses/MIT.
+ */
+
+#ifndef ITO_OPENCL_RINGBUFFER_H_
+#define ITO_OPENCL_RINGBUFFER_H_
+
+#include <vector>
+#include "base.hpp"
+
+namespace ito {
+namespace cl {
+
+/**
+ * RingBuffer
+ * @brief Ring of fixed size slots over a CL_MEM_ALLOC_HOST_PTR buffer for
+ * streaming host data into kernels.
+ *
+ * The producer writes the slot at the head of the ring and passes the slot
+ * sub-buffer to the consuming kernel. The consumer event fences the slot,
+ * and the producer only waits on it when the ring wraps around, so the host
+ * writes new slots while the device consumes older ones:
+ *
+ *  void *ptr = RingBuffer::Begin(ring);
+ *  ... write slot_size bytes to ptr ...
+ *  cl_mem slot = RingBuffer::End(ring, queue);
+ *  SetKernelArg(kernel, 0, sizeof(cl_mem), &slot);
+ *  EnqueueNDRangeKernel(queue, kernel, ..., NULL, &event);
+ *  RingBuffer::Fence(ring, event);
+ *
+ * Each slot sub-buffer is mapped with CL_MAP_WRITE_INVALIDATE_REGION in
+ * Begin and unmapped in End. Only the slot sub-buffer is mapped, never the
+ * backing buffer, so the kernels reading the other slots are not affected.
+ * The maps and unmaps are enqueued on a command queue owned by the ring, and
+ * do not wait for the kernels queued on the consumer queue. End enqueues a
+ * barrier on the consumer queue waiting only for the slot unmap.
+ *
+ * The ring is not persistently mapped, and the cost of a blocking map and an
+ * unmap per slot remains. The ring only removes the wait for the consumer
+ * kernels of the other slots.
+ */
+struct RingBuffer {
+    /* Backing buffer and slot sub-buffers */
+    cl_mem buffer;
+    std::vector<cl_mem> slots;
+    size_t slot_size;                   /* slot size in bytes */
+    size_t slot_stride;                 /* aligned distance between slots */
+
+    /* Host mapping */
+    cl_command_queue map_queue;         /* slot map and unmap queue */
+    void *host_ptr;                     /* current slot mapping */
+
+    /* Producer head and consumer fences */
+    size_t head;
+    bool is_writing;
+    std::vector<cl_event> fences;
+
+    /* Ring buffer factory functions */
+    static RingBuffer Create(
+        const cl_context &context,
+        const cl_device_id &device,
+        const size_t slot_size,
+        const size_t n_slots);
+    static void Destroy(RingBuffer &ring);
+
+    /* Producer interface */
+    static void *Begin(RingBuffer &ring);
+    static cl_mem End(RingBuffer &ring, const cl_command_queue &queue);
+
+    /* Consumer interface */
+    static void Fence(RingBuffer &ring, const cl_event &event);
+};
+
+} /* cl */
+} /* ito */
+
+#endif /* ITO_OPENCL_RINGBUFFER_H_ */
@@ -48,18 +48,35 @@
 #include "opengl/glfw.hpp"
 #include "opengl/error.hpp"
 #include "opengl/image.hpp"
+#include "opengl/compressedimage.hpp"
 #include "opengl/imageformat.hpp"
+#include "opengl/compute.hpp"
 #include "opengl/mesh.hpp"
+#include "opengl/meshbatch.hpp"
+#include "opengl/meshlod.hpp"
+#include "opengl/meshoptimizer.hpp"
+#include "opengl/packedmesh.hpp"
+#include "opengl/readback.hpp"
+#include "opengl/rendergraph.hpp"
+#include "opengl/renderqueue.hpp"
+#include "opengl/state.hpp"
 #include "opengl/timer.hpp"
 
 #include "opengl/buffer.hpp"
 #include "opengl/framebuffer.hpp"
+#include "opengl/framebufferpool.hpp"
 #include "opengl/renderbuffer.hpp"
+#include "opengl/streambuffer.hpp"
 #include "opengl/texture.hpp"
+#include "opengl/texturestream.hpp"
+#include "opengl/uniformbuffer.hpp"
 #include "opengl/vertexarray.hpp"
+#include "opengl/vertexformat.hpp"
 
 #include "opengl/glsl/attribute.hpp"
+#include "opengl/glsl/block.hpp"
 #include "opengl/glsl/program.hpp"
+#include "opengl/glsl/reflection.hpp"
 #include "opengl/glsl/shader.hpp"
 #include "opengl/glsl/uniform.hpp"
 #include "opengl/glsl/variable.hpp"
@@ -10,6 +10,7 @@
  */
 
 #include "buffer.hpp"
+#include "state.hpp"
 
 namespace ito {
 namespace gl {
@@ -48,7 +49,8 @@ namespace gl {
 GLuint CreateBuffer(
     const GLenum target,
     const GLsizeiptr size,
-    const GLenum usage)
+    const GLenum usage,
+    const GLvoid *data)
 {
     ito_assert(size > 0, "invalid buffer data store size");
 
@@ -56,23 +58,32 @@ GLuint CreateBuffer(
      * Generate a new buffer object name and bind it to the target point.
      * No buffer object is associated with the name set by glGenBuffers
      * until it is bound to the target by a call to glBindBuffer.
+     *
+     * The element array buffer binding is part of the vertex array state.
+     * Element buffers are uploaded through the copy write target instead,
+     * leaving the vertex array object bound by the caller untouched.
      */
+    GLenum upload = (target == GL_ELEMENT_ARRAY_BUFFER)
+        ? GL_COPY_WRITE_BUFFER
+        : target;
+
     GLuint buffer;
     glGenBuffers(1, &buffer);
-    glBindBuffer(target, buffer);
+    BindBuffer(upload, buffer);
     ito_assert(glIsBuffer(buffer), "failed to generate buffer object");
 
     /*
      * Create a new data store for a buffer object. Use the buffer object
      * currently bound to the target (glBufferData) or use a buffer object
      * associated with the name (glNamedBufferData).
+     * The data store is initialized with the data if it is not null.
      */
-    glBufferData(target, size, NULL, usage);
+    glBufferData(upload, size, data, usage);
 
     /*
      * Unbind the buffer from the target point and return.
      */
-    glBindBuffer(target, 0);
+    BindBuffer(upload, 0);
     return buffer;
 }
 
@@ -81,6 +92,7 @@ GLuint CreateBuffer(
  */
 void DestroyBuffer(const GLuint &buffer)
 {
+    InvalidateStateObject(buffer);
     glDeleteBuffers(1, &buffer);
 }
 
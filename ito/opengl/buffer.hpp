@@ -18,12 +18,14 @@ namespace ito {
 namespace gl {
 
 /**
- * @brief Create a buffer object.
+ * @brief Create a buffer object. If data is not null, initialize the data
+ * store with size bytes of data, in the same glBufferData call.
  */
 GLuint CreateBuffer(
     const GLenum target,
     const GLsizeiptr size,
-    const GLenum usage);
+    const GLenum usage,
+    const GLvoid *data = NULL);
 
 /**
  * @brief Delete a buffer object.
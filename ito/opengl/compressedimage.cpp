@@ -0,0 +1,714 @@
+/*
+ * compressedimage.cpp
+ *
+ * Copyright (c) 2020 Carlos Braga
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the MIT License.
+ *
+ * See accompanying LICENSE.md or https://opensource.org/licenses/MIT.
+ */
+
+#include <sys/stat.h>
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+#include <sstream>
+#include "compressedimage.hpp"
+#include "buffer.hpp"
+#include "state.hpp"
+#include "texture.hpp"
+
+namespace ito {
+namespace gl {
+
+/** ---------------------------------------------------------------------------
+ * @brief Mipmap level pixels in floating point, four channels per pixel.
+ */
+struct FloatLevel {
+    uint32_t width;
+    uint32_t height;
+    std::vector<float> pixels;
+};
+
+/**
+ * @brief Convert the image to a floating point level. The image channels map
+ * to the texture channels as in glTexImage2D, (r,0,0,1), (r,g,0,1), (r,g,b,1)
+ * and (r,g,b,a).
+ */
+static FloatLevel ToFloatLevel(const Image &image)
+{
+    FloatLevel level;
+    level.width = image.width;
+    level.height = image.height;
+    level.pixels.resize(4 * image.width * image.height);
+
+    const uint32_t n_bytes = image.bpp >> 3;
+    for (uint32_t y = 0; y < image.height; ++y) {
+        for (uint32_t x = 0; x < image.width; ++x) {
+            const uint8_t *px = image(x, y);
+            float *out = &level.pixels[4 * (y * image.width + x)];
+            float a = n_bytes > 3 ? px[3] / 255.0f : 1.0f;
+            out[0] = px[0] / 255.0f;
+            out[1] = n_bytes > 1 ? px[1] / 255.0f : 0.0f;
+            out[2] = n_bytes > 2 ? px[2] / 255.0f : 0.0f;
+            out[3] = a;
+        }
+    }
+    return level;
+}
+
+/** Source pixel index and weight of an area filter tap. */
+struct Tap {
+    uint32_t index;
+    float weight;
+};
+
+/**
+ * @brief Return the area filter taps of each destination pixel along an axis
+ * downsampled from src to dst pixels. Each destination pixel averages the
+ * source pixels it covers, weighted by their coverage, so odd sizes are
+ * filtered without shifting the image.
+ */
+static std::vector<std::vector<Tap>> AreaTaps(
+    const uint32_t src,
+    const uint32_t dst)
+{
+    std::vector<std::vector<Tap>> taps(dst);
+    const double scale = (double) src / (double) dst;
+    for (uint32_t x = 0; x < dst; ++x) {
+        double lo = x * scale;
+        double hi = lo + scale;
+        for (uint32_t i = (uint32_t) lo; i < src && i < hi; ++i) {
+            double w = std::min<double>(i + 1, hi) - std::max<double>(i, lo);
+            if (w > 0.0) {
+                taps[x].push_back({i, (float) (w / scale)});
+            }
+        }
+    }
+    return taps;
+}
+
+/**
+ * @brief Downsample a level to half its size, rounded down, with a separable
+ * area filter. Colours are weighted by alpha, so transparent pixels do not
+ * bleed into the filtered colours.
+ */
+static FloatLevel Downsample(const FloatLevel &src)
+{
+    FloatLevel dst;
+    dst.width = std::max(1u, src.width / 2);
+    dst.height = std::max(1u, src.height / 2);
+    dst.pixels.resize(4 * dst.width * dst.height);
+
+    std::vector<std::vector<Tap>> taps_x = AreaTaps(src.width, dst.width);
+    std::vector<std::vector<Tap>> taps_y = AreaTaps(src.height, dst.height);
+
+    /* Filter the rows, then the columns, with premultiplied colours. */
+    std::vector<float> rows(4 * dst.width * src.height, 0.0f);
+    ito_pragma(omp parallel for schedule(static))
+    for (uint32_t y = 0; y < src.height; ++y) {
+        for (uint32_t x = 0; x < dst.width; ++x) {
+            float *out = &rows[4 * (y * dst.width + x)];
+            for (auto &tap : taps_x[x]) {
+                const float *in = &src.pixels[4 * (y * src.width + tap.index)];
+                float w = tap.weight * in[3];
+                out[0] += w * in[0];
+                out[1] += w * in[1];
+                out[2] += w * in[2];
+                out[3] += w;
+            }
+        }
+    }
+
+    ito_pragma(omp parallel for schedule(static))
+    for (uint32_t y = 0; y < dst.height; ++y) {
+        for (uint32_t x = 0; x < dst.width; ++x) {
+            float *out = &dst.pixels[4 * (y * dst.width + x)];
+            for (uint32_t c = 0; c < 4; ++c) {
+                out[c] = 0.0f;
+            }
+            for (auto &tap : taps_y[y]) {
+                const float *in = &rows[4 * (tap.index * dst.width + x)];
+                for (uint32_t c = 0; c < 4; ++c) {
+                    out[c] += tap.weight * in[c];
+                }
+            }
+            float inv_a = out[3] > 0.0f ? 1.0f / out[3] : 0.0f;
+            out[0] *= inv_a;
+            out[1] *= inv_a;
+            out[2] *= inv_a;
+        }
+    }
+    return dst;
+}
+
+/**
+ * @brief Gather the 4x4 block of pixels at block (bx,by) as 8-bit colours.
+ * Blocks across the level border replicate the edge pixels.
+ */
+static void GatherBlock(
+    const FloatLevel &level,
+    const uint32_t bx,
+    const uint32_t by,
+    uint8_t block[16][4])
+{
+    auto quantize = [] (float v) -> uint8_t {
+        return (uint8_t) std::lround(255.0f * std::min(std::max(v, 0.0f), 1.0f));
+    };
+
+    for (uint32_t j = 0; j < 4; ++j) {
+        for (uint32_t i = 0; i < 4; ++i) {
+            uint32_t x = std::min(4 * bx + i, level.width - 1);
+            uint32_t y = std::min(4 * by + j, level.height - 1);
+            const float *px = &level.pixels[4 * (y * level.width + x)];
+            block[4*j + i][0] = quantize(px[0]);
+            block[4*j + i][1] = quantize(px[1]);
+            block[4*j + i][2] = quantize(px[2]);
+            block[4*j + i][3] = quantize(px[3]);
+        }
+    }
+}
+
+/** ---------------------------------------------------------------------------
+ * @brief Colour block encoder.
+ *
+ * The endpoints start at the extremes of the block colours along their
+ * principal axis, inset to reduce the error of the interpolated colours, and
+ * are then refined by a least squares fit to the selected palette indices.
+ * The endpoints are ordered with c0 > c1 to select the four colour palette,
+ *  index 0: c0, index 1: c1, index 2: (2*c0 + c1)/3, index 3: (c0 + 2*c1)/3.
+ */
+static uint16_t PackRgb565(const float c[3])
+{
+    auto quantize = [] (float v, float scale) -> uint16_t {
+        return (uint16_t) std::lround(
+            scale * std::min(std::max(v, 0.0f), 255.0f) / 255.0f);
+    };
+    return (quantize(c[0], 31.0f) << 11) |
+           (quantize(c[1], 63.0f) << 5) |
+           (quantize(c[2], 31.0f));
+}
+
+static void UnpackRgb565(const uint16_t c, float out[3])
+{
+    uint32_t r = (c >> 11) & 31;
+    uint32_t g = (c >> 5) & 63;
+    uint32_t b = c & 31;
+    out[0] = (float) ((r << 3) | (r >> 2));
+    out[1] = (float) ((g << 2) | (g >> 4));
+    out[2] = (float) ((b << 3) | (b >> 2));
+}
+
+/**
+ * @brief Select the nearest palette colour of each pixel for the endpoints
+ * and return the total squared error.
+ */
+static float SelectColorIndices(
+    const uint8_t block[16][4],
+    const uint16_t c0,
+    const uint16_t c1,
+    uint8_t indices[16])
+{
+    float palette[4][3];
+    UnpackRgb565(c0, palette[0]);
+    UnpackRgb565(c1, palette[1]);
+    for (uint32_t c = 0; c < 3; ++c) {
+        palette[2][c] = (2.0f * palette[0][c] + palette[1][c]) / 3.0f;
+        palette[3][c] = (palette[0][c] + 2.0f * palette[1][c]) / 3.0f;
+    }
+
+    float error = 0.0f;
+    for (uint32_t i = 0; i < 16; ++i) {
+        float best = 1.0e30f;
+        for (uint8_t k = 0; k < 4; ++k) {
+            float d = 0.0f;
+            for (uint32_t c = 0; c < 3; ++c) {
+                float e = palette[k][c] - block[i][c];
+                d += e * e;
+            }
+            if (d < best) {
+                best = d;
+                indices[i] = k;
+            }
+        }
+        error += best;
+    }
+    return error;
+}
+
+/**
+ * @brief Fit the endpoints to the block colours for the selected indices by
+ * least squares. Return false if the fit is degenerate.
+ */
+static bool FitColorEndpoints(
+    const uint8_t block[16][4],
+    const uint8_t indices[16],
+    float e0[3],
+    float e1[3])
+{
+    static const float kWeight[4] = {1.0f, 0.0f, 2.0f / 3.0f, 1.0f / 3.0f};
+
+    float aa = 0.0f, bb = 0.0f, ab = 0.0f;
+    float ax[3] = {}, bx[3] = {};
+    for (uint32_t i = 0; i < 16; ++i) {
+        float a = kWeight[indices[i]];
+        float b = 1.0f - a;
+        aa += a * a;
+        bb += b * b;
+        ab += a * b;
+        for (uint32_t c = 0; c < 3; ++c) {
+            ax[c] += a * block[i][c];
+            bx[c] += b * block[i][c];
+        }
+    }
+
+    float det = aa * bb - ab * ab;
+    if (std::fabs(det) < 1.0e-6f) {
+        return false;
+    }
+    for (uint32_t c = 0; c < 3; ++c) {
+        e0[c] = (ax[c] * bb - bx[c] * ab) / det;
+        e1[c] = (bx[c] * aa - ax[c] * ab) / det;
+    }
+    return true;
+}
+
+static void EncodeColorBlock(const uint8_t block[16][4], uint8_t *out)
+{
+    /* Block colour mean and covariance. */
+    float mean[3] = {};
+    for (uint32_t i = 0; i < 16; ++i) {
+        for (uint32_t c = 0; c < 3; ++c) {
+            mean[c] += block[i][c] / 16.0f;
+        }
+    }
+
+    float cov[6] = {};
+    for (uint32_t i = 0; i < 16; ++i) {
+        float r = block[i][0] - mean[0];
+        float g = block[i][1] - mean[1];
+        float b = block[i][2] - mean[2];
+        cov[0] += r * r;
+        cov[1] += r * g;
+        cov[2] += r * b;
+        cov[3] += g * g;
+        cov[4] += g * b;
+        cov[5] += b * b;
+    }
+
+    /* Principal axis by power iteration. */
+    float axis[3] = {1.0f, 1.0f, 1.0f};
+    for (uint32_t iter = 0; iter < 8; ++iter) {
+        float x = cov[0] * axis[0] + cov[1] * axis[1] + cov[2] * axis[2];
+        float y = cov[1] * axis[0] + cov[3] * axis[1] + cov[4] * axis[2];
+        float z = cov[2] * axis[0] + cov[4] * axis[1] + cov[5] * axis[2];
+        float norm = std::max(std::fabs(x), std::max(std::fabs(y), std::fabs(z)));
+        if (norm < 1.0e-6f) {
+            break;
+        }
+        axis[0] = x / norm;
+        axis[1] = y / norm;
+        axis[2] = z / norm;
+    }
+    float len2 = axis[0]*axis[0] + axis[1]*axis[1] + axis[2]*axis[2];
+
+    /* Extremes along the principal axis, inset by 1/16 of the range. */
+    float lo = 0.0f, hi = 0.0f;
+    for (uint32_t i = 0; i < 16; ++i) {
+        float t = 0.0f;
+        for (uint32_t c = 0; c < 3; ++c) {
+            t += (block[i][c] - mean[c]) * axis[c];
+        }
+        t /= len2;
+        lo = std::min(lo, t);
+        hi = std::max(hi, t);
+    }
+    float inset = (hi - lo) / 16.0f;
+    float e0[3], e1[3];
+    for (uint32_t c = 0; c < 3; ++c) {
+        e0[c] = mean[c] + (hi - inset) * axis[c];
+        e1[c] = mean[c] + (lo + inset) * axis[c];
+    }
+
+    uint16_t c0 = PackRgb565(e0);
+    uint16_t c1 = PackRgb565(e1);
+    uint8_t indices[16];
+    float error = SelectColorIndices(block, c0, c1, indices);
+
+    /* Refine the endpoints by least squares and keep the better fit. */
+    if (FitColorEndpoints(block, indices, e0, e1)) {
+        uint16_t r0 = PackRgb565(e0);
+        uint16_t r1 = PackRgb565(e1);
+        uint8_t r_indices[16];
+        float r_error = SelectColorIndices(block, r0, r1, r_indices);
+        if (r_error < error) {
+            c0 = r0;
+            c1 = r1;
+            std::memcpy(indices, r_indices, sizeof(indices));
+        }
+    }
+
+    /* Order the endpoints for the four colour palette. */
+    static const uint8_t kSwap[4] = {1, 0, 3, 2};
+    if (c0 < c1) {
+        std::swap(c0, c1);
+        for (uint32_t i = 0; i < 16; ++i) {
+            indices[i] = kSwap[indices[i]];
+        }
+    } else if (c0 == c1) {
+        std::memset(indices, 0, sizeof(indices));
+    }
+
+    uint32_t bits = 0;
+    for (uint32_t i = 0; i < 16; ++i) {
+        bits |= (uint32_t) indices[i] << (2 * i);
+    }
+    out[0] = c0 & 0xff;
+    out[1] = c0 >> 8;
+    out[2] = c1 & 0xff;
+    out[3] = c1 >> 8;
+    out[4] = bits & 0xff;
+    out[5] = (bits >> 8) & 0xff;
+    out[6] = (bits >> 16) & 0xff;
+    out[7] = (bits >> 24) & 0xff;
+}
+
+/**
+ * @brief Alpha block encoder, with endpoints a0 > a1 at the alpha extremes
+ * and the eight value palette,
+ *  index 0: a0, index 1: a1, index i: ((8-i)*a0 + (i-1)*a1)/7, i = 2..7.
+ */
+static void EncodeAlphaBlock(const uint8_t block[16][4], uint8_t *out)
+{
+    uint8_t a0 = 0, a1 = 255;
+    for (uint32_t i = 0; i < 16; ++i) {
+        a0 = std::max(a0, block[i][3]);
+        a1 = std::min(a1, block[i][3]);
+    }
+
+    uint64_t bits = 0;
+    if (a0 > a1) {
+        float palette[8] = {(float) a0, (float) a1};
+        for (uint32_t k = 2; k < 8; ++k) {
+            palette[k] = ((8 - k) * a0 + (k - 1) * a1) / 7.0f;
+        }
+        for (uint32_t i = 0; i < 16; ++i) {
+            uint64_t index = 0;
+            float best = 1.0e30f;
+            for (uint32_t k = 0; k < 8; ++k) {
+                float d = std::fabs(palette[k] - block[i][3]);
+                if (d < best) {
+                    best = d;
+                    index = k;
+                }
+            }
+            bits |= index << (3 * i);
+        }
+    }
+
+    out[0] = a0;
+    out[1] = a1;
+    for (uint32_t k = 0; k < 6; ++k) {
+        out[2 + k] = (bits >> (8 * k)) & 0xff;
+    }
+}
+
+/** ---------------------------------------------------------------------------
+ * @brief Return a string with compressed image information.
+ */
+std::string CompressedImage::InfoString(
+    const CompressedImage &image,
+    const char *comment)
+{
+    std::ostringstream ss;
+    if (comment != nullptr) {
+        ss << ito::str::format("%s\n", comment);
+    }
+    ss << ito::str::format(
+        "format:   0x%x\n"
+        "width:    %u\n"
+        "height:   %u\n"
+        "block:    %u\n"
+        "levels:   %zu\n"
+        "size:     %zu\n",
+        image.internalformat,
+        image.width,
+        image.height,
+        image.block_size,
+        image.levels.size(),
+        image.data.size());
+    return ss.str();
+}
+
+/** ---------------------------------------------------------------------------
+ * @brief Encode an image, and its mipmap chain if mipmaps is true, in the
+ * compressed internal format.
+ */
+CompressedImage CompressedImage::Create(
+    const Image &image,
+    const GLenum internalformat,
+    const bool mipmaps)
+{
+    ito_assert(
+        internalformat == GL_COMPRESSED_RGB_S3TC_DXT1_EXT ||
+        internalformat == GL_COMPRESSED_RGBA_S3TC_DXT5_EXT,
+        "invalid compressed internal format");
+    ito_assert(image.width > 0 && image.height > 0, "invalid image size");
+
+    CompressedImage compressed;
+    compressed.internalformat = internalformat;
+    compressed.width = image.width;
+    compressed.height = image.height;
+    compressed.block_size =
+        (internalformat == GL_COMPRESSED_RGB_S3TC_DXT1_EXT) ? 8 : 16;
+
+    /* Downsample each level from the previous one, in floating point. */
+    FloatLevel level = ToFloatLevel(image);
+    while (true) {
+        const uint32_t n_blocks_x = (level.width + 3) / 4;
+        const uint32_t n_blocks_y = (level.height + 3) / 4;
+
+        Level info;
+        info.width = level.width;
+        info.height = level.height;
+        info.offset = compressed.data.size();
+        info.size = n_blocks_x * n_blocks_y * compressed.block_size;
+        compressed.levels.push_back(info);
+        compressed.data.resize(info.offset + info.size);
+
+        /* Encode the level, one row of blocks per iteration. */
+        uint8_t *blocks = &compressed.data[info.offset];
+        const uint32_t block_size = compressed.block_size;
+        ito_pragma(omp parallel for schedule(dynamic))
+        for (uint32_t by = 0; by < n_blocks_y; ++by) {
+            uint8_t block[16][4];
+            for (uint32_t bx = 0; bx < n_blocks_x; ++bx) {
+                uint8_t *out = blocks + (by * n_blocks_x + bx) * block_size;
+                GatherBlock(level, bx, by, block);
+                if (block_size == 16) {
+                    EncodeAlphaBlock(block, out);
+                    out += 8;
+                }
+                EncodeColorBlock(block, out);
+            }
+        }
+
+        if (!mipmaps || (level.width == 1 && level.height == 1)) {
+            break;
+        }
+        level = Downsample(level);
+    }
+
+    return compressed;
+}
+
+/** ---------------------------------------------------------------------------
+ * @brief KTX 1.1 file header. The identifier is followed by the header fields
+ * and, for each mipmap level, the level size and the level data.
+ */
+static const uint8_t kKtxIdentifier[12] = {
+    0xAB, 0x4B, 0x54, 0x58, 0x20, 0x31, 0x31, 0xBB, 0x0D, 0x0A, 0x1A, 0x0A};
+static const uint32_t kKtxEndianness = 0x04030201;
+
+struct KtxHeader {
+    uint8_t identifier[12];
+    uint32_t endianness;
+    uint32_t gl_type;
+    uint32_t gl_type_size;
+    uint32_t gl_format;
+    uint32_t gl_internal_format;
+    uint32_t gl_base_internal_format;
+    uint32_t pixel_width;
+    uint32_t pixel_height;
+    uint32_t pixel_depth;
+    uint32_t number_of_array_elements;
+    uint32_t number_of_faces;
+    uint32_t number_of_mipmap_levels;
+    uint32_t bytes_of_key_value_data;
+};
+
+/**
+ * @brief Load a compressed image from a KTX file with a single 2d image and
+ * its mipmap levels, in a compressed format supported by Create.
+ */
+CompressedImage CompressedImage::Load(const std::string &filename)
+{
+    ito_assert(!filename.empty(), "invalid filename");
+
+    ito::file_ptr file = ito::make_file(filename, "rb");
+    ito_assert(file, "failed to open file");
+
+    KtxHeader header;
+    ito_assert(ito::file::read(file, &header, sizeof(KtxHeader)) == 1,
+        "failed to read ktx header");
+    ito_assert(
+        std::memcmp(header.identifier, kKtxIdentifier, 12) == 0 &&
+        header.endianness == kKtxEndianness,
+        ito::str::format("invalid ktx file %s", filename.c_str()));
+    ito_assert(
+        header.gl_internal_format == GL_COMPRESSED_RGB_S3TC_DXT1_EXT ||
+        header.gl_internal_format == GL_COMPRESSED_RGBA_S3TC_DXT5_EXT,
+        "invalid compressed internal format");
+    ito_assert(
+        header.pixel_depth == 0 &&
+        header.number_of_array_elements == 0 &&
+        header.number_of_faces == 1,
+        "ktx file is not a 2d texture");
+
+    CompressedImage image;
+    image.internalformat = header.gl_internal_format;
+    image.width = header.pixel_width;
+    image.height = header.pixel_height;
+    image.block_size =
+        (image.internalformat == GL_COMPRESSED_RGB_S3TC_DXT1_EXT) ? 8 : 16;
+
+    /* Skip the key value data. */
+    std::fseek(file.get(), header.bytes_of_key_value_data, SEEK_CUR);
+
+    /* Read the mipmap levels, compressed blocks are 4-byte aligned. */
+    uint32_t n_levels = std::max(1u, header.number_of_mipmap_levels);
+    for (uint32_t i = 0; i < n_levels; ++i) {
+        Level level;
+        level.width = std::max(1u, image.width >> i);
+        level.height = std::max(1u, image.height >> i);
+        level.offset = image.data.size();
+        ito_assert(ito::file::read(file, &level.size, sizeof(uint32_t)) == 1,
+            "failed to read ktx level size");
+        ito_assert(level.size ==
+            ((level.width + 3) / 4) * ((level.height + 3) / 4) * image.block_size,
+            "invalid ktx level size");
+
+        image.data.resize(level.offset + level.size);
+        ito_assert(ito::file::read(file, &image.data[level.offset], level.size) == 1,
+            "failed to read ktx level data");
+        image.levels.push_back(level);
+    }
+
+    return image;
+}
+
+/**
+ * @brief Save a compressed image to a KTX file.
+ */
+void CompressedImage::Save(
+    const CompressedImage &image,
+    const std::string &filename)
+{
+    ito_assert(!filename.empty(), "invalid filename");
+
+    ito::file_ptr file = ito::make_file(filename, "wb");
+    ito_assert(file, "failed to open file");
+
+    KtxHeader header;
+    std::memcpy(header.identifier, kKtxIdentifier, 12);
+    header.endianness = kKtxEndianness;
+    header.gl_type = 0;
+    header.gl_type_size = 1;
+    header.gl_format = 0;
+    header.gl_internal_format = image.internalformat;
+    header.gl_base_internal_format =
+        (image.internalformat == GL_COMPRESSED_RGB_S3TC_DXT1_EXT)
+            ? GL_RGB
+            : GL_RGBA;
+    header.pixel_width = image.width;
+    header.pixel_height = image.height;
+    header.pixel_depth = 0;
+    header.number_of_array_elements = 0;
+    header.number_of_faces = 1;
+    header.number_of_mipmap_levels = image.levels.size();
+    header.bytes_of_key_value_data = 0;
+    ito::file::write(file, (void *) &header, sizeof(KtxHeader));
+
+    for (auto &level : image.levels) {
+        ito::file::write(file, (void *) &level.size, sizeof(uint32_t));
+        ito::file::write(file, (void *) &image.data[level.offset], level.size);
+    }
+}
+
+/**
+ * @brief Load the compressed image from the cache file if it is newer than
+ * the image file and has the same internal format. Otherwise, load and encode
+ * the image file, with its mipmap chain, and save it in the cache file.
+ */
+CompressedImage CompressedImage::Cached(
+    const std::string &filename,
+    const std::string &cachename,
+    const GLenum internalformat,
+    const bool flip_vertically)
+{
+    struct stat image_st, cache_st;
+    bool is_cached =
+        stat(cachename.c_str(), &cache_st) == 0 &&
+        (stat(filename.c_str(), &image_st) != 0 ||
+         cache_st.st_mtime >= image_st.st_mtime);
+
+    if (is_cached) {
+        try {
+            CompressedImage image = Load(cachename);
+            if (image.internalformat == internalformat) {
+                return image;
+            }
+        } catch (std::exception &e) {
+            std::cerr << ito::str::format(
+                "failed to load %s: %s\n", cachename.c_str(), e.what());
+        }
+    }
+
+    CompressedImage image = Create(
+        Image::Load(filename, flip_vertically), internalformat, true);
+    Save(image, cachename);
+    return image;
+}
+
+/** ---------------------------------------------------------------------------
+ * @brief Create an OpenGL texture with all the compressed image levels, and
+ * its maximum level set to the last level of the mipmap chain.
+ */
+GLuint CompressedImage::Texture(const CompressedImage &image)
+{
+    ito_assert(IsSupported(), "S3TC texture compression is not supported");
+    ito_assert(!image.levels.empty(), "invalid compressed image");
+
+    /* Generate a new texture object name and bind it to the target point. */
+    GLuint texture;
+    glGenTextures(1, &texture);
+    BindTexture(GL_TEXTURE_2D, texture);
+    ito_assert(glIsTexture(texture), "failed to generate texture object");
+
+    /* Upload each level from client memory, without an unpack buffer. */
+    BindBuffer(GL_PIXEL_UNPACK_BUFFER, 0);
+    for (size_t i = 0; i < image.levels.size(); ++i) {
+        const Level &level = image.levels[i];
+        glCompressedTexImage2D(
+            GL_TEXTURE_2D,
+            i,                              /* level of detail */
+            image.internalformat,           /* compressed internal format */
+            level.width,                    /* level width */
+            level.height,                   /* level height */
+            0,                              /* border - must be 0 */
+            level.size,                     /* level size in bytes */
+            &image.data[level.offset]);     /* compressed blocks */
+    }
+    SetTextureMipmap(GL_TEXTURE_2D, 0, image.levels.size() - 1, GL_FALSE);
+
+    /* Unbind the texture from the target point and return the handle. */
+    BindTexture(GL_TEXTURE_2D, 0);
+    return texture;
+}
+
+/**
+ * @brief Is S3TC texture compression supported by the current context?
+ */
+bool CompressedImage::IsSupported(void)
+{
+#if defined(GL_EXT_texture_compression_s3tc)
+    if (GLAD_GL_EXT_texture_compression_s3tc) {
+        return true;
+    }
+#endif
+    return false;
+}
+
+} /* gl */
+} /* ito */
@@ -0,0 +1,102 @@
+/*
+ * compressedimage.hpp
+ *
+ * Copyright (c) 2020 Carlos Braga
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the MIT License.
+ *
+ * See accompanying LICENSE.md or https://opensource.org/licenses/MIT.
+ */
+
+#ifndef ITO_OPENGL_COMPRESSEDIMAGE_H_
+#define ITO_OPENGL_COMPRESSEDIMAGE_H_
+
+#include <string>
+#include <vector>
+#include "base.hpp"
+#include "image.hpp"
+
+namespace ito {
+namespace gl {
+
+/**
+ * @brief CompressedImage maintains a mipmap chain of an image encoded in a
+ * block compressed texture format, one of:
+ *      GL_COMPRESSED_RGB_S3TC_DXT1_EXT     BC1, 8 bytes per 4x4 block.
+ *      GL_COMPRESSED_RGBA_S3TC_DXT5_EXT    BC3, 16 bytes per 4x4 block.
+ *
+ * Create encodes an Image on the CPU. The mipmap levels are downsampled from
+ * the previous level with an area filter in floating point, with colours
+ * weighted by alpha, and each level is then encoded independently, its rows
+ * of blocks in parallel.
+ *
+ * The levels are stored contiguously in data. Save and Load use the KTX 1.1
+ * file format, so an encoded image is cached on disk and uploaded as is with
+ * glCompressedTexImage2D, without decoding or generating mipmaps at load time.
+ *
+ * @see https://www.khronos.org/opengl/wiki/S3_Texture_Compression
+ *      https://www.khronos.org/opengles/sdk/tools/KTX/file_format_spec
+ */
+struct CompressedImage {
+    /** Mipmap level in the data array. */
+    struct Level {
+        uint32_t width;             /* level width in pixels */
+        uint32_t height;            /* level height in pixels */
+        uint32_t offset;            /* level offset in bytes */
+        uint32_t size;              /* level size in bytes */
+    };
+
+    GLenum internalformat;          /* compressed internal format */
+    uint32_t width;                 /* base level width in pixels */
+    uint32_t height;                /* base level height in pixels */
+    uint32_t block_size;            /* 4x4 block size in bytes */
+    std::vector<Level> levels;      /* mipmap levels */
+    std::vector<uint8_t> data;      /* compressed blocks of all levels */
+
+    /** Return a string with compressed image information. */
+    static std::string InfoString(
+        const CompressedImage &image,
+        const char *comment = nullptr);
+
+    /**
+     * @brief Encode an image, and its mipmap chain if mipmaps is true, in the
+     * compressed internal format.
+     */
+    static CompressedImage Create(
+        const Image &image,
+        const GLenum internalformat,
+        const bool mipmaps = true);
+
+    /**
+     * @brief CompressedImage input/output in the KTX file format.
+     */
+    static CompressedImage Load(const std::string &filename);
+    static void Save(const CompressedImage &image, const std::string &filename);
+
+    /**
+     * @brief Load the compressed image from the cache file if it is newer
+     * than the image file. Otherwise, load and encode the image file and
+     * save it in the cache file.
+     */
+    static CompressedImage Cached(
+        const std::string &filename,
+        const std::string &cachename,
+        const GLenum internalformat,
+        const bool flip_vertically = false);
+
+    /**
+     * @brief Create an OpenGL texture with all the compressed image levels.
+     */
+    static GLuint Texture(const CompressedImage &image);
+
+    /**
+     * @brief Is S3TC texture compression supported by the current context?
+     */
+    static bool IsSupported(void);
+};
+
+} /* gl */
+} /* ito */
+
+#endif /* ITO_OPENGL_COMPRESSEDIMAGE_H_ */
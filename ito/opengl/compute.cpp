@@ -0,0 +1,286 @@
+/*
+ * compute.cpp
+ *
+ * Copyright (c) 2020 Carlos Braga
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the MIT License.
+ *
+ * See accompanying LICENSE.md or https://opensource.org/licenses/MIT.
+ */
+
+#include <sstream>
+#include <vector>
+#include "buffer.hpp"
+#include "compute.hpp"
+#include "state.hpp"
+#include "glsl/program.hpp"
+#include "glsl/shader.hpp"
+
+namespace ito {
+namespace gl {
+
+/** ---------------------------------------------------------------------------
+ * @brief Create a compute program from a compute shader source file.
+ */
+Compute Compute::Create(const std::string &filename)
+{
+    ito_assert(IsSupported(), "compute shaders are not supported");
+
+#if defined(GL_VERSION_4_3)
+    std::vector<GLuint> shaders{CreateShader(GL_COMPUTE_SHADER, filename)};
+    GLuint program = CreateProgram(shaders);
+    DestroyShader(shaders);
+    return Create(program);
+#else
+    ito_throw("compute shaders are not supported");
+#endif
+}
+
+/**
+ * @brief Create a compute program from a linked program object with a compute
+ * shader stage, and query its work group size. The program object is owned
+ * by the compute program.
+ */
+Compute Compute::Create(const GLuint program)
+{
+    ito_assert(IsSupported(), "compute shaders are not supported");
+    ito_assert(glIsProgram(program), "invalid shader program object");
+
+    Compute compute;
+    compute.program = program;
+    compute.group_size = {1, 1, 1};
+    compute.max_groups = {1, 1, 1};
+    compute.pending = 0;
+    compute.n_dispatches = 0;
+
+#if defined(GL_VERSION_4_3)
+    glGetProgramiv(
+        program,
+        GL_COMPUTE_WORK_GROUP_SIZE,
+        compute.group_size.data());
+    for (GLuint i = 0; i < 3; ++i) {
+        glGetIntegeri_v(
+            GL_MAX_COMPUTE_WORK_GROUP_COUNT, i, &compute.max_groups[i]);
+    }
+#endif
+    return compute;
+}
+
+/**
+ * @brief Destroy the compute program object.
+ */
+void Compute::Destroy(Compute &compute)
+{
+    DestroyProgram(compute.program);
+    compute.program = 0;
+}
+
+/** ---------------------------------------------------------------------------
+ * @brief Dispatch the compute program over n_x * n_y * n_z work items. The
+ * number of work items along each dimension is rounded up to a multiple of
+ * the work group size.
+ */
+void Compute::Dispatch(
+    Compute &compute,
+    const GLuint n_x,
+    const GLuint n_y,
+    const GLuint n_z)
+{
+    DispatchGroups(
+        compute,
+        NumGroups(compute, 0, n_x),
+        NumGroups(compute, 1, n_y),
+        NumGroups(compute, 2, n_z));
+}
+
+/**
+ * @brief Dispatch the compute program over n_x * n_y * n_z work groups.
+ */
+void Compute::DispatchGroups(
+    Compute &compute,
+    const GLuint n_x,
+    const GLuint n_y,
+    const GLuint n_z)
+{
+    if (n_x == 0 || n_y == 0 || n_z == 0) {
+        return;
+    }
+    ito_assert(n_x <= (GLuint) compute.max_groups[0] &&
+        n_y <= (GLuint) compute.max_groups[1] &&
+        n_z <= (GLuint) compute.max_groups[2],
+        "number of work groups exceeds GL_MAX_COMPUTE_WORK_GROUP_COUNT");
+
+#if defined(GL_VERSION_4_3)
+    UseProgram(compute.program);
+    glDispatchCompute(n_x, n_y, n_z);
+    compute.pending = GL_ALL_BARRIER_BITS;
+    compute.n_dispatches++;
+#endif
+}
+
+/**
+ * @brief Return the number of work groups along a dimension covering a
+ * number of work items.
+ */
+GLuint Compute::NumGroups(
+    const Compute &compute,
+    const size_t dim,
+    const GLuint n_items)
+{
+    ito_assert(dim < 3, "invalid work group dimension");
+    GLuint size = compute.group_size[dim];
+    return (n_items + size - 1) / size;
+}
+
+/**
+ * @brief Issue a memory barrier making the writes of the dispatches since the
+ * last barrier visible to the commands in the barrier bits, eg
+ *  GL_VERTEX_ATTRIB_ARRAY_BARRIER_BIT  vertex attributes sourced from buffers
+ *  GL_SHADER_STORAGE_BARRIER_BIT       shader storage block reads
+ *  GL_SHADER_IMAGE_ACCESS_BARRIER_BIT  image loads
+ *  GL_TEXTURE_FETCH_BARRIER_BIT        texture samplers
+ *  GL_BUFFER_UPDATE_BARRIER_BIT        buffer reads with glGetBufferSubData
+ * Only the barrier bits not yet issued since the last dispatch are issued,
+ * and the barrier is skipped if there are none.
+ */
+void Compute::Barrier(Compute &compute, const GLbitfield barrier)
+{
+    GLbitfield bits = barrier & compute.pending;
+    if (bits == 0) {
+        return;
+    }
+#if defined(GL_VERSION_4_3)
+    glMemoryBarrier(bits);
+#endif
+    compute.pending &= ~bits;
+}
+
+/** ---------------------------------------------------------------------------
+ * @brief Create a shader storage buffer object with a data store size in
+ * bytes. A vertex buffer object can be used as a storage buffer as well, the
+ * buffer target is only a binding point.
+ */
+GLuint Compute::CreateStorageBuffer(
+    const GLsizeiptr size,
+    const GLenum usage,
+    const GLvoid *data)
+{
+#if defined(GL_VERSION_4_3)
+    GLuint buffer = CreateBuffer(GL_SHADER_STORAGE_BUFFER, size, usage, data);
+    BindBuffer(GL_SHADER_STORAGE_BUFFER, 0);
+    return buffer;
+#else
+    ito_throw("shader storage buffers are not supported");
+#endif
+}
+
+/**
+ * @brief Bind the whole buffer, or a range of the buffer, to the shader
+ * storage block binding point. The buffer is bound to the generic target
+ * as well, through the state cache.
+ */
+void Compute::BindStorageBuffer(const GLuint binding, const GLuint buffer)
+{
+#if defined(GL_VERSION_4_3)
+    BindBuffer(GL_SHADER_STORAGE_BUFFER, buffer);
+    glBindBufferBase(GL_SHADER_STORAGE_BUFFER, binding, buffer);
+#endif
+}
+
+void Compute::BindStorageBuffer(
+    const GLuint binding,
+    const GLuint buffer,
+    const GLintptr offset,
+    const GLsizeiptr size)
+{
+#if defined(GL_VERSION_4_3)
+    BindBuffer(GL_SHADER_STORAGE_BUFFER, buffer);
+    glBindBufferRange(GL_SHADER_STORAGE_BUFFER, binding, buffer, offset, size);
+#endif
+}
+
+/**
+ * @brief Set the binding point of the named shader storage block in the
+ * compute program, for shaders without an explicit binding layout.
+ */
+void Compute::SetStorageBlockBinding(
+    const Compute &compute,
+    const std::string &name,
+    const GLuint binding)
+{
+#if defined(GL_VERSION_4_3)
+    GLuint index = glGetProgramResourceIndex(
+        compute.program, GL_SHADER_STORAGE_BLOCK, name.c_str());
+    ito_assert(index != GL_INVALID_INDEX,
+        ito::str::format("invalid shader storage block %s", name.c_str()));
+    glShaderStorageBlockBinding(compute.program, index, binding);
+#endif
+}
+
+/**
+ * @brief Bind a level of a texture to an image unit, with a GL_READ_ONLY,
+ * GL_WRITE_ONLY or GL_READ_WRITE access and a sized internal format matching
+ * the image format layout qualifier in the shader. Layered textures are bound
+ * with all their layers.
+ */
+void Compute::BindImageTexture(
+    const GLuint unit,
+    const GLuint texture,
+    const GLenum access,
+    const GLenum format,
+    const GLint level)
+{
+    ito_assert(access == GL_READ_ONLY ||
+        access == GL_WRITE_ONLY ||
+        access == GL_READ_WRITE, "invalid image access");
+#if defined(GL_VERSION_4_3)
+    glBindImageTexture(unit, texture, level, GL_TRUE, 0, access, format);
+#endif
+}
+
+/** ---------------------------------------------------------------------------
+ * @brief Return a string with the compute program information.
+ */
+std::string Compute::InfoString(const Compute &compute, const char *comment)
+{
+    std::ostringstream ss;
+    if (comment != nullptr) {
+        ss << ito::str::format("%s\n", comment);
+    }
+    ss << ito::str::format("work group size %dx%dx%d\n",
+        compute.group_size[0],
+        compute.group_size[1],
+        compute.group_size[2]);
+    ss << ito::str::format("max work groups %dx%dx%d\n",
+        compute.max_groups[0],
+        compute.max_groups[1],
+        compute.max_groups[2]);
+    ss << ito::str::format("dispatches %zu, pending 0x%x\n",
+        compute.n_dispatches, compute.pending);
+    return ss.str();
+}
+
+/**
+ * @brief Are compute shaders and shader storage buffers supported by the
+ * current context?
+ */
+bool Compute::IsSupported(void)
+{
+#if defined(GL_VERSION_4_3)
+    if (GLAD_GL_VERSION_4_3) {
+        return true;
+    }
+#endif
+#if defined(GL_ARB_compute_shader) && \
+    defined(GL_ARB_shader_storage_buffer_object)
+    if (GLAD_GL_ARB_compute_shader &&
+        GLAD_GL_ARB_shader_storage_buffer_object) {
+        return true;
+    }
+#endif
+    return false;
+}
+
+} /* gl */
+} /* ito */
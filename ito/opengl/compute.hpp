@@ -0,0 +1,122 @@
+/*
+ * compute.hpp
+ *
+ * Copyright (c) 2020 Carlos Braga
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the MIT License.
+ *
+ * See accompanying LICENSE.md or https://opensource.org/licenses/MIT.
+ */
+
+#ifndef ITO_OPENGL_COMPUTE_H_
+#define ITO_OPENGL_COMPUTE_H_
+
+#include <array>
+#include <string>
+#include "base.hpp"
+
+namespace ito {
+namespace gl {
+
+/**
+ * Compute
+ * @brief Compute shader program with its work group size, dispatched over a
+ * number of work items rather than a number of work groups:
+ *
+ *  Compute::BindStorageBuffer(0, vbo);
+ *  Compute::Dispatch(compute, n_particles);
+ *  Compute::Barrier(compute, GL_VERTEX_ATTRIB_ARRAY_BARRIER_BIT);
+ *  ... draw calls sourcing vbo ...
+ *
+ * The work group size declared by the shader layout is queried when the
+ * program is created, and Dispatch rounds the number of work items up to a
+ * whole number of work groups. The shader must discard the work items past
+ * the end of the data.
+ *
+ * Writes made by a compute shader to shader storage buffers and images are
+ * not coherent with later commands. Barrier issues a glMemoryBarrier with the
+ * bits of the commands reading the data. Each bit is issued once after a
+ * dispatch, and a later barrier only issues the bits not yet issued.
+ *
+ * Compute shaders require OpenGL 4.3 or the ARB_compute_shader and
+ * ARB_shader_storage_buffer_object extensions.
+ */
+struct Compute {
+    GLuint program;                     /* compute shader program object */
+    std::array<GLint,3> group_size;     /* work group size */
+    std::array<GLint,3> max_groups;     /* maximum number of work groups */
+    GLbitfield pending;                 /* barrier bits not yet issued */
+    size_t n_dispatches;                /* number of dispatches */
+
+    /* Compute factory functions */
+    static Compute Create(const std::string &filename);
+    static Compute Create(const GLuint program);
+    static void Destroy(Compute &compute);
+
+    /**
+     * @brief Dispatch the compute program over a number of work items along
+     * each dimension, or over a number of work groups.
+     */
+    static void Dispatch(
+        Compute &compute,
+        const GLuint n_x,
+        const GLuint n_y = 1,
+        const GLuint n_z = 1);
+    static void DispatchGroups(
+        Compute &compute,
+        const GLuint n_x,
+        const GLuint n_y = 1,
+        const GLuint n_z = 1);
+
+    /** Return the number of work groups covering a number of work items. */
+    static GLuint NumGroups(
+        const Compute &compute,
+        const size_t dim,
+        const GLuint n_items);
+
+    /** Make the pending writes visible to the commands in the barrier bits. */
+    static void Barrier(Compute &compute, const GLbitfield barrier);
+
+    /**
+     * @brief Create a shader storage buffer object, and bind a buffer to a
+     * shader storage block binding point.
+     */
+    static GLuint CreateStorageBuffer(
+        const GLsizeiptr size,
+        const GLenum usage,
+        const GLvoid *data = NULL);
+    static void BindStorageBuffer(const GLuint binding, const GLuint buffer);
+    static void BindStorageBuffer(
+        const GLuint binding,
+        const GLuint buffer,
+        const GLintptr offset,
+        const GLsizeiptr size);
+
+    /** Set the binding point of a named shader storage block. */
+    static void SetStorageBlockBinding(
+        const Compute &compute,
+        const std::string &name,
+        const GLuint binding);
+
+    /** Bind a texture level to an image unit for image load and store. */
+    static void BindImageTexture(
+        const GLuint unit,
+        const GLuint texture,
+        const GLenum access,
+        const GLenum format,
+        const GLint level = 0);
+
+    /** Return a string with the work group size and limits. */
+    static std::string InfoString(
+        const Compute &compute,
+        const char *comment = nullptr);
+
+    /** Are compute shaders supported by the current context? */
+    static bool IsSupported(void);
+};
+
+} /* gl */
+} /* ito */
+
+#endif /* ITO_OPENGL_COMPUTE_H_ */
@@ -12,6 +12,7 @@
 #include "framebuffer.hpp"
 #include "imageformat.hpp"
 #include "renderbuffer.hpp"
+#include "state.hpp"
 #include "texture.hpp"
 
 namespace ito {
@@ -57,7 +58,7 @@ GLuint CreateFramebuffer(
      */
     GLuint framebuffer;
     glGenFramebuffers(1, &framebuffer);
-    glBindFramebuffer(GL_FRAMEBUFFER, framebuffer);
+    BindFramebuffer(GL_FRAMEBUFFER, framebuffer);
     ito_assert(glIsFramebuffer(framebuffer),
         "failed to generate framebuffer object");
 
@@ -72,7 +73,7 @@ GLuint CreateFramebuffer(
             ImageFormat::BaseFormat(color_internalformat),
             ImageFormat::DataType(color_internalformat),
             nullptr);
-        glBindTexture(GL_TEXTURE_2D, texture);
+        BindTexture(GL_TEXTURE_2D, texture);
         glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, filter_min);
         glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, filter_mag);
         glFramebufferTexture2D(
@@ -81,7 +82,7 @@ GLuint CreateFramebuffer(
             GL_TEXTURE_2D,
             texture,
             0);
-        glBindTexture(GL_TEXTURE_2D, 0);
+        BindTexture(GL_TEXTURE_2D, 0);
         color_textures[i] = texture;
     }
 
@@ -96,7 +97,7 @@ GLuint CreateFramebuffer(
             ImageFormat::BaseFormat(depth_internalformat),
             ImageFormat::DataType(depth_internalformat),
             nullptr);
-        glBindTexture(GL_TEXTURE_2D, *depth_texture);
+        BindTexture(GL_TEXTURE_2D, *depth_texture);
         glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, filter_min);
         glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, filter_mag);
         glFramebufferTexture2D(
@@ -105,7 +106,7 @@ GLuint CreateFramebuffer(
             GL_TEXTURE_2D,
             *depth_texture,
             0);
-        glBindTexture(GL_TEXTURE_2D, 0);
+        BindTexture(GL_TEXTURE_2D, 0);
     }
 
     /*
@@ -127,7 +128,7 @@ GLuint CreateFramebuffer(
     /*
      * Bind the framebuffer target to the default framebuffer and return.
      */
-    glBindFramebuffer(GL_FRAMEBUFFER, 0);
+    BindFramebuffer(GL_FRAMEBUFFER, 0);
     return framebuffer;
 }
 
@@ -180,7 +181,7 @@ GLuint CreateFramebufferDepth(
      */
     GLuint framebuffer;
     glGenFramebuffers(1, &framebuffer);
-    glBindFramebuffer(GL_FRAMEBUFFER, framebuffer);
+    BindFramebuffer(GL_FRAMEBUFFER, framebuffer);
     ito_assert(glIsFramebuffer(framebuffer),
         "failed to generate framebuffer object");
 
@@ -194,7 +195,7 @@ GLuint CreateFramebufferDepth(
         ImageFormat::BaseFormat(depth_internalformat),
         ImageFormat::DataType(depth_internalformat),
         nullptr);
-    glBindTexture(GL_TEXTURE_2D, *depth_texture);
+    BindTexture(GL_TEXTURE_2D, *depth_texture);
     glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, filter_min);
     glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, filter_mag);
     glFramebufferTexture2D(
@@ -203,7 +204,7 @@ GLuint CreateFramebufferDepth(
         GL_TEXTURE_2D,
         *depth_texture,
         0);
-    glBindTexture(GL_TEXTURE_2D, 0);
+    BindTexture(GL_TEXTURE_2D, 0);
 
     /*
      * Framebuffer object is not complete without an attached color buffer.
@@ -223,7 +224,7 @@ GLuint CreateFramebufferDepth(
     /*
      * Bind the framebuffer target to the default framebuffer and return.
      */
-    glBindFramebuffer(GL_FRAMEBUFFER, 0);
+    BindFramebuffer(GL_FRAMEBUFFER, 0);
     return framebuffer;
 }
 
@@ -254,7 +255,7 @@ GLuint CreateFramebufferRenderbuffer(
      */
     GLuint framebuffer;
     glGenFramebuffers(1, &framebuffer);
-    glBindFramebuffer(GL_FRAMEBUFFER, framebuffer);
+    BindFramebuffer(GL_FRAMEBUFFER, framebuffer);
     ito_assert(glIsFramebuffer(framebuffer),
         "failed to generate framebuffer object");
 
@@ -312,7 +313,7 @@ GLuint CreateFramebufferRenderbuffer(
     /*
      * Unbind from the framebuffer target before returning the handle.
      */
-    glBindFramebuffer(GL_FRAMEBUFFER, 0);
+    BindFramebuffer(GL_FRAMEBUFFER, 0);
     return framebuffer;
 }
 
@@ -321,6 +322,7 @@ GLuint CreateFramebufferRenderbuffer(
  */
 void DestroyFramebuffer(const GLuint &framebuffer)
 {
+    InvalidateStateObject(framebuffer);
     glDeleteFramebuffers(1, &framebuffer);
 }
 
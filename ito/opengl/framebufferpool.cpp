@@ -0,0 +1,351 @@
+/*
+ * framebufferpool.cpp
+ *
+ * Copyright (c) 2020 Carlos Braga
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the MIT License.
+ *
+ * See accompanying LICENSE.md or https://opensource.org/licenses/MIT.
+ */
+
+#include <algorithm>
+#include <sstream>
+#include "framebuffer.hpp"
+#include "framebufferpool.hpp"
+#include "imageformat.hpp"
+#include "state.hpp"
+#include "texture.hpp"
+
+namespace ito {
+namespace gl {
+
+/** ---------------------------------------------------------------------------
+ * @brief Return a render target descriptor with an absolute size.
+ */
+FramebufferPool::Desc FramebufferPool::Desc::Absolute(
+    const GLsizei width,
+    const GLsizei height,
+    const std::vector<GLenum> &color_formats,
+    const GLenum depth_format)
+{
+    return {width, height, 0.0f, color_formats, depth_format};
+}
+
+/**
+ * @brief Return a render target descriptor with a size relative to the window
+ * framebuffer size.
+ */
+FramebufferPool::Desc FramebufferPool::Desc::Relative(
+    const GLfloat scale,
+    const std::vector<GLenum> &color_formats,
+    const GLenum depth_format)
+{
+    return {0, 0, scale, color_formats, depth_format};
+}
+
+/** ---------------------------------------------------------------------------
+ * @brief Destroy the pooled texture at index, and the framebuffer objects
+ * with the texture attached.
+ */
+static void DestroyPoolTexture(FramebufferPool &pool, const size_t index)
+{
+    GLuint id = pool.textures[index].id;
+    for (auto it = pool.framebuffers.begin(); it != pool.framebuffers.end(); ) {
+        const std::vector<GLuint> &key = it->first;
+        if (std::find(key.begin() + 1, key.end(), id) != key.end()) {
+            DestroyFramebuffer(it->second);
+            it = pool.framebuffers.erase(it);
+        } else {
+            ++it;
+        }
+    }
+    DestroyTexture(id);
+    pool.textures.erase(pool.textures.begin() + index);
+}
+
+/**
+ * @brief Acquire a free texture with the size and internal format, or create
+ * a new texture if there is none.
+ */
+static GLuint AcquireTexture(
+    FramebufferPool &pool,
+    const GLsizei width,
+    const GLsizei height,
+    const GLenum format,
+    const bool is_relative)
+{
+    for (auto &texture : pool.textures) {
+        if (texture.is_free &&
+            texture.width == width &&
+            texture.height == height &&
+            texture.format == format) {
+            texture.is_relative = is_relative;
+            texture.is_free = false;
+            texture.last_frame = pool.frame;
+            return texture.id;
+        }
+    }
+
+    FramebufferPool::Texture texture;
+    texture.id = CreateTexture2d(
+        format,
+        width,
+        height,
+        ImageFormat::BaseFormat(format),
+        ImageFormat::DataType(format),
+        nullptr);
+    texture.width = width;
+    texture.height = height;
+    texture.format = format;
+    texture.is_relative = is_relative;
+    texture.is_free = false;
+    texture.last_frame = pool.frame;
+    pool.textures.push_back(texture);
+    pool.n_created++;
+
+    BindTexture(GL_TEXTURE_2D, texture.id);
+    SetTextureWrap(GL_TEXTURE_2D, GL_CLAMP_TO_EDGE, GL_CLAMP_TO_EDGE);
+    BindTexture(GL_TEXTURE_2D, 0);
+    return texture.id;
+}
+
+/**
+ * @brief Return the framebuffer object with the attachments, creating it if
+ * it is not cached. The key holds the number of color attachments followed
+ * by the color and the depth attachment names. The draw and read framebuffer
+ * bindings of the caller are restored after a framebuffer is created.
+ */
+static GLuint AcquireFramebuffer(
+    FramebufferPool &pool,
+    const FramebufferPool::Target &target)
+{
+    std::vector<GLuint> key;
+    key.push_back(target.color_textures.size());
+    key.insert(
+        key.end(),
+        target.color_textures.begin(),
+        target.color_textures.end());
+    key.push_back(target.depth_texture);
+
+    auto it = pool.framebuffers.find(key);
+    if (it != pool.framebuffers.end()) {
+        return it->second;
+    }
+
+    /*
+     * Generate a new framebuffer object and attach the textures.
+     */
+    GLuint draw_framebuffer = GetFramebufferBinding(GL_DRAW_FRAMEBUFFER);
+    GLuint read_framebuffer = GetFramebufferBinding(GL_READ_FRAMEBUFFER);
+
+    GLuint framebuffer;
+    glGenFramebuffers(1, &framebuffer);
+    BindFramebuffer(GL_FRAMEBUFFER, framebuffer);
+
+    std::vector<GLenum> color_attachments;
+    for (size_t i = 0; i < target.color_textures.size(); ++i) {
+        glFramebufferTexture2D(
+            GL_FRAMEBUFFER,
+            GL_COLOR_ATTACHMENT0 + i,
+            GL_TEXTURE_2D,
+            target.color_textures[i],
+            0);
+        color_attachments.push_back(GL_COLOR_ATTACHMENT0 + i);
+    }
+    if (target.depth_texture != 0) {
+        glFramebufferTexture2D(
+            GL_FRAMEBUFFER,
+            GL_DEPTH_ATTACHMENT,
+            GL_TEXTURE_2D,
+            target.depth_texture,
+            0);
+    }
+    glDrawBuffers(color_attachments.size(), color_attachments.data());
+
+    GLenum status = glCheckFramebufferStatus(GL_FRAMEBUFFER);
+    ito_assert(status == GL_FRAMEBUFFER_COMPLETE,
+        ito::str::format("incomplete framebuffer, status: 0x%x\n", status));
+    BindFramebuffer(GL_DRAW_FRAMEBUFFER, draw_framebuffer);
+    BindFramebuffer(GL_READ_FRAMEBUFFER, read_framebuffer);
+
+    pool.framebuffers[key] = framebuffer;
+    return framebuffer;
+}
+
+/** ---------------------------------------------------------------------------
+ * @brief Create a framebuffer pool for a window framebuffer size, destroying
+ * free textures after n_frames unused frames.
+ */
+FramebufferPool FramebufferPool::Create(
+    const GLsizei width,
+    const GLsizei height,
+    const size_t n_frames)
+{
+    ito_assert(width > 0 && height > 0, "invalid window framebuffer size");
+
+    FramebufferPool pool;
+    pool.width = width;
+    pool.height = height;
+    pool.frame = 0;
+    pool.n_frames = n_frames;
+    pool.n_created = 0;
+    return pool;
+}
+
+/**
+ * @brief Destroy all framebuffer objects and textures in the pool.
+ */
+void FramebufferPool::Destroy(FramebufferPool &pool)
+{
+    for (auto &it : pool.framebuffers) {
+        DestroyFramebuffer(it.second);
+    }
+    for (auto &texture : pool.textures) {
+        DestroyTexture(texture.id);
+    }
+    pool.framebuffers.clear();
+    pool.textures.clear();
+}
+
+/**
+ * @brief Resize the window relative targets on a FramebufferSize event. Free
+ * textures of the previous window size are destroyed, the textures held by
+ * acquired targets are destroyed once released and unused.
+ */
+void FramebufferPool::Handle(FramebufferPool &pool, const glfw::Event &event)
+{
+    if (event.type != glfw::Event::FramebufferSize) {
+        return;
+    }
+    GLsizei width = event.framebuffersize.width;
+    GLsizei height = event.framebuffersize.height;
+    if (width <= 0 || height <= 0 ||
+        (width == pool.width && height == pool.height)) {
+        return;
+    }
+    pool.width = width;
+    pool.height = height;
+
+    for (size_t i = pool.textures.size(); i-- > 0; ) {
+        if (pool.textures[i].is_free && pool.textures[i].is_relative) {
+            DestroyPoolTexture(pool, i);
+        }
+    }
+}
+
+/**
+ * @brief Begin a frame, destroying the free textures unused for more than
+ * n_frames frames.
+ */
+void FramebufferPool::BeginFrame(FramebufferPool &pool)
+{
+    pool.frame++;
+    for (size_t i = pool.textures.size(); i-- > 0; ) {
+        const Texture &texture = pool.textures[i];
+        size_t n_unused = pool.frame - texture.last_frame;
+        if (texture.is_free && n_unused > pool.n_frames) {
+            DestroyPoolTexture(pool, i);
+        }
+    }
+}
+
+/** ---------------------------------------------------------------------------
+ * @brief Acquire a render target with the size and attachment formats of the
+ * descriptor, and set the filters of its textures.
+ */
+FramebufferPool::Target FramebufferPool::Acquire(
+    FramebufferPool &pool,
+    const Desc &desc,
+    const GLint filter_min,
+    const GLint filter_mag)
+{
+    ito_assert(!desc.color_formats.empty(), "invalid color attachments");
+    for (auto &format : desc.color_formats) {
+        ito_assert(IsValidFramebufferColorInternalformat(format),
+            "invalid color attachment internal format");
+    }
+    ito_assert(desc.depth_format == GL_NONE ||
+        IsValidFramebufferDepthInternalformat(desc.depth_format),
+        "invalid depth attachment internal format");
+
+    bool is_relative = desc.scale > 0.0f;
+    Target target;
+    target.width = is_relative
+        ? std::max<GLsizei>(1, (GLsizei) (desc.scale * pool.width))
+        : desc.width;
+    target.height = is_relative
+        ? std::max<GLsizei>(1, (GLsizei) (desc.scale * pool.height))
+        : desc.height;
+    ito_assert(target.width > 0 && target.height > 0,
+        "invalid render target size");
+
+    for (auto &format : desc.color_formats) {
+        target.color_textures.push_back(AcquireTexture(
+            pool, target.width, target.height, format, is_relative));
+    }
+    target.depth_texture = 0;
+    if (desc.depth_format != GL_NONE) {
+        target.depth_texture = AcquireTexture(
+            pool, target.width, target.height, desc.depth_format, is_relative);
+    }
+
+    std::vector<GLuint> textures(target.color_textures);
+    if (target.depth_texture != 0) {
+        textures.push_back(target.depth_texture);
+    }
+    for (auto &texture : textures) {
+        BindTexture(GL_TEXTURE_2D, texture);
+        SetTextureFilter(GL_TEXTURE_2D, filter_min, filter_mag);
+    }
+    BindTexture(GL_TEXTURE_2D, 0);
+
+    target.framebuffer = AcquireFramebuffer(pool, target);
+    return target;
+}
+
+/**
+ * @brief Release the textures of the render target to the pool. The target
+ * must not be used after it is released.
+ */
+void FramebufferPool::Release(FramebufferPool &pool, const Target &target)
+{
+    std::vector<GLuint> ids(target.color_textures);
+    if (target.depth_texture != 0) {
+        ids.push_back(target.depth_texture);
+    }
+    for (auto &texture : pool.textures) {
+        if (std::find(ids.begin(), ids.end(), texture.id) != ids.end()) {
+            ito_assert(!texture.is_free, "render target already released");
+            texture.is_free = true;
+            texture.last_frame = pool.frame;
+        }
+    }
+}
+
+/** ---------------------------------------------------------------------------
+ * @brief Return a string with the pool information.
+ */
+std::string FramebufferPool::InfoString(
+    const FramebufferPool &pool,
+    const char *comment)
+{
+    size_t n_free = 0;
+    for (auto &texture : pool.textures) {
+        n_free += texture.is_free ? 1 : 0;
+    }
+
+    std::ostringstream ss;
+    if (comment != nullptr) {
+        ss << ito::str::format("%s\n", comment);
+    }
+    ss << ito::str::format("window size %dx%d, frame %zu\n",
+        pool.width, pool.height, pool.frame);
+    ss << ito::str::format("textures %zu, free %zu, created %zu\n",
+        pool.textures.size(), n_free, pool.n_created);
+    ss << ito::str::format("framebuffers %zu\n", pool.framebuffers.size());
+    return ss.str();
+}
+
+} /* gl */
+} /* ito */
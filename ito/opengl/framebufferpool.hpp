@@ -0,0 +1,122 @@
+/*
+ * framebufferpool.hpp
+ *
+ * Copyright (c) 2020 Carlos Braga
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the MIT License.
+ *
+ * See accompanying LICENSE.md or https://opensource.org/licenses/MIT.
+ */
+
+#ifndef ITO_OPENGL_FRAMEBUFFERPOOL_H_
+#define ITO_OPENGL_FRAMEBUFFERPOOL_H_
+
+#include <map>
+#include <string>
+#include <vector>
+#include "base.hpp"
+#include "glfw.hpp"
+
+namespace ito {
+namespace gl {
+
+/**
+ * @brief FramebufferPool recycles the framebuffer objects and the textures of
+ * transient render targets across passes and frames.
+ *
+ * A render target is described by its size and the internal formats of its
+ * color and depth attachments. The size is either absolute, or a scale of the
+ * window framebuffer size. Acquire returns a target with free textures of the
+ * same size and format, or creates them, and a framebuffer object with these
+ * attachments, cached by the attachment names. Release returns the textures to
+ * the pool.
+ *
+ * Targets whose lifetimes in a frame do not overlap alias the same textures,
+ * eg a ping-pong chain that releases its input after each pass only uses two
+ * sets of textures. A target kept across frames, eg a history buffer, is not
+ * released until it is no longer needed.
+ *
+ * Free textures unused for n_frames frames are destroyed at BeginFrame. A
+ * FramebufferSize event resizes the window relative targets, and destroys the
+ * free textures of the previous window size.
+ */
+struct FramebufferPool {
+    /** Render target size and attachment formats. */
+    struct Desc {
+        GLsizei width;                  /* absolute width, if scale is 0 */
+        GLsizei height;                 /* absolute height, if scale is 0 */
+        GLfloat scale;                  /* scale of the window size */
+        std::vector<GLenum> color_formats;  /* color attachment formats */
+        GLenum depth_format;            /* depth format, or GL_NONE */
+
+        static Desc Absolute(
+            const GLsizei width,
+            const GLsizei height,
+            const std::vector<GLenum> &color_formats,
+            const GLenum depth_format = GL_NONE);
+        static Desc Relative(
+            const GLfloat scale,
+            const std::vector<GLenum> &color_formats,
+            const GLenum depth_format = GL_NONE);
+    };
+
+    /** Render target acquired from the pool. */
+    struct Target {
+        GLuint framebuffer;             /* framebuffer object */
+        GLsizei width;                  /* framebuffer width */
+        GLsizei height;                 /* framebuffer height */
+        std::vector<GLuint> color_textures; /* color attachment textures */
+        GLuint depth_texture;           /* depth attachment texture, or 0 */
+    };
+
+    /** Pooled texture. */
+    struct Texture {
+        GLuint id;                      /* texture object */
+        GLsizei width;                  /* texture width */
+        GLsizei height;                 /* texture height */
+        GLenum format;                  /* texture internal format */
+        bool is_relative;               /* sized relative to the window */
+        bool is_free;                   /* not held by an acquired target */
+        size_t last_frame;              /* last frame the texture was used */
+    };
+
+    std::vector<Texture> textures;      /* pooled textures */
+    std::map<std::vector<GLuint>, GLuint> framebuffers; /* by attachments */
+    GLsizei width;                      /* window framebuffer width */
+    GLsizei height;                     /* window framebuffer height */
+    size_t frame;                       /* current frame */
+    size_t n_frames;                    /* frames before freeing textures */
+    size_t n_created;                   /* number of textures created */
+
+    /* Framebuffer pool factory functions */
+    static FramebufferPool Create(
+        const GLsizei width,
+        const GLsizei height,
+        const size_t n_frames = 3);
+    static void Destroy(FramebufferPool &pool);
+
+    /** Resize the window relative targets on a FramebufferSize event. */
+    static void Handle(FramebufferPool &pool, const glfw::Event &event);
+
+    /** Begin a frame, destroying the textures unused for n_frames frames. */
+    static void BeginFrame(FramebufferPool &pool);
+
+    /** Acquire a render target, and release its textures to the pool. */
+    static Target Acquire(
+        FramebufferPool &pool,
+        const Desc &desc,
+        const GLint filter_min = GL_NEAREST,
+        const GLint filter_mag = GL_NEAREST);
+    static void Release(FramebufferPool &pool, const Target &target);
+
+    /** Return a string with the pool information. */
+    static std::string InfoString(
+        const FramebufferPool &pool,
+        const char *comment = nullptr);
+};
+
+} /* gl */
+} /* ito */
+
+#endif /* ITO_OPENGL_FRAMEBUFFERPOOL_H_ */
@@ -9,8 +9,13 @@
  * See accompanying LICENSE.md or https://opensource.org/licenses/MIT.
  */
 
+#include <cstdlib>
+#include <cstring>
 #include <queue>
 #include "glfw.hpp"
+#include "framebuffer.hpp"
+#include "renderbuffer.hpp"
+#include "state.hpp"
 
 /** ---------------------------------------------------------------------------
  * @brief Interface to the GLFW library and associated GL context. It maintains
@@ -31,6 +36,14 @@ static std::queue<Event> gEventQueue;
 static int gWidth = 0;
 static int gHeight = 0;
 static std::string gInfoString;
+static bool gHeadless = false;
+static GLuint gFramebuffer = 0;
+static GLuint gColorbuffer = 0;
+static GLuint gDepthbuffer = 0;
+static const GLenum kHeadlessColorFormat = GL_RGBA8;
+static const GLenum kHeadlessDepthFormat = GL_DEPTH_COMPONENT24;
+static unsigned long gFrames = 0;
+static unsigned long gMaxFrames = 0;
 
 /** ---------------------------------------------------------------------------
  * @brief Error callback function:
@@ -42,6 +55,26 @@ static void ErrorCallback(int code, const char *desc)
     std::cerr << ito::str::format("GLFW error code %d: %s\n", code, desc);
 }
 
+/**
+ * @brief Reallocate the headless framebuffer attachments with the window
+ * framebuffer size. The framebuffer object keeps its attachments.
+ */
+static void ResizeHeadless(const int width, const int height)
+{
+    if (width <= 0 || height <= 0 || (width == gWidth && height == gHeight)) {
+        return;
+    }
+    glBindRenderbuffer(GL_RENDERBUFFER, gColorbuffer);
+    glRenderbufferStorage(
+        GL_RENDERBUFFER, kHeadlessColorFormat, width, height);
+    glBindRenderbuffer(GL_RENDERBUFFER, gDepthbuffer);
+    glRenderbufferStorage(
+        GL_RENDERBUFFER, kHeadlessDepthFormat, width, height);
+    glBindRenderbuffer(GL_RENDERBUFFER, 0);
+    gWidth = width;
+    gHeight = height;
+}
+
 /**
  * @brief Renderer framebuffer resize callback function:
  *  glfwSetFramebufferSizeCallback(GLFWwindow *window,
@@ -175,7 +208,8 @@ void Init(
     const char *title,
     const int major,
     const int minor,
-    const bool offscreen)
+    const bool offscreen,
+    const bool headless)
 {
     ito_assert(!IsInit(), "GLFW library already initialized");
     ito_assert(width > 0 && height > 0, "invalid window dimensions");
@@ -183,18 +217,39 @@ void Init(
     ito_assert(major >= 3, "client API major version number < 3");
     ito_assert(minor >= 3, "client API minor version number < 3");
 
+    /*
+     * Select a headless window with the headless flag or the ITO_HEADLESS
+     * environment variable, and the number of frames before the window is
+     * closed with the ITO_FRAMES environment variable.
+     */
+    const char *backend = std::getenv("ITO_HEADLESS");
+    const char *frames = std::getenv("ITO_FRAMES");
+    gHeadless = headless || (backend != nullptr && *backend != '\0');
+    gMaxFrames = (frames != nullptr) ? std::strtoul(frames, nullptr, 10) : 0;
+    gFrames = 0;
+
     /*
      * Initialize the GLFW library. If offscreen is enabled, create a context
      * with hidden windows using the GLFW_VISIBLE window creation hint.
      * macOS: The first time a window is created the menu bar is created.
      * Menu bar creation can be disabled with the GLFW_COCOA_MENUBAR init hint.
+     * Headless: The null platform, since GLFW 3.4, creates windows without a
+     * display server, with an EGL or an OSMesa context.
      */
     glfwSetErrorCallback(ErrorCallback);
 #ifdef __APPLE__
-    if (offscreen) {
+    if (offscreen || gHeadless) {
         glfwInitHint(GLFW_COCOA_MENUBAR, GLFW_FALSE);
     }
 #endif
+    if (gHeadless) {
+#if GLFW_VERSION_MAJOR > 3 || \
+    (GLFW_VERSION_MAJOR == 3 && GLFW_VERSION_MINOR >= 4)
+        glfwInitHint(GLFW_PLATFORM, GLFW_PLATFORM_NULL);
+#else
+        ito_throw("headless window requires GLFW 3.4 or later");
+#endif
+    }
     if (glfwInit() != GLFW_TRUE) {
         ito_throw("failed to initialise GLFW library");
     }
@@ -212,9 +267,16 @@ void Init(
 #ifdef __APPLE__
     glfwWindowHint(GLFW_OPENGL_FORWARD_COMPAT, GLFW_TRUE);
 #endif
-    if (offscreen) {
+    if (offscreen || gHeadless) {
         glfwWindowHint(GLFW_VISIBLE, GLFW_FALSE);
     }
+    if (gHeadless) {
+        bool is_osmesa =
+            backend != nullptr && std::strcmp(backend, "osmesa") == 0;
+        glfwWindowHint(
+            GLFW_CONTEXT_CREATION_API,
+            is_osmesa ? GLFW_OSMESA_CONTEXT_API : GLFW_EGL_CONTEXT_API);
+    }
 
     /*
      * Create a new GLFWwindow object.
@@ -242,8 +304,9 @@ void Init(
     /*
      * Set the buffer swap interval to a single monitor refresh between each
      * buffer swap to synchronize buffer swap with the monitor refresh rate.
+     * A headless window has no monitor and is not synchronized.
      */
-    glfwSwapInterval(1);
+    glfwSwapInterval(gHeadless ? 0 : 1);
 
     /*
      * Set OpenGL viewport.
@@ -251,6 +314,23 @@ void Init(
     glfwGetFramebufferSize(gWindow, &gWidth, &gHeight);
     glViewport(0, 0, gWidth, gHeight);
 
+    /*
+     * A headless context may have no window surface. Render to a framebuffer
+     * object of the window size, bound in place of the default framebuffer.
+     */
+    if (gHeadless) {
+        gFramebuffer = gl::CreateFramebufferRenderbuffer(
+            gWidth,
+            gHeight,
+            1,
+            kHeadlessColorFormat,
+            &gColorbuffer,
+            kHeadlessDepthFormat,
+            &gDepthbuffer);
+        gl::SetDefaultFramebuffer(gFramebuffer);
+        gl::BindFramebuffer(GL_FRAMEBUFFER, 0);
+    }
+
     /*
      * Store a info string with the following format:
      *  the version of GLFW,
@@ -263,6 +343,10 @@ void Init(
         glfwGetVersionString(),
         glGetString(GL_RENDERER),
         glGetString(GL_VERSION));
+    if (gHeadless) {
+        gInfoString += ito::str::format("Headless framebuffer: %dx%d\n",
+            gWidth, gHeight);
+    }
 }
 
 /**
@@ -272,6 +356,13 @@ void Terminate(void)
 {
     ito_assert(IsInit(), "GLFW library is not initialized");
 
+    if (gHeadless) {
+        gl::SetDefaultFramebuffer(0);
+        gl::DestroyFramebuffer(gFramebuffer);
+        gl::DestroyRenderbuffer(gColorbuffer);
+        gl::DestroyRenderbuffer(gDepthbuffer);
+    }
+
     glfwDestroyWindow(gWindow);
     glfwTerminate();
 
@@ -279,6 +370,10 @@ void Terminate(void)
     gWidth = 0;
     gHeight = 0;
     gInfoString = {};
+    gHeadless = false;
+    gFramebuffer = 0;
+    gColorbuffer = 0;
+    gDepthbuffer = 0;
 }
 
 /**
@@ -289,6 +384,14 @@ bool IsInit(void)
     return gWindow != nullptr;
 }
 
+/**
+ * @brief Is the GLFW window headless?
+ */
+bool IsHeadless(void)
+{
+    return gHeadless;
+}
+
 /**
  * @brief Return a pointer to the GLFWwindow object.
  */
@@ -310,6 +413,9 @@ const std::string &InfoString()
  */
 bool IsOpen(void)
 {
+    if (gMaxFrames > 0 && gFrames >= gMaxFrames) {
+        return false;
+    }
     return (glfwWindowShouldClose(gWindow) == GLFW_FALSE);
 }
 
@@ -322,10 +428,16 @@ void Close(void)
 }
 
 /**
- * @brief Swap the front and back buffers of the GLFWwindow.
+ * @brief Swap the front and back buffers of the GLFWwindow. A headless window
+ * renders to its framebuffer object and only flushes the commands.
  */
 void SwapBuffers(void)
 {
+    gFrames++;
+    if (gHeadless) {
+        glFlush();
+        return;
+    }
     glfwSwapBuffers(gWindow);
 }
 
@@ -388,11 +500,18 @@ bool HasEvent(void)
 }
 
 /**
- * @brief Poll events until the specified timeout is reached.
+ * @brief Poll events until the specified timeout is reached. A headless
+ * framebuffer is resized with the window framebuffer before the events are
+ * handled.
  */
 void PollEvent(double timeout)
 {
     glfwWaitEventsTimeout(std::max(0.0, timeout));
+    if (gHeadless) {
+        int width, height;
+        glfwGetFramebufferSize(gWindow, &width, &height);
+        ResizeHeadless(width, height);
+    }
 }
 
 /**
@@ -20,6 +20,17 @@ namespace glfw {
 
 /** ---------------------------------------------------------------------------
  * @brief Initialize the GLFW library and create a GLFW window.
+ *
+ * An offscreen window is hidden but still needs a display server. A headless
+ * window uses the GLFW null platform with no display server, and an EGL
+ * context, or an OSMesa context if the ITO_HEADLESS environment variable is
+ * osmesa. Its default framebuffer is a framebuffer object of the window size,
+ * bound by gl::BindFramebuffer in place of the framebuffer 0. PollEvent
+ * resizes it with the window framebuffer, before the FramebufferSize event
+ * is handled.
+ *
+ * Setting ITO_HEADLESS runs any program headless, eg in a CI runner, and
+ * ITO_FRAMES closes the window after the number of frames.
  */
 void Init(
     const int width,
@@ -27,7 +38,8 @@ void Init(
     const char *title,
     const int major = 3,
     const int minor = 3,
-    const bool offscreen = false);
+    const bool offscreen = false,
+    const bool headless = false);
 
 /** @brief Destroy the GLFWwindow object and terminate the GLFW library. */
 void Terminate(void);
@@ -35,6 +47,9 @@ void Terminate(void);
 /** @brief Is GLFW library initialized? */
 bool IsInit(void);
 
+/** @brief Is the GLFW window headless? */
+bool IsHeadless(void);
+
 /** @brief Return a const pointer to the GLFWwindow. */
 GLFWwindow *Window(void);
 
@@ -0,0 +1,383 @@
+/*
+ * block.cpp
+ *
+ * Copyright (c) 2020 Carlos Braga
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the MIT License.
+ *
+ * See accompanying LICENSE.md or https://opensource.org/licenses/MIT.
+ */
+
+#include <algorithm>
+#include <cstring>
+#include <numeric>
+#include "block.hpp"
+
+namespace ito {
+namespace gl {
+
+/** ---------------------------------------------------------------------------
+ * @brief Return the number of columns and rows of a GL matrix type, or false
+ * if the data type is not a matrix.
+ */
+static bool MatrixShape(const GLenum type, GLuint &columns, GLuint &rows)
+{
+    switch (type) {
+    case GL_DOUBLE_MAT2:
+    case GL_FLOAT_MAT2:     columns = 2; rows = 2; return true;
+    case GL_DOUBLE_MAT2x3:
+    case GL_FLOAT_MAT2x3:   columns = 2; rows = 3; return true;
+    case GL_DOUBLE_MAT2x4:
+    case GL_FLOAT_MAT2x4:   columns = 2; rows = 4; return true;
+    case GL_DOUBLE_MAT3x2:
+    case GL_FLOAT_MAT3x2:   columns = 3; rows = 2; return true;
+    case GL_DOUBLE_MAT3:
+    case GL_FLOAT_MAT3:     columns = 3; rows = 3; return true;
+    case GL_DOUBLE_MAT3x4:
+    case GL_FLOAT_MAT3x4:   columns = 3; rows = 4; return true;
+    case GL_DOUBLE_MAT4x2:
+    case GL_FLOAT_MAT4x2:   columns = 4; rows = 2; return true;
+    case GL_DOUBLE_MAT4x3:
+    case GL_FLOAT_MAT4x3:   columns = 4; rows = 3; return true;
+    case GL_DOUBLE_MAT4:
+    case GL_FLOAT_MAT4:     columns = 4; rows = 4; return true;
+    default:
+        return false;
+    }
+}
+
+/**
+ * @brief Round x up to a multiple of the alignment.
+ */
+static GLuint RoundUp(const GLuint x, const GLuint align)
+{
+    return align * ((x + align - 1) / align);
+}
+
+/**
+ * @brief Return the base alignment of a vector with n_components of the
+ * primitive type with the given size. A three component vector has the
+ * alignment of a four component vector.
+ */
+static GLuint VectorAlignment(const GLuint n_components, const GLuint size)
+{
+    return (n_components == 1 ? 1 : (n_components == 2 ? 2 : 4)) * size;
+}
+
+/**
+ * @brief Compute the base alignment, the array and matrix strides and the
+ * size of a block member with the std140 or std430 layout rules:
+ *  - scalars and vectors are aligned to their vector alignment.
+ *  - arrays are aligned to the element alignment. In std140 the alignment
+ *    of array elements is rounded up to the alignment of a vec4.
+ *  - matrices are arrays of column vectors with the matrix row count.
+ *
+ * @see OpenGL 4.6 specification, section 7.6.2.2.
+ */
+static void MemberLayout(
+    const GLenum type,
+    const GLsizei count,
+    const bool is_std430,
+    GLuint &align,
+    GLuint &array_stride,
+    GLuint &matrix_stride,
+    GLuint &size)
+{
+    static const GLuint kVec4Alignment = 4 * sizeof(GLfloat);
+
+    GLuint length = Variable::Length(type);
+    GLuint primitive = Variable::Size(type);
+    ito_assert(length > 0 && primitive > 0, "invalid block member type");
+
+    GLuint columns, rows;
+    if (MatrixShape(type, columns, rows)) {
+        align = VectorAlignment(rows, primitive);
+        if (!is_std430) {
+            align = RoundUp(align, kVec4Alignment);
+        }
+        matrix_stride = align;
+        array_stride = columns * matrix_stride;
+        size = count * array_stride;
+        return;
+    }
+
+    align = VectorAlignment(length, primitive);
+    matrix_stride = 0;
+    if (count > 1) {
+        if (!is_std430) {
+            align = RoundUp(align, kVec4Alignment);
+        }
+        array_stride = align;
+        size = count * array_stride;
+    } else {
+        array_stride = 0;
+        size = length * primitive;
+    }
+}
+
+/**
+ * @brief Compute the layout of the block members in declaration order.
+ */
+static BlockLayout ComputeLayout(
+    const std::vector<Variable> &members,
+    const bool is_std430)
+{
+    BlockLayout layout;
+    layout.members = members;
+
+    GLuint offset = 0;
+    GLuint max_align = is_std430 ? 1 : 4 * sizeof(GLfloat);
+    for (auto &member : members) {
+        GLuint align, array_stride, matrix_stride, size;
+        MemberLayout(
+            member.type,
+            member.count,
+            is_std430,
+            align,
+            array_stride,
+            matrix_stride,
+            size);
+
+        offset = RoundUp(offset, align);
+        layout.offsets.push_back(offset);
+        layout.array_strides.push_back(array_stride);
+        layout.matrix_strides.push_back(matrix_stride);
+        layout.row_major.push_back(GL_FALSE);
+
+        offset += size;
+        max_align = std::max(max_align, align);
+    }
+    layout.size = RoundUp(offset, max_align);
+
+    return layout;
+}
+
+/** ---------------------------------------------------------------------------
+ * @brief Compute the std140 layout of the block members, listed in their
+ * declaration order. The location of the member variables is ignored.
+ */
+BlockLayout BlockLayout::Std140(const std::vector<Variable> &members)
+{
+    return ComputeLayout(members, false);
+}
+
+/**
+ * @brief Compute the std430 layout of the block members, listed in their
+ * declaration order. The location of the member variables is ignored.
+ */
+BlockLayout BlockLayout::Std430(const std::vector<Variable> &members)
+{
+    return ComputeLayout(members, true);
+}
+
+/**
+ * @brief Query the layout of the active uniform block with the specified name
+ * in the shader program object. Members are sorted by their offset and array
+ * members are named without the [0] suffix.
+ */
+BlockLayout BlockLayout::Create(
+    const GLuint &program,
+    const std::string &block_name)
+{
+    BlockLayout layout;
+    layout.size = 0;
+
+    GLuint block_index = glGetUniformBlockIndex(program, block_name.c_str());
+    if (block_index == GL_INVALID_INDEX) {
+        std::cerr << ito::str::format(
+            "invalid uniform block: %s\n", block_name.c_str());
+        return layout;
+    }
+
+    GLint data_size = 0;
+    glGetActiveUniformBlockiv(
+        program, block_index, GL_UNIFORM_BLOCK_DATA_SIZE, &data_size);
+    layout.size = static_cast<GLuint>(data_size);
+
+    GLint n_members = 0;
+    glGetActiveUniformBlockiv(
+        program, block_index, GL_UNIFORM_BLOCK_ACTIVE_UNIFORMS, &n_members);
+    if (n_members == 0) {
+        return layout;
+    }
+
+    std::vector<GLint> indices(n_members);
+    glGetActiveUniformBlockiv(
+        program,
+        block_index,
+        GL_UNIFORM_BLOCK_ACTIVE_UNIFORM_INDICES,
+        indices.data());
+    std::vector<GLuint> members(indices.begin(), indices.end());
+
+    /* Query the properties of the block members. */
+    auto query = [&] (const GLenum pname) -> std::vector<GLint> {
+        std::vector<GLint> params(n_members);
+        glGetActiveUniformsiv(
+            program, n_members, members.data(), pname, params.data());
+        return params;
+    };
+    std::vector<GLint> types = query(GL_UNIFORM_TYPE);
+    std::vector<GLint> counts = query(GL_UNIFORM_SIZE);
+    std::vector<GLint> offsets = query(GL_UNIFORM_OFFSET);
+    std::vector<GLint> array_strides = query(GL_UNIFORM_ARRAY_STRIDE);
+    std::vector<GLint> matrix_strides = query(GL_UNIFORM_MATRIX_STRIDE);
+    std::vector<GLint> row_major = query(GL_UNIFORM_IS_ROW_MAJOR);
+    std::vector<GLint> name_lengths = query(GL_UNIFORM_NAME_LENGTH);
+
+    /* Store the members sorted by their offset in the block. */
+    std::vector<size_t> order(n_members);
+    std::iota(order.begin(), order.end(), 0);
+    std::sort(order.begin(), order.end(), [&] (size_t a, size_t b) {
+        return offsets[a] < offsets[b];
+    });
+
+    for (auto &i : order) {
+        std::vector<GLchar> name(name_lengths[i] + 1);
+        glGetActiveUniformName(
+            program,
+            members[i],
+            static_cast<GLsizei>(name.size()),
+            nullptr,  /* don't return num of chars written */
+            name.data());
+
+        std::string member_name(name.data());
+        size_t pos = member_name.rfind("[0]");
+        if (pos != std::string::npos && pos + 3 == member_name.size()) {
+            member_name.erase(pos);
+        }
+
+        layout.members.push_back({
+            member_name,
+            -1,         /* block members have no location */
+            static_cast<GLsizei>(counts[i]),
+            static_cast<GLenum>(types[i])});
+        layout.offsets.push_back(offsets[i]);
+        layout.array_strides.push_back(array_strides[i]);
+        layout.matrix_strides.push_back(matrix_strides[i]);
+        layout.row_major.push_back(row_major[i] ? GL_TRUE : GL_FALSE);
+    }
+
+    return layout;
+}
+
+/** ---------------------------------------------------------------------------
+ * @brief Return the index of the member with the given name, or -1 if none.
+ */
+GLint BlockLayout::Find(const BlockLayout &layout, const std::string &name)
+{
+    for (size_t i = 0; i < layout.members.size(); ++i) {
+        if (layout.members[i].name == name) {
+            return static_cast<GLint>(i);
+        }
+    }
+    return -1;
+}
+
+/**
+ * @brief Pack the member data into the block storage pointed by dst. The data
+ * holds count elements of the member type, tightly packed, with matrices in
+ * row-major order.
+ */
+bool BlockLayout::Write(
+    const BlockLayout &layout,
+    const GLint index,
+    const void *data,
+    GLubyte *dst)
+{
+    if (index < 0 || index >= static_cast<GLint>(layout.members.size())) {
+        std::cerr << ito::str::format("invalid block member: %d\n", index);
+        return false;
+    }
+
+    if (data == nullptr || dst == nullptr) {
+        std::cerr << ito::str::format("invalid block member data\n");
+        return false;
+    }
+
+    const Variable &member = layout.members[index];
+    const GLuint primitive = Variable::Size(member.type);
+    const GLuint length = Variable::Length(member.type);
+    const GLuint array_stride = layout.array_strides[index];
+    const GLubyte *src = static_cast<const GLubyte *>(data);
+    dst += layout.offsets[index];
+
+    GLuint columns, rows;
+    if (MatrixShape(member.type, columns, rows)) {
+        /* Scatter the row-major elements into the block matrix vectors. */
+        const GLuint stride = layout.matrix_strides[index];
+        const bool row_major = (layout.row_major[index] == GL_TRUE);
+        for (GLsizei e = 0; e < member.count; ++e) {
+            const GLubyte *s = src + e * length * primitive;
+            GLubyte *d = dst + e * array_stride;
+            for (GLuint r = 0; r < rows; ++r) {
+                for (GLuint c = 0; c < columns; ++c) {
+                    GLuint offset = row_major
+                        ? r * stride + c * primitive
+                        : c * stride + r * primitive;
+                    std::memcpy(
+                        d + offset,
+                        s + (r * columns + c) * primitive,
+                        primitive);
+                }
+            }
+        }
+    } else if (member.count > 1) {
+        for (GLsizei e = 0; e < member.count; ++e) {
+            std::memcpy(
+                dst + e * array_stride,
+                src + e * length * primitive,
+                length * primitive);
+        }
+    } else {
+        std::memcpy(dst, src, length * primitive);
+    }
+
+    return true;
+}
+
+/** ---------------------------------------------------------------------------
+ * @brief Return the base alignment of a block member with the given type,
+ * using the std140 or std430 layout rules.
+ */
+GLuint GetBlockAlignment(const GLenum type, const bool is_std430)
+{
+    GLuint align, array_stride, matrix_stride, size;
+    MemberLayout(
+        type, 1, is_std430, align, array_stride, matrix_stride, size);
+    return align;
+}
+
+/**
+ * @brief Return the size in bytes of a block member with count elements of
+ * the given type, using the std140 or std430 layout rules.
+ */
+GLuint GetBlockSize(const GLenum type, const GLsizei count, const bool is_std430)
+{
+    GLuint align, array_stride, matrix_stride, size;
+    MemberLayout(
+        type, count, is_std430, align, array_stride, matrix_stride, size);
+    return size;
+}
+
+/**
+ * @brief Assign a uniform buffer binding point to the uniform block with the
+ * specified name in the shader program object.
+ */
+bool BindUniformBlock(
+    const GLuint &program,
+    const std::string &block_name,
+    const GLuint binding)
+{
+    GLuint block_index = glGetUniformBlockIndex(program, block_name.c_str());
+    if (block_index == GL_INVALID_INDEX) {
+        std::cerr << ito::str::format(
+            "invalid uniform block: %s\n", block_name.c_str());
+        return false;
+    }
+    glUniformBlockBinding(program, block_index, binding);
+    return true;
+}
+
+} /* gl */
+} /* ito */
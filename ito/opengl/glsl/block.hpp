@@ -0,0 +1,86 @@
+/*
+ * block.hpp
+ *
+ * Copyright (c) 2020 Carlos Braga
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the MIT License.
+ *
+ * See accompanying LICENSE.md or https://opensource.org/licenses/MIT.
+ */
+
+#ifndef ITO_OPENGL_GLSL_BLOCK_H_
+#define ITO_OPENGL_GLSL_BLOCK_H_
+
+#include <string>
+#include <vector>
+#include "../base.hpp"
+#include "variable.hpp"
+
+namespace ito {
+namespace gl {
+
+/**
+ * @brief BlockLayout maintains the memory layout of the members of a uniform
+ * or shader storage block: their byte offset, array stride and matrix stride
+ * in the buffer backing the block.
+ *
+ * The layout is either computed from the member variables, listed in their
+ * declaration order, with the std140 or std430 rules, or queried from the
+ * active uniform block of a shader program object.
+ *
+ * Matrix data written to the block is expected in row-major order, the same
+ * as ito::math matrices and SetUniformMatrix with transpose true, and packed
+ * in the block in column-major order unless declared row_major.
+ *
+ * @see https://www.khronos.org/opengl/wiki/Interface_Block_(GLSL)
+ */
+struct BlockLayout {
+    std::vector<Variable> members;      /* block member variables */
+    std::vector<GLuint> offsets;        /* member byte offset */
+    std::vector<GLuint> array_strides;  /* member array element stride */
+    std::vector<GLuint> matrix_strides; /* member matrix column stride */
+    std::vector<GLboolean> row_major;   /* member matrix is row-major */
+    GLuint size;                        /* block size in bytes */
+
+    /* Block layout factory functions */
+    static BlockLayout Std140(const std::vector<Variable> &members);
+    static BlockLayout Std430(const std::vector<Variable> &members);
+    static BlockLayout Create(
+        const GLuint &program,
+        const std::string &block_name);
+
+    /** Return the index of the member with the given name, or -1 if none. */
+    static GLint Find(const BlockLayout &layout, const std::string &name);
+
+    /**
+     * Pack the member data into the block storage pointed by dst. The data
+     * holds count elements of the member type, tightly packed.
+     */
+    static bool Write(
+        const BlockLayout &layout,
+        const GLint index,
+        const void *data,
+        GLubyte *dst);
+};
+
+/**
+ * @brief Return the base alignment and the size in bytes of a block member
+ * with the given type, using the std140 or std430 layout rules.
+ */
+GLuint GetBlockAlignment(const GLenum type, const bool is_std430);
+GLuint GetBlockSize(const GLenum type, const GLsizei count, const bool is_std430);
+
+/**
+ * @brief Assign a uniform buffer binding point to the uniform block with the
+ * specified name in the shader program object.
+ */
+bool BindUniformBlock(
+    const GLuint &program,
+    const std::string &block_name,
+    const GLuint binding);
+
+} /* gl */
+} /* ito */
+
+#endif /* ITO_OPENGL_GLSL_BLOCK_H_ */
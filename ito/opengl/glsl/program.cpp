@@ -14,6 +14,8 @@
 #include "variable.hpp"
 #include "uniform.hpp"
 #include "attribute.hpp"
+#include "../state.hpp"
+#include "../vertexformat.hpp"
 
 namespace ito {
 namespace gl {
@@ -110,7 +112,7 @@ GLuint CreateProgram(const std::vector<GLuint> &shaders)
     }
 
     /* Bind the program before return. */
-    glUseProgram(program);
+    UseProgram(program);
 
     return program;
 }
@@ -127,7 +129,7 @@ void DestroyProgram(const GLuint &program)
     }
 
     /* Bind the program and get the number of attached shaders. */
-    glUseProgram(program);
+    UseProgram(program);
 
     GLint n_shaders;
     glGetProgramiv(program, GL_ATTACHED_SHADERS, &n_shaders);
@@ -145,7 +147,9 @@ void DestroyProgram(const GLuint &program)
         }
     }
 
-    /* Delete the program. */
+    /* Delete the program and the vertex arrays created for it. */
+    VertexFormat::DestroyProgramVertexArrays(program);
+    InvalidateProgram(program);
     glDeleteProgram(program);
 }
 
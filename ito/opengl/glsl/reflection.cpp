@@ -0,0 +1,312 @@
+/*
+ * reflection.cpp
+ *
+ * Copyright (c) 2020 Carlos Braga
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the MIT License.
+ *
+ * See accompanying LICENSE.md or https://opensource.org/licenses/MIT.
+ */
+
+#include <cstring>
+#include "../state.hpp"
+#include "reflection.hpp"
+
+namespace ito {
+namespace gl {
+
+/**
+ * @brief Is the GL data type a sampler type, set with an integer value?
+ */
+static bool IsSampler(const GLenum type)
+{
+    return (type != GL_INT &&
+        Variable::Type(type) == GL_INT &&
+        Variable::Length(type) == 1);
+}
+
+/**
+ * @brief Update count elements of an array uniform in the current shader
+ * program object. Matrix values are row-major and are transposed.
+ */
+static bool UniformArray(
+    const GLint location,
+    const GLenum type,
+    const GLsizei count,
+    const void *data)
+{
+    switch (type) {
+    case GL_FLOAT:
+        glUniform1fv(location, count, static_cast<const GLfloat *>(data));
+        break;
+    case GL_FLOAT_VEC2:
+        glUniform2fv(location, count, static_cast<const GLfloat *>(data));
+        break;
+    case GL_FLOAT_VEC3:
+        glUniform3fv(location, count, static_cast<const GLfloat *>(data));
+        break;
+    case GL_FLOAT_VEC4:
+        glUniform4fv(location, count, static_cast<const GLfloat *>(data));
+        break;
+    case GL_FLOAT_MAT4:
+        glUniformMatrix4fv(
+            location, count, GL_TRUE, static_cast<const GLfloat *>(data));
+        break;
+    case GL_INT:
+        glUniform1iv(location, count, static_cast<const GLint *>(data));
+        break;
+    case GL_UNSIGNED_INT:
+        glUniform1uiv(location, count, static_cast<const GLuint *>(data));
+        break;
+    default:
+        std::cerr << ito::str::format("invalid uniform type: %d\n", type);
+        return false;
+    }
+    return true;
+}
+
+/**
+ * @brief Update the first count elements of the uniform with values of the
+ * specified type, unless they are the same as the last ones set.
+ */
+static bool UpdateUniform(
+    Reflection &reflection,
+    const Reflection::Handle &handle,
+    const GLenum type,
+    const GLsizei count,
+    const void *data)
+{
+    if (handle.index == -1) {
+        std::cerr << ito::str::format("invalid uniform handle\n");
+        return false;
+    }
+
+    if (handle.type != type && !(type == GL_INT && IsSampler(handle.type))) {
+        std::cerr << ito::str::format(
+            "invalid uniform type: %s, expected %s\n",
+            Variable::Name(type).c_str(),
+            Variable::Name(handle.type).c_str());
+        return false;
+    }
+
+    if (count < 1 || count > handle.count) {
+        std::cerr << ito::str::format(
+            "invalid uniform count: %d, expected <= %d\n",
+            count, handle.count);
+        return false;
+    }
+
+    /* Elide the update if the uniform already holds the values. */
+    Reflection::Value &value = reflection.values[handle.index];
+    size_t size = count * Variable::Length(type) * Variable::Size(type);
+    if (value.is_set &&
+        value.count == count &&
+        std::memcmp(value.data.data(), data, size) == 0) {
+        reflection.n_elided++;
+        return true;
+    }
+
+    UseProgram(reflection.program);
+    if (!UniformArray(handle.location, type, count, data)) {
+        return false;
+    }
+    value.is_set = true;
+    value.count = count;
+    std::memcpy(value.data.data(), data, size);
+    reflection.n_updates++;
+    return true;
+}
+
+/** ---------------------------------------------------------------------------
+ * @brief Create the reflection of a linked shader program object.
+ */
+Reflection Reflection::Create(const GLuint &program)
+{
+    Reflection reflection;
+    reflection.program = program;
+    reflection.uniforms = GetUniformVariables(program);
+    reflection.attributes = GetAttributeVariables(program);
+    reflection.n_updates = 0;
+    reflection.n_elided = 0;
+
+    for (size_t i = 0; i < reflection.uniforms.size(); ++i) {
+        const Variable &uniform = reflection.uniforms[i];
+        reflection.uniform_index[uniform.name] = static_cast<GLint>(i);
+
+        /* Array uniforms are named with the [0] suffix. */
+        const std::string suffix("[0]");
+        const std::string &name = uniform.name;
+        if (name.size() > suffix.size() &&
+            name.compare(name.size() - suffix.size(), suffix.size(),
+                suffix) == 0) {
+            std::string base = name.substr(0, name.size() - suffix.size());
+            reflection.uniform_index[base] = static_cast<GLint>(i);
+        }
+
+        Value value;
+        value.is_set = false;
+        value.count = 0;
+        value.data.resize(uniform.count *
+            Variable::Length(uniform.type) * Variable::Size(uniform.type));
+        reflection.values.push_back(value);
+    }
+
+    for (size_t i = 0; i < reflection.attributes.size(); ++i) {
+        const Variable &attribute = reflection.attributes[i];
+        reflection.attribute_index[attribute.name] = static_cast<GLint>(i);
+    }
+
+    return reflection;
+}
+
+/** ---------------------------------------------------------------------------
+ * @brief Return the handle of the uniform with the given name. The handle
+ * index and location are -1 if the name is not an active uniform.
+ */
+Reflection::Handle Reflection::Uniform(
+    const Reflection &reflection,
+    const std::string &name)
+{
+    auto it = reflection.uniform_index.find(name);
+    if (it == reflection.uniform_index.end()) {
+        return {-1, -1, 0, 0};
+    }
+    const Variable &uniform = reflection.uniforms[it->second];
+    return {it->second, uniform.location, uniform.type, uniform.count};
+}
+
+/**
+ * @brief Return the location of the attribute with the given name, or -1 if
+ * the name is not an active attribute.
+ */
+GLint Reflection::Attribute(
+    const Reflection &reflection,
+    const std::string &name)
+{
+    auto it = reflection.attribute_index.find(name);
+    if (it == reflection.attribute_index.end()) {
+        return -1;
+    }
+    return reflection.attributes[it->second].location;
+}
+
+/** ---------------------------------------------------------------------------
+ * @brief Update a scalar, vector or matrix uniform.
+ */
+bool Reflection::Set(
+    Reflection &reflection,
+    const Handle &handle,
+    const GLfloat &value)
+{
+    return UpdateUniform(reflection, handle, GL_FLOAT, 1, &value);
+}
+
+bool Reflection::Set(
+    Reflection &reflection,
+    const Handle &handle,
+    const GLint &value)
+{
+    return UpdateUniform(reflection, handle, GL_INT, 1, &value);
+}
+
+bool Reflection::Set(
+    Reflection &reflection,
+    const Handle &handle,
+    const GLuint &value)
+{
+    return UpdateUniform(reflection, handle, GL_UNSIGNED_INT, 1, &value);
+}
+
+bool Reflection::Set(
+    Reflection &reflection,
+    const Handle &handle,
+    const math::vec2f &value)
+{
+    return UpdateUniform(reflection, handle, GL_FLOAT_VEC2, 1, value.data);
+}
+
+bool Reflection::Set(
+    Reflection &reflection,
+    const Handle &handle,
+    const math::vec3f &value)
+{
+    return UpdateUniform(reflection, handle, GL_FLOAT_VEC3, 1, value.data);
+}
+
+bool Reflection::Set(
+    Reflection &reflection,
+    const Handle &handle,
+    const math::vec4f &value)
+{
+    return UpdateUniform(reflection, handle, GL_FLOAT_VEC4, 1, value.data);
+}
+
+bool Reflection::Set(
+    Reflection &reflection,
+    const Handle &handle,
+    const math::mat4f &value)
+{
+    return UpdateUniform(reflection, handle, GL_FLOAT_MAT4, 1, value.data);
+}
+
+/**
+ * @brief Update the first elements of an array uniform. Vector and matrix
+ * values are packed before the update.
+ */
+bool Reflection::Set(
+    Reflection &reflection,
+    const Handle &handle,
+    const std::vector<GLfloat> &values)
+{
+    return UpdateUniform(
+        reflection, handle, GL_FLOAT, values.size(), values.data());
+}
+
+bool Reflection::Set(
+    Reflection &reflection,
+    const Handle &handle,
+    const std::vector<GLint> &values)
+{
+    return UpdateUniform(
+        reflection, handle, GL_INT, values.size(), values.data());
+}
+
+bool Reflection::Set(
+    Reflection &reflection,
+    const Handle &handle,
+    const std::vector<math::vec4f> &values)
+{
+    std::vector<GLfloat> data;
+    for (auto &value : values) {
+        data.insert(data.end(), value.data, value.data + 4);
+    }
+    return UpdateUniform(
+        reflection, handle, GL_FLOAT_VEC4, values.size(), data.data());
+}
+
+bool Reflection::Set(
+    Reflection &reflection,
+    const Handle &handle,
+    const std::vector<math::mat4f> &values)
+{
+    std::vector<GLfloat> data;
+    for (auto &value : values) {
+        data.insert(data.end(), value.data, value.data + 16);
+    }
+    return UpdateUniform(
+        reflection, handle, GL_FLOAT_MAT4, values.size(), data.data());
+}
+
+/**
+ * @brief Forget the shadow values, eg after the program is relinked.
+ */
+void Reflection::Invalidate(Reflection &reflection)
+{
+    for (auto &value : reflection.values) {
+        value.is_set = false;
+    }
+}
+
+} /* gl */
+} /* ito */
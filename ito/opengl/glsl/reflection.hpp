@@ -0,0 +1,132 @@
+/*
+ * reflection.hpp
+ *
+ * Copyright (c) 2020 Carlos Braga
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the MIT License.
+ *
+ * See accompanying LICENSE.md or https://opensource.org/licenses/MIT.
+ */
+
+#ifndef ITO_OPENGL_GLSL_REFLECTION_H_
+#define ITO_OPENGL_GLSL_REFLECTION_H_
+
+#include <string>
+#include <vector>
+#include <unordered_map>
+#include "../base.hpp"
+#include "variable.hpp"
+
+namespace ito {
+namespace gl {
+
+/**
+ * @brief Reflection maintains the active uniform and attribute variables of a
+ * shader program object, queried once when the reflection is created.
+ *
+ * Variable names are hashed to their index in the variable lists, and uniform
+ * handles resolve the name lookup once. Array uniforms are found by their
+ * name with or without the [0] suffix.
+ *
+ * Uniforms are updated with typed setters, which check the value type
+ * against the uniform type and bind the program through the state cache.
+ * The last value set through each uniform is shadowed and redundant updates
+ * are elided.
+ *
+ * @note The shadow values are only valid if the uniforms of the program are
+ * updated exclusively through its reflection.
+ */
+struct Reflection {
+    /** Uniform handle, an index into the reflection uniform variables. */
+    struct Handle {
+        GLint index;                    /* index of the uniform, -1 if none */
+        GLint location;                 /* location of the uniform */
+        GLenum type;                    /* enumerated type of the uniform */
+        GLsizei count;                  /* number of array elements */
+    };
+
+    /** Shadow copy of the last value set for a uniform variable. */
+    struct Value {
+        bool is_set;
+        GLsizei count;
+        std::vector<GLubyte> data;
+    };
+
+    GLuint program;                     /* shader program object */
+    std::vector<Variable> uniforms;     /* active uniform variables */
+    std::vector<Variable> attributes;   /* active attribute variables */
+    std::vector<Value> values;          /* last value of each uniform */
+    std::unordered_map<std::string, GLint> uniform_index;
+    std::unordered_map<std::string, GLint> attribute_index;
+    size_t n_updates;                   /* number of glUniform* calls */
+    size_t n_elided;                    /* number of elided updates */
+
+    /** Create the reflection of a linked shader program object. */
+    static Reflection Create(const GLuint &program);
+
+    /**
+     * @brief Return the uniform handle or the attribute location with the
+     * given name. Handles are resolved once and used to set the uniform.
+     */
+    static Handle Uniform(const Reflection &reflection, const std::string &name);
+    static GLint Attribute(const Reflection &reflection, const std::string &name);
+
+    /**
+     * @brief Update the uniform, unless the value is the same as the last one
+     * set. Integer values also set sampler uniforms, and arrays set the first
+     * elements of an array uniform.
+     */
+    static bool Set(
+        Reflection &reflection,
+        const Handle &handle,
+        const GLfloat &value);
+    static bool Set(
+        Reflection &reflection,
+        const Handle &handle,
+        const GLint &value);
+    static bool Set(
+        Reflection &reflection,
+        const Handle &handle,
+        const GLuint &value);
+    static bool Set(
+        Reflection &reflection,
+        const Handle &handle,
+        const math::vec2f &value);
+    static bool Set(
+        Reflection &reflection,
+        const Handle &handle,
+        const math::vec3f &value);
+    static bool Set(
+        Reflection &reflection,
+        const Handle &handle,
+        const math::vec4f &value);
+    static bool Set(
+        Reflection &reflection,
+        const Handle &handle,
+        const math::mat4f &value);
+    static bool Set(
+        Reflection &reflection,
+        const Handle &handle,
+        const std::vector<GLfloat> &values);
+    static bool Set(
+        Reflection &reflection,
+        const Handle &handle,
+        const std::vector<GLint> &values);
+    static bool Set(
+        Reflection &reflection,
+        const Handle &handle,
+        const std::vector<math::vec4f> &values);
+    static bool Set(
+        Reflection &reflection,
+        const Handle &handle,
+        const std::vector<math::mat4f> &values);
+
+    /** Forget the shadow values, eg after the program is relinked. */
+    static void Invalidate(Reflection &reflection);
+};
+
+} /* gl */
+} /* ito */
+
+#endif /* ITO_OPENGL_GLSL_REFLECTION_H_ */
@@ -196,6 +196,8 @@ GLenum Variable::Type(const GLenum datatype)
  * Call glGetActiveUniform for each active uniform variable to query its name,
  * type and length.
  *
+ * Members of uniform blocks are skipped, see BlockLayout::Create.
+ *
  * Call glGetUniformLocation to get the location of the uniform variable name
  * in the shader program object. This function returns -1 if name is not an
  * active uniform variable. Possible data types are (cf. glGetActiveUniform):
@@ -246,6 +248,13 @@ std::vector<Variable> GetUniformVariables(const GLuint &program)
             &type,
             name.data());
 
+        /* Skip the members of uniform blocks, they have no location. */
+        GLint block_index;
+        glGetActiveUniformsiv(program, 1, &i, GL_UNIFORM_BLOCK_INDEX, &block_index);
+        if (block_index != -1) {
+            continue;
+        }
+
         GLint location = glGetUniformLocation(program, name.data());
         ito_assert(location != -1, "uniform name is inactive or invalid");
 
@@ -15,14 +15,118 @@
 #define STBI_ONLY_PNG               /* request png decoder only */
 #define STB_IMAGE_IMPLEMENTATION
 #include "stb/stb_image.h"
-#define STB_IMAGE_WRITE_IMPLEMENTATION
-#include "stb/stb_image_write.h"
+
+/**
+ * @brief zlib deflate and checksums for the png writer, and POSIX memory
+ * mapped files for the raw image loader.
+ */
+#include <zlib.h>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
 #include "image.hpp"
 #include "texture.hpp"
 
 namespace ito {
 namespace gl {
 
+/** ---------------------------------------------------------------------------
+ * @brief Raw image file layout, a header followed by the bitmap rows with
+ * their pitch padding, so the bitmap is copied with a single memcpy.
+ */
+static const char kRawMagic[8] = {'I', 'T', 'O', 'R', 'A', 'W', '0', '1'};
+
+struct RawHeader {
+    char magic[8];
+    uint32_t width;
+    uint32_t height;
+    uint32_t bpp;
+    uint32_t pitch;
+};
+
+/**
+ * @brief Read-only memory mapping of a file, unmapped when out of scope so
+ * every exit path of the raw image loader releases it.
+ */
+struct RawMapping {
+    void *addr;
+    size_t size;
+
+    RawMapping(void *addr, const size_t size) : addr(addr), size(size) {}
+    ~RawMapping() { munmap(addr, size); }
+    RawMapping(const RawMapping &) = delete;
+    RawMapping &operator=(const RawMapping &) = delete;
+};
+
+/**
+ * @brief Load a raw image through a read-only memory mapping of the file.
+ * Return false if the file is not a raw image. The header fields and the
+ * file size are validated before the image is created.
+ */
+static bool LoadRaw(
+    const std::string &filename,
+    const bool flip_vertically,
+    const int32_t n_channels,
+    Image &image)
+{
+    int fd = open(filename.c_str(), O_RDONLY);
+    if (fd < 0) {
+        return false;
+    }
+
+    struct stat st;
+    if (fstat(fd, &st) != 0 || st.st_size < (off_t) sizeof(RawHeader)) {
+        close(fd);
+        return false;
+    }
+
+    void *addr = mmap(NULL, st.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+    close(fd);
+    if (addr == MAP_FAILED) {
+        return false;
+    }
+    RawMapping mapping(addr, st.st_size);
+
+    const uint8_t *data = static_cast<const uint8_t *>(mapping.addr);
+    RawHeader header;
+    std::memcpy(&header, data, sizeof(RawHeader));
+    if (std::memcmp(header.magic, kRawMagic, sizeof(kRawMagic)) != 0) {
+        return false;
+    }
+
+    /* Validate the header and the bitmap size against the file size. */
+    bool is_valid =
+        header.width > 0 &&
+        header.height > 0 &&
+        (header.bpp == 8 || header.bpp == 16 ||
+         header.bpp == 24 || header.bpp == 32) &&
+        (uint64_t) header.pitch ==
+            4 * (((uint64_t) header.width * header.bpp + 31) / 32) &&
+        sizeof(RawHeader) + (uint64_t) header.height * header.pitch <=
+            (uint64_t) st.st_size;
+    ito_assert(is_valid,
+        ito::str::format("invalid raw image %s", filename.c_str()));
+    ito_assert(n_channels == 0 || n_channels == (int32_t) (header.bpp >> 3),
+        "raw image channels can not be converted");
+    madvise(mapping.addr, mapping.size, MADV_SEQUENTIAL);
+
+    /* Copy the bitmap, in reverse row order to flip the image vertically. */
+    image = Image::Create(header.width, header.height, header.bpp);
+    const uint8_t *bitmap = data + sizeof(RawHeader);
+    if (flip_vertically) {
+        for (uint32_t y = 0; y < image.height; ++y) {
+            std::memcpy(
+                &image.bitmap[y * image.pitch],
+                bitmap + (image.height - 1 - y) * image.pitch,
+                image.pitch);
+        }
+    } else {
+        std::memcpy(&image.bitmap[0], bitmap, image.size);
+    }
+    return true;
+}
+
 /** ---------------------------------------------------------------------------
  * @brief Return a string with image information.
  */
@@ -96,6 +200,12 @@ Image Image::Load(
 {
     ito_assert(!filename.empty(), "invalid filename");
 
+    /* Load raw images through a memory mapping of the file. */
+    Image raw;
+    if (LoadRaw(filename, flip_vertically, n_channels, raw)) {
+        return raw;
+    }
+
     /*
      * Load image data from the file using stb image loader:
      *  x = width
@@ -114,7 +224,6 @@ Image Image::Load(
      *     3           red, green, blue
      *     4           red, green, blue, alpha
      */
-    stbi_set_flip_vertically_on_load(flip_vertically ? 1 : 0);
     int w, h, n;
     uint8_t *data = stbi_load(filename.c_str(), &w, &h, &n, n_channels);
     ito_assert(data != NULL, ito::str::format(
@@ -122,8 +231,11 @@ Image Image::Load(
 
     /*
      * Create an image from the data. There is no padding between scanlines or
-     * between pixels of a stb image, so we just use the image width to specify
-     * its byte size.
+     * between pixels of a stb image, so copy each scanline into the padded
+     * image row, in reverse order to flip the image vertically.
+     *
+     * The rows are flipped here rather than with the global stb flip flag,
+     * so images can be loaded concurrently from several threads.
      */
     uint32_t width = (uint32_t) w;
     uint32_t height = (uint32_t) h;
@@ -131,8 +243,14 @@ Image Image::Load(
 
     Image image = Image::Create(width, height, bpp);
 
-    uint32_t size = width * height * bpp / 8;
-    std::memcpy(&image.bitmap[0], data, size);
+    uint32_t row_size = width * bpp / 8;
+    for (uint32_t y = 0; y < height; ++y) {
+        uint32_t src_row = flip_vertically ? height - 1 - y : y;
+        std::memcpy(
+            &image.bitmap[y * image.pitch],
+            data + src_row * row_size,
+            row_size);
+    }
 
     /*
      * Free image data.
@@ -143,27 +261,210 @@ Image Image::Load(
 }
 
 /** ---------------------------------------------------------------------------
+ * @brief Return the bitmap row written at position y of a file, in reverse
+ * row order to flip the image vertically.
+ */
+static const uint8_t *FileRow(
+    const Image &image,
+    const uint32_t y,
+    const bool flip_vertically)
+{
+    uint32_t row = flip_vertically ? image.height - 1 - y : y;
+    return &image.bitmap[row * image.pitch];
+}
+
+/**
+ * @brief Write a png chunk with its length, type, data and crc.
+ */
+static void WritePngChunk(
+    ito::file_ptr &file,
+    const char *type,
+    const uint8_t *data,
+    const uint32_t size)
+{
+    uint8_t length[4] = {
+        (uint8_t) (size >> 24),
+        (uint8_t) (size >> 16),
+        (uint8_t) (size >>  8),
+        (uint8_t) (size)};
+    uLong crc = crc32(0L, (const Bytef *) type, 4);
+    if (size > 0) {
+        crc = crc32(crc, data, size);
+    }
+    uint8_t checksum[4] = {
+        (uint8_t) (crc >> 24),
+        (uint8_t) (crc >> 16),
+        (uint8_t) (crc >>  8),
+        (uint8_t) (crc)};
+
+    ito::file::write(file, (void *) length, 4);
+    ito::file::write(file, (void *) type, 4);
+    if (size > 0) {
+        ito::file::write(file, (void *) data, size);
+    }
+    ito::file::write(file, (void *) checksum, 4);
+}
+
+/**
+ * @brief Filter a png scanline with the filter type minimizing the sum of
+ * absolute differences, and return the filtered row with its type byte.
+ */
+static void FilterPngRow(
+    const uint8_t *row,
+    const uint8_t *prev,
+    const uint32_t row_size,
+    const uint32_t n_bytes,
+    uint8_t *out,
+    std::vector<uint8_t> &scratch)
+{
+    auto paeth = [] (int a, int b, int c) -> uint8_t {
+        int p = a + b - c;
+        int pa = std::abs(p - a);
+        int pb = std::abs(p - b);
+        int pc = std::abs(p - c);
+        return (pa <= pb && pa <= pc) ? a : (pb <= pc) ? b : c;
+    };
+
+    scratch.resize(row_size);
+    uint64_t best_sum = UINT64_MAX;
+    for (uint8_t type = 0; type < 5; ++type) {
+        uint64_t sum = 0;
+        for (uint32_t i = 0; i < row_size; ++i) {
+            int a = i >= n_bytes ? row[i - n_bytes] : 0;
+            int b = prev != nullptr ? prev[i] : 0;
+            int c = (i >= n_bytes && prev != nullptr) ? prev[i - n_bytes] : 0;
+            int x = row[i];
+            uint8_t f = (type == 0) ? x :
+                        (type == 1) ? x - a :
+                        (type == 2) ? x - b :
+                        (type == 3) ? x - ((a + b) >> 1) :
+                                      x - paeth(a, b, c);
+            scratch[i] = f;
+            sum += (f < 128) ? f : 256 - f;
+        }
+        if (sum < best_sum) {
+            best_sum = sum;
+            out[0] = type;
+            std::memcpy(out + 1, scratch.data(), row_size);
+        }
+    }
+}
+
+/**
  * @brief Save an image bitmap to a png file.
+ *
+ * The image is split in horizontal strips, one per thread, and each strip
+ * is filtered and deflated independently in parallel. Every strip but the
+ * last ends with a sync flush at a byte boundary, so the raw deflate streams
+ * concatenate into the single zlib stream of the png IDAT chunk, with the
+ * adler32 checksum combined from the strip checksums.
+ *
  * @param flip_vertically Flip image vertically.
- * @param n_channels load n pixel components (0 = load all components)
+ * @param compression_level zlib compression level, 1 (fast) to 9 (small).
  */
 void Image::SavePng(
     const Image &image,
     const std::string &filename,
-    const bool flip_vertically)
+    const bool flip_vertically,
+    const int compression_level)
 {
     ito_assert(!filename.empty(), "invalid filename");
 
-    /* Function stbi_write_png returns 0 on failure and non-0 on success. */
-    stbi_flip_vertically_on_write(flip_vertically ? 1 : 0);
-    int ret = stbi_write_png(
-        filename.c_str(),           /* name of the file */
-        image.width,                /* image width */
-        image.height,               /* image height */
-        (image.bpp >> 3),           /* # components per pixel */
-        &image.bitmap[0],           /* bitmap data */
-        image.pitch);               /* scanline stride in bytes */
-    ito_assert(ret != 0, "failed to write image");
+    const uint32_t n_bytes = image.bpp >> 3;
+    const uint32_t row_size = image.width * n_bytes;
+    const uint32_t n_strips = std::max(1u, std::min(
+        (uint32_t) omp_get_max_threads(), image.height / 16));
+    const uint32_t strip_rows = (image.height + n_strips - 1) / n_strips;
+
+    /* Filter and deflate each strip of rows. */
+    std::vector<std::vector<uint8_t>> strips(n_strips);
+    std::vector<uLong> strip_adler(n_strips);
+    std::vector<uLong> strip_size(n_strips);
+    bool is_ok = true;
+    ito_pragma(omp parallel for schedule(static) reduction(&&:is_ok))
+    for (uint32_t s = 0; s < n_strips; ++s) {
+        uint32_t y_lo = s * strip_rows;
+        uint32_t y_hi = std::min(image.height, y_lo + strip_rows);
+        if (y_lo >= y_hi) {
+            strip_adler[s] = adler32(0L, Z_NULL, 0);
+            strip_size[s] = 0;
+            continue;
+        }
+
+        std::vector<uint8_t> filtered((y_hi - y_lo) * (row_size + 1));
+        std::vector<uint8_t> scratch;
+        for (uint32_t y = y_lo; y < y_hi; ++y) {
+            const uint8_t *prev = (y > 0)
+                ? FileRow(image, y - 1, flip_vertically)
+                : nullptr;
+            FilterPngRow(
+                FileRow(image, y, flip_vertically),
+                prev,
+                row_size,
+                n_bytes,
+                &filtered[(y - y_lo) * (row_size + 1)],
+                scratch);
+        }
+        strip_adler[s] = adler32(
+            adler32(0L, Z_NULL, 0), filtered.data(), filtered.size());
+        strip_size[s] = filtered.size();
+
+        z_stream zs = {};
+        if (deflateInit2(&zs, compression_level, Z_DEFLATED, -15, 8,
+            Z_DEFAULT_STRATEGY) != Z_OK) {
+            is_ok = false;
+            continue;
+        }
+        strips[s].resize(deflateBound(&zs, filtered.size()) + 16);
+        zs.next_in = filtered.data();
+        zs.avail_in = filtered.size();
+        zs.next_out = strips[s].data();
+        zs.avail_out = strips[s].size();
+        int flush = (y_hi == image.height) ? Z_FINISH : Z_SYNC_FLUSH;
+        int ret = deflate(&zs, flush);
+        is_ok = is_ok && (ret == Z_STREAM_END || (ret == Z_OK && zs.avail_in == 0));
+        strips[s].resize(zs.total_out);
+        deflateEnd(&zs);
+    }
+    ito_assert(is_ok, "failed to deflate image");
+
+    /* Assemble the zlib stream, header, strips and combined checksum. */
+    std::vector<uint8_t> idat = {0x78, 0x9c};
+    uLong adler = adler32(0L, Z_NULL, 0);
+    for (uint32_t s = 0; s < n_strips; ++s) {
+        idat.insert(idat.end(), strips[s].begin(), strips[s].end());
+        adler = adler32_combine(adler, strip_adler[s], strip_size[s]);
+    }
+    idat.push_back((uint8_t) (adler >> 24));
+    idat.push_back((uint8_t) (adler >> 16));
+    idat.push_back((uint8_t) (adler >>  8));
+    idat.push_back((uint8_t) (adler));
+
+    /* Write the signature and the header, data and end chunks. */
+    ito::file_ptr file = ito::make_file(filename, "wb");
+    ito_assert(file, "failed to open file");
+
+    const uint8_t signature[8] = {137, 80, 78, 71, 13, 10, 26, 10};
+    ito::file::write(file, (void *) signature, 8);
+
+    const uint8_t color_type[5] = {0, 0, 4, 2, 6};
+    uint8_t ihdr[13] = {
+        (uint8_t) (image.width >> 24),
+        (uint8_t) (image.width >> 16),
+        (uint8_t) (image.width >>  8),
+        (uint8_t) (image.width),
+        (uint8_t) (image.height >> 24),
+        (uint8_t) (image.height >> 16),
+        (uint8_t) (image.height >>  8),
+        (uint8_t) (image.height),
+        8,                          /* bit depth */
+        color_type[n_bytes],        /* color type */
+        0,                          /* deflate compression */
+        0,                          /* adaptive filtering */
+        0};                         /* no interlace */
+    WritePngChunk(file, "IHDR", ihdr, sizeof(ihdr));
+    WritePngChunk(file, "IDAT", idat.data(), idat.size());
+    WritePngChunk(file, "IEND", nullptr, 0);
 }
 
 /**
@@ -197,25 +498,40 @@ void Image::SavePpma(
            << ito::str::format("%u#height\n", image.height)
            << ito::str::format("%u#colors\n", 255);
 
-    /* Write bitmap data. */
-    for (uint32_t y = 0; y < image.height; ++y) {
-        for (uint32_t x = 0; x < image.width; ++x) {
-            const uint8_t *px = flip_vertically
-                ? image(x, image.height - 1 - y)
-                : image(x, y);
+    /* Write buffer to PPM file. */
+    ito::file_ptr file = ito::make_file(filename, "w");
+    ito_assert(file, "failed to open file");
+    ito::file::write(file, (void *) buffer.str().c_str(), buffer.str().size());
 
-            uint8_t r = *px;
-            uint8_t g = image.bpp > 8  ? *(px + 1) : 0;
-            uint8_t b = image.bpp > 16 ? *(px + 2) : 0;
+    /*
+     * Write bitmap data one row at a time, formatting each sample with a
+     * lookup table of decimal strings.
+     */
+    static const std::vector<std::string> kDecimal = [] () {
+        std::vector<std::string> decimal(256);
+        for (size_t i = 0; i < 256; ++i) {
+            decimal[i] = std::to_string(i);
+        }
+        return decimal;
+    }();
 
-            buffer << ito::str::format("%u %u %u\n", r, g, b);
+    const uint32_t n_bytes = image.bpp >> 3;
+    std::string line;
+    line.reserve(12 * image.width);
+    for (uint32_t y = 0; y < image.height; ++y) {
+        const uint8_t *row = FileRow(image, y, flip_vertically);
+        line.clear();
+        for (uint32_t x = 0; x < image.width; ++x) {
+            const uint8_t *px = row + x * n_bytes;
+            line += kDecimal[px[0]];
+            line += ' ';
+            line += kDecimal[n_bytes > 1 ? px[1] : 0];
+            line += ' ';
+            line += kDecimal[n_bytes > 2 ? px[2] : 0];
+            line += '\n';
         }
+        ito::file::write(file, (void *) line.data(), line.size());
     }
-
-    /* Write buffer to PPM file. */
-    ito::file_ptr file = ito::make_file(filename, "w");
-    ito_assert(file, "failed to open file");
-    ito::file::writeline(file, buffer.str());
 }
 
 /**
@@ -259,21 +575,97 @@ void Image::SavePpmb(
            + ito::str::format("%u#colors\n", 255);
     ito::file::write(file, (void *) header.c_str(), header.size());
 
-    /* Write bitmap data. */
+    /*
+     * Write bitmap data one row at a time. RGB rows are written directly
+     * from the bitmap, other formats are converted to RGB in a row buffer.
+     */
+    const uint32_t n_bytes = image.bpp >> 3;
+    std::vector<uint8_t> line(3 * image.width);
     for (uint32_t y = 0; y < image.height; ++y) {
+        const uint8_t *row = FileRow(image, y, flip_vertically);
+        if (n_bytes == 3) {
+            ito::file::write(file, (void *) row, line.size());
+            continue;
+        }
+
         for (uint32_t x = 0; x < image.width; ++x) {
-            const uint8_t *px = flip_vertically
-                ? image(x, image.height - 1 - y)
-                : image(x, y);
+            const uint8_t *px = row + x * n_bytes;
+            line[3*x + 0] = px[0];
+            line[3*x + 1] = n_bytes > 1 ? px[1] : 0;
+            line[3*x + 2] = n_bytes > 2 ? px[2] : 0;
+        }
+        ito::file::write(file, (void *) line.data(), line.size());
+    }
+}
+
+/**
+ * @brief Save an image bitmap using the PAM file format, which keeps all the
+ * image channels. The header is followed by the rows from top to bottom,
+ * each row written directly from the bitmap without its pitch padding.
+ *
+ * @see http://netpbm.sourceforge.net/doc/pam.html
+ */
+void Image::SavePam(
+    const Image &image,
+    const std::string &filename,
+    const bool flip_vertically)
+{
+    ito_assert(!filename.empty(), "invalid filename");
+
+    ito::file_ptr file = ito::make_file(filename, "wb");
+    ito_assert(file, "failed to open file");
+
+    /* Write header. */
+    const uint32_t n_bytes = image.bpp >> 3;
+    const char *tupltype[5] = {
+        "", "GRAYSCALE", "GRAYSCALE_ALPHA", "RGB", "RGB_ALPHA"};
+    std::string header = ito::str::format("P7\n")
+           + ito::str::format("WIDTH %u\n", image.width)
+           + ito::str::format("HEIGHT %u\n", image.height)
+           + ito::str::format("DEPTH %u\n", n_bytes)
+           + ito::str::format("MAXVAL %u\n", 255)
+           + ito::str::format("TUPLTYPE %s\n", tupltype[n_bytes])
+           + ito::str::format("ENDHDR\n");
+    ito::file::write(file, (void *) header.c_str(), header.size());
+
+    /* Write bitmap data. */
+    for (uint32_t y = 0; y < image.height; ++y) {
+        const uint8_t *row = FileRow(image, y, flip_vertically);
+        ito::file::write(file, (void *) row, image.width * n_bytes);
+    }
+}
+
+/**
+ * @brief Save an image bitmap in the raw image format, a header with the
+ * image layout followed by the bitmap rows with their pitch padding. The
+ * bitmap is written with a single call unless flipped, and the file is
+ * loaded back through a memory mapping by Image::Load.
+ */
+void Image::SaveRaw(
+    const Image &image,
+    const std::string &filename,
+    const bool flip_vertically)
+{
+    ito_assert(!filename.empty(), "invalid filename");
+
+    ito::file_ptr file = ito::make_file(filename, "wb");
+    ito_assert(file, "failed to open file");
 
-            uint8_t r = *px;
-            uint8_t g = image.bpp > 8  ? *(px + 1) : 0;
-            uint8_t b = image.bpp > 16 ? *(px + 2) : 0;
+    RawHeader header;
+    std::memcpy(header.magic, kRawMagic, sizeof(kRawMagic));
+    header.width = image.width;
+    header.height = image.height;
+    header.bpp = image.bpp;
+    header.pitch = image.pitch;
+    ito::file::write(file, (void *) &header, sizeof(RawHeader));
 
-            ito::file::write(file, (void *) &r, sizeof(uint8_t));
-            ito::file::write(file, (void *) &g, sizeof(uint8_t));
-            ito::file::write(file, (void *) &b, sizeof(uint8_t));
+    if (flip_vertically) {
+        for (uint32_t y = 0; y < image.height; ++y) {
+            const uint8_t *row = FileRow(image, y, flip_vertically);
+            ito::file::write(file, (void *) row, image.pitch);
         }
+    } else {
+        ito::file::write(file, (void *) &image.bitmap[0], image.size);
     }
 }
 
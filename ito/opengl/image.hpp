@@ -66,7 +66,9 @@ struct Image {
         const uint32_t bpp);
 
     /**
-     * @brief Load Image input/output.
+     * @brief Load Image input/output. Raw images saved with SaveRaw are
+     * loaded through a memory mapping of the file, others are decoded with
+     * stb image.
      */
     static Image Load(
         const std::string &filename,
@@ -76,7 +78,8 @@ struct Image {
     static void SavePng(
         const Image &image,
         const std::string &filename,
-        const bool flip_vertically = false);
+        const bool flip_vertically = false,
+        const int compression_level = 6);
 
     static void SavePpma(
         const Image &image,
@@ -88,6 +91,16 @@ struct Image {
         const std::string &filename,
         const bool flip_vertically = false);
 
+    static void SavePam(
+        const Image &image,
+        const std::string &filename,
+        const bool flip_vertically = false);
+
+    static void SaveRaw(
+        const Image &image,
+        const std::string &filename,
+        const bool flip_vertically = false);
+
     /**
      * @brief Create an OpenGL texture from the specified image.
      */
@@ -12,12 +12,23 @@
 
 #include <string>
 #include <vector>
+#include <algorithm>
 #include <cmath>       /* sin, cos */
+#include <cstdio>      /* fclose, remove */
+#include <cstddef>     /* offsetof */
+#include <cstring>     /* memcpy */
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
 #include "buffer.hpp"
 #include "vertexarray.hpp"
+#include "state.hpp"
 #include "glsl/program.hpp"
 #include "glsl/attribute.hpp"
 #include "mesh.hpp"
+#include "meshoptimizer.hpp"
+#include "vertexformat.hpp"
 
 namespace ito {
 namespace gl {
@@ -102,26 +113,65 @@ std::vector<Mesh::Face> Mesh::Grid(const size_t n1, const size_t n2)
  *      ball_normal
  *      ball_color
  *      ball_texcoord
+ *
+ * Meshes updated every frame should use GL_STREAM_DRAW usage. The vertex data
+ * is then kept in a StreamBuffer, with triple-buffered persistent mapped
+ * regions where supported, and rendered from the region last updated.
  */
 Mesh Mesh::Create(
     const GLuint &program,
     const std::string &name,
     const std::vector<Vertex> &vertices,
-    const std::vector<Face> &faces)
+    const std::vector<Face> &faces,
+    const GLenum usage)
+{
+    return Create(
+        program,
+        name,
+        std::vector<Vertex>(vertices),
+        std::vector<Face>(faces),
+        usage);
+}
+
+/**
+ * @brief Create a mesh moving the vertex and face data into the mesh, with
+ * no copy on the cpu.
+ */
+Mesh Mesh::Create(
+    const GLuint &program,
+    const std::string &name,
+    std::vector<Vertex> &&vertices,
+    std::vector<Face> &&faces,
+    const GLenum usage)
+{
+    Mesh mesh = Create(program, name, View::Make(vertices, faces), usage);
+    mesh.vertices = std::move(vertices);
+    mesh.faces = std::move(faces);
+    return mesh;
+}
+
+/**
+ * @brief Create a gpu only mesh uploading the vertex and face data of the
+ * view, with no copy on the cpu. Each buffer data store is created and
+ * initialized with a single glBufferData call.
+ */
+Mesh Mesh::Create(
+    const GLuint &program,
+    const std::string &name,
+    const View &view,
+    const GLenum usage)
 {
+    ito_assert(view.n_vertices > 0 && view.n_faces > 0, "invalid mesh data");
+
     /*
      * Create a new mesh and given name from a list of vertices and faces.
      */
     Mesh mesh;
     mesh.name = name;
-    mesh.vertices = vertices;
-    mesh.faces = faces;
-
-    /*
-     * Create vertex array object.
-     */
-    mesh.vao = CreateVertexArray();
-    glBindVertexArray(mesh.vao);
+    mesh.n_vertices = view.n_vertices;
+    mesh.n_faces = view.n_faces;
+    mesh.ibo = 0;
+    mesh.n_instances = 0;
 
     /*
      * Create buffer storage for the vertex data with layout:
@@ -135,17 +185,19 @@ Mesh Mesh::Create(
      *   (rgb)_n
      *    (uv)_n}
      */
-    GLsizeiptr vertex_data_size = mesh.vertices.size() * sizeof(Mesh::Vertex);
-    mesh.vbo = CreateBuffer(
-        GL_ARRAY_BUFFER,
-        vertex_data_size,
-        GL_STATIC_DRAW);
-    glBindBuffer(GL_ARRAY_BUFFER, mesh.vbo);
-    glBufferSubData(
-        GL_ARRAY_BUFFER,                /* target binding point */
-        0,                              /* offset in data store */
-        vertex_data_size,               /* data store size in bytes */
-        mesh.vertices.data());          /* pointer to data source */
+    GLsizeiptr vertex_data_size = view.n_vertices * sizeof(Mesh::Vertex);
+    mesh.is_streaming = (usage == GL_STREAM_DRAW);
+    if (mesh.is_streaming) {
+        mesh.stream = StreamBuffer::Create(GL_ARRAY_BUFFER, vertex_data_size);
+        StreamBuffer::Update(mesh.stream, view.vertices);
+        mesh.vbo = mesh.stream.buffer;
+    } else {
+        mesh.vbo = CreateBuffer(
+            GL_ARRAY_BUFFER,            /* target binding point */
+            vertex_data_size,           /* data store size in bytes */
+            usage,                      /* data store usage pattern */
+            view.vertices);             /* pointer to data source */
+    }
 
     /*
      * Create a buffer storage for the face indices with layout:
@@ -153,64 +205,27 @@ Mesh Mesh::Create(
      *      ...
      *   v0,v1,v2)_n}
      */
-    GLsizeiptr index_data_size = mesh.faces.size() * sizeof(Mesh::Face);
+    GLsizeiptr index_data_size = view.n_faces * sizeof(Mesh::Face);
     mesh.ebo = CreateBuffer(
-        GL_ELEMENT_ARRAY_BUFFER,
-        index_data_size,
-        GL_STATIC_DRAW);
-    glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, mesh.ebo);
-    glBufferSubData(
         GL_ELEMENT_ARRAY_BUFFER,        /* target binding point */
-        0,                              /* offset in data store */
         index_data_size,                /* data store size in bytes */
-        mesh.faces.data());             /* pointer to data source */
+        GL_STATIC_DRAW,                 /* data store usage pattern */
+        view.faces);                    /* pointer to data source */
 
     /*
-     * Specify how OpenGL interprets the mesh vertex attributes.
+     * Create the vertex array object and specify how OpenGL interprets the
+     * mesh vertex attributes.
      */
-    EnableAttribute(program, mesh.name + std::string("_position"));
-    AttributePointer(
-        program,
-        mesh.name + std::string("_position"),
-        GL_FLOAT_VEC3,
-        11 * sizeof(GLfloat),   /* byte offset between consecutive attributes */
-        0,                      /* byte offset of first element in the buffer */
-        false);                 /* normalized flag */
-
-    /*
-     * Specify how OpenGL interprets the mesh vertex attributes.
-     */
-    EnableAttribute(program, mesh.name + std::string("_normal"));
-    AttributePointer(
-        program,
-        mesh.name + std::string("_normal"),
-        GL_FLOAT_VEC3,
-        11 * sizeof(GLfloat),   /* byte offset between consecutive attributes */
-        3 * sizeof(GLfloat),    /* byte offset of first element in the buffer */
-        false);                 /* normalized flag */
-
-    EnableAttribute(program, mesh.name + std::string("_color"));
-    AttributePointer(
-        program,
-        mesh.name + std::string("_color"),
-        GL_FLOAT_VEC3,
-        11 * sizeof(GLfloat),   /* byte offset between consecutive attributes */
-        6 * sizeof(GLfloat),    /* byte offset of first element in the buffer */
-        false);                 /* normalized flag */
-
-    EnableAttribute(program, mesh.name + std::string("_texcoord"));
-    AttributePointer(
-        program,
-        mesh.name + std::string("_texcoord"),
-        GL_FLOAT_VEC2,
-        11 * sizeof(GLfloat),   /* byte offset between consecutive attributes */
-        9 * sizeof(GLfloat),    /* byte offset of first element in the buffer */
-        false);                 /* normalized flag */
+    mesh.vao = CreateVertexArray();
+    BindVertexArray(mesh.vao);
+    BindBuffer(GL_ARRAY_BUFFER, mesh.vbo);
+    BindBuffer(GL_ELEMENT_ARRAY_BUFFER, mesh.ebo);
+    VertexAttributes(program, mesh.name);
 
     /*
      * Unbind vertex array object.
      */
-    glBindVertexArray(0);
+    BindVertexArray(0);
 
     /*
      * Return mesh object
@@ -225,27 +240,69 @@ void Mesh::Destroy(Mesh &mesh)
 {
     /* Destroy OpenGL data */
     DestroyBuffer(mesh.ebo);
-    DestroyBuffer(mesh.vbo);
+    if (mesh.ibo != 0) {
+        DestroyBuffer(mesh.ibo);
+    }
+    if (mesh.is_streaming) {
+        StreamBuffer::Destroy(mesh.stream);
+    } else {
+        DestroyBuffer(mesh.vbo);
+    }
     DestroyVertexArray(mesh.vao);
 
     /* Destroy vertex data */
-    mesh.vertices.clear();
-    mesh.faces.clear();
+    Release(mesh);
+    mesh.n_vertices = 0;
+    mesh.n_faces = 0;
+}
+
+/**
+ * @brief Release the vertex and face data on the cpu, and their memory. The
+ * mesh is still rendered from its gpu buffers, but can no longer be updated.
+ */
+void Mesh::Release(Mesh &mesh)
+{
+    std::vector<Vertex>().swap(mesh.vertices);
+    std::vector<Face>().swap(mesh.faces);
+}
+
+bool Mesh::IsGpuOnly(const Mesh &mesh)
+{
+    return mesh.vertices.empty() && mesh.n_vertices > 0;
 }
 
 /**
  * @brief Update mesh vertex data on the gpu.
  */
-void Mesh::Update(const Mesh &mesh)
+void Mesh::Update(Mesh &mesh)
 {
-    GLsizeiptr vertex_data_size = mesh.vertices.size() * sizeof(Mesh::Vertex);
-    glBindBuffer(GL_ARRAY_BUFFER, mesh.vbo);
+    Update(mesh, 0, mesh.vertices.size());
+}
+
+/**
+ * @brief Update the range of count vertices starting at first on the gpu.
+ * Streaming meshes copy the range into the next region of the stream buffer,
+ * along with the ranges changed since that region was last written.
+ */
+void Mesh::Update(Mesh &mesh, const size_t first, const size_t count)
+{
+    ito_assert(!IsGpuOnly(mesh), "mesh data released from the cpu");
+    ito_assert(first + count <= mesh.vertices.size(), "invalid vertex range");
+
+    GLintptr offset = first * sizeof(Mesh::Vertex);
+    GLsizeiptr size = count * sizeof(Mesh::Vertex);
+    if (mesh.is_streaming) {
+        StreamBuffer::Invalidate(mesh.stream, offset, size);
+        StreamBuffer::Update(mesh.stream, mesh.vertices.data());
+        return;
+    }
+
+    BindBuffer(GL_ARRAY_BUFFER, mesh.vbo);
     glBufferSubData(
         GL_ARRAY_BUFFER,            /* target binding point */
-        0,                          /* offset in data store */
-        vertex_data_size,           /* data store size in bytes */
-        mesh.vertices.data());      /* pointer to data source */
-    glBindBuffer(GL_ARRAY_BUFFER, 0);
+        offset,                     /* offset in data store */
+        size,                       /* data store size in bytes */
+        mesh.vertices.data() + first);  /* pointer to data source */
 }
 
 /**
@@ -254,14 +311,174 @@ void Mesh::Update(const Mesh &mesh)
  */
 void Mesh::Render(const Mesh &mesh)
 {
-    GLsizei n_elements = 3 * mesh.faces.size();
-    glBindVertexArray(mesh.vao);
-    glDrawElements(
+    GLsizei n_elements = 3 * mesh.n_faces;
+    BindVertexArray(mesh.vao);
+    if (mesh.is_streaming) {
+        /* Offset the vertex indices to the stream region last updated. */
+        GLint base_vertex = StreamBuffer::Offset(mesh.stream) /
+            sizeof(Mesh::Vertex);
+        glDrawElementsBaseVertex(
+            GL_TRIANGLES,       /* what kind of primitives to render */
+            n_elements,         /* number of elements to be rendered */
+            GL_UNSIGNED_INT,    /* type of the values in indices */
+            (GLvoid *) 0,       /* offset of first index in the data array */
+            base_vertex);       /* constant added to each index */
+    } else {
+        glDrawElements(
+            GL_TRIANGLES,       /* what kind of primitives to render */
+            n_elements,         /* number of elements to be rendered */
+            GL_UNSIGNED_INT,    /* type of the values in indices */
+            (GLvoid *) 0);      /* offset of first index in the data array */
+    }
+}
+
+/** ---------------------------------------------------------------------------
+ * @brief Return the instance attributes of a row-major transform, such as an
+ * ito::math matrix, and a color.
+ */
+Mesh::Instance Mesh::Instance::Make(
+    const math::mat4f &transform,
+    const math::vec4f &color)
+{
+    Instance instance;
+    for (size_t i = 0; i < 4; ++i) {
+        for (size_t j = 0; j < 4; ++j) {
+            instance.transform[4*j + i] = transform.data[4*i + j];
+        }
+    }
+    for (size_t i = 0; i < 4; ++i) {
+        instance.color[i] = color.data[i];
+    }
+    return instance;
+}
+
+/**
+ * @brief Return a view of the vertex and face data held in the vectors.
+ */
+Mesh::View Mesh::View::Make(
+    const std::vector<Vertex> &vertices,
+    const std::vector<Face> &faces)
+{
+    View view;
+    view.vertices = vertices.data();
+    view.n_vertices = vertices.size();
+    view.faces = faces.data();
+    view.n_faces = faces.size();
+    return view;
+}
+
+/**
+ * @brief Set the mesh instances. The instance buffer is created on the first
+ * call, with the instance attributes bound to the mesh vertex array, and its
+ * data store is reallocated on later calls so it is never written while in
+ * use by previous draw calls.
+ *
+ * The shader program object needs two active instance attributes, prefixed
+ * by the mesh name, eg:
+ *      ball_instance_transform (mat4)
+ *      ball_instance_color     (vec4)
+ */
+void Mesh::SetInstances(
+    Mesh &mesh,
+    const GLuint &program,
+    const std::vector<Instance> &instances)
+{
+    GLsizeiptr instance_data_size = instances.size() * sizeof(Mesh::Instance);
+    if (mesh.ibo == 0) {
+        mesh.ibo = CreateBuffer(
+            GL_ARRAY_BUFFER,
+            std::max(instance_data_size, (GLsizeiptr) sizeof(Mesh::Instance)),
+            GL_DYNAMIC_DRAW);
+
+        std::string transform_name = mesh.name + "_instance_transform";
+        std::string color_name = mesh.name + "_instance_color";
+        BindVertexArray(mesh.vao);
+        BindBuffer(GL_ARRAY_BUFFER, mesh.ibo);
+        InstanceAttributes(
+            glGetAttribLocation(program, transform_name.c_str()),
+            glGetAttribLocation(program, color_name.c_str()),
+            0);
+        BindVertexArray(0);
+    }
+
+    BindBuffer(GL_ARRAY_BUFFER, mesh.ibo);
+    glBufferData(
+        GL_ARRAY_BUFFER,            /* target binding point */
+        instance_data_size,         /* data store size in bytes */
+        instances.data(),           /* pointer to data source */
+        GL_DYNAMIC_DRAW);           /* data store usage */
+    mesh.n_instances = instances.size();
+}
+
+/**
+ * @brief Render all instances of the mesh with a single draw call.
+ */
+void Mesh::RenderInstanced(const Mesh &mesh)
+{
+    if (mesh.n_instances == 0) {
+        return;
+    }
+
+    GLsizei n_elements = 3 * mesh.n_faces;
+    GLint base_vertex = mesh.is_streaming
+        ? StreamBuffer::Offset(mesh.stream) / sizeof(Mesh::Vertex)
+        : 0;
+    BindVertexArray(mesh.vao);
+    glDrawElementsInstancedBaseVertex(
         GL_TRIANGLES,           /* what kind of primitives to render */
         n_elements,             /* number of elements to be rendered */
         GL_UNSIGNED_INT,        /* type of the values in indices */
-        (GLvoid *) 0);          /* offset of first index in the data array */
-    glBindVertexArray(0);
+        (GLvoid *) 0,           /* offset of first index in the data array */
+        mesh.n_instances,       /* number of instances to be rendered */
+        base_vertex);           /* constant added to each index */
+}
+
+/** ---------------------------------------------------------------------------
+ * @brief Specify the mesh vertex attributes, prefixed by the name, in the
+ * bound vertex array object with data in the buffer bound to GL_ARRAY_BUFFER,
+ * with the layout of the standard vertex format.
+ */
+void Mesh::VertexAttributes(const GLuint &program, const std::string &name)
+{
+    VertexFormat::AttributePointers(
+        VertexFormat::Standard(), program, name, 0);
+}
+
+/**
+ * @brief Specify the instance attributes in the bound vertex array object,
+ * with data in the buffer bound to GL_ARRAY_BUFFER starting at offset bytes.
+ * The transform occupies four consecutive locations, one per column, and all
+ * instance attributes advance once per instance.
+ */
+void Mesh::InstanceAttributes(
+    const GLint transform_location,
+    const GLint color_location,
+    const GLintptr offset)
+{
+    if (transform_location != -1) {
+        for (GLint i = 0; i < 4; ++i) {
+            EnableAttribute(transform_location + i);
+            AttributePointer(
+                transform_location + i,
+                GL_FLOAT_VEC4,
+                sizeof(Mesh::Instance),
+                offset + offsetof(Mesh::Instance, transform) +
+                    4 * i * sizeof(GLfloat),
+                false);
+            AttributeDivisor(transform_location + i, 1);
+        }
+    }
+
+    if (color_location != -1) {
+        EnableAttribute(color_location);
+        AttributePointer(
+            color_location,
+            GL_FLOAT_VEC4,
+            sizeof(Mesh::Instance),
+            offset + offsetof(Mesh::Instance, color),
+            false);
+        AttributeDivisor(color_location, 1);
+    }
 }
 
 /**
@@ -326,7 +543,7 @@ Mesh Mesh::Plane(
     std::vector<Mesh::Face> faces = Mesh::Grid(n1, n2);
 
     /* Create mesh. */
-    return Mesh::Create(program, name, vertices, faces);
+    return Mesh::Create(program, name, std::move(vertices), std::move(faces));
 }
 
 /**
@@ -400,24 +617,225 @@ Mesh Mesh::Sphere(
     std::vector<Mesh::Face> faces = Mesh::Grid(n1, n2);
 
     /* Create mesh. */
-    return Mesh::Create(program, name, vertices, faces);
+    return Mesh::Create(program, name, std::move(vertices), std::move(faces));
+}
+
+/** ---------------------------------------------------------------------------
+ * @brief Mesh cache file layout:
+ *      header,
+ *      table with the vertex and face blob of each mesh,
+ *      vertex and face blobs, each aligned to a 16-byte boundary.
+ *
+ * The blobs hold the Vertex and Face arrays as they are laid out in memory,
+ * so each is copied from the memory mapped file with a single memcpy. The
+ * file format version and the vertex and face sizes are stored in the header,
+ * and a cache file written with a different layout is rejected. The header
+ * flags record how the data was processed, eg optimized, and a cache file
+ * with different flags is a cache miss.
+ */
+static const char kMeshCacheMagic[8] = {'I', 'T', 'O', 'M', 'E', 'S', 'H', 0};
+static const uint32_t kMeshCacheVersion = 2;
+static const uint32_t kMeshCacheOptimized = 1;
+
+struct MeshCacheHeader {
+    char magic[8];
+    uint32_t version;
+    uint32_t flags;
+    uint32_t vertex_size;
+    uint32_t face_size;
+    uint64_t n_meshes;
+};
+
+struct MeshCacheEntry {
+    uint64_t vertex_offset;
+    uint64_t n_vertices;
+    uint64_t face_offset;
+    uint64_t n_faces;
+};
+
+static uint64_t MeshCacheAlign(const uint64_t offset)
+{
+    return (offset + 15) & ~((uint64_t) 15);
 }
 
 /**
- * @brief Load the model meshes from a specified filename. The filename has a
- * format by Assimp and loads the model with the supported extensions.
- * If successful, processes each individual mesh in the Assimp scene and
- * retrieves the vertices and faces.
+ * @brief Memory mapped mesh cache file with a view of each mesh data.
+ */
+struct MeshCacheMap {
+    void *addr;
+    size_t size;
+    std::vector<Mesh::View> views;
+};
+
+/**
+ * @brief Map the cache file read-only and return a view of the vertex and
+ * face data of each mesh. Return false if the file is not a valid mesh
+ * cache file, or if it was written with different flags.
+ */
+static bool MapCache(
+    const std::string &cachename,
+    const uint32_t flags,
+    MeshCacheMap &map)
+{
+    int fd = open(cachename.c_str(), O_RDONLY);
+    if (fd < 0) {
+        return false;
+    }
+
+    struct stat st;
+    if (fstat(fd, &st) != 0 || st.st_size < (off_t) sizeof(MeshCacheHeader)) {
+        close(fd);
+        return false;
+    }
+
+    void *addr = mmap(NULL, st.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+    close(fd);
+    if (addr == MAP_FAILED) {
+        return false;
+    }
+
+    /* Check the header, the table and the blob ranges. */
+    const uint8_t *data = static_cast<const uint8_t *>(addr);
+    const uint64_t size = st.st_size;
+
+    MeshCacheHeader header;
+    std::memcpy(&header, data, sizeof(MeshCacheHeader));
+    bool is_valid =
+        std::memcmp(header.magic, kMeshCacheMagic, 8) == 0 &&
+        header.version == kMeshCacheVersion &&
+        header.flags == flags &&
+        header.vertex_size == sizeof(Mesh::Vertex) &&
+        header.face_size == sizeof(Mesh::Face) &&
+        header.n_meshes <= (size - sizeof(MeshCacheHeader)) /
+            sizeof(MeshCacheEntry);
+
+    std::vector<MeshCacheEntry> entries;
+    if (is_valid) {
+        entries.resize(header.n_meshes);
+        std::memcpy(
+            entries.data(),
+            data + sizeof(MeshCacheHeader),
+            entries.size() * sizeof(MeshCacheEntry));
+    }
+    for (auto &entry : entries) {
+        is_valid = is_valid &&
+            entry.n_vertices > 0 &&
+            entry.n_faces > 0 &&
+            entry.vertex_offset <= size &&
+            entry.vertex_offset % 16 == 0 &&
+            entry.n_vertices <= (size - entry.vertex_offset) /
+                sizeof(Mesh::Vertex) &&
+            entry.face_offset <= size &&
+            entry.face_offset % 16 == 0 &&
+            entry.n_faces <= (size - entry.face_offset) / sizeof(Mesh::Face);
+    }
+    if (!is_valid) {
+        munmap(addr, st.st_size);
+        return false;
+    }
+
+    /*
+     * The blobs are aligned, so the views point into the mapping. The face
+     * indices are checked against the number of vertices once, before the
+     * views are uploaded or used on the cpu.
+     */
+    madvise(addr, st.st_size, MADV_SEQUENTIAL);
+    std::vector<Mesh::View> views;
+    for (auto &entry : entries) {
+        Mesh::View view;
+        view.vertices = reinterpret_cast<const Mesh::Vertex *>(
+            data + entry.vertex_offset);
+        view.n_vertices = entry.n_vertices;
+        view.faces = reinterpret_cast<const Mesh::Face *>(
+            data + entry.face_offset);
+        view.n_faces = entry.n_faces;
+
+        for (size_t i = 0; is_valid && i < view.n_faces; ++i) {
+            const Mesh::Face &face = view.faces[i];
+            is_valid =
+                face.index[0] < view.n_vertices &&
+                face.index[1] < view.n_vertices &&
+                face.index[2] < view.n_vertices;
+        }
+        views.push_back(view);
+    }
+    if (!is_valid) {
+        munmap(addr, st.st_size);
+        return false;
+    }
+
+    map.addr = addr;
+    map.size = st.st_size;
+    map.views = std::move(views);
+    return true;
+}
+
+/**
+ * @brief Unmap the cache file, invalidating its views.
+ */
+static void UnmapCache(MeshCacheMap &map)
+{
+    munmap(map.addr, map.size);
+    map.addr = NULL;
+    map.size = 0;
+    map.views.clear();
+}
+
+/**
+ * @brief Is the mesh cache file present and not older than the model file?
+ */
+static bool IsCacheCurrent(
+    const std::string &filename,
+    const std::string &cachename)
+{
+    if (cachename.empty()) {
+        return false;
+    }
+    struct stat model_st, cache_st;
+    return stat(cachename.c_str(), &cache_st) == 0 &&
+        (stat(filename.c_str(), &model_st) != 0 ||
+         cache_st.st_mtime >= model_st.st_mtime);
+}
+
+/**
+ * @brief Import the vertex and face data of the model meshes on the cpu,
+ * without creating any gpu objects. The filename has a format by Assimp and
+ * loads the model with the supported extensions. If successful, processes
+ * each individual mesh in the Assimp scene and retrieves the vertices and
+ * faces.
+ *
+ * If cachename is not empty, the vertex and face data is read from the mesh
+ * cache file when it is newer than the model file, and Assimp is only used on
+ * a cache miss, after which the cache file is written.
+ *
+ * If optimize is true, the imported vertices are welded and the faces and
+ * vertices reordered by MeshOptimizer. The cache file holds the optimized
+ * data, so the optimization only runs on a cache miss. The cache file records
+ * whether its data is optimized, and a file written with a different optimize
+ * flag is a cache miss.
  *
  * @see OpenGL mesh and polygon file format(ply):
  *      https://learnopengl.com/Model-Loading/MModel
  *      http://paulbourke.net/dataformats/ply
  */
-std::vector<Mesh> Mesh::Load(
-    const GLuint &program,
-    const std::string &name,
-    const std::string &filename)
+void Mesh::Import(
+    const std::string &filename,
+    std::vector<std::vector<Mesh::Vertex>> &vertices,
+    std::vector<std::vector<Mesh::Face>> &faces,
+    const std::string &cachename,
+    const bool optimize)
 {
+    vertices.clear();
+    faces.clear();
+
+    /*
+     * Read the mesh cache file if it exists and is not older than the model.
+     */
+    if (IsCacheCurrent(filename, cachename) &&
+        ReadCache(cachename, vertices, faces, optimize)) {
+        return;
+    }
+
     /*
      * Load Assimp scene from the specified filename.
      * aiProcess_Triangulate ensures triangles are the model's only primitive.
@@ -431,19 +849,195 @@ std::vector<Mesh> Mesh::Load(
         aiProcess_CalcTangentSpace);
     ito_assert(scene != NULL, importer.GetErrorString());
 
-    /* Initialize the meshes in the scene one by one. */
-    std::vector<Mesh> meshes;
+    /* Process the meshes in the scene one by one. */
     for (size_t i = 0; i < scene->mNumMeshes; ++i) {
-        std::vector<Mesh::Vertex> vertices;
-        std::vector<Mesh::Face> faces;
-        if (Mesh::Process(scene->mMeshes[i], vertices, faces)) {
-            meshes.push_back(Mesh::Create(program, name, vertices, faces));
+        std::vector<Mesh::Vertex> mesh_vertices;
+        std::vector<Mesh::Face> mesh_faces;
+        if (Mesh::Process(scene->mMeshes[i], mesh_vertices, mesh_faces)) {
+            if (optimize) {
+                MeshOptimizer::Optimize(mesh_vertices, mesh_faces);
+            }
+            vertices.push_back(std::move(mesh_vertices));
+            faces.push_back(std::move(mesh_faces));
         }
+    }
 
+    /* Write the mesh cache file for the next import. */
+    if (!cachename.empty()) {
+        std::vector<View> views;
+        for (size_t i = 0; i < vertices.size(); ++i) {
+            views.push_back(View::Make(vertices[i], faces[i]));
+        }
+        WriteCache(cachename, views, optimize);
+    }
+}
+
+/**
+ * @brief Load the model meshes from a specified filename, or from the mesh
+ * cache file, and create them. The mesh data is imported by Import.
+ *
+ * If keep_data is false, the meshes are gpu only. Cached meshes are then
+ * uploaded straight from the mapped cache file, with no copy on the cpu, and
+ * imported meshes release their data once the cache file is written.
+ */
+std::vector<Mesh> Mesh::Load(
+    const GLuint &program,
+    const std::string &name,
+    const std::string &filename,
+    const std::string &cachename,
+    const bool optimize,
+    const bool keep_data)
+{
+    std::vector<Mesh> meshes;
+
+    /*
+     * Upload gpu only meshes straight from the mapped cache file.
+     */
+    MeshCacheMap map;
+    uint32_t flags = optimize ? kMeshCacheOptimized : 0;
+    if (!keep_data &&
+        IsCacheCurrent(filename, cachename) &&
+        MapCache(cachename, flags, map)) {
+        for (auto &view : map.views) {
+            meshes.push_back(Mesh::Create(program, name, view));
+        }
+        UnmapCache(map);
+        return meshes;
+    }
+
+    /*
+     * Import the mesh data, from the cache file or Assimp, and create the
+     * meshes. Release the mesh data once uploaded and cached.
+     */
+    std::vector<std::vector<Mesh::Vertex>> vertices;
+    std::vector<std::vector<Mesh::Face>> faces;
+    Import(filename, vertices, faces, cachename, optimize);
+    for (size_t i = 0; i < vertices.size(); ++i) {
+        meshes.push_back(Mesh::Create(
+            program, name, std::move(vertices[i]), std::move(faces[i])));
+        if (!keep_data) {
+            Mesh::Release(meshes.back());
+        }
     }
     return meshes;
 }
 
+/**
+ * @brief Read the vertex and face data of each mesh in the cache file through
+ * a read-only memory mapping. Return false if the file is not a valid mesh
+ * cache file, or if its data is not optimized as requested.
+ */
+bool Mesh::ReadCache(
+    const std::string &cachename,
+    std::vector<std::vector<Mesh::Vertex>> &vertices,
+    std::vector<std::vector<Mesh::Face>> &faces,
+    const bool optimized)
+{
+    MeshCacheMap map;
+    if (!MapCache(cachename, optimized ? kMeshCacheOptimized : 0, map)) {
+        return false;
+    }
+
+    /* Copy the blobs, sequentially, into the vertex and face arrays. */
+    vertices.resize(map.views.size());
+    faces.resize(map.views.size());
+    for (size_t i = 0; i < map.views.size(); ++i) {
+        const View &view = map.views[i];
+        vertices[i].assign(view.vertices, view.vertices + view.n_vertices);
+        faces[i].assign(view.faces, view.faces + view.n_faces);
+    }
+
+    UnmapCache(map);
+    return true;
+}
+
+/**
+ * @brief Write a blob of size bytes to the cache file. Return false if the
+ * blob is not written whole.
+ */
+static bool WriteCacheBlob(
+    ito::file_ptr &file,
+    const void *ptr,
+    const size_t size)
+{
+    return size == 0 || ito::file::write(file, (void *) ptr, size) == 1;
+}
+
+/**
+ * @brief Write the vertex and face data of the mesh views to a cache file,
+ * flagged as optimized data if optimized is true. The file is removed if it
+ * is not written and closed whole, so a short write never leaves a cache
+ * file that maps as valid.
+ */
+void Mesh::WriteCache(
+    const std::string &cachename,
+    const std::vector<View> &views,
+    const bool optimized)
+{
+    ito_assert(!cachename.empty(), "invalid filename");
+
+    /* Lay out the blobs after the header and the table. */
+    MeshCacheHeader header;
+    std::memcpy(header.magic, kMeshCacheMagic, 8);
+    header.version = kMeshCacheVersion;
+    header.flags = optimized ? kMeshCacheOptimized : 0;
+    header.vertex_size = sizeof(Mesh::Vertex);
+    header.face_size = sizeof(Mesh::Face);
+    header.n_meshes = views.size();
+
+    std::vector<MeshCacheEntry> entries(views.size());
+    uint64_t offset = sizeof(MeshCacheHeader) +
+        entries.size() * sizeof(MeshCacheEntry);
+    for (size_t i = 0; i < views.size(); ++i) {
+        entries[i].vertex_offset = MeshCacheAlign(offset);
+        entries[i].n_vertices = views[i].n_vertices;
+        offset = entries[i].vertex_offset +
+            entries[i].n_vertices * sizeof(Mesh::Vertex);
+
+        entries[i].face_offset = MeshCacheAlign(offset);
+        entries[i].n_faces = views[i].n_faces;
+        offset = entries[i].face_offset +
+            entries[i].n_faces * sizeof(Mesh::Face);
+    }
+
+    /* Write the header, the table and the padded blobs. */
+    ito::file_ptr file = ito::make_file(cachename, "wb");
+    ito_assert(file, "failed to open file");
+    bool is_written =
+        WriteCacheBlob(file, &header, sizeof(MeshCacheHeader)) &&
+        WriteCacheBlob(
+            file, entries.data(), entries.size() * sizeof(MeshCacheEntry));
+
+    uint8_t padding[16] = {};
+    offset = sizeof(MeshCacheHeader) + entries.size() * sizeof(MeshCacheEntry);
+    for (size_t i = 0; is_written && i < views.size(); ++i) {
+        is_written = is_written &&
+            WriteCacheBlob(file, padding, entries[i].vertex_offset - offset) &&
+            WriteCacheBlob(
+                file,
+                views[i].vertices,
+                entries[i].n_vertices * sizeof(Mesh::Vertex));
+        offset = entries[i].vertex_offset +
+            entries[i].n_vertices * sizeof(Mesh::Vertex);
+
+        is_written = is_written &&
+            WriteCacheBlob(file, padding, entries[i].face_offset - offset) &&
+            WriteCacheBlob(
+                file,
+                views[i].faces,
+                entries[i].n_faces * sizeof(Mesh::Face));
+        offset = entries[i].face_offset +
+            entries[i].n_faces * sizeof(Mesh::Face);
+    }
+
+    /* Close the file, flushing the buffered writes, and check the result. */
+    is_written = (std::fclose(file.release()) == 0) && is_written;
+    if (!is_written) {
+        std::remove(cachename.c_str());
+    }
+    ito_assert(is_written, "failed to write mesh cache file");
+}
+
 /**
  * @brief Process an Assimp mesh and retrieve vertex and face data.
  */
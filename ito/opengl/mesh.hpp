@@ -20,6 +20,7 @@
 #include <string>
 #include <vector>
 #include "base.hpp"
+#include "streambuffer.hpp"
 
 namespace ito {
 namespace gl {
@@ -115,37 +116,111 @@ struct Mesh {
         GLuint index[3];
     };
 
+    /**
+     * @brief Instance holds the attributes of an instance of the mesh in
+     * instanced rendering, a column-major model transform and a color.
+     */
+    struct Instance {
+        GLfloat transform[16];
+        GLfloat color[4];
+
+        static Instance Make(
+            const math::mat4f &transform,
+            const math::vec4f &color);
+    };
+
+    /**
+     * @brief View is a non-owning reference to vertex and face data, held in
+     * a vector, a memory mapped file, or any other contiguous storage that
+     * outlives its use.
+     */
+    struct View {
+        const Vertex *vertices;
+        size_t n_vertices;
+        const Face *faces;
+        size_t n_faces;
+
+        static View Make(
+            const std::vector<Vertex> &vertices,
+            const std::vector<Face> &faces);
+    };
+
     /** -----------------------------------------------------------------------
      * Mesh member variables.
      */
     std::string name;                   /* mesh name */
-    std::vector<Vertex> vertices;       /* vertex list */
-    std::vector<Face> faces;            /* indexed face list */
+    std::vector<Vertex> vertices;       /* vertex list, empty if gpu only */
+    std::vector<Face> faces;            /* face list, empty if gpu only */
+    GLsizei n_vertices;                 /* number of vertices on the gpu */
+    GLsizei n_faces;                    /* number of faces on the gpu */
     GLuint vao;                         /* vertex array object */
     GLuint vbo;                         /* vertex buffer object */
     GLuint ebo;                         /* element buffer object */
+    bool is_streaming;                  /* vertex data is streamed */
+    StreamBuffer stream;                /* streaming vertex buffer */
+    GLuint ibo;                         /* instance buffer object */
+    GLsizei n_instances;                /* number of mesh instances */
 
     /** -----------------------------------------------------------------------
      * @brief Create a grid with (n1 * n2) vertices.
      */
     static std::vector<Face> Grid(const size_t n1, const size_t n2);
 
-    /** @brief Create a mesh. */
+    /**
+     * @brief Create a mesh. The vertex and face data is copied, or moved
+     * from rvalues, into the mesh. A mesh created from a view is gpu only,
+     * its data is uploaded without a copy and is not kept in the mesh.
+     */
     static Mesh Create(
         const GLuint &program,
         const std::string &name,
         const std::vector<Vertex> &vertices,
-        const std::vector<Face> &faces);
+        const std::vector<Face> &faces,
+        const GLenum usage = GL_STATIC_DRAW);
+    static Mesh Create(
+        const GLuint &program,
+        const std::string &name,
+        std::vector<Vertex> &&vertices,
+        std::vector<Face> &&faces,
+        const GLenum usage = GL_STATIC_DRAW);
+    static Mesh Create(
+        const GLuint &program,
+        const std::string &name,
+        const View &view,
+        const GLenum usage = GL_STATIC_DRAW);
 
     /** @brief Destroy mesh objects. */
     static void Destroy(Mesh &mesh);
 
+    /** @brief Release the mesh data on the cpu, keeping the gpu objects. */
+    static void Release(Mesh &mesh);
+
+    /** @brief Is the mesh data released from the cpu? */
+    static bool IsGpuOnly(const Mesh &mesh);
+
     /** @brief Update mesh vertex data on the gpu. */
-    static void Update(const Mesh &mesh);
+    static void Update(Mesh &mesh);
+    static void Update(Mesh &mesh, const size_t first, const size_t count);
 
     /** @brief Render the mesh. */
     static void Render(const Mesh &mesh);
 
+    /** @brief Set the mesh instances and render them. */
+    static void SetInstances(
+        Mesh &mesh,
+        const GLuint &program,
+        const std::vector<Instance> &instances);
+    static void RenderInstanced(const Mesh &mesh);
+
+    /** @brief Specify the vertex and instance attributes of the bound VAO. */
+    static void VertexAttributes(
+        const GLuint &program,
+        const std::string &name);
+    static void InstanceAttributes(
+        const GLint transform_location,
+        const GLint color_location,
+        const GLintptr offset);
+
     /** @brief Create a plane represented by (n1 * n2) vertices. */
     static Mesh Plane(
         const GLuint &program,
@@ -169,11 +244,47 @@ struct Mesh {
         GLfloat phi_lo,
         GLfloat phi_hi);
 
-    /** @brief Load the model meshes from a specified filename. */
+    /**
+     * @brief Import the vertex and face data of the model meshes on the cpu,
+     * from a specified filename, or from the mesh cache file if it is newer
+     * than the model file. No gpu objects are created. Optimize the mesh data
+     * for the GPU vertex pipeline if optimize is true.
+     */
+    static void Import(
+        const std::string &filename,
+        std::vector<std::vector<Mesh::Vertex>> &vertices,
+        std::vector<std::vector<Mesh::Face>> &faces,
+        const std::string &cachename = "",
+        const bool optimize = false);
+
+    /**
+     * @brief Load the model meshes from a specified filename, or from the
+     * mesh cache file if it is newer than the model file. Optimize the mesh
+     * data for the GPU vertex pipeline if optimize is true. Keep the mesh
+     * data on the cpu if keep_data is true, otherwise the meshes are gpu only
+     * and cached meshes are uploaded directly from the mapped cache file.
+     */
     static std::vector<Mesh> Load(
         const GLuint &program,
         const std::string &name,
-        const std::string &filename);
+        const std::string &filename,
+        const std::string &cachename = "",
+        const bool optimize = false,
+        const bool keep_data = true);
+
+    /**
+     * @brief Read and write the vertex and face data in a mesh cache file.
+     * A cache file written with a different optimized flag is not read.
+     */
+    static bool ReadCache(
+        const std::string &cachename,
+        std::vector<std::vector<Mesh::Vertex>> &vertices,
+        std::vector<std::vector<Mesh::Face>> &faces,
+        const bool optimized = false);
+    static void WriteCache(
+        const std::string &cachename,
+        const std::vector<View> &views,
+        const bool optimized = false);
 
     /** @brief Process an Assimp mesh and retrieve vertex and face data. */
     static bool Process(
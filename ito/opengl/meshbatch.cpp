@@ -0,0 +1,281 @@
+/*
+ * meshbatch.cpp
+ *
+ * Copyright (c) 2020 Carlos Braga
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the MIT License.
+ *
+ * See accompanying LICENSE.md or https://opensource.org/licenses/MIT.
+ */
+
+#include <algorithm>
+#include "buffer.hpp"
+#include "state.hpp"
+#include "vertexarray.hpp"
+#include "meshbatch.hpp"
+
+namespace ito {
+namespace gl {
+
+/** ---------------------------------------------------------------------------
+ * @brief Create a batch with a given name bound to a shader program object,
+ * merging the vertices and faces of the meshes. The meshes are not modified
+ * and can be destroyed once the batch is created.
+ */
+MeshBatch MeshBatch::Create(
+    const GLuint &program,
+    const std::string &name,
+    const std::vector<Mesh> &meshes)
+{
+    ito_assert(!meshes.empty(), "invalid mesh batch");
+
+    MeshBatch batch;
+    batch.name = name;
+    batch.is_indirect = IsIndirectSupported();
+
+    /*
+     * Compute the draw command of each mesh and the merged buffer sizes.
+     */
+    size_t n_vertices = 0;
+    size_t n_faces = 0;
+    for (auto &mesh : meshes) {
+        Command command;
+        command.count = 3 * mesh.n_faces;
+        command.instance_count = 0;
+        command.first_index = 3 * n_faces;
+        command.base_vertex = n_vertices;
+        command.base_instance = 0;
+        batch.commands.push_back(command);
+
+        n_vertices += mesh.n_vertices;
+        n_faces += mesh.n_faces;
+    }
+
+    /*
+     * Create the merged vertex and element buffers and copy each mesh in
+     * the range of its draw command. Gpu only meshes are copied from their
+     * buffer objects. The element buffer is written through the copy write
+     * target, which is not vertex array state.
+     */
+    batch.vbo = CreateBuffer(
+        GL_ARRAY_BUFFER,
+        n_vertices * sizeof(Mesh::Vertex),
+        GL_STATIC_DRAW);
+    batch.ebo = CreateBuffer(
+        GL_ELEMENT_ARRAY_BUFFER,
+        n_faces * sizeof(Mesh::Face),
+        GL_STATIC_DRAW);
+    BindBuffer(GL_ARRAY_BUFFER, batch.vbo);
+    BindBuffer(GL_COPY_WRITE_BUFFER, batch.ebo);
+    for (size_t i = 0; i < meshes.size(); ++i) {
+        const Mesh &mesh = meshes[i];
+        const Command &command = batch.commands[i];
+        if (Mesh::IsGpuOnly(mesh)) {
+            GLintptr vertex_offset = mesh.is_streaming
+                ? StreamBuffer::Offset(mesh.stream)
+                : 0;
+            BindBuffer(GL_COPY_READ_BUFFER, mesh.vbo);
+            glCopyBufferSubData(
+                GL_COPY_READ_BUFFER,
+                GL_ARRAY_BUFFER,
+                vertex_offset,
+                command.base_vertex * sizeof(Mesh::Vertex),
+                mesh.n_vertices * sizeof(Mesh::Vertex));
+            BindBuffer(GL_COPY_READ_BUFFER, mesh.ebo);
+            glCopyBufferSubData(
+                GL_COPY_READ_BUFFER,
+                GL_COPY_WRITE_BUFFER,
+                0,
+                command.first_index * sizeof(GLuint),
+                mesh.n_faces * sizeof(Mesh::Face));
+            continue;
+        }
+        glBufferSubData(
+            GL_ARRAY_BUFFER,
+            command.base_vertex * sizeof(Mesh::Vertex),
+            mesh.n_vertices * sizeof(Mesh::Vertex),
+            mesh.vertices.data());
+        glBufferSubData(
+            GL_COPY_WRITE_BUFFER,
+            command.first_index * sizeof(GLuint),
+            mesh.n_faces * sizeof(Mesh::Face),
+            mesh.faces.data());
+    }
+
+    BindBuffer(GL_COPY_READ_BUFFER, 0);
+    BindBuffer(GL_COPY_WRITE_BUFFER, 0);
+
+    batch.ibo = CreateBuffer(
+        GL_ARRAY_BUFFER,
+        sizeof(Mesh::Instance),
+        GL_DYNAMIC_DRAW);
+
+    /*
+     * Create vertex array object and specify the vertex attributes and the
+     * instance attributes.
+     */
+    batch.vao = CreateVertexArray();
+    BindVertexArray(batch.vao);
+    BindBuffer(GL_ARRAY_BUFFER, batch.vbo);
+    BindBuffer(GL_ELEMENT_ARRAY_BUFFER, batch.ebo);
+    Mesh::VertexAttributes(program, name);
+
+    std::string transform_name = name + "_instance_transform";
+    std::string color_name = name + "_instance_color";
+    batch.transform_location = glGetAttribLocation(
+        program, transform_name.c_str());
+    batch.color_location = glGetAttribLocation(
+        program, color_name.c_str());
+    BindBuffer(GL_ARRAY_BUFFER, batch.ibo);
+    Mesh::InstanceAttributes(batch.transform_location, batch.color_location, 0);
+
+    /*
+     * Unbind vertex array object and create the draw indirect buffer.
+     */
+    BindVertexArray(0);
+    BindBuffer(GL_ARRAY_BUFFER, 0);
+
+    batch.dbo = 0;
+    if (batch.is_indirect) {
+        batch.dbo = CreateBuffer(
+            GL_DRAW_INDIRECT_BUFFER,
+            batch.commands.size() * sizeof(Command),
+            GL_DYNAMIC_DRAW);
+    }
+
+    return batch;
+}
+
+/**
+ * @brief Destroy the batch buffer objects.
+ */
+void MeshBatch::Destroy(MeshBatch &batch)
+{
+    if (batch.dbo != 0) {
+        DestroyBuffer(batch.dbo);
+    }
+    DestroyBuffer(batch.ibo);
+    DestroyBuffer(batch.ebo);
+    DestroyBuffer(batch.vbo);
+    DestroyVertexArray(batch.vao);
+    batch.commands.clear();
+}
+
+/** ---------------------------------------------------------------------------
+ * @brief Set the instances of each mesh in the batch, packed in mesh order
+ * in the instance buffer, and update the draw commands.
+ */
+void MeshBatch::SetInstances(
+    MeshBatch &batch,
+    const std::vector<std::vector<Mesh::Instance>> &instances)
+{
+    ito_assert(instances.size() == batch.commands.size(),
+        "invalid number of mesh instance lists");
+
+    size_t n_instances = 0;
+    for (size_t i = 0; i < batch.commands.size(); ++i) {
+        batch.commands[i].instance_count = instances[i].size();
+        batch.commands[i].base_instance = n_instances;
+        n_instances += instances[i].size();
+    }
+
+    /* Reallocate the instance data store and copy each instance list. */
+    BindBuffer(GL_ARRAY_BUFFER, batch.ibo);
+    glBufferData(
+        GL_ARRAY_BUFFER,
+        std::max(n_instances, (size_t) 1) * sizeof(Mesh::Instance),
+        NULL,
+        GL_DYNAMIC_DRAW);
+    for (size_t i = 0; i < batch.commands.size(); ++i) {
+        if (instances[i].empty()) {
+            continue;
+        }
+        glBufferSubData(
+            GL_ARRAY_BUFFER,
+            batch.commands[i].base_instance * sizeof(Mesh::Instance),
+            instances[i].size() * sizeof(Mesh::Instance),
+            instances[i].data());
+    }
+
+    /* Upload the draw commands. */
+    if (batch.is_indirect) {
+        BindBuffer(GL_DRAW_INDIRECT_BUFFER, batch.dbo);
+        glBufferData(
+            GL_DRAW_INDIRECT_BUFFER,
+            batch.commands.size() * sizeof(Command),
+            batch.commands.data(),
+            GL_DYNAMIC_DRAW);
+    }
+}
+
+/**
+ * @brief Render the instances of all meshes in the batch.
+ */
+void MeshBatch::Render(const MeshBatch &batch)
+{
+    BindVertexArray(batch.vao);
+
+#if defined(GL_VERSION_4_3) || defined(GL_ARB_multi_draw_indirect)
+    if (batch.is_indirect) {
+        BindBuffer(GL_DRAW_INDIRECT_BUFFER, batch.dbo);
+        glMultiDrawElementsIndirect(
+            GL_TRIANGLES,           /* what kind of primitives to render */
+            GL_UNSIGNED_INT,        /* type of the values in indices */
+            (GLvoid *) 0,           /* offset of the first draw command */
+            batch.commands.size(),  /* number of draw commands */
+            0);                     /* tightly packed commands */
+        return;
+    }
+#endif
+
+    /* Point the instance attributes to the first instance of each command. */
+    BindBuffer(GL_ARRAY_BUFFER, batch.ibo);
+    for (auto &command : batch.commands) {
+        if (command.instance_count == 0) {
+            continue;
+        }
+        Mesh::InstanceAttributes(
+            batch.transform_location,
+            batch.color_location,
+            command.base_instance * sizeof(Mesh::Instance));
+        glDrawElementsInstancedBaseVertex(
+            GL_TRIANGLES,
+            command.count,
+            GL_UNSIGNED_INT,
+            (GLvoid *) (command.first_index * sizeof(GLuint)),
+            command.instance_count,
+            command.base_vertex);
+    }
+}
+
+/**
+ * @brief Is multi draw indirect supported by the current context? The draw
+ * commands use a non-zero baseInstance, which requires OpenGL 4.2 or the
+ * ARB_base_instance extension. Otherwise, the batch falls back to one draw
+ * call per command.
+ */
+bool MeshBatch::IsIndirectSupported(void)
+{
+#if defined(GL_VERSION_4_3)
+    if (GLAD_GL_VERSION_4_3) {
+        return true;
+    }
+#endif
+    bool has_base_instance = false;
+#if defined(GL_VERSION_4_2)
+    has_base_instance = has_base_instance || GLAD_GL_VERSION_4_2;
+#endif
+#if defined(GL_ARB_base_instance)
+    has_base_instance = has_base_instance || GLAD_GL_ARB_base_instance;
+#endif
+#if defined(GL_ARB_multi_draw_indirect)
+    if (GLAD_GL_ARB_multi_draw_indirect && has_base_instance) {
+        return true;
+    }
+#endif
+    return false;
+}
+
+} /* gl */
+} /* ito */
@@ -0,0 +1,84 @@
+/*
+ * meshbatch.hpp
+ *
+ * Copyright (c) 2020 Carlos Braga
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the MIT License.
+ *
+ * See accompanying LICENSE.md or https://opensource.org/licenses/MIT.
+ */
+
+#ifndef ITO_OPENGL_MESHBATCH_H_
+#define ITO_OPENGL_MESHBATCH_H_
+
+#include <string>
+#include <vector>
+#include "base.hpp"
+#include "mesh.hpp"
+
+namespace ito {
+namespace gl {
+
+/**
+ * @brief MeshBatch merges the geometry of a collection of meshes into a single
+ * vertex buffer and a single element buffer, and draws the instances of all
+ * meshes with a single glMultiDrawElementsIndirect call.
+ *
+ * Each mesh in the batch has a draw command in a GL_DRAW_INDIRECT_BUFFER
+ * with the range of its indices in the element buffer, the offset of its
+ * vertices in the vertex buffer, and the range of its instances in the
+ * instance buffer. The instances of all meshes share the instance buffer
+ * and are packed in mesh order.
+ *
+ * Without GL 4.3 or ARB_multi_draw_indirect, the batch draws each command
+ * with glDrawElementsInstancedBaseVertex, pointing the instance attributes to
+ * the first instance of the command.
+ *
+ * The shader program object uses the mesh vertex and instance attributes,
+ * prefixed by the batch name.
+ */
+struct MeshBatch {
+    /** Draw command layout of glMultiDrawElementsIndirect. */
+    struct Command {
+        GLuint count;                   /* number of indices */
+        GLuint instance_count;          /* number of instances */
+        GLuint first_index;             /* first index in the element buffer */
+        GLint base_vertex;              /* first vertex in the vertex buffer */
+        GLuint base_instance;           /* first instance in instance buffer */
+    };
+
+    std::string name;                   /* batch name */
+    std::vector<Command> commands;      /* draw command of each mesh */
+    GLuint vao;                         /* vertex array object */
+    GLuint vbo;                         /* merged vertex buffer object */
+    GLuint ebo;                         /* merged element buffer object */
+    GLuint ibo;                         /* instance buffer object */
+    GLuint dbo;                         /* draw indirect buffer object */
+    GLint transform_location;           /* instance transform attribute */
+    GLint color_location;               /* instance color attribute */
+    bool is_indirect;                   /* multi draw indirect is supported */
+
+    /* Mesh batch factory functions */
+    static MeshBatch Create(
+        const GLuint &program,
+        const std::string &name,
+        const std::vector<Mesh> &meshes);
+    static void Destroy(MeshBatch &batch);
+
+    /** Set the instances of each mesh in the batch. */
+    static void SetInstances(
+        MeshBatch &batch,
+        const std::vector<std::vector<Mesh::Instance>> &instances);
+
+    /** Render the instances of all meshes in the batch. */
+    static void Render(const MeshBatch &batch);
+
+    /** Is multi draw indirect supported by the current context? */
+    static bool IsIndirectSupported(void);
+};
+
+} /* gl */
+} /* ito */
+
+#endif /* ITO_OPENGL_MESHBATCH_H_ */
@@ -0,0 +1,215 @@
+/*
+ * meshlod.cpp
+ *
+ * Copyright (c) 2020 Carlos Braga
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the MIT License.
+ *
+ * See accompanying LICENSE.md or https://opensource.org/licenses/MIT.
+ */
+
+#include <algorithm>
+#include <cmath>
+#include <sstream>
+#include "meshoptimizer.hpp"
+#include "state.hpp"
+#include "meshlod.hpp"
+
+namespace ito {
+namespace gl {
+
+/** ---------------------------------------------------------------------------
+ * @brief Create a chain of at most n_levels levels of detail of the mesh
+ * data, each with a fraction reduction of the faces of the previous level.
+ * The chain stops early when a level can no longer be simplified.
+ */
+MeshLod MeshLod::Create(
+    const GLuint &program,
+    const std::string &name,
+    const std::vector<Mesh::Vertex> &vertices,
+    const std::vector<Mesh::Face> &faces,
+    const size_t n_levels,
+    const GLfloat reduction)
+{
+    ito_assert(!vertices.empty() && !faces.empty(), "invalid mesh data");
+    ito_assert(n_levels > 0, "invalid number of levels");
+    ito_assert(reduction > 0.0f && reduction < 1.0f, "invalid reduction");
+
+    /*
+     * Simplify the faces to the target of each coarser level in a single
+     * progressive pass.
+     */
+    std::vector<size_t> targets;
+    GLfloat target = (GLfloat) faces.size();
+    for (size_t i = 1; i < n_levels; ++i) {
+        target *= reduction;
+        targets.push_back(std::max<size_t>(1, (size_t) target));
+    }
+    std::vector<float> errors;
+    std::vector<std::vector<Mesh::Face>> simplified =
+        MeshOptimizer::Simplify(vertices, faces, targets, &errors);
+
+    /*
+     * Keep the levels that reduce the faces of the previous level, each
+     * reordered for the vertex cache, in a single face list.
+     */
+    MeshLod lod;
+    std::vector<Mesh::Face> lod_faces(faces);
+    MeshOptimizer::OptimizeVertexCache(lod_faces, vertices.size());
+    lod.levels.push_back({0, (GLsizei) lod_faces.size(), 0.0f});
+
+    for (size_t i = 0; i < simplified.size(); ++i) {
+        std::vector<Mesh::Face> &level_faces = simplified[i];
+        if (level_faces.empty() ||
+            level_faces.size() >= (size_t) lod.levels.back().count) {
+            break;
+        }
+        MeshOptimizer::OptimizeVertexCache(level_faces, vertices.size());
+
+        Level level;
+        level.first = lod_faces.size();
+        level.count = level_faces.size();
+        level.error = std::max(errors[i], lod.levels.back().error);
+        lod.levels.push_back(level);
+        lod_faces.insert(
+            lod_faces.end(), level_faces.begin(), level_faces.end());
+    }
+
+    /*
+     * Reorder the shared vertices by first reference, from the finest level,
+     * and create a gpu only mesh with the faces of all levels in its element
+     * buffer.
+     */
+    std::vector<Mesh::Vertex> lod_vertices(vertices);
+    MeshOptimizer::OptimizeVertexFetch(lod_vertices, lod_faces);
+    lod.mesh = Mesh::Create(
+        program, name, Mesh::View::Make(lod_vertices, lod_faces));
+
+    /*
+     * Compute the bounding sphere about the center of the bounding box.
+     */
+    math::vec3f lo{
+        lod_vertices[0].position[0],
+        lod_vertices[0].position[1],
+        lod_vertices[0].position[2]};
+    math::vec3f hi = lo;
+    for (auto &vertex : lod_vertices) {
+        math::vec3f p{vertex.position[0], vertex.position[1], vertex.position[2]};
+        lo = math::vec3f{
+            std::min(lo.x, p.x), std::min(lo.y, p.y), std::min(lo.z, p.z)};
+        hi = math::vec3f{
+            std::max(hi.x, p.x), std::max(hi.y, p.y), std::max(hi.z, p.z)};
+    }
+    lod.center = (lo + hi) * 0.5f;
+    lod.radius = 0.0f;
+    for (auto &vertex : lod_vertices) {
+        math::vec3f p{vertex.position[0], vertex.position[1], vertex.position[2]};
+        lod.radius = std::max(lod.radius, math::norm(p - lod.center));
+    }
+
+    return lod;
+}
+
+/**
+ * @brief Destroy the mesh objects of the levels of detail.
+ */
+void MeshLod::Destroy(MeshLod &lod)
+{
+    Mesh::Destroy(lod.mesh);
+    lod.levels.clear();
+}
+
+/** ---------------------------------------------------------------------------
+ * @brief Return a string with the levels of detail information.
+ */
+std::string MeshLod::InfoString(const MeshLod &lod, const char *comment)
+{
+    std::ostringstream ss;
+    if (comment != nullptr) {
+        ss << ito::str::format("%s\n", comment);
+    }
+    ss << ito::str::format(
+        "vertices: %d\n"
+        "radius:   %f\n",
+        lod.mesh.n_vertices,
+        lod.radius);
+    for (size_t i = 0; i < lod.levels.size(); ++i) {
+        ss << ito::str::format(
+            "level %zu:  faces %d, error %g\n",
+            i,
+            lod.levels[i].count,
+            lod.levels[i].error);
+    }
+    return ss.str();
+}
+
+/** ---------------------------------------------------------------------------
+ * @brief Return the coarsest level with a projected error below threshold
+ * pixels in a viewport with the given height.
+ *
+ * The number of pixels per unit length is measured at the near side of the
+ * bounding sphere, from the clip w coordinate of its center and the vertical
+ * scale of the projection matrix - 1/tan(fovy/2) in a perspective, with w the
+ * distance to the eye, or 2/(top - bottom) in an orthographic projection,
+ * with w equal to one. The model space error is scaled by the largest scale
+ * factor of the model matrix. If the eye is inside the bounding sphere, the
+ * finest level is selected.
+ */
+size_t MeshLod::Select(
+    const MeshLod &lod,
+    const math::mat4f &model,
+    const math::mat4f &view,
+    const math::mat4f &proj,
+    const GLfloat viewport_height,
+    const GLfloat threshold)
+{
+    /* Transform the bounding sphere into view space. */
+    math::vec4f center = math::dot(
+        math::dot(view, model),
+        math::vec4f{lod.center.x, lod.center.y, lod.center.z, 1.0f});
+    GLfloat scale = std::max({
+        math::norm(math::vec3f{model.xx, model.yx, model.zx}),
+        math::norm(math::vec3f{model.xy, model.yy, model.zy}),
+        math::norm(math::vec3f{model.xz, model.yz, model.zz})});
+    GLfloat radius = lod.radius * scale;
+
+    /* Clip w coordinate of the near side of the bounding sphere. */
+    GLfloat w = proj.wx * center.x +
+                proj.wy * center.y +
+                proj.wz * center.z +
+                proj.ww * center.w;
+    if (proj.ww == 0.0f) {
+        w -= radius;
+    }
+    if (w <= 0.0f) {
+        return 0;
+    }
+
+    /* Select the coarsest level with projected error below threshold. */
+    GLfloat pixels = std::fabs(proj.yy) * 0.5f * viewport_height / w;
+    size_t level = 0;
+    while (level + 1 < lod.levels.size() &&
+           lod.levels[level + 1].error * scale * pixels <= threshold) {
+        level++;
+    }
+    return level;
+}
+
+/** ---------------------------------------------------------------------------
+ * @brief Render the level of detail from its range in the element buffer.
+ */
+void MeshLod::Render(const MeshLod &lod, const size_t level)
+{
+    ito_assert(level < lod.levels.size(), "invalid level of detail");
+    const Level &range = lod.levels[level];
+    BindVertexArray(lod.mesh.vao);
+    glDrawElements(
+        GL_TRIANGLES,           /* what kind of primitives to render */
+        3 * range.count,        /* number of elements to be rendered */
+        GL_UNSIGNED_INT,        /* type of the values in indices */
+        (GLvoid *) (range.first * sizeof(Mesh::Face)));
+}
+
+} /* gl */
+} /* ito */
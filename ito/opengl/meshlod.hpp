@@ -0,0 +1,85 @@
+/*
+ * meshlod.hpp
+ *
+ * Copyright (c) 2020 Carlos Braga
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the MIT License.
+ *
+ * See accompanying LICENSE.md or https://opensource.org/licenses/MIT.
+ */
+
+#ifndef ITO_OPENGL_MESHLOD_H_
+#define ITO_OPENGL_MESHLOD_H_
+
+#include <string>
+#include <vector>
+#include "base.hpp"
+#include "mesh.hpp"
+
+namespace ito {
+namespace gl {
+
+/**
+ * @brief MeshLod maintains a chain of levels of detail of a mesh, from the
+ * full resolution level 0 to the coarsest level.
+ *
+ * The levels are generated with MeshOptimizer::Simplify, each with a fraction
+ * reduction of the faces of the previous level, and reordered for the vertex
+ * cache. The edge collapses keep the vertex array, so all levels share the
+ * vertex buffer, and their faces are stored contiguously in a single element
+ * buffer. Each level is a range of faces in the element buffer.
+ *
+ * Select chooses the coarsest level whose geometric error, projected on the
+ * screen at the near side of the bounding sphere of the mesh, is below a
+ * threshold in pixels. The projection uses the model, view and projection
+ * matrices, e.g. lookat and perspective, and the viewport height.
+ */
+struct MeshLod {
+    /** Level of detail in the element buffer. */
+    struct Level {
+        GLsizei first;                  /* first face in the element buffer */
+        GLsizei count;                  /* number of faces */
+        GLfloat error;                  /* geometric error in model space */
+    };
+
+    Mesh mesh;                          /* shared vertex and element buffers */
+    std::vector<Level> levels;          /* levels of detail, finest first */
+    math::vec3f center;                 /* bounding sphere center */
+    GLfloat radius;                     /* bounding sphere radius */
+
+    /* Mesh lod factory functions */
+    static MeshLod Create(
+        const GLuint &program,
+        const std::string &name,
+        const std::vector<Mesh::Vertex> &vertices,
+        const std::vector<Mesh::Face> &faces,
+        const size_t n_levels = 4,
+        const GLfloat reduction = 0.5f);
+    static void Destroy(MeshLod &lod);
+
+    /** Return a string with the levels of detail information. */
+    static std::string InfoString(
+        const MeshLod &lod,
+        const char *comment = nullptr);
+
+    /**
+     * @brief Return the coarsest level with a projected error below threshold
+     * pixels in a viewport with the given height.
+     */
+    static size_t Select(
+        const MeshLod &lod,
+        const math::mat4f &model,
+        const math::mat4f &view,
+        const math::mat4f &proj,
+        const GLfloat viewport_height,
+        const GLfloat threshold = 1.0f);
+
+    /** Render the level of detail. */
+    static void Render(const MeshLod &lod, const size_t level);
+};
+
+} /* gl */
+} /* ito */
+
+#endif /* ITO_OPENGL_MESHLOD_H_ */
@@ -0,0 +1,788 @@
+/*
+ * meshoptimizer.cpp
+ *
+ * Copyright (c) 2020 Carlos Braga
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the MIT License.
+ *
+ * See accompanying LICENSE.md or https://opensource.org/licenses/MIT.
+ */
+
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+#include <numeric>
+#include <queue>
+#include <sstream>
+#include <unordered_map>
+#include "meshoptimizer.hpp"
+
+namespace ito {
+namespace gl {
+
+/** ---------------------------------------------------------------------------
+ * @brief Simulate a FIFO vertex cache of the given size rendering the faces.
+ * A vertex is in the cache if it was transformed less than cache_size misses
+ * ago.
+ */
+MeshOptimizer::Stats MeshOptimizer::CacheStats(
+    const std::vector<Mesh::Face> &faces,
+    const size_t n_vertices,
+    const size_t cache_size)
+{
+    std::vector<size_t> timestamps(n_vertices, 0);
+    std::vector<bool> is_referenced(n_vertices, false);
+
+    Stats stats = {};
+    stats.n_faces = faces.size();
+    size_t time = cache_size + 1;
+    for (auto &face : faces) {
+        for (auto &v : face.index) {
+            ito_assert(v < n_vertices, "invalid vertex index");
+            if (time - timestamps[v] > cache_size) {
+                timestamps[v] = time++;
+                stats.n_transformed++;
+            }
+            if (!is_referenced[v]) {
+                is_referenced[v] = true;
+                stats.n_vertices++;
+            }
+        }
+    }
+
+    stats.acmr = stats.n_faces > 0
+        ? (double) stats.n_transformed / stats.n_faces
+        : 0.0;
+    stats.atvr = stats.n_vertices > 0
+        ? (double) stats.n_transformed / stats.n_vertices
+        : 0.0;
+    return stats;
+}
+
+/**
+ * @brief Return a string with the cache statistics.
+ */
+std::string MeshOptimizer::InfoString(const Stats &stats, const char *comment)
+{
+    std::ostringstream ss;
+    if (comment != nullptr) {
+        ss << ito::str::format("%s\n", comment);
+    }
+    ss << ito::str::format(
+        "faces:       %zu\n"
+        "vertices:    %zu\n"
+        "transformed: %zu\n"
+        "acmr:        %.4f\n"
+        "atvr:        %.4f\n",
+        stats.n_faces,
+        stats.n_vertices,
+        stats.n_transformed,
+        stats.acmr,
+        stats.atvr);
+    return ss.str();
+}
+
+/** ---------------------------------------------------------------------------
+ * @brief Merge the vertices with identical attributes, compared bitwise, and
+ * remove the faces with repeated vertices. Return the number of vertices
+ * removed.
+ */
+size_t MeshOptimizer::WeldVertices(
+    std::vector<Mesh::Vertex> &vertices,
+    std::vector<Mesh::Face> &faces)
+{
+    /* FNV-1a hash of the vertex bytes. */
+    auto hash = [] (const Mesh::Vertex &vertex) -> uint64_t {
+        const uint8_t *bytes = reinterpret_cast<const uint8_t *>(&vertex);
+        uint64_t h = 14695981039346656037ull;
+        for (size_t i = 0; i < sizeof(Mesh::Vertex); ++i) {
+            h = (h ^ bytes[i]) * 1099511628211ull;
+        }
+        return h;
+    };
+
+    /* Map each vertex to the first vertex with identical attributes. */
+    std::unordered_multimap<uint64_t, GLuint> table;
+    table.reserve(vertices.size());
+    std::vector<GLuint> remap(vertices.size());
+    std::vector<Mesh::Vertex> welded;
+    welded.reserve(vertices.size());
+    for (size_t i = 0; i < vertices.size(); ++i) {
+        uint64_t key = hash(vertices[i]);
+        auto range = table.equal_range(key);
+        auto it = std::find_if(range.first, range.second,
+            [&] (const std::pair<const uint64_t, GLuint> &entry) {
+                return std::memcmp(
+                    &welded[entry.second],
+                    &vertices[i],
+                    sizeof(Mesh::Vertex)) == 0;
+            });
+
+        if (it != range.second) {
+            remap[i] = it->second;
+        } else {
+            remap[i] = welded.size();
+            table.emplace(key, remap[i]);
+            welded.push_back(vertices[i]);
+        }
+    }
+
+    /* Remap the faces and remove the degenerate ones. */
+    std::vector<Mesh::Face> remapped;
+    remapped.reserve(faces.size());
+    for (auto &face : faces) {
+        GLuint a = remap[face.index[0]];
+        GLuint b = remap[face.index[1]];
+        GLuint c = remap[face.index[2]];
+        if (a != b && b != c && c != a) {
+            remapped.push_back({a, b, c});
+        }
+    }
+
+    size_t n_removed = vertices.size() - welded.size();
+    vertices.swap(welded);
+    faces.swap(remapped);
+    return n_removed;
+}
+
+/** ---------------------------------------------------------------------------
+ * @brief Reorder the faces with the Tipsify algorithm.
+ *
+ * Starting from a fanning vertex, all its remaining faces are emitted. The
+ * next fanning vertex is the one among the vertices of the emitted faces that
+ * is still in the cache after its remaining faces are emitted, and the oldest
+ * in the cache. When none remains, the ordering restarts from the most recent
+ * vertex with remaining faces in the dead-end stack, or the next vertex in
+ * index order, starting a new cluster.
+ */
+void MeshOptimizer::OptimizeVertexCache(
+    std::vector<Mesh::Face> &faces,
+    const size_t n_vertices,
+    const size_t cache_size,
+    std::vector<size_t> *clusters)
+{
+    /* Vertex-face adjacency in compressed row storage. */
+    std::vector<size_t> live(n_vertices, 0);
+    for (auto &face : faces) {
+        for (auto &v : face.index) {
+            ito_assert(v < n_vertices, "invalid vertex index");
+            live[v]++;
+        }
+    }
+    std::vector<size_t> offsets(n_vertices + 1, 0);
+    std::partial_sum(live.begin(), live.end(), offsets.begin() + 1);
+    std::vector<size_t> adjacency(offsets.back());
+    {
+        std::vector<size_t> cursor(offsets.begin(), offsets.end() - 1);
+        for (size_t f = 0; f < faces.size(); ++f) {
+            for (auto &v : faces[f].index) {
+                adjacency[cursor[v]++] = f;
+            }
+        }
+    }
+
+    /* Emit the faces fanning around each vertex. */
+    std::vector<size_t> timestamps(n_vertices, 0);
+    std::vector<bool> is_emitted(faces.size(), false);
+    std::vector<GLuint> dead_end;
+    std::vector<GLuint> candidates;
+    std::vector<Mesh::Face> ordered;
+    ordered.reserve(faces.size());
+    if (clusters != nullptr) {
+        clusters->clear();
+        clusters->push_back(0);
+    }
+
+    size_t time = cache_size + 1;
+    size_t cursor = 0;
+    int64_t fanning = n_vertices > 0 ? 0 : -1;
+    while (fanning >= 0) {
+        candidates.clear();
+        for (size_t k = offsets[fanning]; k < offsets[fanning + 1]; ++k) {
+            size_t f = adjacency[k];
+            if (is_emitted[f]) {
+                continue;
+            }
+            for (auto &v : faces[f].index) {
+                dead_end.push_back(v);
+                candidates.push_back(v);
+                live[v]--;
+                if (time - timestamps[v] > cache_size) {
+                    timestamps[v] = time++;
+                }
+            }
+            is_emitted[f] = true;
+            ordered.push_back(faces[f]);
+        }
+
+        /* Pick the candidate in the cache after fanning, oldest first. */
+        fanning = -1;
+        int64_t best = -1;
+        for (auto &v : candidates) {
+            if (live[v] == 0) {
+                continue;
+            }
+            int64_t priority = 0;
+            if (time - timestamps[v] + 2 * live[v] <= cache_size) {
+                priority = time - timestamps[v];
+            }
+            if (priority > best) {
+                best = priority;
+                fanning = v;
+            }
+        }
+
+        /* Skip the dead-end, restarting a new cluster. */
+        if (fanning < 0) {
+            while (!dead_end.empty() && fanning < 0) {
+                GLuint v = dead_end.back();
+                dead_end.pop_back();
+                if (live[v] > 0) {
+                    fanning = v;
+                }
+            }
+            while (cursor < n_vertices && fanning < 0) {
+                if (live[cursor] > 0) {
+                    fanning = cursor;
+                }
+                cursor++;
+            }
+            if (fanning >= 0 && clusters != nullptr &&
+                clusters->back() != ordered.size()) {
+                clusters->push_back(ordered.size());
+            }
+        }
+    }
+
+    faces.swap(ordered);
+}
+
+/** ---------------------------------------------------------------------------
+ * @brief Reorder the faces to reduce overdraw.
+ *
+ * The faces are first ordered for the vertex cache. Each cluster of the cache
+ * ordering is split further where the cache miss ratio of the faces since
+ * the last split is within threshold of the cluster miss ratio. The clusters
+ * are then sorted by the distance of their centroid to the mesh centroid
+ * along their normal, so clusters on the outside of the mesh facing outwards,
+ * the most likely occluders, are rendered first.
+ */
+static size_t CountMisses(
+    const std::vector<Mesh::Face> &faces,
+    const size_t begin,
+    const size_t end,
+    const size_t cache_size,
+    std::vector<size_t> &timestamps,
+    size_t &time)
+{
+    size_t n_misses = 0;
+    for (size_t f = begin; f < end; ++f) {
+        for (auto &v : faces[f].index) {
+            if (time - timestamps[v] > cache_size) {
+                timestamps[v] = time++;
+                n_misses++;
+            }
+        }
+    }
+    return n_misses;
+}
+
+void MeshOptimizer::OptimizeOverdraw(
+    const std::vector<Mesh::Vertex> &vertices,
+    std::vector<Mesh::Face> &faces,
+    const size_t cache_size,
+    const float threshold)
+{
+    if (faces.empty()) {
+        return;
+    }
+
+    std::vector<size_t> hard;
+    OptimizeVertexCache(faces, vertices.size(), cache_size, &hard);
+    hard.push_back(faces.size());
+
+    /* Split the hard clusters at soft boundaries. */
+    std::vector<size_t> timestamps(vertices.size(), 0);
+    size_t time = cache_size + 1;
+    std::vector<size_t> soft;
+    for (size_t c = 0; c + 1 < hard.size(); ++c) {
+        size_t begin = hard[c];
+        size_t end = hard[c + 1];
+
+        time += cache_size + 1;
+        double cluster_acmr = (double) CountMisses(
+            faces, begin, end, cache_size, timestamps, time) / (end - begin);
+
+        time += cache_size + 1;
+        size_t start = begin;
+        size_t n_misses = 0;
+        soft.push_back(begin);
+        for (size_t f = begin; f < end; ++f) {
+            n_misses += CountMisses(
+                faces, f, f + 1, cache_size, timestamps, time);
+            double acmr = (double) n_misses / (f + 1 - start);
+            if (f + 1 < end && acmr <= threshold * cluster_acmr) {
+                soft.push_back(f + 1);
+                start = f + 1;
+                n_misses = 0;
+                time += cache_size + 1;
+            }
+        }
+    }
+    soft.push_back(faces.size());
+
+    /* Mesh centroid, weighted by face area. */
+    auto position = [&vertices] (const GLuint v) -> math::vec3f {
+        const GLfloat *p = vertices[v].position;
+        return math::vec3f{p[0], p[1], p[2]};
+    };
+
+    math::vec3f mesh_centroid = {0.0f, 0.0f, 0.0f};
+    float mesh_area = 0.0f;
+    for (auto &face : faces) {
+        math::vec3f p0 = position(face.index[0]);
+        math::vec3f p1 = position(face.index[1]);
+        math::vec3f p2 = position(face.index[2]);
+        float area = math::norm(math::cross(p1 - p0, p2 - p0));
+        mesh_centroid += (p0 + p1 + p2) * (area / 3.0f);
+        mesh_area += area;
+    }
+    if (mesh_area > 0.0f) {
+        mesh_centroid /= mesh_area;
+    }
+
+    /* Sort the clusters by their centroid distance along their normal. */
+    size_t n_clusters = soft.size() - 1;
+    std::vector<float> sort_keys(n_clusters);
+    for (size_t c = 0; c < n_clusters; ++c) {
+        math::vec3f centroid = {0.0f, 0.0f, 0.0f};
+        math::vec3f normal = {0.0f, 0.0f, 0.0f};
+        float area = 0.0f;
+        for (size_t f = soft[c]; f < soft[c + 1]; ++f) {
+            math::vec3f p0 = position(faces[f].index[0]);
+            math::vec3f p1 = position(faces[f].index[1]);
+            math::vec3f p2 = position(faces[f].index[2]);
+            math::vec3f n = math::cross(p1 - p0, p2 - p0);
+            float a = math::norm(n);
+            centroid += (p0 + p1 + p2) * (a / 3.0f);
+            normal += n;
+            area += a;
+        }
+        if (area > 0.0f) {
+            centroid /= area;
+        }
+        float length = math::norm(normal);
+        sort_keys[c] = (length > 0.0f)
+            ? math::dot(centroid - mesh_centroid, normal) / length
+            : 0.0f;
+    }
+
+    std::vector<size_t> order(n_clusters);
+    std::iota(order.begin(), order.end(), 0);
+    std::stable_sort(order.begin(), order.end(),
+        [&sort_keys] (const size_t a, const size_t b) {
+            return sort_keys[a] > sort_keys[b];
+        });
+
+    std::vector<Mesh::Face> ordered;
+    ordered.reserve(faces.size());
+    for (auto &c : order) {
+        ordered.insert(
+            ordered.end(),
+            faces.begin() + soft[c],
+            faces.begin() + soft[c + 1]);
+    }
+    faces.swap(ordered);
+}
+
+/** ---------------------------------------------------------------------------
+ * @brief Reorder the vertices in the order they are first referenced by the
+ * faces, so the vertex fetches walk the vertex buffer sequentially, and remap
+ * the face indices. Unreferenced vertices are removed.
+ */
+void MeshOptimizer::OptimizeVertexFetch(
+    std::vector<Mesh::Vertex> &vertices,
+    std::vector<Mesh::Face> &faces)
+{
+    const GLuint kUnused = ~0u;
+    std::vector<GLuint> remap(vertices.size(), kUnused);
+    std::vector<Mesh::Vertex> ordered;
+    ordered.reserve(vertices.size());
+    for (auto &face : faces) {
+        for (auto &v : face.index) {
+            ito_assert(v < vertices.size(), "invalid vertex index");
+            if (remap[v] == kUnused) {
+                remap[v] = ordered.size();
+                ordered.push_back(vertices[v]);
+            }
+            v = remap[v];
+        }
+    }
+    vertices.swap(ordered);
+}
+
+/** ---------------------------------------------------------------------------
+ * @brief Symmetric 4x4 quadric error matrix, the sum of the squared distances
+ * to a set of planes, stored as its upper triangle.
+ */
+struct Quadric {
+    double a[10];
+    double n_planes;
+
+    /** Add the quadric of the plane dot(n,p) + d = 0, with unit normal n. */
+    void AddPlane(const double n[3], const double d) {
+        a[0] += n[0] * n[0]; a[1] += n[0] * n[1]; a[2] += n[0] * n[2];
+        a[3] += n[0] * d;    a[4] += n[1] * n[1]; a[5] += n[1] * n[2];
+        a[6] += n[1] * d;    a[7] += n[2] * n[2]; a[8] += n[2] * d;
+        a[9] += d * d;
+        n_planes += 1.0;
+    }
+
+    /** Add a quadric. */
+    void Add(const Quadric &q) {
+        for (size_t i = 0; i < 10; ++i) {
+            a[i] += q.a[i];
+        }
+        n_planes += q.n_planes;
+    }
+
+    /** Return the quadric error at point p. */
+    double Eval(const GLfloat p[3]) const {
+        double x = p[0], y = p[1], z = p[2];
+        return x * (a[0] * x + 2.0 * (a[1] * y + a[2] * z + a[3])) +
+               y * (a[4] * y + 2.0 * (a[5] * z + a[6])) +
+               z * (a[7] * z + 2.0 * a[8]) +
+               a[9];
+    }
+};
+
+/**
+ * @brief Compute the unnormalized normal of the triangle (p0,p1,p2).
+ */
+static void FaceNormal(
+    const GLfloat *p0,
+    const GLfloat *p1,
+    const GLfloat *p2,
+    double n[3])
+{
+    double u[3] = {p1[0] - p0[0], p1[1] - p0[1], p1[2] - p0[2]};
+    double v[3] = {p2[0] - p0[0], p2[1] - p0[1], p2[2] - p0[2]};
+    n[0] = u[1] * v[2] - u[2] * v[1];
+    n[1] = u[2] * v[0] - u[0] * v[2];
+    n[2] = u[0] * v[1] - u[1] * v[0];
+}
+
+/**
+ * @brief Return the dot product of the face normal with the sum of the vertex
+ * normals of the face (i0,i1,i2), with vertex u moved onto vertex v. The
+ * result is negative if the face is flipped with respect to its shading
+ * normals, and zero if the vertices have no normals.
+ */
+static double FaceShading(
+    const std::vector<Mesh::Vertex> &vertices,
+    const GLuint index[3],
+    const GLuint u,
+    const GLuint v,
+    const double n[3])
+{
+    double shading = 0.0;
+    for (size_t k = 0; k < 3; ++k) {
+        const GLfloat *normal = vertices[index[k] == u ? v : index[k]].normal;
+        shading += n[0] * normal[0] + n[1] * normal[1] + n[2] * normal[2];
+    }
+    return shading;
+}
+
+/**
+ * @brief Simplify the faces by half-edge collapses in order of increasing
+ * quadric error.
+ *
+ * A collapse moves vertex u onto an adjacent vertex v, so the simplified
+ * faces index the original vertex array and all levels of detail share one
+ * vertex buffer. The vertex quadric is the sum of the plane quadrics of its
+ * faces, and the collapse cost is the error of the merged quadric at v.
+ *
+ * Vertices on boundary or non-manifold edges are never moved, keeping the
+ * mesh borders and the attribute seams, where vertices are split. A collapse
+ * is rejected if it flips a face, or turns a face against the vertex normals
+ * it is shaded with, or joins two vertices with more common neighbours than
+ * shared faces. Collapses are queued lazily, an entry being
+ * stale once either vertex has changed since it was queued.
+ *
+ * The geometric error is the largest root mean square distance of a collapsed
+ * vertex to the planes of its quadric.
+ *
+ * The collapses are progressive, each set of faces is a snapshot taken when
+ * its target is reached, so a chain of levels is computed in a single pass.
+ */
+std::vector<std::vector<Mesh::Face>> MeshOptimizer::Simplify(
+    const std::vector<Mesh::Vertex> &vertices,
+    const std::vector<Mesh::Face> &faces,
+    const std::vector<size_t> &targets,
+    std::vector<float> *errors)
+{
+    const size_t n_vertices = vertices.size();
+    std::vector<Mesh::Face> result(faces);
+    std::vector<bool> is_alive(faces.size(), true);
+    size_t n_alive = faces.size();
+
+    auto position = [&vertices] (const GLuint v) -> const GLfloat * {
+        return vertices[v].position;
+    };
+
+    /* Vertex face lists, boundary vertices and plane quadrics. */
+    std::vector<std::vector<size_t>> adjacency(n_vertices);
+    std::unordered_map<uint64_t, size_t> edges;
+    std::vector<Quadric> quadrics(n_vertices, Quadric{});
+    for (size_t f = 0; f < result.size(); ++f) {
+        const GLuint *index = result[f].index;
+        for (size_t k = 0; k < 3; ++k) {
+            ito_assert(index[k] < n_vertices, "invalid vertex index");
+            adjacency[index[k]].push_back(f);
+            uint64_t a = std::min(index[k], index[(k + 1) % 3]);
+            uint64_t b = std::max(index[k], index[(k + 1) % 3]);
+            edges[(a << 32) | b]++;
+        }
+
+        double n[3];
+        FaceNormal(position(index[0]), position(index[1]), position(index[2]), n);
+        double length = std::sqrt(n[0] * n[0] + n[1] * n[1] + n[2] * n[2]);
+        if (length > 0.0) {
+            n[0] /= length;
+            n[1] /= length;
+            n[2] /= length;
+            const GLfloat *p = position(index[0]);
+            double d = -(n[0] * p[0] + n[1] * p[1] + n[2] * p[2]);
+            for (size_t k = 0; k < 3; ++k) {
+                quadrics[index[k]].AddPlane(n, d);
+            }
+        }
+    }
+
+    std::vector<bool> is_locked(n_vertices, false);
+    for (auto &edge : edges) {
+        if (edge.second != 2) {
+            is_locked[edge.first >> 32] = true;
+            is_locked[edge.first & 0xffffffff] = true;
+        }
+    }
+
+    /* Collapse queue ordered by increasing cost. */
+    struct Collapse {
+        double cost;
+        double error;
+        GLuint u;
+        GLuint v;
+        uint32_t stamp_u;
+        uint32_t stamp_v;
+        bool operator<(const Collapse &other) const {
+            return cost > other.cost;
+        }
+    };
+    std::priority_queue<Collapse> queue;
+    std::vector<uint32_t> stamps(n_vertices, 0);
+    std::vector<bool> is_removed(n_vertices, false);
+
+    auto push = [&] (const GLuint u, const GLuint v) {
+        if (is_locked[u]) {
+            return;
+        }
+        Quadric q = quadrics[u];
+        q.Add(quadrics[v]);
+        double cost = std::max(q.Eval(position(v)), 0.0);
+        double error = q.n_planes > 0.0 ? std::sqrt(cost / q.n_planes) : 0.0;
+        queue.push({cost, error, u, v, stamps[u], stamps[v]});
+    };
+
+    /* Queue the collapses of the edges of v, in both directions. */
+    std::vector<GLuint> neighbours;
+    auto push_edges = [&] (const GLuint v) {
+        neighbours.clear();
+        for (auto &f : adjacency[v]) {
+            for (auto &w : result[f].index) {
+                if (w != v) {
+                    neighbours.push_back(w);
+                }
+            }
+        }
+        std::sort(neighbours.begin(), neighbours.end());
+        neighbours.erase(
+            std::unique(neighbours.begin(), neighbours.end()),
+            neighbours.end());
+        for (auto &w : neighbours) {
+            push(v, w);
+            push(w, v);
+        }
+    };
+
+    for (GLuint v = 0; v < n_vertices; ++v) {
+        push_edges(v);
+    }
+
+    /* Collapse edges until each target number of faces is reached. */
+    std::vector<std::vector<Mesh::Face>> levels;
+    if (errors != nullptr) {
+        errors->clear();
+    }
+    double max_error = 0.0;
+    std::vector<GLuint> neighbours_u, neighbours_v;
+    for (auto &target : targets) {
+        while (n_alive > target && !queue.empty()) {
+            Collapse c = queue.top();
+            queue.pop();
+            if (is_removed[c.u] || is_removed[c.v] ||
+                stamps[c.u] != c.stamp_u || stamps[c.v] != c.stamp_v) {
+                continue;
+            }
+
+            /* Link condition and face flip test. */
+            neighbours_u.clear();
+            neighbours_v.clear();
+            size_t n_shared = 0;
+            bool is_valid = true;
+            for (auto &f : adjacency[c.u]) {
+                if (!is_alive[f]) {
+                    continue;
+                }
+                const GLuint *index = result[f].index;
+                bool has_v = index[0] == c.v || index[1] == c.v || index[2] == c.v;
+                if (has_v) {
+                    n_shared++;
+                } else {
+                    double n0[3], n1[3];
+                    const GLfloat *p[3], *q[3];
+                    for (size_t k = 0; k < 3; ++k) {
+                        p[k] = position(index[k]);
+                        q[k] = (index[k] == c.u) ? position(c.v) : p[k];
+                    }
+                    FaceNormal(p[0], p[1], p[2], n0);
+                    FaceNormal(q[0], q[1], q[2], n1);
+                    if (n0[0] * n1[0] + n0[1] * n1[1] + n0[2] * n1[2] <= 0.0 ||
+                        FaceShading(vertices, index, c.u, c.v, n1) < 0.0) {
+                        is_valid = false;
+                        break;
+                    }
+                }
+                for (size_t k = 0; k < 3; ++k) {
+                    if (index[k] != c.u && index[k] != c.v) {
+                        neighbours_u.push_back(index[k]);
+                    }
+                }
+            }
+            if (!is_valid || n_shared == 0) {
+                continue;
+            }
+
+            for (auto &f : adjacency[c.v]) {
+                if (!is_alive[f]) {
+                    continue;
+                }
+                for (auto &w : result[f].index) {
+                    if (w != c.u && w != c.v) {
+                        neighbours_v.push_back(w);
+                    }
+                }
+            }
+            std::sort(neighbours_u.begin(), neighbours_u.end());
+            neighbours_u.erase(
+                std::unique(neighbours_u.begin(), neighbours_u.end()),
+                neighbours_u.end());
+            std::sort(neighbours_v.begin(), neighbours_v.end());
+            neighbours_v.erase(
+                std::unique(neighbours_v.begin(), neighbours_v.end()),
+                neighbours_v.end());
+
+            size_t n_common = 0;
+            for (auto &w : neighbours_u) {
+                n_common += std::binary_search(
+                    neighbours_v.begin(), neighbours_v.end(), w);
+            }
+            if (n_common > n_shared) {
+                continue;
+            }
+
+            /* Collapse u onto v. */
+            for (auto &f : adjacency[c.u]) {
+                if (!is_alive[f]) {
+                    continue;
+                }
+                GLuint *index = result[f].index;
+                if (index[0] == c.v || index[1] == c.v || index[2] == c.v) {
+                    is_alive[f] = false;
+                    n_alive--;
+                } else {
+                    for (size_t k = 0; k < 3; ++k) {
+                        if (index[k] == c.u) {
+                            index[k] = c.v;
+                        }
+                    }
+                    adjacency[c.v].push_back(f);
+                }
+            }
+            adjacency[c.u].clear();
+            adjacency[c.v].erase(
+                std::remove_if(
+                    adjacency[c.v].begin(),
+                    adjacency[c.v].end(),
+                    [&is_alive] (const size_t f) { return !is_alive[f]; }),
+                adjacency[c.v].end());
+            is_removed[c.u] = true;
+            quadrics[c.v].Add(quadrics[c.u]);
+            stamps[c.v]++;
+            max_error = std::max(max_error, c.error);
+
+            push_edges(c.v);
+        }
+
+        /* Snapshot the remaining faces in their original order. */
+        std::vector<Mesh::Face> simplified;
+        simplified.reserve(n_alive);
+        for (size_t f = 0; f < result.size(); ++f) {
+            if (is_alive[f]) {
+                simplified.push_back(result[f]);
+            }
+        }
+        levels.push_back(std::move(simplified));
+        if (errors != nullptr) {
+            errors->push_back((float) max_error);
+        }
+    }
+
+    return levels;
+}
+
+/**
+ * @brief Return the faces simplified to at most target_faces faces.
+ */
+std::vector<Mesh::Face> MeshOptimizer::Simplify(
+    const std::vector<Mesh::Vertex> &vertices,
+    const std::vector<Mesh::Face> &faces,
+    const size_t target_faces,
+    float *error)
+{
+    std::vector<float> errors;
+    std::vector<std::vector<Mesh::Face>> levels = Simplify(
+        vertices, faces, std::vector<size_t>{target_faces}, &errors);
+    if (error != nullptr) {
+        *error = errors[0];
+    }
+    return levels[0];
+}
+
+/** ---------------------------------------------------------------------------
+ * @brief Weld the vertices, reorder the faces for the vertex cache and
+ * overdraw, and reorder the vertices for fetch locality.
+ */
+void MeshOptimizer::Optimize(
+    std::vector<Mesh::Vertex> &vertices,
+    std::vector<Mesh::Face> &faces,
+    const size_t cache_size)
+{
+    WeldVertices(vertices, faces);
+    OptimizeOverdraw(vertices, faces, cache_size);
+    OptimizeVertexFetch(vertices, faces);
+}
+
+} /* gl */
+} /* ito */
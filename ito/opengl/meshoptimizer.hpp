@@ -0,0 +1,149 @@
+/*
+ * meshoptimizer.hpp
+ *
+ * Copyright (c) 2020 Carlos Braga
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the MIT License.
+ *
+ * See accompanying LICENSE.md or https://opensource.org/licenses/MIT.
+ */
+
+#ifndef ITO_OPENGL_MESHOPTIMIZER_H_
+#define ITO_OPENGL_MESHOPTIMIZER_H_
+
+#include <string>
+#include <vector>
+#include "base.hpp"
+#include "mesh.hpp"
+
+namespace ito {
+namespace gl {
+
+/**
+ * @brief MeshOptimizer reorders the vertex and face data of a mesh for the
+ * GPU vertex pipeline, before the mesh is created:
+ *
+ *  - WeldVertices merges the vertices with identical attributes, and removes
+ *    the faces that become degenerate.
+ *  - OptimizeVertexCache reorders the faces with the Tipsify algorithm, so
+ *    vertices are reused while still in the post-transform vertex cache.
+ *  - OptimizeOverdraw splits the vertex cache ordering in clusters and sorts
+ *    them front to back from the outside of the mesh, while keeping the cache
+ *    efficiency within a threshold of the Tipsify ordering.
+ *  - OptimizeVertexFetch reorders the vertices in the order they are first
+ *    referenced by the faces, and remaps the face indices.
+ *  - Simplify reduces the number of faces by quadric error edge collapses,
+ *    keeping the vertex array, so levels of detail share the vertices.
+ *
+ * The cache efficiency is measured on a FIFO cache simulation by:
+ *  - ACMR, the average cache miss ratio, the number of transformed vertices
+ *    per face, between 0.5 and 3.
+ *  - ATVR, the average transformed vertex ratio, the number of transformed
+ *    vertices per referenced vertex, 1 at best.
+ *
+ * @see Sander, Nehab and Barczak, Fast Triangle Reordering for Vertex Locality
+ *      and Reduced Overdraw, ACM Transactions on Graphics, 2007.
+ *      Garland and Heckbert, Surface Simplification Using Quadric Error
+ *      Metrics, SIGGRAPH 1997.
+ */
+struct MeshOptimizer {
+    /**
+     * @brief Vertex cache statistics of a face list.
+     */
+    struct Stats {
+        size_t n_faces;                 /* number of faces */
+        size_t n_vertices;              /* number of referenced vertices */
+        size_t n_transformed;           /* number of cache misses */
+        double acmr;                    /* cache misses per face */
+        double atvr;                    /* cache misses per vertex */
+    };
+
+    /**
+     * @brief Return the statistics of a FIFO vertex cache of the given size
+     * rendering the faces.
+     */
+    static Stats CacheStats(
+        const std::vector<Mesh::Face> &faces,
+        const size_t n_vertices,
+        const size_t cache_size = 16);
+
+    /**
+     * @brief Return a string with the cache statistics.
+     */
+    static std::string InfoString(
+        const Stats &stats,
+        const char *comment = nullptr);
+
+    /**
+     * @brief Merge the vertices with identical attributes and remove the
+     * degenerate faces. Return the number of vertices removed.
+     */
+    static size_t WeldVertices(
+        std::vector<Mesh::Vertex> &vertices,
+        std::vector<Mesh::Face> &faces);
+
+    /**
+     * @brief Reorder the faces for the post-transform vertex cache. If the
+     * clusters array is not null, return the face offsets where the ordering
+     * restarts from a dead-end.
+     */
+    static void OptimizeVertexCache(
+        std::vector<Mesh::Face> &faces,
+        const size_t n_vertices,
+        const size_t cache_size = 16,
+        std::vector<size_t> *clusters = nullptr);
+
+    /**
+     * @brief Reorder the faces to reduce overdraw, keeping the cache miss ratio
+     * of each cluster within threshold of the vertex cache ordering.
+     */
+    static void OptimizeOverdraw(
+        const std::vector<Mesh::Vertex> &vertices,
+        std::vector<Mesh::Face> &faces,
+        const size_t cache_size = 16,
+        const float threshold = 1.05f);
+
+    /**
+     * @brief Reorder the vertices by first reference and remap the faces.
+     * Unreferenced vertices are removed.
+     */
+    static void OptimizeVertexFetch(
+        std::vector<Mesh::Vertex> &vertices,
+        std::vector<Mesh::Face> &faces);
+
+    /**
+     * @brief Return the faces simplified to at most target_faces faces, or
+     * as close as the collapses allow. If error is not null, return the
+     * geometric error of the simplified faces.
+     */
+    static std::vector<Mesh::Face> Simplify(
+        const std::vector<Mesh::Vertex> &vertices,
+        const std::vector<Mesh::Face> &faces,
+        const size_t target_faces,
+        float *error = nullptr);
+
+    /**
+     * @brief Return the faces simplified progressively to each of the targets,
+     * in decreasing order, in a single pass. If errors is not null, return the
+     * geometric error of each set of simplified faces.
+     */
+    static std::vector<std::vector<Mesh::Face>> Simplify(
+        const std::vector<Mesh::Vertex> &vertices,
+        const std::vector<Mesh::Face> &faces,
+        const std::vector<size_t> &targets,
+        std::vector<float> *errors = nullptr);
+
+    /**
+     * @brief Run all the optimization passes on the mesh data.
+     */
+    static void Optimize(
+        std::vector<Mesh::Vertex> &vertices,
+        std::vector<Mesh::Face> &faces,
+        const size_t cache_size = 16);
+};
+
+} /* gl */
+} /* ito */
+
+#endif /* ITO_OPENGL_MESHOPTIMIZER_H_ */
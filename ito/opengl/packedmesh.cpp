@@ -0,0 +1,95 @@
+/*
+ * packedmesh.cpp
+ *
+ * Copyright (c) 2020 Carlos Braga
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the MIT License.
+ *
+ * See accompanying LICENSE.md or https://opensource.org/licenses/MIT.
+ */
+
+#include "buffer.hpp"
+#include "state.hpp"
+#include "packedmesh.hpp"
+
+namespace ito {
+namespace gl {
+
+/** ---------------------------------------------------------------------------
+ * @brief Create a packed mesh with a given attribute name prefix, encoding the
+ * vertex data of the view in the format. Each stream is uploaded to its own
+ * vertex buffer with a single glBufferData call.
+ */
+PackedMesh PackedMesh::Create(
+    const std::string &name,
+    const VertexFormat &format,
+    const Mesh::View &view)
+{
+    ito_assert(view.n_vertices > 0 && view.n_faces > 0, "invalid mesh data");
+
+    PackedMesh mesh;
+    mesh.name = name;
+    mesh.format = format;
+    mesh.n_vertices = view.n_vertices;
+    mesh.n_faces = view.n_faces;
+
+    std::vector<std::vector<uint8_t>> streams =
+        VertexFormat::Pack(format, view.vertices, view.n_vertices);
+    for (auto &stream : streams) {
+        mesh.buffers.push_back(CreateBuffer(
+            GL_ARRAY_BUFFER,
+            stream.size(),
+            GL_STATIC_DRAW,
+            stream.data()));
+    }
+    mesh.ebo = CreateBuffer(
+        GL_ELEMENT_ARRAY_BUFFER,
+        view.n_faces * sizeof(Mesh::Face),
+        GL_STATIC_DRAW,
+        view.faces);
+
+    return mesh;
+}
+
+/**
+ * @brief Destroy the mesh buffers, and the vertex arrays created for them.
+ */
+void PackedMesh::Destroy(PackedMesh &mesh)
+{
+    std::vector<GLuint> buffers(mesh.buffers);
+    buffers.push_back(mesh.ebo);
+    VertexFormat::DestroyVertexArrays(buffers);
+
+    for (auto &buffer : buffers) {
+        DestroyBuffer(buffer);
+    }
+    mesh.buffers.clear();
+    mesh.ebo = 0;
+    mesh.n_vertices = 0;
+    mesh.n_faces = 0;
+}
+
+/** ---------------------------------------------------------------------------
+ * @brief Render the mesh with the attributes used by the program. A shared
+ * vertex array is bound once for consecutive meshes with the same format and
+ * program, and only the vertex and element buffers change between them.
+ */
+void PackedMesh::Render(const PackedMesh &mesh, const GLuint &program)
+{
+    GLuint array = VertexFormat::VertexArray(
+        mesh.format, program, mesh.name, mesh.buffers, mesh.ebo);
+    BindVertexArray(array);
+    if (VertexFormat::IsBindingSupported()) {
+        VertexFormat::BindStreams(mesh.format, mesh.buffers);
+        BindBuffer(GL_ELEMENT_ARRAY_BUFFER, mesh.ebo);
+    }
+    glDrawElements(
+        GL_TRIANGLES,           /* what kind of primitives to render */
+        3 * mesh.n_faces,       /* number of elements to be rendered */
+        GL_UNSIGNED_INT,        /* type of the values in indices */
+        (GLvoid *) 0);          /* offset of first index in the data array */
+}
+
+} /* gl */
+} /* ito */
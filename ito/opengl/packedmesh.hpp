@@ -0,0 +1,57 @@
+/*
+ * packedmesh.hpp
+ *
+ * Copyright (c) 2020 Carlos Braga
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the MIT License.
+ *
+ * See accompanying LICENSE.md or https://opensource.org/licenses/MIT.
+ */
+
+#ifndef ITO_OPENGL_PACKEDMESH_H_
+#define ITO_OPENGL_PACKEDMESH_H_
+
+#include <string>
+#include <vector>
+#include "base.hpp"
+#include "mesh.hpp"
+#include "vertexformat.hpp"
+
+namespace ito {
+namespace gl {
+
+/**
+ * @brief PackedMesh maintains a gpu only mesh with its vertex data encoded in
+ * a VertexFormat, with a vertex buffer for each stream of the format, and an
+ * element buffer with the faces.
+ *
+ * The mesh is not bound to a shader program object. Render draws the mesh
+ * with the vertex array of the format and program, shared by all meshes with
+ * the same format where separate attribute formats are supported. The same
+ * mesh is drawn in a depth only pass by a program using only the positions,
+ * and in a shading pass by a program using all the attributes.
+ */
+struct PackedMesh {
+    std::string name;                   /* attribute name prefix */
+    VertexFormat format;                /* vertex format */
+    std::vector<GLuint> buffers;        /* vertex buffer of each stream */
+    GLuint ebo;                         /* element buffer object */
+    GLsizei n_vertices;                 /* number of vertices */
+    GLsizei n_faces;                    /* number of faces */
+
+    /* Packed mesh factory functions */
+    static PackedMesh Create(
+        const std::string &name,
+        const VertexFormat &format,
+        const Mesh::View &view);
+    static void Destroy(PackedMesh &mesh);
+
+    /** Render the mesh with the attributes used by the program. */
+    static void Render(const PackedMesh &mesh, const GLuint &program);
+};
+
+} /* gl */
+} /* ito */
+
+#endif /* ITO_OPENGL_PACKEDMESH_H_ */
@@ -0,0 +1,169 @@
+/*
+ * readback.cpp
+ *
+ * Copyright (c) 2020 Carlos Braga
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the MIT License.
+ *
+ * See accompanying LICENSE.md or https://opensource.org/licenses/MIT.
+ */
+
+#include "buffer.hpp"
+#include "state.hpp"
+#include "readback.hpp"
+
+namespace ito {
+namespace gl {
+
+/** ---------------------------------------------------------------------------
+ * @brief Create a readback of (width x height) pixels with a ring of n_buffers
+ * pixel pack buffers.
+ */
+Readback Readback::Create(
+    const GLsizei width,
+    const GLsizei height,
+    const GLenum format,
+    const Callback &callback,
+    const size_t n_buffers)
+{
+    ito_assert(width > 0 && height > 0, "invalid readback size");
+    ito_assert(n_buffers > 0, "invalid number of buffers");
+    ito_assert(
+        format == GL_RED ||
+        format == GL_RG ||
+        format == GL_RGB ||
+        format == GL_RGBA,
+        "invalid readback format");
+
+    /* Pixel layout of an image with the same size and bit depth. */
+    Readback readback;
+    readback.width = width;
+    readback.height = height;
+    readback.format = format;
+    readback.bpp = (format == GL_RED ?  8 :
+                    format == GL_RG  ? 16 :
+                    format == GL_RGB ? 24 : 32);
+    readback.pitch = 4 * (((width * readback.bpp) + 31) / 32);
+    readback.size = height * readback.pitch;
+    readback.callback = callback;
+
+    for (size_t i = 0; i < n_buffers; ++i) {
+        readback.buffers.push_back(CreateBuffer(
+            GL_PIXEL_PACK_BUFFER,
+            readback.size,
+            GL_STREAM_READ));
+    }
+    readback.fences.resize(n_buffers, NULL);
+    readback.frames.resize(n_buffers, 0);
+    readback.tail = 0;
+    readback.n_pending = 0;
+    readback.n_frames = 0;
+    return readback;
+}
+
+/**
+ * @brief Delete the fences and the pack buffers, discarding pending frames.
+ */
+void Readback::Destroy(Readback &readback)
+{
+    for (auto &fence : readback.fences) {
+        if (fence != NULL) {
+            glDeleteSync(fence);
+            fence = NULL;
+        }
+    }
+    for (auto &buffer : readback.buffers) {
+        DestroyBuffer(buffer);
+    }
+    readback.buffers.clear();
+    readback.fences.clear();
+    readback.frames.clear();
+    readback.n_pending = 0;
+}
+
+/** ---------------------------------------------------------------------------
+ * @brief Map the oldest pending pack buffer, once its fence has signaled,
+ * and hand its pixels to the callback. Return false if the pixels are not
+ * available and wait is false.
+ */
+static bool Deliver(Readback &readback, const bool wait)
+{
+    GLsync &fence = readback.fences[readback.tail];
+    GLenum status = glClientWaitSync(
+        fence,
+        wait ? GL_SYNC_FLUSH_COMMANDS_BIT : 0,
+        wait ? GL_TIMEOUT_IGNORED : 0);
+    ito_assert(status != GL_WAIT_FAILED, "glClientWaitSync");
+    if (status == GL_TIMEOUT_EXPIRED) {
+        return false;
+    }
+    glDeleteSync(fence);
+    fence = NULL;
+
+    BindBuffer(GL_PIXEL_PACK_BUFFER, readback.buffers[readback.tail]);
+    const GLubyte *pixels = static_cast<const GLubyte *>(glMapBufferRange(
+        GL_PIXEL_PACK_BUFFER, 0, readback.size, GL_MAP_READ_BIT));
+    ito_assert(pixels != NULL, "glMapBufferRange");
+    readback.callback(pixels, readback.frames[readback.tail]);
+    glUnmapBuffer(GL_PIXEL_PACK_BUFFER);
+    BindBuffer(GL_PIXEL_PACK_BUFFER, 0);
+
+    readback.tail = (readback.tail + 1) % readback.buffers.size();
+    readback.n_pending--;
+    return true;
+}
+
+/**
+ * @brief Read the pixels of the read framebuffer, in the rectangle with lower
+ * left corner at (x,y), into the next pack buffer of the ring.
+ *
+ * The available frames are delivered first. If the ring is still full, the
+ * oldest frame is waited on and delivered to free its pack buffer.
+ */
+void Readback::Read(Readback &readback, const GLint x, const GLint y)
+{
+    Poll(readback);
+    if (readback.n_pending == readback.buffers.size()) {
+        Deliver(readback, true);
+    }
+
+    size_t head = (readback.tail + readback.n_pending) % readback.buffers.size();
+    BindBuffer(GL_PIXEL_PACK_BUFFER, readback.buffers[head]);
+    glPixelStorei(GL_PACK_ALIGNMENT, 4);
+    glReadPixels(
+        x,                          /* lower left corner */
+        y,
+        readback.width,             /* rectangle size */
+        readback.height,
+        readback.format,            /* pixel format */
+        GL_UNSIGNED_BYTE,           /* pixel data type */
+        (GLvoid *) 0);              /* offset in the pack buffer */
+    BindBuffer(GL_PIXEL_PACK_BUFFER, 0);
+
+    readback.fences[head] = glFenceSync(GL_SYNC_GPU_COMMANDS_COMPLETE, 0);
+    readback.frames[head] = readback.n_frames++;
+    readback.n_pending++;
+}
+
+/**
+ * @brief Deliver the pending frames whose pixels are available, oldest first,
+ * without waiting.
+ */
+void Readback::Poll(Readback &readback)
+{
+    while (readback.n_pending > 0 && Deliver(readback, false)) {}
+}
+
+/**
+ * @brief Wait for and deliver all pending frames.
+ */
+void Readback::Flush(Readback &readback)
+{
+    while (readback.n_pending > 0) {
+        Deliver(readback, true);
+    }
+}
+
+} /* gl */
+} /* ito */
@@ -0,0 +1,74 @@
+/*
+ * readback.hpp
+ *
+ * Copyright (c) 2020 Carlos Braga
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the MIT License.
+ *
+ * See accompanying LICENSE.md or https://opensource.org/licenses/MIT.
+ */
+
+#ifndef ITO_OPENGL_READBACK_H_
+#define ITO_OPENGL_READBACK_H_
+
+#include <functional>
+#include <vector>
+#include "base.hpp"
+
+namespace ito {
+namespace gl {
+
+/**
+ * @brief Readback reads the pixels of the read framebuffer asynchronously,
+ * through a ring of GL_PIXEL_PACK_BUFFER buffer objects.
+ *
+ * Read issues glReadPixels into the next pack buffer of the ring and fences
+ * it, and returns without waiting for the GPU. Poll maps the pack buffers
+ * whose fences have signaled, oldest first, and hands the pixels of each
+ * frame to the callback. A frame is usually delivered n_buffers-1 frames
+ * after it is read. Read only waits for a fence when the ring is full.
+ *
+ * The pixels have the layout of an Image with the same size and bit depth,
+ * the first row at the bottom of the framebuffer and rows padded to a 4-byte
+ * boundary. The pixel pointer is only valid during the callback.
+ */
+struct Readback {
+    typedef std::function<void(const GLubyte *pixels, uint64_t frame)> Callback;
+
+    GLsizei width;                  /* read rectangle width in pixels */
+    GLsizei height;                 /* read rectangle height in pixels */
+    GLenum format;                  /* pixel format, GL_RED to GL_RGBA */
+    uint32_t bpp;                   /* pixel bit depth */
+    uint32_t pitch;                 /* row size in bytes */
+    GLsizeiptr size;                /* frame size in bytes */
+    Callback callback;              /* pixel callback */
+
+    std::vector<GLuint> buffers;    /* pixel pack buffer objects */
+    std::vector<GLsync> fences;     /* pack buffer fences */
+    std::vector<uint64_t> frames;   /* frame read into each pack buffer */
+    size_t tail;                    /* oldest pending pack buffer */
+    size_t n_pending;               /* number of pending pack buffers */
+    uint64_t n_frames;              /* number of frames read */
+
+    /* Readback factory functions */
+    static Readback Create(
+        const GLsizei width,
+        const GLsizei height,
+        const GLenum format,
+        const Callback &callback,
+        const size_t n_buffers = 3);
+    static void Destroy(Readback &readback);
+
+    /** Read the pixels of the read framebuffer at (x,y) into the ring. */
+    static void Read(Readback &readback, const GLint x, const GLint y);
+
+    /** Deliver the frames whose pixels are available, or all frames. */
+    static void Poll(Readback &readback);
+    static void Flush(Readback &readback);
+};
+
+} /* gl */
+} /* ito */
+
+#endif /* ITO_OPENGL_READBACK_H_ */
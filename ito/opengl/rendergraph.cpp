@@ -0,0 +1,509 @@
+/*
+ * rendergraph.cpp
+ *
+ * Copyright (c) 2020 Carlos Braga
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the MIT License.
+ *
+ * See accompanying LICENSE.md or https://opensource.org/licenses/MIT.
+ */
+
+#include <algorithm>
+#include <array>
+#include <set>
+#include <sstream>
+#include "glfw.hpp"
+#include "rendergraph.hpp"
+#include "state.hpp"
+
+namespace ito {
+namespace gl {
+
+/** ---------------------------------------------------------------------------
+ * @brief Return the passes in a dependency order, preferring the order in
+ * which the passes were added, and the passes producing the reads of each
+ * pass.
+ *
+ * Each write makes a new version of the resource. A read is bound to the
+ * version of the last writer added before the pass, and the pass runs after
+ * that writer and before the next writer of the resource. Writers of the same
+ * resource run in the order they were added.
+ */
+static std::vector<size_t> SortPasses(
+    const RenderGraph &graph,
+    std::vector<std::set<size_t>> &producers)
+{
+    const size_t n_passes = graph.passes.size();
+    const size_t n_resources = graph.resources.size();
+    std::vector<std::set<size_t>> edges(n_passes);
+    producers.assign(n_passes, std::set<size_t>());
+
+    std::vector<size_t> writer(n_resources, n_passes);
+    std::vector<std::vector<size_t>> readers(n_resources);
+    for (size_t p = 0; p < n_passes; ++p) {
+        const RenderGraph::Pass &pass = graph.passes[p];
+
+        /* Read after write of the current version. */
+        for (auto &read : pass.reads) {
+            size_t q = writer[read.resource];
+            if (q != n_passes) {
+                edges[q].insert(p);
+                producers[p].insert(q);
+            }
+            readers[read.resource].push_back(p);
+        }
+
+        /* Write after read and write after write of the current version. */
+        for (auto &write : pass.writes) {
+            for (auto &q : readers[write.resource]) {
+                if (q != p) {
+                    edges[q].insert(p);
+                }
+            }
+            size_t q = writer[write.resource];
+            if (q != n_passes && q != p) {
+                edges[q].insert(p);
+            }
+            writer[write.resource] = p;
+            readers[write.resource].clear();
+        }
+    }
+
+    std::vector<size_t> indegree(n_passes, 0);
+    for (auto &edge : edges) {
+        for (auto &q : edge) {
+            indegree[q]++;
+        }
+    }
+
+    std::set<size_t> ready;
+    for (size_t p = 0; p < n_passes; ++p) {
+        if (indegree[p] == 0) {
+            ready.insert(p);
+        }
+    }
+
+    std::vector<size_t> order;
+    while (!ready.empty()) {
+        size_t p = *ready.begin();
+        ready.erase(ready.begin());
+        order.push_back(p);
+        for (auto &q : edges[p]) {
+            if (--indegree[q] == 0) {
+                ready.insert(q);
+            }
+        }
+    }
+    if (order.size() != n_passes) {
+        ito_throw("render graph has a dependency cycle");
+    }
+    return order;
+}
+
+/**
+ * @brief Return the barrier bits ordering a write after the pending incoherent
+ * writes to the same resource: image and storage stores, framebuffer writes,
+ * or buffer updates.
+ */
+static GLbitfield WriteBarrier(
+    const RenderGraph::Resource &resource,
+    const RenderGraph::Access &write)
+{
+    if (write.is_storage) {
+        return GL_SHADER_IMAGE_ACCESS_BARRIER_BIT |
+            GL_SHADER_STORAGE_BARRIER_BIT;
+    }
+    return resource.is_target
+        ? GL_FRAMEBUFFER_BARRIER_BIT
+        : GL_BUFFER_UPDATE_BARRIER_BIT;
+}
+
+/** ---------------------------------------------------------------------------
+ * @brief Create an empty render graph, with transient render targets from
+ * the framebuffer pool.
+ */
+RenderGraph RenderGraph::Create(FramebufferPool &pool)
+{
+    RenderGraph graph;
+    graph.pool = &pool;
+    graph.is_compiled = false;
+    return graph;
+}
+
+/**
+ * @brief Destroy the render graph. Transient render targets are released to
+ * the pool after each execution, and the imported resources are not owned.
+ */
+void RenderGraph::Destroy(RenderGraph &graph)
+{
+    graph.pool = nullptr;
+    graph.resources.clear();
+    graph.passes.clear();
+    graph.order.clear();
+    graph.is_compiled = false;
+}
+
+/** ---------------------------------------------------------------------------
+ * @brief Add a transient render target to the graph.
+ */
+size_t RenderGraph::CreateTarget(
+    RenderGraph &graph,
+    const std::string &name,
+    const FramebufferPool::Desc &desc)
+{
+    Resource resource = {};
+    resource.name = name;
+    resource.is_target = true;
+    resource.is_imported = false;
+    resource.desc = desc;
+    graph.resources.push_back(resource);
+    graph.is_compiled = false;
+    return graph.resources.size() - 1;
+}
+
+/**
+ * @brief Import a render target owned by the caller.
+ */
+size_t RenderGraph::ImportTarget(
+    RenderGraph &graph,
+    const std::string &name,
+    const FramebufferPool::Target &target)
+{
+    Resource resource = {};
+    resource.name = name;
+    resource.is_target = true;
+    resource.is_imported = true;
+    resource.target = target;
+    graph.resources.push_back(resource);
+    graph.is_compiled = false;
+    return graph.resources.size() - 1;
+}
+
+/**
+ * @brief Import a buffer object owned by the caller.
+ */
+size_t RenderGraph::ImportBuffer(
+    RenderGraph &graph,
+    const std::string &name,
+    const GLuint buffer)
+{
+    Resource resource = {};
+    resource.name = name;
+    resource.is_target = false;
+    resource.is_imported = true;
+    resource.buffer = buffer;
+    graph.resources.push_back(resource);
+    graph.is_compiled = false;
+    return graph.resources.size() - 1;
+}
+
+/**
+ * @brief Return a read access to a resource, with the barrier bits needed
+ * to make incoherent writes visible to the read, or 0 for all barrier bits.
+ */
+RenderGraph::Access RenderGraph::Read(
+    const size_t resource,
+    const GLbitfield barrier)
+{
+    return {resource, barrier, false};
+}
+
+/**
+ * @brief Return a write access to a resource, through the framebuffer or
+ * with image or shader storage stores.
+ */
+RenderGraph::Access RenderGraph::Write(
+    const size_t resource,
+    const bool is_storage)
+{
+    return {resource, 0, is_storage};
+}
+
+/**
+ * @brief Add a pass reading and writing the resources.
+ */
+size_t RenderGraph::AddPass(
+    RenderGraph &graph,
+    const std::string &name,
+    const std::vector<Access> &reads,
+    const std::vector<Access> &writes,
+    const Callback &callback,
+    const bool is_output)
+{
+    size_t n_targets = 0;
+    for (auto &access : reads) {
+        ito_assert(access.resource < graph.resources.size(),
+            "invalid render graph resource");
+    }
+    for (auto &access : writes) {
+        ito_assert(access.resource < graph.resources.size(),
+            "invalid render graph resource");
+        const Resource &resource = graph.resources[access.resource];
+        n_targets += (resource.is_target && !access.is_storage) ? 1 : 0;
+    }
+    ito_assert(n_targets <= 1, "pass writes more than one render target");
+
+    Pass pass;
+    pass.name = name;
+    pass.reads = reads;
+    pass.writes = writes;
+    pass.callback = callback;
+    pass.is_output = is_output;
+    pass.is_culled = false;
+    pass.barrier = 0;
+    graph.passes.push_back(pass);
+    graph.is_compiled = false;
+    return graph.passes.size() - 1;
+}
+
+/** ---------------------------------------------------------------------------
+ * @brief Order the passes, cull the passes whose outputs are unused, and
+ * compute the lifetime of each transient render target.
+ */
+void RenderGraph::Compile(RenderGraph &graph)
+{
+    std::vector<std::set<size_t>> producers;
+    std::vector<size_t> sorted = SortPasses(graph, producers);
+
+    /*
+     * Walk the passes backwards, keeping a pass if it is an output, writes
+     * an imported resource or produces a version read by a kept pass.
+     */
+    std::vector<bool> is_needed(graph.passes.size(), false);
+    for (auto it = sorted.rbegin(); it != sorted.rend(); ++it) {
+        Pass &pass = graph.passes[*it];
+        bool is_kept = pass.is_output || is_needed[*it];
+        for (auto &write : pass.writes) {
+            is_kept |= graph.resources[write.resource].is_imported;
+        }
+        pass.is_culled = !is_kept;
+        if (is_kept) {
+            for (auto &q : producers[*it]) {
+                is_needed[q] = true;
+            }
+        }
+    }
+
+    graph.order.clear();
+    for (auto &p : sorted) {
+        if (!graph.passes[p].is_culled) {
+            graph.order.push_back(p);
+        }
+    }
+
+    /*
+     * Compute the first and last kept pass using each resource. A transient
+     * target must be written before it is read.
+     */
+    const size_t n_order = graph.order.size();
+    for (auto &resource : graph.resources) {
+        resource.first = n_order;
+        resource.last = n_order;
+        resource.is_pending = false;
+    }
+    for (size_t k = 0; k < n_order; ++k) {
+        const Pass &pass = graph.passes[graph.order[k]];
+        for (auto &write : pass.writes) {
+            Resource &resource = graph.resources[write.resource];
+            if (resource.first == n_order) {
+                resource.first = k;
+            }
+            resource.last = k;
+        }
+        for (auto &read : pass.reads) {
+            Resource &resource = graph.resources[read.resource];
+            ito_assert(resource.is_imported || resource.first <= k,
+                ito::str::format("transient %s is read before it is written",
+                    resource.name.c_str()));
+            resource.last = k;
+        }
+    }
+
+    graph.is_compiled = true;
+}
+
+/**
+ * @brief Execute the kept passes in order. Each transient target is acquired
+ * before its first pass and released after its last pass.
+ */
+void RenderGraph::Execute(RenderGraph &graph)
+{
+    if (!graph.is_compiled) {
+        Compile(graph);
+    }
+
+    std::array<GLint, 4> viewport;
+    glfw::GetViewport(viewport);
+
+    for (size_t k = 0; k < graph.order.size(); ++k) {
+        Pass &pass = graph.passes[graph.order[k]];
+
+        /* Acquire the transient targets first used by the pass. */
+        for (auto &resource : graph.resources) {
+            if (!resource.is_imported && resource.first == k) {
+                resource.target = FramebufferPool::Acquire(
+                    *graph.pool, resource.desc);
+            }
+        }
+
+        /*
+         * Make the pending incoherent writes visible to the reads, and order
+         * the writes after them, from one version of a resource to the next.
+         */
+        pass.barrier = 0;
+        for (auto &read : pass.reads) {
+            const Resource &resource = graph.resources[read.resource];
+            if (resource.is_pending) {
+                pass.barrier |= (read.barrier != 0)
+                    ? read.barrier
+                    : GL_ALL_BARRIER_BITS;
+            }
+        }
+        for (auto &write : pass.writes) {
+            const Resource &resource = graph.resources[write.resource];
+            if (resource.is_pending) {
+                pass.barrier |= WriteBarrier(resource, write);
+            }
+        }
+        for (auto &read : pass.reads) {
+            graph.resources[read.resource].is_pending = false;
+        }
+        for (auto &write : pass.writes) {
+            graph.resources[write.resource].is_pending = false;
+        }
+#if defined(GL_VERSION_4_2)
+        if (pass.barrier != 0 && IsBarrierSupported()) {
+            glMemoryBarrier(pass.barrier);
+        }
+#endif
+
+        /* Bind the render target written by the pass and its viewport. */
+        for (auto &write : pass.writes) {
+            const Resource &resource = graph.resources[write.resource];
+            if (resource.is_target && !write.is_storage) {
+                GLsizei width = resource.target.width;
+                GLsizei height = resource.target.height;
+                if (width == 0 || height == 0) {
+                    width = graph.pool->width;
+                    height = graph.pool->height;
+                }
+                BindFramebuffer(GL_DRAW_FRAMEBUFFER,
+                    resource.target.framebuffer);
+                glfw::SetViewport({0, 0, width, height});
+            }
+        }
+
+        pass.callback(graph);
+
+        /* Mark the incoherent writes of the pass as pending. */
+        for (auto &write : pass.writes) {
+            if (write.is_storage) {
+                graph.resources[write.resource].is_pending = true;
+            }
+        }
+
+        /* Release the transient targets last used by the pass. */
+        for (auto &resource : graph.resources) {
+            if (!resource.is_imported && resource.last == k) {
+                FramebufferPool::Release(*graph.pool, resource.target);
+                resource.target = {};
+            }
+        }
+    }
+
+    BindFramebuffer(GL_DRAW_FRAMEBUFFER, 0);
+    glfw::SetViewport(viewport);
+}
+
+/** ---------------------------------------------------------------------------
+ * @brief Return the render target of a resource.
+ */
+const FramebufferPool::Target &RenderGraph::GetTarget(
+    const RenderGraph &graph,
+    const size_t resource)
+{
+    ito_assert(resource < graph.resources.size() &&
+        graph.resources[resource].is_target, "invalid render target");
+    return graph.resources[resource].target;
+}
+
+/**
+ * @brief Return a color attachment texture of a render target resource.
+ */
+GLuint RenderGraph::GetTexture(
+    const RenderGraph &graph,
+    const size_t resource,
+    const size_t index)
+{
+    const FramebufferPool::Target &target = GetTarget(graph, resource);
+    ito_assert(index < target.color_textures.size(), "invalid color texture");
+    return target.color_textures[index];
+}
+
+/**
+ * @brief Return the buffer object of a buffer resource.
+ */
+GLuint RenderGraph::GetBuffer(const RenderGraph &graph, const size_t resource)
+{
+    ito_assert(resource < graph.resources.size() &&
+        !graph.resources[resource].is_target, "invalid buffer");
+    return graph.resources[resource].buffer;
+}
+
+/**
+ * @brief Return a string with the pass order, the culled passes and the
+ * lifetime of each transient render target.
+ */
+std::string RenderGraph::InfoString(
+    const RenderGraph &graph,
+    const char *comment)
+{
+    std::ostringstream ss;
+    if (comment != nullptr) {
+        ss << ito::str::format("%s\n", comment);
+    }
+
+    for (size_t k = 0; k < graph.order.size(); ++k) {
+        const Pass &pass = graph.passes[graph.order[k]];
+        ss << ito::str::format("pass %zu: %s, barrier 0x%x\n",
+            k, pass.name.c_str(), pass.barrier);
+    }
+    for (auto &pass : graph.passes) {
+        if (pass.is_culled) {
+            ss << ito::str::format("culled: %s\n", pass.name.c_str());
+        }
+    }
+    for (auto &resource : graph.resources) {
+        if (resource.is_imported) {
+            ss << ito::str::format("imported: %s\n", resource.name.c_str());
+        } else if (resource.first < graph.order.size()) {
+            ss << ito::str::format("transient: %s, passes %zu to %zu\n",
+                resource.name.c_str(), resource.first, resource.last);
+        } else {
+            ss << ito::str::format("unused: %s\n", resource.name.c_str());
+        }
+    }
+    return ss.str();
+}
+
+/**
+ * @brief Are memory barriers supported by the current context?
+ */
+bool RenderGraph::IsBarrierSupported(void)
+{
+#if defined(GL_VERSION_4_2)
+    if (GLAD_GL_VERSION_4_2) {
+        return true;
+    }
+#endif
+#if defined(GL_ARB_shader_image_load_store)
+    if (GLAD_GL_ARB_shader_image_load_store) {
+        return true;
+    }
+#endif
+    return false;
+}
+
+} /* gl */
+} /* ito */
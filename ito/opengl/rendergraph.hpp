@@ -0,0 +1,158 @@
+/*
+ * rendergraph.hpp
+ *
+ * Copyright (c) 2020 Carlos Braga
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the MIT License.
+ *
+ * See accompanying LICENSE.md or https://opensource.org/licenses/MIT.
+ */
+
+#ifndef ITO_OPENGL_RENDERGRAPH_H_
+#define ITO_OPENGL_RENDERGRAPH_H_
+
+#include <functional>
+#include <string>
+#include <vector>
+#include "base.hpp"
+#include "framebufferpool.hpp"
+
+namespace ito {
+namespace gl {
+
+/**
+ * @brief RenderGraph executes a multi-pass pipeline described by its passes
+ * and the render targets and buffers each pass reads and writes.
+ *
+ * Transient render targets are created by the graph and live from the first
+ * to the last pass using them. They are acquired from a FramebufferPool before
+ * their first pass and released after their last pass, so transients whose
+ * lifetimes do not overlap alias the same textures. Imported render targets,
+ * eg the window framebuffer, and imported buffers are owned by the caller.
+ *
+ * Compile orders the passes by their dependencies. Each write of a resource
+ * makes a new version of it, and a pass reads the version of the last writer
+ * added before it. The pass runs after that writer and before the next writer
+ * of the resource, eg a ping-pong over two targets, or a pass reading a
+ * history target before a later pass overwrites it. Passes writing the same
+ * resource run in the order they were added. Passes whose versions are never
+ * read by a pass that is kept are culled, unless they write an imported
+ * resource or are marked as output.
+ *
+ * Execute binds the render target written by each pass as the draw
+ * framebuffer with a viewport of its size before calling the pass. Writes
+ * made with image or shader storage stores are not coherent, and a
+ * glMemoryBarrier with the barrier bits of the reading access is issued
+ * before the first pass that reads them. A pass writing the resource next is
+ * ordered after them as well, with GL_FRAMEBUFFER_BARRIER_BIT for a render
+ * target write, or the image and storage bits for another store.
+ */
+struct RenderGraph {
+    /** Resource access by a pass. */
+    struct Access {
+        size_t resource;                /* resource index */
+        GLbitfield barrier;             /* read barrier bits, 0 for all */
+        bool is_storage;                /* written by image or storage stores */
+    };
+
+    /** Render target or buffer resource. */
+    struct Resource {
+        std::string name;               /* resource name */
+        bool is_target;                 /* render target or buffer */
+        bool is_imported;               /* owned by the caller */
+        FramebufferPool::Desc desc;     /* transient target descriptor */
+        FramebufferPool::Target target; /* render target */
+        GLuint buffer;                  /* buffer object */
+        bool is_pending;                /* incoherent writes not yet visible */
+        size_t first;                   /* first pass using the resource */
+        size_t last;                    /* last pass using the resource */
+    };
+
+    /** Pass render function. */
+    typedef std::function<void(const RenderGraph &graph)> Callback;
+
+    /** Pass with the resources it reads and writes. */
+    struct Pass {
+        std::string name;               /* pass name */
+        std::vector<Access> reads;      /* resources read by the pass */
+        std::vector<Access> writes;     /* resources written by the pass */
+        Callback callback;              /* pass render function */
+        bool is_output;                 /* pass is never culled */
+        bool is_culled;                 /* pass outputs are unused */
+        GLbitfield barrier;             /* last barrier before the pass */
+    };
+
+    FramebufferPool *pool;              /* pool of transient targets */
+    std::vector<Resource> resources;    /* graph resources */
+    std::vector<Pass> passes;           /* passes in the order added */
+    std::vector<size_t> order;          /* execution order of kept passes */
+    bool is_compiled;                   /* graph is compiled */
+
+    /* Render graph factory functions */
+    static RenderGraph Create(FramebufferPool &pool);
+    static void Destroy(RenderGraph &graph);
+
+    /**
+     * @brief Add a transient render target, or import a render target or a
+     * buffer owned by the caller. An imported target with no size has the
+     * size of the window framebuffer. Return the resource index.
+     */
+    static size_t CreateTarget(
+        RenderGraph &graph,
+        const std::string &name,
+        const FramebufferPool::Desc &desc);
+    static size_t ImportTarget(
+        RenderGraph &graph,
+        const std::string &name,
+        const FramebufferPool::Target &target);
+    static size_t ImportBuffer(
+        RenderGraph &graph,
+        const std::string &name,
+        const GLuint buffer);
+
+    /** Return a read or a write access to a resource. */
+    static Access Read(const size_t resource, const GLbitfield barrier = 0);
+    static Access Write(const size_t resource, const bool is_storage = false);
+
+    /** Add a pass and return the pass index. */
+    static size_t AddPass(
+        RenderGraph &graph,
+        const std::string &name,
+        const std::vector<Access> &reads,
+        const std::vector<Access> &writes,
+        const Callback &callback,
+        const bool is_output = false);
+
+    /** Order the passes, cull unused passes and compute the lifetimes. */
+    static void Compile(RenderGraph &graph);
+
+    /** Execute the kept passes in order. */
+    static void Execute(RenderGraph &graph);
+
+    /**
+     * @brief Return the render target, a color texture or the buffer of a
+     * resource, valid while the resource is used by the executing pass.
+     */
+    static const FramebufferPool::Target &GetTarget(
+        const RenderGraph &graph,
+        const size_t resource);
+    static GLuint GetTexture(
+        const RenderGraph &graph,
+        const size_t resource,
+        const size_t index = 0);
+    static GLuint GetBuffer(const RenderGraph &graph, const size_t resource);
+
+    /** Return a string with the pass order and the resource lifetimes. */
+    static std::string InfoString(
+        const RenderGraph &graph,
+        const char *comment = nullptr);
+
+    /** Are memory barriers supported by the current context? */
+    static bool IsBarrierSupported(void);
+};
+
+} /* gl */
+} /* ito */
+
+#endif /* ITO_OPENGL_RENDERGRAPH_H_ */
@@ -0,0 +1,291 @@
+/*
+ * renderqueue.cpp
+ *
+ * Copyright (c) 2020 Carlos Braga
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the MIT License.
+ *
+ * See accompanying LICENSE.md or https://opensource.org/licenses/MIT.
+ */
+
+#include <algorithm>
+#include "buffer.hpp"
+#include "state.hpp"
+#include "streambuffer.hpp"
+#include "renderqueue.hpp"
+
+namespace ito {
+namespace gl {
+
+/** ---------------------------------------------------------------------------
+ * @brief Sort key field widths, most significant first.
+ */
+static const uint64_t kFramebufferBits = 8;
+static const uint64_t kProgramBits = 10;
+static const uint64_t kTextureBits = 12;
+static const uint64_t kMeshBits = 16;
+static const uint64_t kDepthBits = 18;
+
+/**
+ * @brief Return the dense id of a state in the current frame, assigning the
+ * next id to a new state.
+ */
+template<typename Map, typename State>
+static uint64_t StateId(Map &ids, const State &state, const uint64_t bits)
+{
+    auto it = ids.find(state);
+    if (it != ids.end()) {
+        return it->second;
+    }
+
+    uint64_t id = ids.size();
+    ito_assert(id < ((uint64_t) 1 << bits), "too many render queue states");
+    ids[state] = id;
+    return id;
+}
+
+/** ---------------------------------------------------------------------------
+ * @brief Create a render queue and its instance buffer object.
+ */
+RenderQueue RenderQueue::Create(void)
+{
+    RenderQueue queue;
+    queue.ibo = CreateBuffer(
+        GL_ARRAY_BUFFER,
+        sizeof(Mesh::Instance),
+        GL_STREAM_DRAW);
+    queue.n_draws = 0;
+    queue.program_epoch = GetProgramEpoch();
+    return queue;
+}
+
+/**
+ * @brief Destroy the render queue instance buffer object.
+ */
+void RenderQueue::Destroy(RenderQueue &queue)
+{
+    DestroyBuffer(queue.ibo);
+    Clear(queue);
+    queue.locations.clear();
+}
+
+/** ---------------------------------------------------------------------------
+ * @brief Submit a draw item with the mesh instance attributes, drawn with the
+ * program and textures into the framebuffer. The depth in [0,1] orders the
+ * items with the same state front to back.
+ */
+void RenderQueue::Submit(
+    RenderQueue &queue,
+    const Mesh &mesh,
+    const GLuint program,
+    const std::vector<GLuint> &textures,
+    const Mesh::Instance &instance,
+    const GLfloat depth,
+    const GLuint framebuffer)
+{
+    ito_assert(textures.size() <= kMaxTextures, "too many textures");
+
+    Item item;
+    item.mesh = &mesh;
+    item.framebuffer = framebuffer;
+    item.program = program;
+    item.textures.fill(0);
+    std::copy(textures.begin(), textures.end(), item.textures.begin());
+    item.instance = instance;
+
+    /* Pack the state ids and the quantized depth in the sort key. */
+    const uint64_t max_depth = ((uint64_t) 1 << kDepthBits) - 1;
+    GLfloat d = std::min(std::max(depth, 0.0f), 1.0f);
+
+    uint64_t key = StateId(queue.framebuffer_ids, framebuffer, kFramebufferBits);
+    key = (key << kProgramBits) |
+        StateId(queue.program_ids, program, kProgramBits);
+    key = (key << kTextureBits) |
+        StateId(queue.texture_ids, item.textures, kTextureBits);
+    key = (key << kMeshBits) |
+        StateId(queue.mesh_ids, item.mesh, kMeshBits);
+    key = (key << kDepthBits) |
+        static_cast<uint64_t>(d * static_cast<GLfloat>(max_depth));
+
+    queue.items.push_back(item);
+    queue.keys.push_back(key);
+}
+
+/**
+ * @brief Sort and draw the submitted items, and clear the queue.
+ *
+ * The instances are copied in key order into the instance buffer with a
+ * single upload. Each run of items with the same framebuffer, program,
+ * textures and mesh is then drawn with one instanced draw call, pointing
+ * the mesh instance attributes to the first instance of the run. State
+ * changes go through the render state cache, so state shared by adjacent
+ * runs is not set again.
+ */
+void RenderQueue::Execute(RenderQueue &queue)
+{
+    queue.n_draws = 0;
+    const size_t n_items = queue.items.size();
+    if (n_items == 0) {
+        return;
+    }
+
+    RadixSort(
+        queue.keys,
+        queue.order,
+        queue.sort_keys,
+        queue.swap_keys,
+        queue.sort_order);
+
+    /* Upload the instances in key order. */
+    queue.instances.resize(n_items);
+    for (size_t i = 0; i < n_items; ++i) {
+        queue.instances[i] = queue.items[queue.order[i]].instance;
+    }
+    BindBuffer(GL_ARRAY_BUFFER, queue.ibo);
+    glBufferData(
+        GL_ARRAY_BUFFER,
+        n_items * sizeof(Mesh::Instance),
+        queue.instances.data(),
+        GL_STREAM_DRAW);
+
+    /* Draw each run of items with the same state and mesh. */
+    size_t first = 0;
+    while (first < n_items) {
+        const uint64_t state = queue.keys[queue.order[first]] >> kDepthBits;
+        size_t last = first + 1;
+        while (last < n_items &&
+               (queue.keys[queue.order[last]] >> kDepthBits) == state) {
+            ++last;
+        }
+
+        const Item &item = queue.items[queue.order[first]];
+        const Mesh &mesh = *item.mesh;
+
+        BindFramebuffer(GL_FRAMEBUFFER, item.framebuffer);
+        UseProgram(item.program);
+        for (size_t unit = 0; unit < kMaxTextures; ++unit) {
+            if (item.textures[unit] != 0) {
+                ActiveTexture(GL_TEXTURE0 + unit);
+                BindTexture(GL_TEXTURE_2D, item.textures[unit]);
+            }
+        }
+
+        /*
+         * Query the instance attribute locations once per program, and
+         * forget them if a program was destroyed since they were queried.
+         */
+        if (queue.program_epoch != GetProgramEpoch()) {
+            queue.locations.clear();
+            queue.program_epoch = GetProgramEpoch();
+        }
+        auto loc = queue.locations.find({item.program, mesh.name});
+        if (loc == queue.locations.end()) {
+            std::string transform_name = mesh.name + "_instance_transform";
+            std::string color_name = mesh.name + "_instance_color";
+            loc = queue.locations.emplace(
+                std::make_pair(item.program, mesh.name),
+                std::make_pair(
+                    glGetAttribLocation(item.program, transform_name.c_str()),
+                    glGetAttribLocation(item.program, color_name.c_str()))).first;
+        }
+
+        BindVertexArray(mesh.vao);
+        BindBuffer(GL_ARRAY_BUFFER, queue.ibo);
+        Mesh::InstanceAttributes(
+            loc->second.first,
+            loc->second.second,
+            first * sizeof(Mesh::Instance));
+
+        GLint base_vertex = mesh.is_streaming
+            ? StreamBuffer::Offset(mesh.stream) / sizeof(Mesh::Vertex)
+            : 0;
+        glDrawElementsInstancedBaseVertex(
+            GL_TRIANGLES,               /* what kind of primitives to render */
+            3 * mesh.n_faces,           /* number of elements to be rendered */
+            GL_UNSIGNED_INT,            /* type of the values in indices */
+            (GLvoid *) 0,               /* offset of first index */
+            last - first,               /* number of instances */
+            base_vertex);               /* constant added to each index */
+        queue.n_draws++;
+
+        first = last;
+    }
+
+    Clear(queue);
+}
+
+/**
+ * @brief Clear the submitted items and the state ids of the frame.
+ */
+void RenderQueue::Clear(RenderQueue &queue)
+{
+    queue.items.clear();
+    queue.keys.clear();
+    queue.framebuffer_ids.clear();
+    queue.program_ids.clear();
+    queue.texture_ids.clear();
+    queue.mesh_ids.clear();
+}
+
+/** ---------------------------------------------------------------------------
+ * @brief Sort the key indices in ascending key order with a least significant
+ * digit radix sort over 8 byte digits. Each pass is a stable counting sort,
+ * and passes over a digit shared by all keys are skipped. The first pass
+ * reads the keys in place, and later passes alternate between the scratch
+ * buffers, so no buffer is allocated once they reach the number of keys.
+ */
+void RenderQueue::RadixSort(
+    const std::vector<uint64_t> &keys,
+    std::vector<uint32_t> &order,
+    std::vector<uint64_t> &sort_keys,
+    std::vector<uint64_t> &swap_keys,
+    std::vector<uint32_t> &sort_order)
+{
+    const size_t n = keys.size();
+    order.resize(n);
+    for (size_t i = 0; i < n; ++i) {
+        order[i] = i;
+    }
+    if (n == 0) {
+        return;
+    }
+
+    sort_keys.resize(n);
+    swap_keys.resize(n);
+    sort_order.resize(n);
+    const uint64_t *src_keys = keys.data();
+    uint64_t *dst_keys = sort_keys.data();
+
+    for (size_t shift = 0; shift < 64; shift += 8) {
+        /* Count the keys with each digit value. */
+        size_t count[256] = {};
+        for (size_t i = 0; i < n; ++i) {
+            count[(src_keys[i] >> shift) & 0xff]++;
+        }
+        if (count[(src_keys[0] >> shift) & 0xff] == n) {
+            continue;
+        }
+
+        /* Scatter the keys to the prefix sum offsets of their digit. */
+        size_t offset = 0;
+        for (size_t d = 0; d < 256; ++d) {
+            size_t c = count[d];
+            count[d] = offset;
+            offset += c;
+        }
+        for (size_t i = 0; i < n; ++i) {
+            size_t ix = count[(src_keys[i] >> shift) & 0xff]++;
+            dst_keys[ix] = src_keys[i];
+            sort_order[ix] = order[i];
+        }
+        src_keys = dst_keys;
+        dst_keys = (dst_keys == sort_keys.data())
+            ? swap_keys.data()
+            : sort_keys.data();
+        order.swap(sort_order);
+    }
+}
+
+} /* gl */
+} /* ito */
@@ -0,0 +1,122 @@
+/*
+ * renderqueue.hpp
+ *
+ * Copyright (c) 2020 Carlos Braga
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the MIT License.
+ *
+ * See accompanying LICENSE.md or https://opensource.org/licenses/MIT.
+ */
+
+#ifndef ITO_OPENGL_RENDERQUEUE_H_
+#define ITO_OPENGL_RENDERQUEUE_H_
+
+#include <array>
+#include <map>
+#include <string>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+#include "base.hpp"
+#include "mesh.hpp"
+
+namespace ito {
+namespace gl {
+
+/**
+ * @brief RenderQueue collects the draw items of a frame, sorts them to
+ * minimize the state changes, and merges the items drawing the same mesh
+ * with the same state into instanced draw calls.
+ *
+ * Each item is a mesh drawn with a shader program object, a set of 2d
+ * textures bound to units 0..kMaxTextures-1, into a framebuffer. The per
+ * item uniforms are the mesh instance attributes, a transform and a color,
+ * so items differing only in these are drawn with a single call. Uniforms
+ * shared by all items of a program are set by the caller, eg in a uniform
+ * buffer, before Execute.
+ *
+ * Items are sorted by a 64-bit key with the fields, most significant first:
+ *      framebuffer     8 bits
+ *      program         10 bits
+ *      texture set     12 bits
+ *      mesh            16 bits
+ *      depth           18 bits
+ * Each state field is a dense id assigned in submission order, and depth is
+ * the item depth in [0,1] quantized, so items are drawn front to back within
+ * each state. The keys are sorted with a least significant digit radix sort,
+ * skipping the digits shared by all keys.
+ *
+ * The instance attribute locations are cached by program and mesh name, and
+ * the cache is cleared when a program object is destroyed, since GL recycles
+ * program names.
+ *
+ * @note The queue points the instance attributes of the mesh vertex arrays
+ * to its own instance buffer. A mesh drawn by the queue should not use
+ * Mesh::SetInstances.
+ */
+struct RenderQueue {
+    static const size_t kMaxTextures = 4;
+    typedef std::array<GLuint, kMaxTextures> Textures;
+
+    /** Draw item of a frame. */
+    struct Item {
+        const Mesh *mesh;               /* mesh to draw */
+        GLuint framebuffer;             /* framebuffer to draw into */
+        GLuint program;                 /* shader program object */
+        Textures textures;              /* 2d textures, 0 if unused */
+        Mesh::Instance instance;        /* instance transform and color */
+    };
+
+    std::vector<Item> items;            /* submitted items */
+    std::vector<uint64_t> keys;         /* item sort keys */
+    std::vector<uint32_t> order;        /* item indices in key order */
+    std::vector<uint64_t> sort_keys;    /* radix sort scratch buffers */
+    std::vector<uint64_t> swap_keys;
+    std::vector<uint32_t> sort_order;
+    std::vector<Mesh::Instance> instances;  /* instances in key order */
+
+    /* Dense ids of each state in the current frame. */
+    std::unordered_map<GLuint, uint64_t> framebuffer_ids;
+    std::unordered_map<GLuint, uint64_t> program_ids;
+    std::map<Textures, uint64_t> texture_ids;
+    std::unordered_map<const Mesh *, uint64_t> mesh_ids;
+
+    /* Instance attribute locations of each program and mesh name. */
+    std::map<std::pair<GLuint, std::string>, std::pair<GLint, GLint>> locations;
+    size_t program_epoch;               /* program epoch of the locations */
+
+    GLuint ibo;                         /* instance buffer object */
+    size_t n_draws;                     /* draw calls of the last Execute */
+
+    /* Render queue factory functions */
+    static RenderQueue Create(void);
+    static void Destroy(RenderQueue &queue);
+
+    /** Submit a draw item to the queue. */
+    static void Submit(
+        RenderQueue &queue,
+        const Mesh &mesh,
+        const GLuint program,
+        const std::vector<GLuint> &textures,
+        const Mesh::Instance &instance,
+        const GLfloat depth,
+        const GLuint framebuffer = 0);
+
+    /** Sort, merge and draw the submitted items, and clear the queue. */
+    static void Execute(RenderQueue &queue);
+    static void Clear(RenderQueue &queue);
+
+    /** Sort the key indices in ascending key order. */
+    static void RadixSort(
+        const std::vector<uint64_t> &keys,
+        std::vector<uint32_t> &order,
+        std::vector<uint64_t> &sort_keys,
+        std::vector<uint64_t> &swap_keys,
+        std::vector<uint32_t> &sort_order);
+};
+
+} /* gl */
+} /* ito */
+
+#endif /* ITO_OPENGL_RENDERQUEUE_H_ */
@@ -0,0 +1,461 @@
+/*
+ * state.cpp
+ *
+ * Copyright (c) 2020 Carlos Braga
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the MIT License.
+ *
+ * See accompanying LICENSE.md or https://opensource.org/licenses/MIT.
+ */
+
+#include <cstdint>
+#include <unordered_map>
+#include "state.hpp"
+
+namespace ito {
+namespace gl {
+
+/** ---------------------------------------------------------------------------
+ * @brief Shadow state of the current context. Each state entry is keyed by
+ * its kind, texture unit and target, and absent entries are unknown.
+ */
+enum : uint64_t {
+    kProgram = 1,
+    kVertexArray,
+    kBuffer,
+    kActiveTexture,
+    kTexture,
+    kFramebuffer,
+    kCapability,
+    kBlendFunc,
+    kDepthFunc,
+    kDepthMask,
+};
+
+static std::unordered_map<uint64_t, uint64_t> gState;
+static StateCounters gCounters = {0, 0};
+static bool gValidation = false;
+static GLuint gDefaultFramebuffer = 0;
+static size_t gProgramEpoch = 0;
+
+/**
+ * @brief Return the key of a state entry.
+ */
+static uint64_t Key(
+    const uint64_t kind,
+    const uint64_t target = 0,
+    const uint64_t unit = 0)
+{
+    return (kind << 56) | (unit << 32) | target;
+}
+
+/**
+ * @brief Return the kind of a state entry key.
+ */
+static uint64_t Kind(const uint64_t key)
+{
+    return key >> 56;
+}
+
+/**
+ * @brief Update the shadow state entry with the value. Return false if the
+ * entry already holds the value and the state change can be elided.
+ */
+static bool Update(const uint64_t key, const uint64_t value)
+{
+    auto it = gState.find(key);
+    if (it != gState.end() && it->second == value) {
+        gCounters.n_elided++;
+        return false;
+    }
+    gState[key] = value;
+    gCounters.n_calls++;
+    return true;
+}
+
+/**
+ * @brief Validate the shadow state if validation is enabled.
+ */
+static void Validate(void)
+{
+    if (gValidation) {
+        ito_assert(ValidateState(), "render state cache is out of sync");
+    }
+}
+
+/** ---------------------------------------------------------------------------
+ * @brief Install the program object as part of the current rendering state.
+ */
+void UseProgram(const GLuint program)
+{
+    if (Update(Key(kProgram), program)) {
+        glUseProgram(program);
+        Validate();
+    }
+}
+
+/**
+ * @brief Bind the vertex array object. The element array buffer binding is
+ * part of the vertex array state and is forgotten when the array changes.
+ */
+void BindVertexArray(const GLuint array)
+{
+    if (Update(Key(kVertexArray), array)) {
+        glBindVertexArray(array);
+        gState.erase(Key(kBuffer, GL_ELEMENT_ARRAY_BUFFER));
+        Validate();
+    }
+}
+
+/**
+ * @brief Bind the buffer object to the target.
+ */
+void BindBuffer(const GLenum target, const GLuint buffer)
+{
+    if (Update(Key(kBuffer, target), buffer)) {
+        glBindBuffer(target, buffer);
+        Validate();
+    }
+}
+
+/**
+ * @brief Select the active texture unit, GL_TEXTURE0 + i.
+ */
+void ActiveTexture(const GLenum texunit)
+{
+    if (Update(Key(kActiveTexture), texunit)) {
+        glActiveTexture(texunit);
+        Validate();
+    }
+}
+
+/**
+ * @brief Bind the texture to the target of the active texture unit. Texture
+ * bindings are only shadowed if the active texture unit is known.
+ */
+void BindTexture(const GLenum target, const GLuint texture)
+{
+    auto it = gState.find(Key(kActiveTexture));
+    if (it == gState.end()) {
+        gCounters.n_calls++;
+        glBindTexture(target, texture);
+        return;
+    }
+
+    if (Update(Key(kTexture, target, it->second), texture)) {
+        glBindTexture(target, texture);
+        Validate();
+    }
+}
+
+/**
+ * @brief Bind the framebuffer to the target. GL_FRAMEBUFFER binds both the
+ * draw and read framebuffers. The name 0 binds the default framebuffer.
+ */
+void BindFramebuffer(const GLenum target, const GLuint name)
+{
+    GLuint framebuffer = (name == 0) ? gDefaultFramebuffer : name;
+    bool is_changed = false;
+    if (target == GL_FRAMEBUFFER) {
+        is_changed |= Update(Key(kFramebuffer, GL_DRAW_FRAMEBUFFER), framebuffer);
+        is_changed |= Update(Key(kFramebuffer, GL_READ_FRAMEBUFFER), framebuffer);
+    } else {
+        is_changed = Update(Key(kFramebuffer, target), framebuffer);
+    }
+
+    if (is_changed) {
+        glBindFramebuffer(target, framebuffer);
+        Validate();
+    }
+}
+
+/**
+ * @brief Set the framebuffer object bound in place of the window framebuffer,
+ * or 0 to restore the window framebuffer. The framebuffer bindings are
+ * forgotten and set again by the next BindFramebuffer.
+ */
+void SetDefaultFramebuffer(const GLuint framebuffer)
+{
+    for (auto it = gState.begin(); it != gState.end(); ) {
+        if (Kind(it->first) == kFramebuffer) {
+            it = gState.erase(it);
+        } else {
+            ++it;
+        }
+    }
+    gDefaultFramebuffer = framebuffer;
+}
+
+GLuint GetDefaultFramebuffer(void)
+{
+    return gDefaultFramebuffer;
+}
+
+/**
+ * @brief Return the framebuffer object bound to the target, eg to restore it
+ * after binding a framebuffer temporarily.
+ */
+GLuint GetFramebufferBinding(const GLenum target)
+{
+    GLenum binding_target = (target == GL_READ_FRAMEBUFFER)
+        ? GL_READ_FRAMEBUFFER
+        : GL_DRAW_FRAMEBUFFER;
+    auto it = gState.find(Key(kFramebuffer, binding_target));
+    if (it != gState.end()) {
+        return (GLuint) it->second;
+    }
+
+    GLint framebuffer = 0;
+    glGetIntegerv(
+        (binding_target == GL_READ_FRAMEBUFFER)
+            ? GL_READ_FRAMEBUFFER_BINDING
+            : GL_DRAW_FRAMEBUFFER_BINDING,
+        &framebuffer);
+    return (GLuint) framebuffer;
+}
+
+/**
+ * @brief Enable or disable a server-side capability, eg GL_BLEND.
+ */
+void Enable(const GLenum cap)
+{
+    if (Update(Key(kCapability, cap), GL_TRUE)) {
+        glEnable(cap);
+        Validate();
+    }
+}
+
+void Disable(const GLenum cap)
+{
+    if (Update(Key(kCapability, cap), GL_FALSE)) {
+        glDisable(cap);
+        Validate();
+    }
+}
+
+/**
+ * @brief Specify the source and destination blend factors.
+ */
+void BlendFunc(const GLenum sfactor, const GLenum dfactor)
+{
+    if (Update(Key(kBlendFunc), ((uint64_t) sfactor << 32) | dfactor)) {
+        glBlendFunc(sfactor, dfactor);
+        Validate();
+    }
+}
+
+/**
+ * @brief Specify the depth comparison function and the depth write mask.
+ */
+void DepthFunc(const GLenum func)
+{
+    if (Update(Key(kDepthFunc), func)) {
+        glDepthFunc(func);
+        Validate();
+    }
+}
+
+void DepthMask(const GLboolean flag)
+{
+    if (Update(Key(kDepthMask), flag)) {
+        glDepthMask(flag);
+        Validate();
+    }
+}
+
+/** ---------------------------------------------------------------------------
+ * @brief Forget the shadow state.
+ */
+void InvalidateState(void)
+{
+    gState.clear();
+}
+
+/**
+ * @brief Forget the bindings to a deleted object name. Objects of different
+ * types may share the name, so all bindings to the name are forgotten.
+ */
+void InvalidateStateObject(const GLuint name)
+{
+    for (auto it = gState.begin(); it != gState.end(); ) {
+        uint64_t kind = Kind(it->first);
+        bool is_object =
+            kind == kProgram ||
+            kind == kVertexArray ||
+            kind == kBuffer ||
+            kind == kTexture ||
+            kind == kFramebuffer;
+        if (is_object && it->second == name) {
+            it = gState.erase(it);
+        } else {
+            ++it;
+        }
+    }
+}
+
+/**
+ * @brief Forget the bindings to a deleted program object name and increment
+ * the program epoch.
+ */
+void InvalidateProgram(const GLuint program)
+{
+    InvalidateStateObject(program);
+    gProgramEpoch++;
+}
+
+/**
+ * @brief Return the number of program objects destroyed so far.
+ */
+size_t GetProgramEpoch(void)
+{
+    return gProgramEpoch;
+}
+
+/**
+ * @brief Return the number of state changes issued and elided.
+ */
+StateCounters GetStateCounters(void)
+{
+    return gCounters;
+}
+
+void ResetStateCounters(void)
+{
+    gCounters = {0, 0};
+}
+
+/** ---------------------------------------------------------------------------
+ * @brief Return the glGet* parameter name of the binding to the buffer or
+ * texture target, or 0 if unknown.
+ */
+static GLenum BufferBinding(const GLenum target)
+{
+    switch (target) {
+    case GL_ARRAY_BUFFER:           return GL_ARRAY_BUFFER_BINDING;
+    case GL_ELEMENT_ARRAY_BUFFER:   return GL_ELEMENT_ARRAY_BUFFER_BINDING;
+    case GL_COPY_READ_BUFFER:       return GL_COPY_READ_BUFFER_BINDING;
+    case GL_COPY_WRITE_BUFFER:      return GL_COPY_WRITE_BUFFER_BINDING;
+    case GL_PIXEL_PACK_BUFFER:      return GL_PIXEL_PACK_BUFFER_BINDING;
+    case GL_PIXEL_UNPACK_BUFFER:    return GL_PIXEL_UNPACK_BUFFER_BINDING;
+    case GL_UNIFORM_BUFFER:         return GL_UNIFORM_BUFFER_BINDING;
+#if defined(GL_VERSION_4_3)
+    case GL_DRAW_INDIRECT_BUFFER:   return GL_DRAW_INDIRECT_BUFFER_BINDING;
+    case GL_SHADER_STORAGE_BUFFER:  return GL_SHADER_STORAGE_BUFFER_BINDING;
+#endif
+    default:
+        return 0;
+    }
+}
+
+static GLenum TextureBinding(const GLenum target)
+{
+    switch (target) {
+    case GL_TEXTURE_1D:             return GL_TEXTURE_BINDING_1D;
+    case GL_TEXTURE_2D:             return GL_TEXTURE_BINDING_2D;
+    case GL_TEXTURE_3D:             return GL_TEXTURE_BINDING_3D;
+    case GL_TEXTURE_2D_ARRAY:       return GL_TEXTURE_BINDING_2D_ARRAY;
+    case GL_TEXTURE_CUBE_MAP:       return GL_TEXTURE_BINDING_CUBE_MAP;
+    case GL_TEXTURE_RECTANGLE:      return GL_TEXTURE_BINDING_RECTANGLE;
+    case GL_TEXTURE_BUFFER:         return GL_TEXTURE_BINDING_BUFFER;
+    default:
+        return 0;
+    }
+}
+
+/**
+ * @brief Query the integer state parameter.
+ */
+static uint64_t GetInteger(const GLenum pname)
+{
+    GLint value = 0;
+    glGetIntegerv(pname, &value);
+    return static_cast<GLuint>(value);
+}
+
+/**
+ * @brief Validate the shadow state against the state queried with glGet*.
+ */
+bool ValidateState(void)
+{
+    GLint active_texture = 0;
+    glGetIntegerv(GL_ACTIVE_TEXTURE, &active_texture);
+
+    bool is_valid = true;
+    for (auto &entry : gState) {
+        uint64_t kind = Kind(entry.first);
+        GLenum target = static_cast<GLenum>(entry.first & 0xffffffff);
+        GLenum unit = static_cast<GLenum>((entry.first >> 32) & 0xffffff);
+
+        uint64_t value = entry.second;
+        switch (kind) {
+        case kProgram:
+            value = GetInteger(GL_CURRENT_PROGRAM);
+            break;
+        case kVertexArray:
+            value = GetInteger(GL_VERTEX_ARRAY_BINDING);
+            break;
+        case kBuffer:
+            if (BufferBinding(target) != 0) {
+                value = GetInteger(BufferBinding(target));
+            }
+            break;
+        case kActiveTexture:
+            value = static_cast<GLuint>(active_texture);
+            break;
+        case kTexture:
+            if (TextureBinding(target) != 0) {
+                glActiveTexture(unit);
+                value = GetInteger(TextureBinding(target));
+                glActiveTexture(active_texture);
+            }
+            break;
+        case kFramebuffer:
+            value = GetInteger(target == GL_DRAW_FRAMEBUFFER
+                ? GL_DRAW_FRAMEBUFFER_BINDING
+                : GL_READ_FRAMEBUFFER_BINDING);
+            break;
+        case kCapability:
+            value = glIsEnabled(target);
+            break;
+        case kBlendFunc:
+            value = (GetInteger(GL_BLEND_SRC_RGB) << 32) |
+                GetInteger(GL_BLEND_DST_RGB);
+            break;
+        case kDepthFunc:
+            value = GetInteger(GL_DEPTH_FUNC);
+            break;
+        case kDepthMask:
+            {
+                GLboolean mask;
+                glGetBooleanv(GL_DEPTH_WRITEMASK, &mask);
+                value = mask;
+            }
+            break;
+        }
+
+        if (value != entry.second) {
+            std::cerr << ito::str::format(
+                "render state mismatch: kind %lu target 0x%x, "
+                "shadow %lu, actual %lu\n",
+                (unsigned long) kind,
+                target,
+                (unsigned long) entry.second,
+                (unsigned long) value);
+            is_valid = false;
+        }
+    }
+
+    return is_valid;
+}
+
+/**
+ * @brief Enable validation of the shadow state after every state change.
+ */
+void EnableStateValidation(const bool enable)
+{
+    gValidation = enable;
+}
+
+} /* gl */
+} /* ito */
@@ -0,0 +1,96 @@
+/*
+ * state.hpp
+ *
+ * Copyright (c) 2020 Carlos Braga
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the MIT License.
+ *
+ * See accompanying LICENSE.md or https://opensource.org/licenses/MIT.
+ */
+
+#ifndef ITO_OPENGL_STATE_H_
+#define ITO_OPENGL_STATE_H_
+
+#include "base.hpp"
+
+namespace ito {
+namespace gl {
+
+/**
+ * @brief Render state cache. The functions below shadow the bound program,
+ * vertex array, buffers, textures and framebuffers, and the blend and depth
+ * state of the current context, and skip the GL call if the state is already
+ * set. Unknown state is always set.
+ *
+ * The shadow state is only valid if the state is changed exclusively through
+ * these functions. Call InvalidateState after changing the state directly,
+ * eg in third party code, to forget the shadow state.
+ *
+ * @note The element array buffer binding is part of the vertex array object
+ * state, and is forgotten when the bound vertex array changes. Deleting an
+ * object with the Destroy* functions forgets any binding to its name.
+ */
+void UseProgram(const GLuint program);
+void BindVertexArray(const GLuint array);
+void BindBuffer(const GLenum target, const GLuint buffer);
+void ActiveTexture(const GLenum texunit);
+void BindTexture(const GLenum target, const GLuint texture);
+void BindFramebuffer(const GLenum target, const GLuint framebuffer);
+void Enable(const GLenum cap);
+void Disable(const GLenum cap);
+void BlendFunc(const GLenum sfactor, const GLenum dfactor);
+void DepthFunc(const GLenum func);
+void DepthMask(const GLboolean flag);
+
+/**
+ * @brief Set the framebuffer object bound by BindFramebuffer in place of the
+ * default framebuffer, name 0, eg in a headless context without a window
+ * surface, and return the default framebuffer object.
+ */
+void SetDefaultFramebuffer(const GLuint framebuffer);
+GLuint GetDefaultFramebuffer(void);
+
+/**
+ * @brief Return the framebuffer object bound to the draw or read target, from
+ * the shadow state, or queried with glGet* if unknown. GL_FRAMEBUFFER returns
+ * the draw framebuffer binding.
+ */
+GLuint GetFramebufferBinding(const GLenum target);
+
+/**
+ * @brief Forget the shadow state, or the bindings to a deleted object name.
+ */
+void InvalidateState(void);
+void InvalidateStateObject(const GLuint name);
+
+/**
+ * @brief Forget the bindings to a deleted program object and increment the
+ * program epoch. GL recycles program names, so caches keyed by program name
+ * are cleared when the epoch differs from the one they were filled in.
+ */
+void InvalidateProgram(const GLuint program);
+size_t GetProgramEpoch(void);
+
+/**
+ * @brief Number of state changes issued and elided by the render state cache.
+ */
+struct StateCounters {
+    size_t n_calls;
+    size_t n_elided;
+};
+StateCounters GetStateCounters(void);
+void ResetStateCounters(void);
+
+/**
+ * @brief Validate the shadow state against the state queried with glGet*.
+ * With validation enabled, the shadow state is validated after every state
+ * change, which is slow and only meant for debugging.
+ */
+bool ValidateState(void);
+void EnableStateValidation(const bool enable);
+
+} /* gl */
+} /* ito */
+
+#endif /* ITO_OPENGL_STATE_H_ */
@@ -0,0 +1,207 @@
+/*
+ * streambuffer.cpp
+ *
+ * Copyright (c) 2020 Carlos Braga
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the MIT License.
+ *
+ * See accompanying LICENSE.md or https://opensource.org/licenses/MIT.
+ */
+
+#include <algorithm>
+#include <cstring>
+#include "buffer.hpp"
+#include "state.hpp"
+#include "streambuffer.hpp"
+
+namespace ito {
+namespace gl {
+
+/** ---------------------------------------------------------------------------
+ * @brief Create a stream buffer with n_regions regions of size bytes each,
+ * or with a single region if immutable buffer storage is not supported.
+ * The data store is written through the copy write target, so an element
+ * buffer never changes the vertex array object bound by the caller.
+ */
+StreamBuffer StreamBuffer::Create(
+    const GLenum target,
+    const GLsizeiptr size,
+    const size_t n_regions)
+{
+    ito_assert(size > 0, "invalid stream buffer size");
+    ito_assert(n_regions > 0, "invalid number of regions");
+
+    StreamBuffer stream;
+    stream.target = target;
+    stream.size = size;
+    stream.is_persistent = IsPersistentSupported();
+    stream.host_ptr = NULL;
+
+    size_t n = stream.is_persistent ? n_regions : 1;
+    if (stream.is_persistent) {
+#if defined(GL_VERSION_4_4) || defined(GL_ARB_buffer_storage)
+        const GLbitfield flags =
+            GL_MAP_WRITE_BIT | GL_MAP_PERSISTENT_BIT | GL_MAP_COHERENT_BIT;
+        glGenBuffers(1, &stream.buffer);
+        BindBuffer(GL_COPY_WRITE_BUFFER, stream.buffer);
+        glBufferStorage(GL_COPY_WRITE_BUFFER, n * size, NULL, flags);
+        stream.host_ptr = static_cast<GLubyte *>(
+            glMapBufferRange(GL_COPY_WRITE_BUFFER, 0, n * size, flags));
+        ito_assert(stream.host_ptr != NULL, "glMapBufferRange");
+        BindBuffer(GL_COPY_WRITE_BUFFER, 0);
+#endif
+    } else {
+        stream.buffer = CreateBuffer(target, size, GL_STREAM_DRAW);
+    }
+
+    /* Every region is dirty until it is first written. */
+    stream.head = 0;
+    stream.tail = n;
+    stream.fences.resize(n, NULL);
+    stream.dirty_lo.resize(n, 0);
+    stream.dirty_hi.resize(n, size);
+    return stream;
+}
+
+/**
+ * @brief Delete the region fences, unmap and delete the buffer object.
+ */
+void StreamBuffer::Destroy(StreamBuffer &stream)
+{
+    for (auto &fence : stream.fences) {
+        if (fence != NULL) {
+            glDeleteSync(fence);
+            fence = NULL;
+        }
+    }
+
+    if (stream.is_persistent) {
+        BindBuffer(GL_COPY_WRITE_BUFFER, stream.buffer);
+        glUnmapBuffer(GL_COPY_WRITE_BUFFER);
+        BindBuffer(GL_COPY_WRITE_BUFFER, 0);
+        stream.host_ptr = NULL;
+    }
+
+    DestroyBuffer(stream.buffer);
+    stream.fences.clear();
+    stream.dirty_lo.clear();
+    stream.dirty_hi.clear();
+}
+
+/** ---------------------------------------------------------------------------
+ * @brief Mark a byte range of the host array as changed in every region.
+ */
+void StreamBuffer::Invalidate(
+    StreamBuffer &stream,
+    const GLintptr offset,
+    const GLsizeiptr size)
+{
+    ito_assert(offset >= 0 && offset + size <= stream.size, "invalid range");
+    if (size == 0) {
+        return;
+    }
+
+    for (size_t i = 0; i < stream.fences.size(); ++i) {
+        if (stream.dirty_lo[i] < stream.dirty_hi[i]) {
+            stream.dirty_lo[i] = std::min(stream.dirty_lo[i], offset);
+            stream.dirty_hi[i] = std::max(stream.dirty_hi[i], offset + size);
+        } else {
+            stream.dirty_lo[i] = offset;
+            stream.dirty_hi[i] = offset + size;
+        }
+    }
+}
+
+/**
+ * @brief Copy the changed ranges of the host array into the next region.
+ *
+ * The draw calls issued since the previous update have read the last region
+ * written, so it is fenced here. The next region is only waited on when its
+ * fence, set when the ring last passed over it, has not been signaled yet.
+ */
+void StreamBuffer::Update(StreamBuffer &stream, const void *data)
+{
+    ito_assert(data != nullptr, "invalid stream buffer data");
+    const GLubyte *src = static_cast<const GLubyte *>(data);
+
+    /*
+     * Single region, orphan the data store if the whole region changed or
+     * write the changed range in place otherwise.
+     */
+    if (!stream.is_persistent) {
+        GLintptr lo = stream.dirty_lo[0];
+        GLintptr hi = stream.dirty_hi[0];
+        if (lo < hi) {
+            BindBuffer(GL_COPY_WRITE_BUFFER, stream.buffer);
+            if (lo == 0 && hi == stream.size) {
+                glBufferData(
+                    GL_COPY_WRITE_BUFFER, stream.size, NULL, GL_STREAM_DRAW);
+            }
+            glBufferSubData(GL_COPY_WRITE_BUFFER, lo, hi - lo, src + lo);
+        }
+        stream.dirty_lo[0] = stream.dirty_hi[0] = 0;
+        return;
+    }
+
+    /* Fence the region read by the draw calls since the last update. */
+    const size_t n_regions = stream.fences.size();
+    if (stream.tail < n_regions) {
+        GLsync &last = stream.fences[stream.tail];
+        if (last != NULL) {
+            glDeleteSync(last);
+        }
+        last = glFenceSync(GL_SYNC_GPU_COMMANDS_COMPLETE, 0);
+    }
+
+    /* Wait until the draw calls reading the next region have completed. */
+    GLsync &fence = stream.fences[stream.head];
+    if (fence != NULL) {
+        GLenum status = glClientWaitSync(
+            fence, GL_SYNC_FLUSH_COMMANDS_BIT, GL_TIMEOUT_IGNORED);
+        ito_assert(status != GL_WAIT_FAILED, "glClientWaitSync");
+        glDeleteSync(fence);
+        fence = NULL;
+    }
+
+    /* Copy the region dirty range through the coherent mapping. */
+    GLintptr lo = stream.dirty_lo[stream.head];
+    GLintptr hi = stream.dirty_hi[stream.head];
+    if (lo < hi) {
+        GLubyte *dst = stream.host_ptr + stream.head * stream.size;
+        std::memcpy(dst + lo, src + lo, hi - lo);
+    }
+    stream.dirty_lo[stream.head] = stream.dirty_hi[stream.head] = 0;
+
+    stream.tail = stream.head;
+    stream.head = (stream.head + 1) % n_regions;
+}
+
+/**
+ * @brief Return the byte offset of the region last written.
+ */
+GLintptr StreamBuffer::Offset(const StreamBuffer &stream)
+{
+    return (stream.tail < stream.fences.size()) ? stream.tail * stream.size : 0;
+}
+
+/**
+ * @brief Is immutable buffer storage supported by the current context?
+ */
+bool StreamBuffer::IsPersistentSupported(void)
+{
+#if defined(GL_VERSION_4_4)
+    if (GLAD_GL_VERSION_4_4) {
+        return true;
+    }
+#endif
+#if defined(GL_ARB_buffer_storage)
+    if (GLAD_GL_ARB_buffer_storage) {
+        return true;
+    }
+#endif
+    return false;
+}
+
+} /* gl */
+} /* ito */
@@ -0,0 +1,79 @@
+/*
+ * streambuffer.hpp
+ *
+ * Copyright (c) 2020 Carlos Braga
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the MIT License.
+ *
+ * See accompanying LICENSE.md or https://opensource.org/licenses/MIT.
+ */
+
+#ifndef ITO_OPENGL_STREAMBUFFER_H_
+#define ITO_OPENGL_STREAMBUFFER_H_
+
+#include <vector>
+#include "base.hpp"
+
+namespace ito {
+namespace gl {
+
+/**
+ * StreamBuffer
+ * @brief Buffer object mirroring a host array that changes every frame, eg
+ * the vertices of a dynamic mesh.
+ *
+ * Where immutable buffer storage is available (GL 4.4 or ARB_buffer_storage),
+ * the buffer holds n_regions copies of the host array and is mapped once with
+ * GL_MAP_PERSISTENT_BIT | GL_MAP_COHERENT_BIT. Each Update writes the next
+ * region with a memcpy, and draw calls read the region at Offset. Regions
+ * are fenced with glFenceSync, and the host only waits on a fence when the
+ * ring wraps around to a region still read by draw calls in flight.
+ *
+ * Otherwise, the buffer holds a single region. Updates of the whole region
+ * orphan the data store with glBufferData before writing it, and updates of
+ * a partial range use glBufferSubData.
+ *
+ * Only the ranges marked with Invalidate are copied. Each region keeps its
+ * own dirty range, since a range changed since the region was last written
+ * must be copied into it even if another region is already up to date.
+ */
+struct StreamBuffer {
+    GLenum target;                      /* buffer target binding point */
+    GLuint buffer;                      /* buffer object */
+    GLsizeiptr size;                    /* region size in bytes */
+    bool is_persistent;                 /* buffer is persistently mapped */
+    GLubyte *host_ptr;                  /* persistent mapping of the regions */
+    size_t head;                        /* next region to write */
+    size_t tail;                        /* last region written */
+    std::vector<GLsync> fences;         /* region fences */
+    std::vector<GLintptr> dirty_lo;     /* region dirty range lower bound */
+    std::vector<GLintptr> dirty_hi;     /* region dirty range upper bound */
+
+    /* Stream buffer factory functions */
+    static StreamBuffer Create(
+        const GLenum target,
+        const GLsizeiptr size,
+        const size_t n_regions = 3);
+    static void Destroy(StreamBuffer &stream);
+
+    /** Mark a byte range of the host array as changed. */
+    static void Invalidate(
+        StreamBuffer &stream,
+        const GLintptr offset,
+        const GLsizeiptr size);
+
+    /** Copy the changed ranges of the host array into the next region. */
+    static void Update(StreamBuffer &stream, const void *data);
+
+    /** Return the byte offset of the region last written. */
+    static GLintptr Offset(const StreamBuffer &stream);
+
+    /** Is immutable buffer storage supported by the current context? */
+    static bool IsPersistentSupported(void);
+};
+
+} /* gl */
+} /* ito */
+
+#endif /* ITO_OPENGL_STREAMBUFFER_H_ */
@@ -11,6 +11,7 @@
 
 #include "texture.hpp"
 #include "imageformat.hpp"
+#include "state.hpp"
 
 namespace ito {
 namespace gl {
@@ -50,7 +51,7 @@ GLuint CreateTexture1d(
     /* Generate a new texture object name and bind it to the target point. */
     GLuint texture;
     glGenTextures(1, &texture);
-    glBindTexture(GL_TEXTURE_1D, texture);
+    BindTexture(GL_TEXTURE_1D, texture);
     ito_assert(glIsTexture(texture), "failed to generate texture object");
 
     /*
@@ -68,7 +69,7 @@ GLuint CreateTexture1d(
         pixels);            /* pointer to the pixel data */
 
     /* Unbind the texture from the target point and return the handle. */
-    glBindTexture(GL_TEXTURE_1D, 0);
+    BindTexture(GL_TEXTURE_1D, 0);
     return texture;
 }
 
@@ -92,7 +93,7 @@ GLuint CreateTexture2d(
     /* Generate a new texture object name and bind it to the target point. */
     GLuint texture;
     glGenTextures(1, &texture);
-    glBindTexture(GL_TEXTURE_2D, texture);
+    BindTexture(GL_TEXTURE_2D, texture);
     ito_assert(glIsTexture(texture), "failed to generate texture object");
 
     /*
@@ -111,7 +112,7 @@ GLuint CreateTexture2d(
         pixels);            /* pointer to the pixel data */
 
     /* Unbind the texture from the target point and return the handle. */
-    glBindTexture(GL_TEXTURE_2D, 0);
+    BindTexture(GL_TEXTURE_2D, 0);
     return texture;
 }
 
@@ -137,7 +138,7 @@ GLuint CreateTexture3d(
     /* Generate a new texture object name and bind it to the target point. */
     GLuint texture;
     glGenTextures(1, &texture);
-    glBindTexture(GL_TEXTURE_3D, texture);
+    BindTexture(GL_TEXTURE_3D, texture);
     ito_assert(glIsTexture(texture), "failed to generate texture object");
 
     /*
@@ -157,7 +158,7 @@ GLuint CreateTexture3d(
         pixels);            /* pointer to the pixel data */
 
     /* Unbind the texture from the target point and return the handle. */
-    glBindTexture(GL_TEXTURE_3D, 0);
+    BindTexture(GL_TEXTURE_3D, 0);
     return texture;
 }
 
@@ -178,7 +179,7 @@ GLuint CreateTextureBuffer(GLint internalformat, GLuint buffer)
     /* Generate a new texture object name and bind it to GL_TEXTURE_BUFFER. */
     GLuint texture;
     glGenTextures(1, &texture);
-    glBindTexture(GL_TEXTURE_BUFFER, texture);
+    BindTexture(GL_TEXTURE_BUFFER, texture);
     ito_assert(glIsTexture(texture), "failed to generate texture object");
 
     /*
@@ -189,7 +190,7 @@ GLuint CreateTextureBuffer(GLint internalformat, GLuint buffer)
     glTexBuffer(GL_TEXTURE_BUFFER, internalformat, buffer);
 
     /* Unbind the texture from the target point and return the handle. */
-    glBindTexture(GL_TEXTURE_BUFFER, 0);
+    BindTexture(GL_TEXTURE_BUFFER, 0);
     return texture;
 }
 
@@ -198,6 +199,7 @@ GLuint CreateTextureBuffer(GLint internalformat, GLuint buffer)
  */
 void DestroyTexture(const GLuint &texture)
 {
+    InvalidateStateObject(texture);
     glDeleteTextures(1, &texture);
 }
 
@@ -433,8 +435,8 @@ void ActiveBindTexture(GLenum target, GLenum texunit, GLuint texture)
         target == GL_TEXTURE_2D ||
         target == GL_TEXTURE_3D,
         "invalid texture target");
-    glActiveTexture(GL_TEXTURE0 + texunit);
-    glBindTexture(target, texture);
+    ActiveTexture(GL_TEXTURE0 + texunit);
+    BindTexture(target, texture);
 }
 
 /**
@@ -449,8 +451,8 @@ void ActiveBindTextureBuffer(
     GLuint buffer)
 {
     ito_assert(target == GL_TEXTURE_BUFFER, "invalid texture buffer target");
-    glActiveTexture(GL_TEXTURE0 + texunit);
-    glBindTexture(target, texture);
+    ActiveTexture(GL_TEXTURE0 + texunit);
+    BindTexture(target, texture);
     glTexBuffer(target, internalformat, buffer);
 }
 
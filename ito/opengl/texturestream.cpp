@@ -0,0 +1,291 @@
+/*
+ * texturestream.cpp
+ *
+ * Copyright (c) 2020 Carlos Braga
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the MIT License.
+ *
+ * See accompanying LICENSE.md or https://opensource.org/licenses/MIT.
+ */
+
+#include <algorithm>
+#include <cstring>
+#include "buffer.hpp"
+#include "state.hpp"
+#include "texture.hpp"
+#include "texturestream.hpp"
+
+namespace ito {
+namespace gl {
+
+/** ---------------------------------------------------------------------------
+ * @brief Decode the queued image files until the stream is destroyed.
+ * A file that fails to load keeps the placeholder texture.
+ */
+static void DecodeWorker(std::shared_ptr<TextureStream::Shared> shared)
+{
+    while (true) {
+        std::pair<size_t, std::string> request;
+        {
+            std::unique_lock<std::mutex> lock(shared->mutex);
+            shared->cond.wait(lock, [&shared] () {
+                return shared->is_done || !shared->requests.empty();
+            });
+            if (shared->is_done) {
+                return;
+            }
+            request = shared->requests.front();
+            shared->requests.pop_front();
+        }
+
+        TextureStream::Upload upload;
+        upload.id = request.first;
+        upload.texture = 0;
+        upload.row = 0;
+        try {
+            upload.image = Image::Load(
+                request.second, shared->flip_vertically, 4);
+        } catch (std::exception &e) {
+            std::cerr << ito::str::format(
+                "failed to decode %s: %s\n", request.second.c_str(), e.what());
+            continue;
+        }
+
+        std::lock_guard<std::mutex> lock(shared->mutex);
+        shared->decoded.push_back(std::move(upload));
+    }
+}
+
+/** ---------------------------------------------------------------------------
+ * @brief Create a texture stream uploading up to budget bytes per frame
+ * through a ring of n_buffers pixel unpack buffers, with n_workers decoding
+ * threads.
+ */
+TextureStream TextureStream::Create(
+    const GLsizeiptr budget,
+    const size_t n_workers,
+    const size_t n_buffers,
+    const bool flip_vertically)
+{
+    ito_assert(budget > 0, "invalid texture stream budget");
+    ito_assert(n_workers > 0, "invalid number of workers");
+    ito_assert(n_buffers > 0, "invalid number of buffers");
+
+    TextureStream stream;
+    stream.budget = budget;
+
+    /* Create a 2x2 checkerboard placeholder texture. */
+    const GLubyte checker[16] = {
+        160, 160, 160, 255,     96,  96,  96, 255,
+         96,  96,  96, 255,    160, 160, 160, 255};
+    BindBuffer(GL_PIXEL_UNPACK_BUFFER, 0);
+    stream.placeholder = CreateTexture2d(
+        GL_RGBA8, 2, 2, GL_RGBA, GL_UNSIGNED_BYTE, checker);
+    BindTexture(GL_TEXTURE_2D, stream.placeholder);
+    SetTextureWrap(GL_TEXTURE_2D, GL_REPEAT, GL_REPEAT);
+    SetTextureFilter(GL_TEXTURE_2D, GL_NEAREST, GL_NEAREST);
+    BindTexture(GL_TEXTURE_2D, 0);
+
+    /* Create the unpack buffer ring, each buffer holding one chunk. */
+    for (size_t i = 0; i < n_buffers; ++i) {
+        stream.buffers.push_back(CreateBuffer(
+            GL_PIXEL_UNPACK_BUFFER,
+            budget,
+            GL_STREAM_DRAW));
+    }
+    stream.capacity.resize(n_buffers, budget);
+    stream.fences.resize(n_buffers, NULL);
+    stream.head = 0;
+
+    /* Start the decoding threads. */
+    stream.shared = std::make_shared<Shared>();
+    stream.shared->flip_vertically = flip_vertically;
+    stream.shared->is_done = false;
+    for (size_t i = 0; i < n_workers; ++i) {
+        stream.workers.emplace_back(DecodeWorker, stream.shared);
+    }
+
+    return stream;
+}
+
+/**
+ * @brief Stop the decoding threads and delete the textures, the unpack
+ * buffers and their fences.
+ */
+void TextureStream::Destroy(TextureStream &stream)
+{
+    {
+        std::lock_guard<std::mutex> lock(stream.shared->mutex);
+        stream.shared->is_done = true;
+        stream.shared->requests.clear();
+    }
+    stream.shared->cond.notify_all();
+    for (auto &worker : stream.workers) {
+        worker.join();
+    }
+    stream.workers.clear();
+
+    for (auto &fence : stream.fences) {
+        if (fence != NULL) {
+            glDeleteSync(fence);
+            fence = NULL;
+        }
+    }
+    for (auto &buffer : stream.buffers) {
+        DestroyBuffer(buffer);
+    }
+    stream.buffers.clear();
+
+    for (auto &upload : stream.uploads) {
+        if (upload.texture != 0) {
+            DestroyTexture(upload.texture);
+        }
+    }
+    stream.uploads.clear();
+    for (auto &entry : stream.entries) {
+        if (entry.texture != 0) {
+            DestroyTexture(entry.texture);
+        }
+    }
+    stream.entries.clear();
+    DestroyTexture(stream.placeholder);
+}
+
+/** ---------------------------------------------------------------------------
+ * @brief Queue an image file for decoding and return its texture id.
+ */
+size_t TextureStream::Load(TextureStream &stream, const std::string &filename)
+{
+    size_t id = stream.entries.size();
+    stream.entries.push_back({0, false});
+    {
+        std::lock_guard<std::mutex> lock(stream.shared->mutex);
+        stream.shared->requests.emplace_back(id, filename);
+    }
+    stream.shared->cond.notify_one();
+    return id;
+}
+
+/**
+ * @brief Upload the decoded images, in decoding order, up to the per frame
+ * byte budget. Each chunk of rows is copied into the next unpack buffer of
+ * the ring and uploaded from it with glTexSubImage2D. At least one row is
+ * uploaded per frame, so rows larger than the budget still progress. At most
+ * one chunk per unpack buffer is uploaded per frame, so the ring never wraps
+ * around to a buffer fenced in the same frame.
+ */
+void TextureStream::Update(TextureStream &stream)
+{
+    {
+        std::lock_guard<std::mutex> lock(stream.shared->mutex);
+        while (!stream.shared->decoded.empty()) {
+            stream.uploads.push_back(std::move(stream.shared->decoded.front()));
+            stream.shared->decoded.pop_front();
+        }
+    }
+
+    GLsizeiptr remaining = stream.budget;
+    size_t n_chunks = 0;
+    while (!stream.uploads.empty() &&
+           remaining > 0 &&
+           n_chunks < stream.buffers.size()) {
+        Upload &upload = stream.uploads.front();
+        const Image &image = upload.image;
+
+        /* Allocate the texture storage without pixel data. */
+        if (upload.texture == 0) {
+            BindBuffer(GL_PIXEL_UNPACK_BUFFER, 0);
+            upload.texture = CreateTexture2d(
+                GL_RGBA8,
+                image.width,
+                image.height,
+                image.format,
+                GL_UNSIGNED_BYTE,
+                NULL);
+        }
+
+        /* Wait until the upload reading the next unpack buffer completes. */
+        GLsync &fence = stream.fences[stream.head];
+        if (fence != NULL) {
+            GLenum status = glClientWaitSync(
+                fence, GL_SYNC_FLUSH_COMMANDS_BIT, GL_TIMEOUT_IGNORED);
+            ito_assert(status != GL_WAIT_FAILED, "glClientWaitSync");
+            glDeleteSync(fence);
+            fence = NULL;
+        }
+
+        /* Copy the chunk of rows into the unpack buffer. */
+        uint32_t n_rows = std::max<GLsizeiptr>(1, remaining / image.pitch);
+        n_rows = std::min(n_rows, image.height - upload.row);
+        GLsizeiptr size = n_rows * image.pitch;
+
+        BindBuffer(GL_PIXEL_UNPACK_BUFFER, stream.buffers[stream.head]);
+        if (stream.capacity[stream.head] < size) {
+            glBufferData(GL_PIXEL_UNPACK_BUFFER, size, NULL, GL_STREAM_DRAW);
+            stream.capacity[stream.head] = size;
+        }
+        GLvoid *dst = glMapBufferRange(
+            GL_PIXEL_UNPACK_BUFFER,
+            0,
+            size,
+            GL_MAP_WRITE_BIT | GL_MAP_INVALIDATE_RANGE_BIT);
+        ito_assert(dst != NULL, "glMapBufferRange");
+        std::memcpy(dst, &image.bitmap[upload.row * image.pitch], size);
+        glUnmapBuffer(GL_PIXEL_UNPACK_BUFFER);
+
+        /* Upload the rows from the unpack buffer and fence it. */
+        BindTexture(GL_TEXTURE_2D, upload.texture);
+        glPixelStorei(GL_UNPACK_ALIGNMENT, 4);
+        glTexSubImage2D(
+            GL_TEXTURE_2D,
+            0,                      /* level of detail */
+            0,                      /* x offset */
+            upload.row,             /* y offset */
+            image.width,            /* width */
+            n_rows,                 /* height */
+            image.format,           /* format of the pixel data */
+            GL_UNSIGNED_BYTE,       /* type of the pixel data */
+            (GLvoid *) 0);          /* offset in the unpack buffer */
+        fence = glFenceSync(GL_SYNC_GPU_COMMANDS_COMPLETE, 0);
+        stream.head = (stream.head + 1) % stream.buffers.size();
+
+        upload.row += n_rows;
+        remaining -= size;
+        n_chunks++;
+
+        /* Generate the mipmaps and publish the texture once complete. */
+        if (upload.row == image.height) {
+            SetTextureMipmap(GL_TEXTURE_2D);
+            SetTextureWrap(GL_TEXTURE_2D, GL_CLAMP_TO_EDGE, GL_CLAMP_TO_EDGE);
+            SetTextureFilter(
+                GL_TEXTURE_2D, GL_LINEAR_MIPMAP_LINEAR, GL_LINEAR);
+            stream.entries[upload.id] = {upload.texture, true};
+            stream.uploads.pop_front();
+        }
+    }
+
+    /* Client memory pixel transfers need the unpack buffer unbound. */
+    BindBuffer(GL_PIXEL_UNPACK_BUFFER, 0);
+    BindTexture(GL_TEXTURE_2D, 0);
+}
+
+/** ---------------------------------------------------------------------------
+ * @brief Return the texture with the id, or the placeholder if the upload is
+ * not complete.
+ */
+GLuint TextureStream::Texture(const TextureStream &stream, const size_t id)
+{
+    ito_assert(id < stream.entries.size(), "invalid texture id");
+    const Entry &entry = stream.entries[id];
+    return entry.is_ready ? entry.texture : stream.placeholder;
+}
+
+bool TextureStream::IsReady(const TextureStream &stream, const size_t id)
+{
+    ito_assert(id < stream.entries.size(), "invalid texture id");
+    return stream.entries[id].is_ready;
+}
+
+} /* gl */
+} /* ito */
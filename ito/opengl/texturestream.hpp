@@ -0,0 +1,107 @@
+/*
+ * texturestream.hpp
+ *
+ * Copyright (c) 2020 Carlos Braga
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the MIT License.
+ *
+ * See accompanying LICENSE.md or https://opensource.org/licenses/MIT.
+ */
+
+#ifndef ITO_OPENGL_TEXTURESTREAM_H_
+#define ITO_OPENGL_TEXTURESTREAM_H_
+
+#include <condition_variable>
+#include <deque>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+#include "base.hpp"
+#include "image.hpp"
+
+namespace ito {
+namespace gl {
+
+/**
+ * @brief TextureStream loads 2d textures from image files without blocking
+ * the render thread.
+ *
+ * Load queues an image file and returns a texture id. Worker threads decode
+ * the queued files with Image::Load. Update, called once per frame on the
+ * render thread, uploads the decoded images in chunks of rows through a ring
+ * of GL_PIXEL_UNPACK_BUFFER buffer objects, up to a byte budget and one chunk
+ * per ring buffer per frame, so a large image is spread across several
+ * frames. Each ring buffer is fenced after its glTexSubImage2D, and only
+ * waited on when the ring wraps around to a buffer fenced in an earlier
+ * frame.
+ *
+ * Texture returns a placeholder texture until the upload of the image, and
+ * its mipmaps, is complete. Complete textures are sampled with trilinear
+ * filtering. The stream owns the textures it loads and
+ * deletes them in Destroy.
+ *
+ * Images are decoded with 4 channels and uploaded as GL_RGBA8 textures.
+ */
+struct TextureStream {
+    /** Texture loaded by the stream. */
+    struct Entry {
+        GLuint texture;                 /* texture object, 0 until uploaded */
+        bool is_ready;                  /* upload is complete */
+    };
+
+    /** Decoded image waiting for upload, or being uploaded. */
+    struct Upload {
+        size_t id;                      /* texture id */
+        Image image;                    /* decoded image */
+        GLuint texture;                 /* texture object */
+        uint32_t row;                   /* next row to upload */
+    };
+
+    /** Work shared with the decoding threads. */
+    struct Shared {
+        std::mutex mutex;
+        std::condition_variable cond;
+        std::deque<std::pair<size_t, std::string>> requests;
+        std::deque<Upload> decoded;
+        bool flip_vertically;
+        bool is_done;
+    };
+
+    std::vector<Entry> entries;         /* loaded textures */
+    std::deque<Upload> uploads;         /* decoded images in upload order */
+    std::shared_ptr<Shared> shared;     /* decoding work queues */
+    std::vector<std::thread> workers;   /* decoding threads */
+
+    GLuint placeholder;                 /* placeholder texture */
+    GLsizeiptr budget;                  /* upload bytes per frame */
+    std::vector<GLuint> buffers;        /* pixel unpack buffer objects */
+    std::vector<GLsizeiptr> capacity;   /* unpack buffer sizes */
+    std::vector<GLsync> fences;         /* unpack buffer fences */
+    size_t head;                        /* next unpack buffer */
+
+    /* Texture stream factory functions */
+    static TextureStream Create(
+        const GLsizeiptr budget,
+        const size_t n_workers = 2,
+        const size_t n_buffers = 3,
+        const bool flip_vertically = true);
+    static void Destroy(TextureStream &stream);
+
+    /** Queue an image file and return its texture id. */
+    static size_t Load(TextureStream &stream, const std::string &filename);
+
+    /** Upload the decoded images up to the per frame byte budget. */
+    static void Update(TextureStream &stream);
+
+    /** Return the texture with the id, or the placeholder if not ready. */
+    static GLuint Texture(const TextureStream &stream, const size_t id);
+    static bool IsReady(const TextureStream &stream, const size_t id);
+};
+
+} /* gl */
+} /* ito */
+
+#endif /* ITO_OPENGL_TEXTURESTREAM_H_ */
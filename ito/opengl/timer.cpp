@@ -0,0 +1,390 @@
+/*
+ * timer.cpp
+ *
+ * Copyright (c) 2020 Carlos Braga
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the MIT License.
+ *
+ * See accompanying LICENSE.md or https://opensource.org/licenses/MIT.
+ */
+
+#include <algorithm>
+#include <cmath>
+#include <sstream>
+#include "timer.hpp"
+
+namespace ito {
+namespace gl {
+
+/** ---------------------------------------------------------------------------
+ * @brief Write a timestamp query in the frame, from its query pool.
+ */
+static size_t WriteTimestamp(GpuTimer &timer, GpuTimer::Frame &frame)
+{
+    if (!timer.is_supported) {
+        return 0;
+    }
+    if (frame.n_queries == frame.queries.size()) {
+        GLuint query;
+        glGenQueries(1, &query);
+        frame.queries.push_back(query);
+    }
+    glQueryCounter(frame.queries[frame.n_queries], GL_TIMESTAMP);
+    return frame.n_queries++;
+}
+
+/**
+ * @brief Is the result of the last query of the frame available? Queries
+ * complete in order, so all results of the frame are then available.
+ */
+static bool IsAvailable(const GpuTimer &timer, const GpuTimer::Frame &frame)
+{
+    if (!timer.is_supported || frame.n_queries == 0) {
+        return true;
+    }
+    GLint available = 0;
+    glGetQueryObjectiv(
+        frame.queries[frame.n_queries - 1],
+        GL_QUERY_RESULT_AVAILABLE,
+        &available);
+    return available != 0;
+}
+
+/**
+ * @brief Read back the results of the frame and record the duration of each
+ * scope in its samples and in the trace events.
+ */
+static void Collect(GpuTimer &timer, GpuTimer::Frame &frame)
+{
+    std::vector<GLuint64> timestamps(frame.n_queries, 0);
+    for (size_t i = 0; i < frame.n_queries; ++i) {
+        glGetQueryObjectui64v(
+            frame.queries[i], GL_QUERY_RESULT, &timestamps[i]);
+    }
+
+    for (auto &scope : frame.scopes) {
+        double gpu_begin = 0.0;
+        double gpu_end = 0.0;
+        if (timer.is_supported) {
+            gpu_begin = 1.0e-9 * (double) timestamps[scope.begin];
+            gpu_end = 1.0e-9 * (double) timestamps[scope.end];
+        }
+
+        /* Find or add the samples of the scope path. */
+        auto it = std::find_if(
+            timer.samples.begin(),
+            timer.samples.end(),
+            [&scope] (const GpuTimer::Samples &samples) {
+                return samples.path == scope.path;
+            });
+        if (it == timer.samples.end()) {
+            GpuTimer::Samples samples;
+            samples.path = scope.path;
+            samples.depth = scope.depth;
+            samples.head = 0;
+            timer.samples.push_back(samples);
+            it = timer.samples.end() - 1;
+        }
+
+        double gpu = 1.0e3 * (gpu_end - gpu_begin);
+        double cpu = 1.0e3 * (scope.cpu_end - scope.cpu_begin);
+        if (it->gpu.size() < timer.n_samples) {
+            it->gpu.push_back(gpu);
+            it->cpu.push_back(cpu);
+        } else {
+            it->gpu[it->head] = gpu;
+            it->cpu[it->head] = cpu;
+        }
+        it->head = (it->head + 1) % timer.n_samples;
+
+        /* Record the cpu and gpu events on the cpu clock. */
+        std::string name = scope.path.substr(scope.path.rfind('/') + 1);
+        timer.events.push_back(
+            {name, 1.0e6 * scope.cpu_begin, 1.0e3 * cpu, 0});
+        if (timer.is_supported) {
+            timer.events.push_back(
+                {name, 1.0e6 * (gpu_begin - timer.gpu_offset), 1.0e3 * gpu, 1});
+        }
+        while (timer.events.size() > timer.n_events) {
+            timer.events.pop_front();
+        }
+    }
+    frame.is_pending = false;
+}
+
+/**
+ * @brief Return the mean and the 99th percentile of the samples.
+ */
+static void Percentiles(
+    const std::vector<double> &samples,
+    double &mean,
+    double &p99)
+{
+    mean = 0.0;
+    p99 = 0.0;
+    if (samples.empty()) {
+        return;
+    }
+    std::vector<double> sorted(samples);
+    std::sort(sorted.begin(), sorted.end());
+    for (auto &sample : sorted) {
+        mean += sample;
+    }
+    mean /= (double) sorted.size();
+    size_t rank = (size_t) std::ceil(0.99 * (double) sorted.size());
+    p99 = sorted[std::min(std::max<size_t>(rank, 1), sorted.size()) - 1];
+}
+
+/** ---------------------------------------------------------------------------
+ * @brief Create a gpu timer with results read back latency frames later,
+ * keeping n_samples durations of each scope and the last n_events trace
+ * events.
+ */
+GpuTimer GpuTimer::Create(
+    const size_t latency,
+    const size_t n_samples,
+    const size_t n_events)
+{
+    ito_assert(latency > 0, "invalid gpu timer latency");
+    ito_assert(n_samples > 0, "invalid number of samples");
+
+    GpuTimer timer;
+    timer.frames.resize(latency + 1);
+    for (auto &frame : timer.frames) {
+        frame.n_queries = 0;
+        frame.is_pending = false;
+    }
+    timer.head = 0;
+    timer.n_frames = 0;
+    timer.n_dropped = 0;
+    timer.n_samples = n_samples;
+    timer.n_events = n_events;
+    timer.is_supported = IsSupported();
+
+    /* Offset between the gpu and the cpu clocks, for the trace events. */
+    timer.gpu_offset = 0.0;
+    if (timer.is_supported) {
+        GLint64 timestamp;
+        glGetInteger64v(GL_TIMESTAMP, &timestamp);
+        timer.gpu_offset = 1.0e-9 * (double) timestamp - glfwGetTime();
+    }
+
+    return timer;
+}
+
+/**
+ * @brief Delete the query objects of all frames.
+ */
+void GpuTimer::Destroy(GpuTimer &timer)
+{
+    for (auto &frame : timer.frames) {
+        if (!frame.queries.empty()) {
+            glDeleteQueries(frame.queries.size(), frame.queries.data());
+        }
+    }
+    timer.frames.clear();
+    timer.stack.clear();
+    timer.samples.clear();
+    timer.events.clear();
+}
+
+/** ---------------------------------------------------------------------------
+ * @brief Read back the results of the previous frames that are available, in
+ * frame order, and begin the frame scope in the next slot of the ring.
+ */
+void GpuTimer::BeginFrame(GpuTimer &timer)
+{
+    ito_assert(timer.stack.empty(), "gpu timer frame already begun");
+
+    const size_t n_slots = timer.frames.size();
+    for (size_t i = 1; i <= n_slots; ++i) {
+        Frame &frame = timer.frames[(timer.head + i) % n_slots];
+        if (!frame.is_pending) {
+            continue;
+        }
+        if (!IsAvailable(timer, frame)) {
+            break;
+        }
+        Collect(timer, frame);
+    }
+
+    timer.head = (timer.head + 1) % n_slots;
+    Frame &frame = timer.frames[timer.head];
+    if (frame.is_pending) {
+        timer.n_dropped++;
+    }
+    frame.n_queries = 0;
+    frame.scopes.clear();
+    frame.is_pending = false;
+    timer.n_frames++;
+
+    Begin(timer, "frame");
+}
+
+/**
+ * @brief End the frame scope, the frame results are read back later.
+ */
+void GpuTimer::EndFrame(GpuTimer &timer)
+{
+    ito_assert(timer.stack.size() == 1, "unbalanced gpu timer scopes");
+    End(timer);
+    timer.frames[timer.head].is_pending = true;
+}
+
+/**
+ * @brief Begin a named scope, nested in the current scope.
+ */
+void GpuTimer::Begin(GpuTimer &timer, const std::string &name)
+{
+    Frame &frame = timer.frames[timer.head];
+
+    Scope scope;
+    scope.path = timer.stack.empty()
+        ? name
+        : frame.scopes[timer.stack.back()].path + "/" + name;
+    scope.depth = timer.stack.size();
+    scope.begin = WriteTimestamp(timer, frame);
+    scope.end = scope.begin;
+    scope.cpu_begin = glfwGetTime();
+    scope.cpu_end = scope.cpu_begin;
+
+    timer.stack.push_back(frame.scopes.size());
+    frame.scopes.push_back(scope);
+}
+
+/**
+ * @brief End the current scope.
+ */
+void GpuTimer::End(GpuTimer &timer)
+{
+    ito_assert(!timer.stack.empty(), "unbalanced gpu timer scopes");
+    Frame &frame = timer.frames[timer.head];
+
+    Scope &scope = frame.scopes[timer.stack.back()];
+    scope.end = WriteTimestamp(timer, frame);
+    scope.cpu_end = glfwGetTime();
+    timer.stack.pop_back();
+}
+
+/** ---------------------------------------------------------------------------
+ * @brief Return the statistics of each scope, in first begin order.
+ */
+std::vector<GpuTimer::Stats> GpuTimer::Statistics(const GpuTimer &timer)
+{
+    std::vector<Stats> stats;
+    for (auto &samples : timer.samples) {
+        Stats s;
+        s.path = samples.path;
+        s.depth = samples.depth;
+        s.n_samples = samples.gpu.size();
+        Percentiles(samples.gpu, s.gpu_mean, s.gpu_p99);
+        Percentiles(samples.cpu, s.cpu_mean, s.cpu_p99);
+        stats.push_back(s);
+    }
+    return stats;
+}
+
+/**
+ * @brief Return a string with the statistics of each scope, and whether the
+ * frames are cpu or gpu bound.
+ */
+std::string GpuTimer::InfoString(const GpuTimer &timer, const char *comment)
+{
+    std::ostringstream ss;
+    if (comment != nullptr) {
+        ss << ito::str::format("%s\n", comment);
+    }
+
+    std::vector<Stats> stats = Statistics(timer);
+    for (auto &s : stats) {
+        std::string name = std::string(2 * s.depth, ' ') +
+            s.path.substr(s.path.rfind('/') + 1);
+        ss << ito::str::format(
+            "%-24s gpu %8.3f ms (p99 %8.3f)  cpu %8.3f ms (p99 %8.3f)\n",
+            name.c_str(),
+            s.gpu_mean,
+            s.gpu_p99,
+            s.cpu_mean,
+            s.cpu_p99);
+    }
+    if (!stats.empty() && timer.is_supported) {
+        ss << ito::str::format(
+            "frames %zu, dropped %zu, %s bound\n",
+            timer.n_frames,
+            timer.n_dropped,
+            stats[0].gpu_mean > stats[0].cpu_mean ? "gpu" : "cpu");
+    }
+    return ss.str();
+}
+
+/**
+ * @brief Return the string escaped as a JSON string value. Quotes and
+ * backslashes are escaped, control characters are written as \u00XX.
+ */
+static std::string EscapeJson(const std::string &str)
+{
+    std::string escaped;
+    for (auto &c : str) {
+        if (c == '"' || c == '\\') {
+            escaped += '\\';
+            escaped += c;
+        } else if ((unsigned char) c < 0x20) {
+            escaped += ito::str::format("\\u%04x", (unsigned char) c);
+        } else {
+            escaped += c;
+        }
+    }
+    return escaped;
+}
+
+/**
+ * @brief Write the trace events to a file in the Chrome trace event format,
+ * as complete events with a start time and a duration in microseconds. The
+ * event names are escaped.
+ */
+void GpuTimer::WriteTrace(const GpuTimer &timer, const std::string &filename)
+{
+    std::ostringstream ss;
+    ss << "{\"traceEvents\":[\n";
+    ss << "{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":0,\"tid\":0,"
+          "\"args\":{\"name\":\"cpu\"}},\n";
+    ss << "{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":0,\"tid\":1,"
+          "\"args\":{\"name\":\"gpu\"}}";
+    for (auto &event : timer.events) {
+        ss << ito::str::format(
+            ",\n{\"name\":\"%s\",\"ph\":\"X\",\"pid\":0,\"tid\":%d,"
+            "\"ts\":%.3f,\"dur\":%.3f}",
+            EscapeJson(event.name).c_str(),
+            event.tid,
+            event.ts,
+            event.dur);
+    }
+    ss << "\n]}\n";
+
+    std::string trace = ss.str();
+    ito::file_ptr file = ito::make_file(filename, "w");
+    ito_assert(file, "failed to open file");
+    ito::file::write(file, (void *) trace.c_str(), trace.size());
+}
+
+/**
+ * @brief Are timestamp queries supported by the current context?
+ */
+bool GpuTimer::IsSupported(void)
+{
+#if defined(GL_VERSION_3_3)
+    if (GLAD_GL_VERSION_3_3) {
+        return true;
+    }
+#endif
+#if defined(GL_ARB_timer_query)
+    if (GLAD_GL_ARB_timer_query) {
+        return true;
+    }
+#endif
+    return false;
+}
+
+} /* gl */
+} /* ito */
@@ -12,6 +12,9 @@
 #ifndef ITO_OPENGL_TIMER_H_
 #define ITO_OPENGL_TIMER_H_
 
+#include <deque>
+#include <string>
+#include <vector>
 #include "base.hpp"
 #include "glfw.hpp"
 
@@ -52,6 +55,119 @@ struct Timer {
     ~Timer() = default;
 }; /* Timer */
 
+/**
+ * @brief GpuTimer measures the gpu and cpu time of each frame and of nested
+ * named scopes within the frame, to tell whether a frame, or a pass, is cpu
+ * or gpu bound.
+ *
+ * Each scope begin and end writes a GL_TIMESTAMP query with glQueryCounter,
+ * which, unlike GL_TIME_ELAPSED queries, can be nested. The queries of each
+ * frame are kept in a ring of latency + 1 frames, and the results of a frame
+ * are read back at a later BeginFrame, once available, without blocking. A
+ * frame whose results are not available when its slot in the ring is reused
+ * is dropped.
+ *
+ * Each scope is identified by its path from the frame scope, eg frame/depth.
+ * The last n_samples durations of each scope give the mean and 99th
+ * percentile statistics, and the last n_events scopes are kept as events in
+ * the Chrome trace event format, the cpu scopes in thread 0 and the gpu
+ * scopes in thread 1, on the cpu clock.
+ *
+ * @see https://www.khronos.org/opengl/wiki/Query_Object
+ *      https://docs.google.com/document/d/1CvAClvFfyA5R-PhYUmn5OOQtYMH4h6I0nSsKchNAySU
+ */
+struct GpuTimer {
+    /** Scope in a frame, with the indices of its timestamp queries. */
+    struct Scope {
+        std::string path;               /* scope path from the frame scope */
+        size_t depth;                   /* nesting depth */
+        size_t begin;                   /* begin timestamp query */
+        size_t end;                     /* end timestamp query */
+        double cpu_begin;               /* cpu time at begin, in seconds */
+        double cpu_end;                 /* cpu time at end, in seconds */
+    };
+
+    /** Frame in flight, with its pool of timestamp queries. */
+    struct Frame {
+        std::vector<GLuint> queries;    /* timestamp query pool */
+        size_t n_queries;               /* number of queries written */
+        std::vector<Scope> scopes;      /* scopes in begin order */
+        bool is_pending;                /* results not yet read back */
+    };
+
+    /** Last durations of a scope, in milliseconds. */
+    struct Samples {
+        std::string path;
+        size_t depth;
+        std::vector<double> gpu;
+        std::vector<double> cpu;
+        size_t head;
+    };
+
+    /** Statistics of a scope, in milliseconds. */
+    struct Stats {
+        std::string path;
+        size_t depth;
+        size_t n_samples;
+        double gpu_mean;
+        double gpu_p99;
+        double cpu_mean;
+        double cpu_p99;
+    };
+
+    /** Trace event of a complete scope, in microseconds. */
+    struct Event {
+        std::string name;
+        double ts;                      /* start time */
+        double dur;                     /* duration */
+        int tid;                        /* 0 for cpu, 1 for gpu */
+    };
+
+    std::vector<Frame> frames;          /* ring of frames in flight */
+    size_t head;                        /* current frame in the ring */
+    size_t n_frames;                    /* number of frames begun */
+    size_t n_dropped;                   /* number of frames dropped */
+    std::vector<size_t> stack;          /* open scopes of current frame */
+    std::vector<Samples> samples;       /* samples of each scope path */
+    size_t n_samples;                   /* samples kept per scope */
+    std::deque<Event> events;           /* trace events */
+    size_t n_events;                    /* trace events kept */
+    double gpu_offset;                  /* gpu minus cpu clock, in seconds */
+    bool is_supported;                  /* timestamp queries are supported */
+
+    /* Gpu timer factory functions */
+    static GpuTimer Create(
+        const size_t latency = 3,
+        const size_t n_samples = 256,
+        const size_t n_events = 65536);
+    static void Destroy(GpuTimer &timer);
+
+    /**
+     * @brief Read back the available results of the previous frames, and
+     * begin and end the frame scope.
+     */
+    static void BeginFrame(GpuTimer &timer);
+    static void EndFrame(GpuTimer &timer);
+
+    /** Begin and end a named scope, nested in the current scope. */
+    static void Begin(GpuTimer &timer, const std::string &name);
+    static void End(GpuTimer &timer);
+
+    /** Return the statistics of each scope, in first begin order. */
+    static std::vector<Stats> Statistics(const GpuTimer &timer);
+
+    /** Return a string with the statistics of each scope. */
+    static std::string InfoString(
+        const GpuTimer &timer,
+        const char *comment = nullptr);
+
+    /** Write the trace events to a file in the Chrome trace event format. */
+    static void WriteTrace(const GpuTimer &timer, const std::string &filename);
+
+    /** Are timestamp queries supported by the current context? */
+    static bool IsSupported(void);
+};
+
 } /* gl */
 } /* ito */
 
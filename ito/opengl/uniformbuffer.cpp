@@ -0,0 +1,135 @@
+/*
+ * uniformbuffer.cpp
+ *
+ * Copyright (c) 2020 Carlos Braga
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the MIT License.
+ *
+ * See accompanying LICENSE.md or https://opensource.org/licenses/MIT.
+ */
+
+#include <algorithm>
+#include "buffer.hpp"
+#include "state.hpp"
+#include "uniformbuffer.hpp"
+
+namespace ito {
+namespace gl {
+
+/** ---------------------------------------------------------------------------
+ * @brief Create a uniform buffer with n_slots copies of the block layout.
+ * Slots are aligned to GL_UNIFORM_BUFFER_OFFSET_ALIGNMENT so each slot can be
+ * bound with glBindBufferRange.
+ */
+UniformBuffer UniformBuffer::Create(
+    const BlockLayout &layout,
+    const GLuint binding,
+    const size_t n_slots)
+{
+    ito_assert(layout.size > 0, "invalid uniform block layout");
+    ito_assert(n_slots > 0, "invalid number of slots");
+
+    GLint offset_align = 1;
+    glGetIntegerv(GL_UNIFORM_BUFFER_OFFSET_ALIGNMENT, &offset_align);
+    GLsizeiptr align = std::max(offset_align, 1);
+
+    UniformBuffer ubo;
+    ubo.binding = binding;
+    ubo.layout = layout;
+    ubo.slot_stride = align * ((layout.size + align - 1) / align);
+    ubo.buffer = CreateBuffer(
+        GL_UNIFORM_BUFFER,
+        n_slots * ubo.slot_stride,
+        GL_DYNAMIC_DRAW);
+    ubo.data.resize(layout.size, 0);
+    ubo.n_slots = n_slots;
+    ubo.head = 0;
+    return ubo;
+}
+
+/**
+ * @brief Delete the uniform buffer object.
+ */
+void UniformBuffer::Destroy(UniformBuffer &ubo)
+{
+    DestroyBuffer(ubo.buffer);
+    ubo.data.clear();
+}
+
+/** ---------------------------------------------------------------------------
+ * @brief Pack the value of the block member with the given name into the
+ * host copy of the block. The data holds the member elements tightly packed.
+ */
+bool UniformBuffer::Set(
+    UniformBuffer &ubo,
+    const std::string &name,
+    const void *data)
+{
+    GLint index = BlockLayout::Find(ubo.layout, name);
+    if (index == -1) {
+        std::cerr << ito::str::format("invalid block member: %s\n", name.c_str());
+        return false;
+    }
+    return BlockLayout::Write(ubo.layout, index, data, ubo.data.data());
+}
+
+/**
+ * @brief Pack a vec4f into the block member with the given name.
+ */
+bool UniformBuffer::Set(
+    UniformBuffer &ubo,
+    const std::string &name,
+    const math::vec4f &v)
+{
+    GLint index = BlockLayout::Find(ubo.layout, name);
+    if (index == -1 || ubo.layout.members[index].type != GL_FLOAT_VEC4) {
+        std::cerr << ito::str::format("invalid vec4 member: %s\n", name.c_str());
+        return false;
+    }
+    return BlockLayout::Write(ubo.layout, index, v.data, ubo.data.data());
+}
+
+/**
+ * @brief Pack a row-major mat4f into the block member with the given name.
+ */
+bool UniformBuffer::Set(
+    UniformBuffer &ubo,
+    const std::string &name,
+    const math::mat4f &m)
+{
+    GLint index = BlockLayout::Find(ubo.layout, name);
+    if (index == -1 || ubo.layout.members[index].type != GL_FLOAT_MAT4) {
+        std::cerr << ito::str::format("invalid mat4 member: %s\n", name.c_str());
+        return false;
+    }
+    return BlockLayout::Write(ubo.layout, index, m.data, ubo.data.data());
+}
+
+/** ---------------------------------------------------------------------------
+ * @brief Write the host copy of the block into the next slot of the ring and
+ * bind the slot to the uniform buffer binding point.
+ */
+void UniformBuffer::Commit(UniformBuffer &ubo)
+{
+    /* Write the block into the slot with a single call and bind it. */
+    GLintptr offset = ubo.head * ubo.slot_stride;
+    BindBuffer(GL_UNIFORM_BUFFER, ubo.buffer);
+    glBufferSubData(
+        GL_UNIFORM_BUFFER,              /* target binding point */
+        offset,                         /* offset in data store */
+        ubo.data.size(),                /* data store size in bytes */
+        ubo.data.data());               /* pointer to data source */
+
+    glBindBufferRange(
+        GL_UNIFORM_BUFFER,
+        ubo.binding,
+        ubo.buffer,
+        offset,
+        ubo.data.size());
+
+    ubo.head = (ubo.head + 1) % ubo.n_slots;
+}
+
+} /* gl */
+} /* ito */
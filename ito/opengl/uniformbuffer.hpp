@@ -0,0 +1,79 @@
+/*
+ * uniformbuffer.hpp
+ *
+ * Copyright (c) 2020 Carlos Braga
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the MIT License.
+ *
+ * See accompanying LICENSE.md or https://opensource.org/licenses/MIT.
+ */
+
+#ifndef ITO_OPENGL_UNIFORMBUFFER_H_
+#define ITO_OPENGL_UNIFORMBUFFER_H_
+
+#include <string>
+#include <vector>
+#include "base.hpp"
+#include "glsl/block.hpp"
+
+namespace ito {
+namespace gl {
+
+/**
+ * UniformBuffer
+ * @brief Uniform buffer object holding a ring of per-frame copies of a
+ * uniform block, for updating the block constants with a single buffer write
+ * per frame instead of one glUniform* call per constant:
+ *
+ *  UniformBuffer::Set(ubo, "u_mvp", mvp);
+ *  UniformBuffer::Set(ubo, "u_light", light);
+ *  UniformBuffer::Commit(ubo);
+ *  ... draw calls ...
+ *
+ * Set packs the member values into a host copy of the block, and Commit
+ * writes the host copy into the next slot of the ring and binds that slot
+ * to the uniform buffer binding point with glBindBufferRange.
+ *
+ * The driver orders glBufferSubData after the draw calls already issued, so
+ * the slots are not fenced. Writing a different slot each frame avoids
+ * updating the range read by the draw calls still in flight.
+ */
+struct UniformBuffer {
+    GLuint buffer;                      /* uniform buffer object */
+    GLuint binding;                     /* uniform buffer binding point */
+    BlockLayout layout;                 /* uniform block layout */
+    GLsizeiptr slot_stride;             /* aligned distance between slots */
+    std::vector<GLubyte> data;          /* host copy of the block */
+    size_t n_slots;                     /* number of slots */
+    size_t head;                        /* next slot to write */
+
+    /* Uniform buffer factory functions */
+    static UniformBuffer Create(
+        const BlockLayout &layout,
+        const GLuint binding,
+        const size_t n_slots = 3);
+    static void Destroy(UniformBuffer &ubo);
+
+    /* Update the host copy of a block member. */
+    static bool Set(
+        UniformBuffer &ubo,
+        const std::string &name,
+        const void *data);
+    static bool Set(
+        UniformBuffer &ubo,
+        const std::string &name,
+        const math::vec4f &v);
+    static bool Set(
+        UniformBuffer &ubo,
+        const std::string &name,
+        const math::mat4f &m);
+
+    /* Write the host copy to the next slot and bind it. */
+    static void Commit(UniformBuffer &ubo);
+};
+
+} /* gl */
+} /* ito */
+
+#endif /* ITO_OPENGL_UNIFORMBUFFER_H_ */
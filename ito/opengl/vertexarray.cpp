@@ -11,6 +11,7 @@
 
 #include "vertexarray.hpp"
 #include "buffer.hpp"
+#include "state.hpp"
 
 namespace ito {
 namespace gl {
@@ -70,9 +71,9 @@ GLuint CreateVertexArray(void)
 {
     GLuint array;
     glGenVertexArrays(1, &array);
-    glBindVertexArray(array);
+    BindVertexArray(array);
     ito_assert(glIsVertexArray(array), "failed to generate vertex array");
-    glBindVertexArray(0);
+    BindVertexArray(0);
     return array;
 }
 
@@ -81,6 +82,7 @@ GLuint CreateVertexArray(void)
  */
 void DestroyVertexArray(const GLuint &array)
 {
+    InvalidateStateObject(array);
     glDeleteVertexArrays(1, &array);
 }
 
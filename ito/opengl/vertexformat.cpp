@@ -0,0 +1,541 @@
+/*
+ * vertexformat.cpp
+ *
+ * Copyright (c) 2020 Carlos Braga
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the MIT License.
+ *
+ * See accompanying LICENSE.md or https://opensource.org/licenses/MIT.
+ */
+
+#include <algorithm>
+#include <cmath>
+#include <cstddef>
+#include <cstring>
+#include <map>
+#include <sstream>
+#include <tuple>
+#include "glsl/attribute.hpp"
+#include "state.hpp"
+#include "vertexarray.hpp"
+#include "vertexformat.hpp"
+
+namespace ito {
+namespace gl {
+
+/** ---------------------------------------------------------------------------
+ * @brief Registry of the vertex format layouts, mapping each layout to its id,
+ * and cache of the vertex arrays of each format, program and name, and of the
+ * buffers if the vertex arrays are not shared.
+ */
+typedef std::tuple<GLuint, GLuint, std::string, std::vector<GLuint>>
+    VertexArrayKey;
+
+static std::map<std::string, GLuint> gFormats;
+static std::map<VertexArrayKey, GLuint> gVertexArrays;
+
+/**
+ * @brief Return the size in bytes of the attribute components.
+ */
+static GLuint AttributeSize(const VertexFormat::Attribute &attribute)
+{
+    switch (attribute.type) {
+    case GL_FLOAT:
+        return 4 * attribute.size;
+    case GL_HALF_FLOAT:
+        return 2 * attribute.size;
+    case GL_INT_2_10_10_10_REV:
+        return 4;
+    case GL_BYTE:
+    case GL_UNSIGNED_BYTE:
+        return attribute.size;
+    case GL_SHORT:
+    case GL_UNSIGNED_SHORT:
+        return 2 * attribute.size;
+    default:
+        ito_throw("invalid vertex attribute type");
+    }
+    return 0;
+}
+
+/**
+ * @brief Return the offset of the Mesh::Vertex data and the number of its
+ * components of the attribute with the suffix.
+ */
+static GLuint AttributeSource(const std::string &suffix, GLint &length)
+{
+    if (suffix == "_position") {
+        length = 3;
+        return offsetof(Mesh::Vertex, position);
+    } else if (suffix == "_normal") {
+        length = 3;
+        return offsetof(Mesh::Vertex, normal);
+    } else if (suffix == "_color") {
+        length = 3;
+        return offsetof(Mesh::Vertex, color);
+    } else if (suffix == "_texcoord") {
+        length = 2;
+        return offsetof(Mesh::Vertex, texcoord);
+    }
+    ito_throw("invalid vertex attribute suffix");
+    return 0;
+}
+
+/**
+ * @brief Convert a float to a half float, rounding to the nearest even.
+ */
+static uint16_t FloatToHalf(const float value)
+{
+    uint32_t bits;
+    std::memcpy(&bits, &value, sizeof(bits));
+    uint32_t sign = (bits >> 16) & 0x8000;
+    int32_t exponent = (int32_t) ((bits >> 23) & 0xff) - 127 + 15;
+    uint32_t mantissa = bits & 0x7fffff;
+
+    /* Infinity and NaN, and overflow to infinity. */
+    if (((bits >> 23) & 0xff) == 0xff) {
+        return sign | 0x7c00 | (mantissa != 0 ? 0x200 : 0);
+    }
+    if (exponent >= 31) {
+        return sign | 0x7c00;
+    }
+
+    /* Subnormal half, or underflow to zero. */
+    if (exponent <= 0) {
+        if (exponent < -10) {
+            return sign;
+        }
+        mantissa |= 0x800000;
+        uint32_t shift = 14 - exponent;
+        uint32_t half = mantissa >> shift;
+        uint32_t rest = mantissa & ((1u << shift) - 1);
+        uint32_t middle = 1u << (shift - 1);
+        if (rest > middle || (rest == middle && (half & 1))) {
+            half++;
+        }
+        return sign | half;
+    }
+
+    /* Normal half, a mantissa carry rounds up into the exponent. */
+    uint32_t half = ((uint32_t) exponent << 10) | (mantissa >> 13);
+    uint32_t rest = mantissa & 0x1fff;
+    if (rest > 0x1000 || (rest == 0x1000 && (half & 1))) {
+        half++;
+    }
+    return sign | half;
+}
+
+/**
+ * @brief Convert a float to a fixed point value in [lo, hi], scaled if the
+ * value is normalized.
+ */
+static int32_t FloatToFixed(
+    const float value,
+    const int32_t lo,
+    const int32_t hi,
+    const bool normalized)
+{
+    float v = normalized ? value * (float) hi : value;
+    v = std::round(v);
+    return (int32_t) std::min(std::max(v, (float) lo), (float) hi);
+}
+
+/** ---------------------------------------------------------------------------
+ * @brief Create a vertex format from the attributes, laying out the offsets
+ * of the attributes in each stream in order, and the stream strides.
+ */
+VertexFormat VertexFormat::Create(const std::vector<Attribute> &attributes)
+{
+    ito_assert(!attributes.empty(), "invalid vertex format");
+
+    VertexFormat format;
+    format.attributes = attributes;
+    for (auto &attribute : format.attributes) {
+        ito_assert(attribute.size >= 1 && attribute.size <= 4,
+            "invalid vertex attribute size");
+        ito_assert(attribute.type != GL_INT_2_10_10_10_REV ||
+            attribute.size == 4, "invalid packed vertex attribute size");
+
+        if (attribute.stream >= format.strides.size()) {
+            format.strides.resize(attribute.stream + 1, 0);
+        }
+        GLsizei &stride = format.strides[attribute.stream];
+        attribute.offset = stride;
+        stride = (stride + AttributeSize(attribute) + 3) & ~3;
+    }
+    for (auto &stride : format.strides) {
+        ito_assert(stride > 0, "invalid vertex format stream");
+    }
+
+    /* Register the layout and assign it a unique id. */
+    std::ostringstream ss;
+    for (auto &attribute : format.attributes) {
+        ss << ito::str::format("%s:%d:%x:%d:%u:%u;",
+            attribute.suffix.c_str(),
+            attribute.size,
+            attribute.type,
+            attribute.normalized,
+            attribute.stream,
+            attribute.offset);
+    }
+    auto it = gFormats.find(ss.str());
+    if (it == gFormats.end()) {
+        GLuint id = gFormats.size() + 1;
+        it = gFormats.emplace(ss.str(), id).first;
+    }
+    format.id = it->second;
+
+    return format;
+}
+
+/**
+ * @brief Return the format of Mesh::Vertex, 44 bytes in a single stream.
+ */
+VertexFormat VertexFormat::Standard(void)
+{
+    static const VertexFormat format = Create({
+        {"_position", 3, GL_FLOAT, GL_FALSE, 0, 0},
+        {"_normal",   3, GL_FLOAT, GL_FALSE, 0, 0},
+        {"_color",    3, GL_FLOAT, GL_FALSE, 0, 0},
+        {"_texcoord", 2, GL_FLOAT, GL_FALSE, 0, 0}});
+    ito_assert(format.strides[0] == sizeof(Mesh::Vertex),
+        "invalid standard vertex format");
+    return format;
+}
+
+/**
+ * @brief Return a compact format of 20 bytes, the positions in the first
+ * stream, the normals in 10-10-10-2 and the half float texture coordinates
+ * in the second stream.
+ */
+VertexFormat VertexFormat::Compact(void)
+{
+    static const VertexFormat format = Create({
+        {"_position", 3, GL_FLOAT,             GL_FALSE, 0, 0},
+        {"_normal",   4, GL_INT_2_10_10_10_REV, GL_TRUE, 1, 0},
+        {"_texcoord", 2, GL_HALF_FLOAT,        GL_FALSE, 1, 0}});
+    return format;
+}
+
+/**
+ * @brief Return a string with the vertex format information.
+ */
+std::string VertexFormat::InfoString(
+    const VertexFormat &format,
+    const char *comment)
+{
+    std::ostringstream ss;
+    if (comment != nullptr) {
+        ss << ito::str::format("%s\n", comment);
+    }
+    ss << ito::str::format("id:       %u\n", format.id);
+    for (size_t i = 0; i < format.strides.size(); ++i) {
+        ss << ito::str::format("stream %zu: stride %d\n", i, format.strides[i]);
+    }
+    for (auto &attribute : format.attributes) {
+        ss << ito::str::format(
+            "%s: size %d, type 0x%x, normalized %d, stream %u, offset %u\n",
+            attribute.suffix.c_str(),
+            attribute.size,
+            attribute.type,
+            attribute.normalized,
+            attribute.stream,
+            attribute.offset);
+    }
+    return ss.str();
+}
+
+/**
+ * @brief Return the vertex size in bytes, over all streams.
+ */
+GLsizei VertexFormat::VertexSize(const VertexFormat &format)
+{
+    GLsizei size = 0;
+    for (auto &stride : format.strides) {
+        size += stride;
+    }
+    return size;
+}
+
+/** ---------------------------------------------------------------------------
+ * @brief Encode the vertices in the format, one array for each stream. Source
+ * components missing in the vertex are zero.
+ */
+std::vector<std::vector<uint8_t>> VertexFormat::Pack(
+    const VertexFormat &format,
+    const Mesh::Vertex *vertices,
+    const size_t n_vertices)
+{
+    /* Find the source data of each attribute in the vertex. */
+    std::vector<GLuint> sources;
+    std::vector<GLint> lengths;
+    for (auto &attribute : format.attributes) {
+        GLint length;
+        sources.push_back(AttributeSource(attribute.suffix, length));
+        lengths.push_back(length);
+    }
+
+    std::vector<std::vector<uint8_t>> streams(format.strides.size());
+    for (size_t s = 0; s < streams.size(); ++s) {
+        streams[s].resize(n_vertices * format.strides[s], 0);
+    }
+
+    ito_pragma(omp parallel for schedule(static))
+    for (size_t i = 0; i < n_vertices; ++i) {
+        const uint8_t *vertex =
+            reinterpret_cast<const uint8_t *>(&vertices[i]);
+        for (size_t k = 0; k < format.attributes.size(); ++k) {
+            const Attribute &attribute = format.attributes[k];
+            GLfloat src[4] = {0.0f, 0.0f, 0.0f, 0.0f};
+            std::memcpy(
+                src,
+                vertex + sources[k],
+                std::min(lengths[k], attribute.size) * sizeof(GLfloat));
+
+            uint8_t *dst = streams[attribute.stream].data() +
+                i * format.strides[attribute.stream] + attribute.offset;
+            bool normalized = attribute.normalized;
+            switch (attribute.type) {
+            case GL_FLOAT:
+                std::memcpy(dst, src, attribute.size * sizeof(GLfloat));
+                break;
+            case GL_HALF_FLOAT:
+                for (GLint c = 0; c < attribute.size; ++c) {
+                    uint16_t half = FloatToHalf(src[c]);
+                    std::memcpy(dst + 2 * c, &half, sizeof(half));
+                }
+                break;
+            case GL_INT_2_10_10_10_REV: {
+                uint32_t packed =
+                    ((uint32_t) FloatToFixed(src[0], -511, 511, normalized)
+                        & 0x3ff) |
+                    ((uint32_t) FloatToFixed(src[1], -511, 511, normalized)
+                        & 0x3ff) << 10 |
+                    ((uint32_t) FloatToFixed(src[2], -511, 511, normalized)
+                        & 0x3ff) << 20 |
+                    ((uint32_t) FloatToFixed(src[3], -1, 1, normalized)
+                        & 0x3) << 30;
+                std::memcpy(dst, &packed, sizeof(packed));
+                break;
+            }
+            case GL_BYTE:
+                for (GLint c = 0; c < attribute.size; ++c) {
+                    dst[c] = (uint8_t) FloatToFixed(
+                        src[c], -127, 127, normalized);
+                }
+                break;
+            case GL_UNSIGNED_BYTE:
+                for (GLint c = 0; c < attribute.size; ++c) {
+                    dst[c] = (uint8_t) FloatToFixed(
+                        src[c], 0, 255, normalized);
+                }
+                break;
+            case GL_SHORT:
+                for (GLint c = 0; c < attribute.size; ++c) {
+                    int16_t value = (int16_t) FloatToFixed(
+                        src[c], -32767, 32767, normalized);
+                    std::memcpy(dst + 2 * c, &value, sizeof(value));
+                }
+                break;
+            case GL_UNSIGNED_SHORT:
+                for (GLint c = 0; c < attribute.size; ++c) {
+                    uint16_t value = (uint16_t) FloatToFixed(
+                        src[c], 0, 65535, normalized);
+                    std::memcpy(dst + 2 * c, &value, sizeof(value));
+                }
+                break;
+            }
+        }
+    }
+
+    return streams;
+}
+
+/** ---------------------------------------------------------------------------
+ * @brief Specify the attributes of a stream, prefixed by the name, in the
+ * bound vertex array object with data in the buffer bound to GL_ARRAY_BUFFER.
+ * Query each attribute location once and use the location based functions.
+ */
+void VertexFormat::AttributePointers(
+    const VertexFormat &format,
+    const GLuint &program,
+    const std::string &name,
+    const GLuint stream)
+{
+    std::string attribute_name = name;
+    for (auto &attribute : format.attributes) {
+        if (attribute.stream != stream) {
+            continue;
+        }
+        attribute_name.resize(name.size());
+        attribute_name.append(attribute.suffix);
+
+        GLint location = glGetAttribLocation(program, attribute_name.c_str());
+        if (!EnableAttribute(location)) {
+            std::cerr << ito::str::format(
+                "invalid attribute: %s\n", attribute_name.c_str());
+            continue;
+        }
+        glVertexAttribPointer(
+            location,
+            attribute.size,         /* number of components */
+            attribute.type,         /* component type */
+            attribute.normalized,   /* normalized flag */
+            format.strides[stream], /* byte offset between consecutive attributes */
+            (GLvoid *) (uintptr_t) attribute.offset);
+    }
+}
+
+/**
+ * @brief Return the vertex array object of the format attributes used by the
+ * program, prefixed by the name, with the vertex and element buffers.
+ *
+ * A shared vertex array holds the attribute formats and their stream
+ * bindings, and the vertex buffers are bound to the streams with BindStreams
+ * and the element buffer with BindBuffer at draw time. Attributes not used by
+ * the program are skipped, so a depth only program fetches only the stream
+ * of the positions. Otherwise, the vertex array holds the buffers and is
+ * ready to draw.
+ */
+GLuint VertexFormat::VertexArray(
+    const VertexFormat &format,
+    const GLuint &program,
+    const std::string &name,
+    const std::vector<GLuint> &buffers,
+    const GLuint ebo)
+{
+    ito_assert(buffers.size() == format.strides.size(),
+        "invalid number of vertex buffers");
+
+    bool is_shared = IsBindingSupported();
+    VertexArrayKey key(format.id, program, name, std::vector<GLuint>{});
+    if (!is_shared) {
+        std::get<3>(key) = buffers;
+        std::get<3>(key).push_back(ebo);
+    }
+    auto it = gVertexArrays.find(key);
+    if (it != gVertexArrays.end()) {
+        return it->second;
+    }
+
+    GLuint array = CreateVertexArray();
+    BindVertexArray(array);
+    if (is_shared) {
+#if defined(GL_VERSION_4_3) || defined(GL_ARB_vertex_attrib_binding)
+        std::string attribute_name = name;
+        for (auto &attribute : format.attributes) {
+            attribute_name.resize(name.size());
+            attribute_name.append(attribute.suffix);
+            GLint location = glGetAttribLocation(
+                program, attribute_name.c_str());
+            if (!EnableAttribute(location)) {
+                continue;
+            }
+            glVertexAttribFormat(
+                location,
+                attribute.size,
+                attribute.type,
+                attribute.normalized,
+                attribute.offset);
+            glVertexAttribBinding(location, attribute.stream);
+        }
+#endif
+    } else {
+        for (size_t s = 0; s < buffers.size(); ++s) {
+            BindBuffer(GL_ARRAY_BUFFER, buffers[s]);
+            AttributePointers(format, program, name, s);
+        }
+        BindBuffer(GL_ELEMENT_ARRAY_BUFFER, ebo);
+    }
+    BindVertexArray(0);
+
+    gVertexArrays[key] = array;
+    return array;
+}
+
+/**
+ * @brief Bind the vertex buffers to the streams of the bound shared vertex
+ * array.
+ */
+void VertexFormat::BindStreams(
+    const VertexFormat &format,
+    const std::vector<GLuint> &buffers)
+{
+#if defined(GL_VERSION_4_3) || defined(GL_ARB_vertex_attrib_binding)
+    for (size_t s = 0; s < buffers.size(); ++s) {
+        glBindVertexBuffer(s, buffers[s], 0, format.strides[s]);
+    }
+#endif
+}
+
+/**
+ * @brief Destroy the vertex arrays created for any of the buffers.
+ */
+void VertexFormat::DestroyVertexArrays(const std::vector<GLuint> &buffers)
+{
+    for (auto it = gVertexArrays.begin(); it != gVertexArrays.end();) {
+        const std::vector<GLuint> &key_buffers = std::get<3>(it->first);
+        bool is_used = std::any_of(
+            key_buffers.begin(),
+            key_buffers.end(),
+            [&buffers] (const GLuint buffer) {
+                return std::find(buffers.begin(), buffers.end(), buffer) !=
+                    buffers.end();
+            });
+        if (is_used) {
+            DestroyVertexArray(it->second);
+            it = gVertexArrays.erase(it);
+        } else {
+            ++it;
+        }
+    }
+}
+
+/**
+ * @brief Destroy the vertex arrays created for the program. Called when the
+ * program object is destroyed, since GL recycles program names.
+ */
+void VertexFormat::DestroyProgramVertexArrays(const GLuint program)
+{
+    for (auto it = gVertexArrays.begin(); it != gVertexArrays.end();) {
+        if (std::get<1>(it->first) == program) {
+            DestroyVertexArray(it->second);
+            it = gVertexArrays.erase(it);
+        } else {
+            ++it;
+        }
+    }
+}
+
+/**
+ * @brief Destroy all the vertex arrays of all formats.
+ */
+void VertexFormat::DestroyVertexArrays(void)
+{
+    for (auto &it : gVertexArrays) {
+        DestroyVertexArray(it.second);
+    }
+    gVertexArrays.clear();
+}
+
+/**
+ * @brief Are separate attribute formats supported by the current context?
+ */
+bool VertexFormat::IsBindingSupported(void)
+{
+#if defined(GL_VERSION_4_3)
+    if (GLAD_GL_VERSION_4_3) {
+        return true;
+    }
+#endif
+#if defined(GL_ARB_vertex_attrib_binding)
+    if (GLAD_GL_ARB_vertex_attrib_binding) {
+        return true;
+    }
+#endif
+    return false;
+}
+
+} /* gl */
+} /* ito */
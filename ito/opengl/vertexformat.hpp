@@ -0,0 +1,137 @@
+/*
+ * vertexformat.hpp
+ *
+ * Copyright (c) 2020 Carlos Braga
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the MIT License.
+ *
+ * See accompanying LICENSE.md or https://opensource.org/licenses/MIT.
+ */
+
+#ifndef ITO_OPENGL_VERTEXFORMAT_H_
+#define ITO_OPENGL_VERTEXFORMAT_H_
+
+#include <string>
+#include <vector>
+#include "base.hpp"
+#include "mesh.hpp"
+
+namespace ito {
+namespace gl {
+
+/**
+ * @brief VertexFormat describes the layout of the vertex attributes in one or
+ * more vertex buffer streams. Each attribute has a name suffix, a number of
+ * components, a component type, a normalized flag and a stream. The offsets
+ * of the attributes in their stream and the stride of each stream are laid
+ * out by Create, each aligned to 4 bytes.
+ *
+ * The component types are:
+ *      GL_FLOAT                    32-bit floating point.
+ *      GL_HALF_FLOAT               16-bit floating point.
+ *      GL_INT_2_10_10_10_REV       packed signed 10-10-10-2 in 4 bytes.
+ *      GL_BYTE, GL_UNSIGNED_BYTE   8-bit fixed point.
+ *      GL_SHORT, GL_UNSIGNED_SHORT 16-bit fixed point.
+ * Fixed point components are converted to floating point in the shader, and
+ * mapped to [-1,1] or [0,1] if normalized.
+ *
+ * Pack encodes Mesh::Vertex data in the format, the attribute suffixes being
+ * _position, _normal, _color or _texcoord. The Standard format is the layout
+ * of Mesh::Vertex. The Compact format drops the colors and keeps the positions
+ * in their own stream, so depth only passes fetch 12 bytes per vertex, and
+ * the normals and texture coordinates in 8 bytes in a second stream.
+ *
+ * With separate attribute formats (GL 4.3 or ARB_vertex_attrib_binding) the
+ * vertex array object only holds the format of the attributes, and one vertex
+ * array object per program is shared by all meshes with the same format, the
+ * vertex buffers being bound to the streams at draw time. Otherwise, a vertex
+ * array object is created for each mesh and program. The vertex arrays of a
+ * program are destroyed with the program by DestroyProgram.
+ *
+ * @see https://www.khronos.org/opengl/wiki/Vertex_Specification
+ *      https://www.khronos.org/opengl/wiki/Vertex_Specification_Best_Practices
+ */
+struct VertexFormat {
+    /** Vertex attribute in a stream. */
+    struct Attribute {
+        std::string suffix;             /* attribute name suffix */
+        GLint size;                     /* number of components */
+        GLenum type;                    /* component type */
+        GLboolean normalized;           /* fixed point is normalized */
+        GLuint stream;                  /* vertex buffer stream */
+        GLuint offset;                  /* byte offset in the stream vertex */
+    };
+
+    std::vector<Attribute> attributes;  /* vertex attributes */
+    std::vector<GLsizei> strides;       /* vertex size of each stream */
+    GLuint id;                          /* unique id of the layout */
+
+    /* Vertex format factory functions */
+    static VertexFormat Create(const std::vector<Attribute> &attributes);
+    static VertexFormat Standard(void);
+    static VertexFormat Compact(void);
+
+    /** Return a string with the vertex format information. */
+    static std::string InfoString(
+        const VertexFormat &format,
+        const char *comment = nullptr);
+
+    /** Return the vertex size in bytes, over all streams. */
+    static GLsizei VertexSize(const VertexFormat &format);
+
+    /**
+     * @brief Encode the vertices in the format, one array for each stream.
+     */
+    static std::vector<std::vector<uint8_t>> Pack(
+        const VertexFormat &format,
+        const Mesh::Vertex *vertices,
+        const size_t n_vertices);
+
+    /**
+     * @brief Specify the attributes of a stream, prefixed by the name, in the
+     * bound vertex array object with data in the buffer bound to
+     * GL_ARRAY_BUFFER.
+     */
+    static void AttributePointers(
+        const VertexFormat &format,
+        const GLuint &program,
+        const std::string &name,
+        const GLuint stream);
+
+    /**
+     * @brief Return the vertex array object of the format attributes used by
+     * the program, prefixed by the name, with the vertex and element buffers.
+     * The vertex array is shared by all buffers if separate attribute formats
+     * are supported, and created for the buffers otherwise.
+     */
+    static GLuint VertexArray(
+        const VertexFormat &format,
+        const GLuint &program,
+        const std::string &name,
+        const std::vector<GLuint> &buffers,
+        const GLuint ebo);
+
+    /**
+     * @brief Bind the vertex buffers to the streams of a shared vertex array.
+     */
+    static void BindStreams(
+        const VertexFormat &format,
+        const std::vector<GLuint> &buffers);
+
+    /**
+     * @brief Destroy the vertex arrays created for any of the buffers, for
+     * the program, or all the vertex arrays of all formats.
+     */
+    static void DestroyVertexArrays(const std::vector<GLuint> &buffers);
+    static void DestroyProgramVertexArrays(const GLuint program);
+    static void DestroyVertexArrays(void);
+
+    /** Are separate attribute formats supported by the current context? */
+    static bool IsBindingSupported(void);
+};
+
+} /* gl */
+} /* ito */
+
+#endif /* ITO_OPENGL_VERTEXFORMAT_H_ */
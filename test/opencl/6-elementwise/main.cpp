@@ -0,0 +1,227 @@
+/*
+ * main.cpp
+ *
+ * Copyright (c) 2020 Carlos Braga
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the MIT License.
+ *
+ * See accompanying LICENSE.md or https://opensource.org/licenses/MIT.
+ */
+
+#include <vector>
+#include <chrono>
+#include <cmath>
+#include "../params.hpp"
+
+using namespace ito;
+
+/** ---------------------------------------------------------------------------
+ * Maximum absolute difference between the fused and the unfused results.
+ */
+static const double kTolerance = 1.0e-5;
+
+/** ---------------------------------------------------------------------------
+ * Program source with one kernel per element-wise operation.
+ */
+const std::string unfused_source = ito_strify(
+__kernel void axpy(
+    const unsigned long n,
+    const float a,
+    __global const float4 *x,
+    __global float4 *y)
+{
+    const size_t i = get_global_id(0);
+    if (i < n) {
+        y[i] = mad((float4) a, x[i], y[i]);
+    }
+}
+
+__kernel void normalize4(
+    const unsigned long n,
+    __global float4 *y)
+{
+    const size_t i = get_global_id(0);
+    if (i < n) {
+        y[i] = normalize(y[i]);
+    }
+}
+
+__kernel void clamp4(
+    const unsigned long n,
+    const float lo,
+    const float hi,
+    __global float4 *y)
+{
+    const size_t i = get_global_id(0);
+    if (i < n) {
+        y[i] = clamp(y[i], lo, hi);
+    }
+});
+
+/** ---------------------------------------------------------------------------
+ * Execute y = clamp(normalize(a * x + y), lo, hi) with three kernels.
+ */
+double ExecuteUnfused(
+    const size_t array_size,
+    const cl_float a,
+    const cl_float lo,
+    const cl_float hi,
+    cl_mem &x,
+    cl_mem &y)
+{
+    cl_command_queue queue = clfw::Queue();
+
+    cl_program program = cl::CreateProgramWithSource(
+        clfw::Context(), unfused_source);
+    cl::BuildProgram(program, clfw::Device());
+
+    cl_kernel axpy = cl::CreateKernel(program, "axpy");
+    cl_kernel normalize = cl::CreateKernel(program, "normalize4");
+    cl_kernel clamp = cl::CreateKernel(program, "clamp4");
+
+    cl_ulong n = array_size;
+    cl::SetKernelArg(axpy, 0, sizeof(cl_ulong), &n);
+    cl::SetKernelArg(axpy, 1, sizeof(cl_float), &a);
+    cl::SetKernelArg(axpy, 2, sizeof(cl_mem), &x);
+    cl::SetKernelArg(axpy, 3, sizeof(cl_mem), &y);
+
+    cl::SetKernelArg(normalize, 0, sizeof(cl_ulong), &n);
+    cl::SetKernelArg(normalize, 1, sizeof(cl_mem), &y);
+
+    cl::SetKernelArg(clamp, 0, sizeof(cl_ulong), &n);
+    cl::SetKernelArg(clamp, 1, sizeof(cl_float), &lo);
+    cl::SetKernelArg(clamp, 2, sizeof(cl_float), &hi);
+    cl::SetKernelArg(clamp, 3, sizeof(cl_mem), &y);
+
+    cl::NDRange local_ws  = cl::NDRange::Make(Params::kWorkGroupSize1d);
+    cl::NDRange global_ws = cl::NDRange::Make(
+        cl::NDRange::Roundup(array_size, Params::kWorkGroupSize1d));
+
+    auto tic = std::chrono::high_resolution_clock::now();
+    cl::EnqueueNDRangeKernel(queue, axpy, cl::NDRange::Null, global_ws, local_ws);
+    cl::EnqueueNDRangeKernel(queue, normalize, cl::NDRange::Null, global_ws, local_ws);
+    cl::EnqueueNDRangeKernel(queue, clamp, cl::NDRange::Null, global_ws, local_ws);
+    cl::Finish(queue);
+    auto toc = std::chrono::high_resolution_clock::now();
+
+    cl::ReleaseKernel(clamp);
+    cl::ReleaseKernel(normalize);
+    cl::ReleaseKernel(axpy);
+    cl::ReleaseProgram(program);
+
+    std::chrono::duration<double,std::ratio<1,1000>> msec = toc-tic;
+    return msec.count();
+}
+
+/** ---------------------------------------------------------------------------
+ * Execute y = clamp(normalize(a * x + y), lo, hi) with a single fused kernel.
+ */
+double ExecuteFused(
+    const size_t array_size,
+    const cl_float a,
+    const cl_float lo,
+    const cl_float hi,
+    cl_mem &x,
+    cl_mem &y)
+{
+    cl::Elementwise expr = cl::Elementwise::Make("float4", array_size);
+    size_t rx = cl::Elementwise::Load(expr, x);
+    size_t ry = cl::Elementwise::Load(expr, y);
+    size_t r = cl::Elementwise::Axpy(expr, a, rx, ry);
+    r = cl::Elementwise::Normalize(expr, r);
+    r = cl::Elementwise::Clamp(expr, r, lo, hi);
+    cl::Elementwise::Store(expr, y, r);
+    std::cout << cl::Elementwise::Source(expr) << "\n";
+
+    /* Compile outside the timed region, the program is built only once. */
+    cl::Elementwise::Compile(expr, clfw::Context(), clfw::Device());
+
+    auto tic = std::chrono::high_resolution_clock::now();
+    cl::Elementwise::Enqueue(expr, clfw::Context(), clfw::Device(), clfw::Queue());
+    cl::Finish(clfw::Queue());
+    auto toc = std::chrono::high_resolution_clock::now();
+
+    cl::Elementwise::Destroy(expr);
+
+    std::chrono::duration<double,std::ratio<1,1000>> msec = toc-tic;
+    return msec.count();
+}
+
+/** ---------------------------------------------------------------------------
+ * main
+ */
+int main(int argc, char const *argv[])
+{
+    /* Initialize OpenCL context on the specified device. */
+    clfw::Init(CL_DEVICE_TYPE_GPU, Params::kDeviceIndex);
+    std::cout << clfw::InfoString() << "\n";
+
+    cl_context context = clfw::Context();
+    cl_command_queue queue = clfw::Queue();
+
+    /* Create the host and device arrays. */
+    const size_t array_size = 1000000;
+    const cl_float a = 2.0f;
+    const cl_float lo = -0.5f;
+    const cl_float hi = 0.5f;
+
+    std::vector<cl_float4> x(array_size);
+    std::vector<cl_float4> y(array_size);
+    for (size_t i = 0; i < array_size; ++i) {
+        for (size_t k = 0; k < 4; ++k) {
+            x[i].s[k] = (cl_float) (i + k);
+            y[i].s[k] = (cl_float) (k + 1);
+        }
+    }
+
+    cl_mem x_buffer = cl::CreateBuffer(
+        context,
+        CL_MEM_READ_ONLY,
+        array_size * sizeof(cl_float4),
+        (void *) NULL);
+    cl_mem y_buffer = cl::CreateBuffer(
+        context,
+        CL_MEM_READ_WRITE,
+        array_size * sizeof(cl_float4),
+        (void *) NULL);
+
+    /* Run the unfused and the fused versions from the same input. */
+    std::vector<cl_float4> unfused(array_size);
+    std::vector<cl_float4> fused(array_size);
+
+    cl::EnqueueWriteBuffer(queue, x_buffer, CL_TRUE, 0,
+        array_size * sizeof(cl_float4), (void *) x.data());
+    cl::EnqueueWriteBuffer(queue, y_buffer, CL_TRUE, 0,
+        array_size * sizeof(cl_float4), (void *) y.data());
+    double unfused_msec = ExecuteUnfused(array_size, a, lo, hi, x_buffer, y_buffer);
+    cl::EnqueueReadBuffer(queue, y_buffer, CL_TRUE, 0,
+        array_size * sizeof(cl_float4), (void *) unfused.data());
+
+    cl::EnqueueWriteBuffer(queue, y_buffer, CL_TRUE, 0,
+        array_size * sizeof(cl_float4), (void *) y.data());
+    double fused_msec = ExecuteFused(array_size, a, lo, hi, x_buffer, y_buffer);
+    cl::EnqueueReadBuffer(queue, y_buffer, CL_TRUE, 0,
+        array_size * sizeof(cl_float4), (void *) fused.data());
+
+    /* Compare the results. */
+    double err = 0.0;
+    for (size_t i = 0; i < array_size; ++i) {
+        for (size_t k = 0; k < 4; ++k) {
+            err = std::max(err, (double)
+                std::fabs(fused[i].s[k] - unfused[i].s[k]));
+        }
+    }
+    std::printf("unfused elapsed time %lf\n", unfused_msec);
+    std::printf("fused elapsed time %lf\n", fused_msec);
+    std::printf("max error %lf\n", err);
+    ito_assert(err < kTolerance, "fused result differs from unfused result");
+
+    cl::ReleaseMemObject(y_buffer);
+    cl::ReleaseMemObject(x_buffer);
+
+    /* Terminate OpenCL context. */
+    clfw::Terminate();
+
+    exit(EXIT_SUCCESS);
+}
@@ -0,0 +1,116 @@
+/*
+ * main.cpp
+ *
+ * Copyright (c) 2020 Carlos Braga
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the MIT License.
+ *
+ * See accompanying LICENSE.md or https://opensource.org/licenses/MIT.
+ */
+
+#include <vector>
+#include <chrono>
+#include <numeric>
+#include <atomic>
+#include "../params.hpp"
+
+using namespace ito;
+
+/** ---------------------------------------------------------------------------
+ * Program vecscale kernel source.
+ */
+const std::string vecscale_source = ito_strify(
+__kernel void vecscale(
+    const unsigned long array_size,
+    const float scale,
+    __global float *a)
+{
+    const size_t ix = get_global_id(0);
+    if (ix < array_size) {
+       a[ix] *= scale;
+    }
+});
+
+/** ---------------------------------------------------------------------------
+ * main
+ */
+int main(int argc, char const *argv[])
+{
+    /* Initialize OpenCL context on the specified device. */
+    clfw::Init(CL_DEVICE_TYPE_GPU, Params::kDeviceIndex);
+    std::cout << clfw::InfoString() << "\n";
+
+    cl_context context = clfw::Context();
+    cl_command_queue queue = clfw::Queue();
+
+    cl_program program = cl::CreateProgramWithSource(context, vecscale_source);
+    cl::BuildProgram(program, clfw::Device());
+    cl_kernel kernel = cl::CreateKernel(program, "vecscale");
+
+    /* Create the host array and the device buffer. */
+    size_t array_size = 1000000;
+    std::vector<float> a(array_size, 0.0f);
+    std::iota(a.begin(), a.end(), 0);
+
+    cl_mem buffer = cl::CreateBuffer(
+        context,
+        CL_MEM_READ_WRITE,
+        array_size * sizeof(float),
+        (void *) NULL);
+
+    cl_float scale = 2.0f;
+    cl::SetKernelArg(kernel, 0, sizeof(cl_ulong), &array_size);
+    cl::SetKernelArg(kernel, 1, sizeof(cl_float), &scale);
+    cl::SetKernelArg(kernel, 2, sizeof(cl_mem), &buffer);
+
+    /*
+     * Write, scale and read the array without blocking, then insert host tasks
+     * in the queue: the first one writes the result to a file once the read is
+     * complete, and the second kernel launch only starts after it.
+     */
+    auto tic = std::chrono::high_resolution_clock::now();
+
+    cl::NDRange local_ws  = cl::NDRange::Make(Params::kWorkGroupSize1d);
+    cl::NDRange global_ws = cl::NDRange::Make(
+        cl::NDRange::Roundup(array_size, Params::kWorkGroupSize1d));
+
+    cl::EnqueueWriteBuffer(queue, buffer, CL_FALSE, 0,
+        array_size * sizeof(float), (void *) a.data());
+    cl::EnqueueNDRangeKernel(queue, kernel, cl::NDRange::Null, global_ws, local_ws);
+    cl::EnqueueReadBuffer(queue, buffer, CL_FALSE, 0,
+        array_size * sizeof(float), (void *) a.data());
+
+    std::atomic<size_t> n_tasks(0);
+    cl::EnqueueHostTask(queue, [&] () {
+        ito::file_ptr fp = ito::make_file("out.hosttask.bin", "wb");
+        ito::file::write(fp, (void *) a.data(), array_size * sizeof(float));
+        n_tasks++;
+    });
+
+    cl::EnqueueNDRangeKernel(queue, kernel, cl::NDRange::Null, global_ws, local_ws);
+
+    cl_event done;
+    cl::EnqueueHostTask(queue, [&] () { n_tasks++; }, NULL, &done);
+
+    auto toc = std::chrono::high_resolution_clock::now();
+    std::chrono::duration<double,std::ratio<1,1000>> msec = toc-tic;
+    std::printf("enqueue time %lf\n", msec.count());
+
+    cl::WaitForEvent(done);
+    cl::ReleaseEvent(done);
+    toc = std::chrono::high_resolution_clock::now();
+    msec = toc-tic;
+    std::printf("elapsed time %lf, host tasks %lu\n", msec.count(),
+        n_tasks.load());
+    std::remove("out.hosttask.bin");
+
+    cl::ReleaseMemObject(buffer);
+    cl::ReleaseKernel(kernel);
+    cl::ReleaseProgram(program);
+
+    /* Terminate OpenCL context. */
+    clfw::Terminate();
+
+    exit(EXIT_SUCCESS);
+}
@@ -0,0 +1,143 @@
+/*
+ * particles.cl
+ *
+ * Copyright (c) 2020 Carlos Braga
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the MIT License.
+ *
+ * See accompanying LICENSE.md or https://opensource.org/licenses/MIT.
+ */
+
+/*
+ * integrate
+ * Integrate the particles attracted to the origin inside the box [-1,1]^3,
+ * reflecting the velocities at the box walls.
+ */
+__kernel void integrate(
+    const ulong n_particles,
+    const float dt,
+    __global float4 *pos,
+    __global float4 *vel)
+{
+    const size_t i = get_global_id(0);
+    if (i >= n_particles) {
+        return;
+    }
+
+    float4 p = pos[i];
+    float4 v = vel[i];
+
+    float4 a = (float4) (-p.x, -p.y, -p.z, 0.0f);
+    v += dt * a;
+    p += dt * v;
+
+    if (fabs(p.x) > 1.0f) { v.x = -v.x; p.x = clamp(p.x, -1.0f, 1.0f); }
+    if (fabs(p.y) > 1.0f) { v.y = -v.y; p.y = clamp(p.y, -1.0f, 1.0f); }
+    if (fabs(p.z) > 1.0f) { v.z = -v.z; p.z = clamp(p.z, -1.0f, 1.0f); }
+
+    pos[i] = p;
+    vel[i] = v;
+}
+
+/*
+ * bin_clear
+ * Clear the particle counter of each grid cell.
+ */
+__kernel void bin_clear(
+    const uint n_cells,
+    __global uint *count)
+{
+    const size_t i = get_global_id(0);
+    if (i < n_cells) {
+        count[i] = 0;
+    }
+}
+
+/*
+ * bin_count
+ * Compute the grid cell of each particle and count the particles in each cell.
+ */
+__kernel void bin_count(
+    const ulong n_particles,
+    const uint n_side,
+    __global const float4 *pos,
+    __global uint *cell,
+    __global uint *count)
+{
+    const size_t i = get_global_id(0);
+    if (i >= n_particles) {
+        return;
+    }
+
+    float4 p = 0.5f * (pos[i] + 1.0f) * (float) n_side;
+    uint cx = min((uint) max(p.x, 0.0f), n_side - 1);
+    uint cy = min((uint) max(p.y, 0.0f), n_side - 1);
+    uint cz = min((uint) max(p.z, 0.0f), n_side - 1);
+    uint c = cx + n_side * (cy + n_side * cz);
+
+    cell[i] = c;
+    atomic_inc(&count[c]);
+}
+
+/*
+ * bin_scan
+ * Exclusive prefix sum of the cell counters computed by a single work-group.
+ * Each work-item sums a contiguous range of cells, the partial sums are
+ * scanned in local memory and added back to each range.
+ */
+__kernel void bin_scan(
+    const uint n_cells,
+    __global const uint *count,
+    __global uint *offset,
+    __local uint *partial)
+{
+    const uint lid = get_local_id(0);
+    const uint lsize = get_local_size(0);
+    const uint chunk = (n_cells + lsize - 1) / lsize;
+    const uint begin = min(lid * chunk, n_cells);
+    const uint end = min(begin + chunk, n_cells);
+
+    uint sum = 0;
+    for (uint c = begin; c < end; ++c) {
+        sum += count[c];
+    }
+    partial[lid] = sum;
+    barrier(CLK_LOCAL_MEM_FENCE);
+
+    for (uint stride = 1; stride < lsize; stride <<= 1) {
+        uint value = (lid >= stride) ? partial[lid - stride] : 0;
+        barrier(CLK_LOCAL_MEM_FENCE);
+        partial[lid] += value;
+        barrier(CLK_LOCAL_MEM_FENCE);
+    }
+
+    uint base = partial[lid] - sum;
+    for (uint c = begin; c < end; ++c) {
+        offset[c] = base;
+        base += count[c];
+    }
+}
+
+/*
+ * bin_scatter
+ * Scatter the particle positions and velocities in grid cell order.
+ */
+__kernel void bin_scatter(
+    const ulong n_particles,
+    __global const float4 *pos,
+    __global const float4 *vel,
+    __global const uint *cell,
+    __global uint *offset,
+    __global float4 *pos_sorted,
+    __global float4 *vel_sorted)
+{
+    const size_t i = get_global_id(0);
+    if (i >= n_particles) {
+        return;
+    }
+
+    uint j = atomic_inc(&offset[cell[i]]);
+    pos_sorted[j] = pos[i];
+    vel_sorted[j] = vel[i];
+}
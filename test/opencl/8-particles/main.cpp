@@ -0,0 +1,181 @@
+/*
+ * main.cpp
+ *
+ * Copyright (c) 2020 Carlos Braga
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the MIT License.
+ *
+ * See accompanying LICENSE.md or https://opensource.org/licenses/MIT.
+ */
+
+#include <chrono>
+#include <cstring>
+#include "../params.hpp"
+#include "particles.hpp"
+
+using namespace ito;
+
+/** ---------------------------------------------------------------------------
+ * @brief Constants and globals.
+ */
+static const int kWidth = 800;
+static const int kHeight = 800;
+static const char kTitle[] = "Test particles";
+static const double kTimeout = 0.001;
+static const float kTimestep = 0.005f;
+
+static const size_t kNumParticles = 100000;
+static const size_t kNumBenchFrames = 100;
+static const size_t kNumBenchWarmup = 10;
+
+Particles gParticles;
+
+/** ---------------------------------------------------------------------------
+ * @brief Return true if the GPU device with the specified index supports
+ * sharing buffers with the OpenGL context.
+ */
+static bool HasGLSharing(const size_t device_index)
+{
+    std::vector<cl_platform_id> platforms = cl::GetPlatformIDs();
+    cl_uint n_devices = 0;
+    cl_int err = clGetDeviceIDs(
+        platforms[0], CL_DEVICE_TYPE_GPU, 0, NULL, &n_devices);
+    if (err != CL_SUCCESS || device_index >= n_devices) {
+        return false;
+    }
+
+    std::vector<cl_device_id> devices = cl::GetDeviceIDs(CL_DEVICE_TYPE_GPU);
+    size_t size = 0;
+    clGetDeviceInfo(devices[device_index], CL_DEVICE_EXTENSIONS, 0, NULL, &size);
+    std::string extensions(size, '\0');
+    clGetDeviceInfo(devices[device_index], CL_DEVICE_EXTENSIONS, size,
+        (void *) &extensions[0], NULL);
+
+    return (extensions.find("cl_khr_gl_sharing") != std::string::npos ||
+            extensions.find("cl_APPLE_gl_sharing") != std::string::npos);
+}
+
+/** ---------------------------------------------------------------------------
+ * @brief Handle events.
+ */
+static void Handle(void)
+{
+    /* Poll events and handle. */
+    glfw::PollEvent(kTimeout);
+    while (glfw::HasEvent()) {
+        glfw::Event event = glfw::PopEvent();
+
+        if (event.type == glfw::Event::FramebufferSize) {
+            int w = event.framebuffersize.width;
+            int h = event.framebuffersize.height;
+            glfw::SetViewport({0, 0, w, h});
+        }
+
+        if ((event.type == glfw::Event::WindowClose) ||
+            (event.type == glfw::Event::Key &&
+             event.key.code == GLFW_KEY_ESCAPE)) {
+            glfw::Close();
+        }
+
+        gParticles.Handle(event);
+    }
+}
+
+/** ---------------------------------------------------------------------------
+ * @brief Update state.
+ */
+static void Update(void)
+{
+    gParticles.Update(kTimestep);
+}
+
+/** ---------------------------------------------------------------------------
+ * @brief Draw and swap buffers.
+ */
+static void Render(void)
+{
+    glfw::ClearBuffers(0.0f, 0.0f, 0.0f, 1.0f, 1.0f);
+    gParticles.Render();
+    glfw::SwapBuffers();
+}
+
+/** ---------------------------------------------------------------------------
+ * @brief Run the particle engine offscreen and print the frame time for an
+ * increasing number of particles.
+ */
+static void Benchmark(const bool is_shared)
+{
+    for (size_t n_particles : {100000, 1000000, 10000000}) {
+        gParticles = Particles::Create(n_particles, is_shared);
+
+        for (size_t i = 0; i < kNumBenchWarmup; ++i) {
+            Update();
+            Render();
+        }
+        glFinish();
+
+        auto tic = std::chrono::high_resolution_clock::now();
+        for (size_t i = 0; i < kNumBenchFrames; ++i) {
+            Update();
+            Render();
+        }
+        cl::Finish(clfw::Queue());
+        glFinish();
+        auto toc = std::chrono::high_resolution_clock::now();
+
+        std::chrono::duration<double,std::ratio<1,1000>> msec = toc-tic;
+        std::printf("particles %lu shared %d frame time %lf\n",
+            n_particles, is_shared, msec.count() / kNumBenchFrames);
+
+        Particles::Destroy(gParticles);
+    }
+}
+
+/** ---------------------------------------------------------------------------
+ * main test client
+ * Run with the "bench" argument to measure the frame time offscreen.
+ */
+int main(int argc, char const *argv[])
+{
+    bool bench = (argc > 1 && std::strcmp(argv[1], "bench") == 0);
+
+    /* Initalize GLFW library and create OpenGL context. */
+    glfw::Init(kWidth, kHeight, kTitle, 3, 3, bench);
+    glfw::EnableEvent(
+        glfw::Event::FramebufferSize |
+        glfw::Event::WindowClose     |
+        glfw::Event::Key);
+
+    /*
+     * Initialize the OpenCL context shared with the OpenGL context if the
+     * device supports it. Otherwise, use the first device and upload the
+     * particle positions to the vertex buffer every frame.
+     */
+    bool is_shared = HasGLSharing(Params::kDeviceIndex);
+    if (is_shared) {
+        clfw::InitFromGLContext(Params::kDeviceIndex);
+    } else {
+        clfw::Init(CL_DEVICE_TYPE_ALL, 0);
+    }
+    std::cout << clfw::InfoString() << "\n";
+
+    if (bench) {
+        Benchmark(is_shared);
+    } else {
+        /* Render loop: handle events, update state, and render. */
+        gParticles = Particles::Create(kNumParticles, is_shared);
+        while (glfw::IsOpen()) {
+            Handle();
+            Update();
+            Render();
+        }
+        Particles::Destroy(gParticles);
+    }
+
+    /* Terminate OpenCL context, GLFW library and destroy OpenGL context. */
+    clfw::Terminate();
+    glfw::Terminate();
+
+    exit(EXIT_SUCCESS);
+}
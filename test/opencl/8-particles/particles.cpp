@@ -0,0 +1,310 @@
+/*
+ * particles.cpp
+ *
+ * Copyright (c) 2020 Carlos Braga
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the MIT License.
+ *
+ * See accompanying LICENSE.md or https://opensource.org/licenses/MIT.
+ */
+
+#include <random>
+#include <utility>
+#include "../params.hpp"
+#include "particles.hpp"
+
+using namespace ito;
+
+/**
+ * @brief Number of grid cells along each dimension and particle quad size.
+ */
+static const cl_uint kNumSide = 32;
+static const GLfloat kParticleSize = 0.004f;
+
+/**
+ * @brief Create a new particle engine.
+ */
+Particles Particles::Create(const size_t n_particles, const bool is_shared)
+{
+    Particles particles;
+    particles.n_particles = n_particles;
+    particles.n_side = kNumSide;
+    particles.n_cells = kNumSide * kNumSide * kNumSide;
+    particles.is_shared = is_shared;
+    particles.mvp = math::mat4f::eye;
+
+    /*
+     * Initial particle positions and velocities.
+     */
+    std::vector<cl_float4> pos_data(n_particles);
+    std::vector<cl_float4> vel_data(n_particles);
+    {
+        std::mt19937 engine(1);
+        std::uniform_real_distribution<float> uniform(-1.0f, 1.0f);
+        for (size_t i = 0; i < n_particles; ++i) {
+            pos_data[i].s[0] = uniform(engine);
+            pos_data[i].s[1] = uniform(engine);
+            pos_data[i].s[2] = uniform(engine);
+            pos_data[i].s[3] = 1.0f;
+
+            vel_data[i].s[0] = -pos_data[i].s[1];
+            vel_data[i].s[1] =  pos_data[i].s[0];
+            vel_data[i].s[2] =  0.1f * uniform(engine);
+            vel_data[i].s[3] =  0.0f;
+        }
+    }
+    const GLsizeiptr pos_size = n_particles * sizeof(cl_float4);
+
+    /*
+     * Particle shader program object.
+     */
+    std::vector<GLuint> shaders{
+        gl::CreateShader(GL_VERTEX_SHADER, "data/particles.vert"),
+        gl::CreateShader(GL_FRAGMENT_SHADER, "data/particles.frag")};
+    particles.program = gl::CreateProgram(shaders);
+    gl::DestroyShader(shaders);
+    std::cout << gl::GetProgramInfoString(particles.program) << "\n";
+
+    /*
+     * Create vertex array object with the quad corners as per-vertex
+     * attributes and the particle positions as per-instance attributes.
+     */
+    particles.vao = gl::CreateVertexArray();
+    gl::BindVertexArray(particles.vao);
+
+    const std::vector<GLfloat> quad_data = {
+        -1.0f, -1.0f,
+         1.0f, -1.0f,
+        -1.0f,  1.0f,
+         1.0f,  1.0f};
+    const GLsizeiptr quad_size = quad_data.size() * sizeof(GLfloat);
+    particles.quad = gl::CreateBuffer(GL_ARRAY_BUFFER, quad_size, GL_STATIC_DRAW);
+    gl::BindBuffer(GL_ARRAY_BUFFER, particles.quad);
+    glBufferSubData(GL_ARRAY_BUFFER, 0, quad_size, quad_data.data());
+
+    gl::EnableAttribute(particles.program, "a_corner");
+    gl::AttributePointer(
+        particles.program,
+        "a_corner",
+        GL_FLOAT_VEC2,
+        2 * sizeof(GLfloat),    /* offset between consecutive attributes */
+        0,                      /* offset of first element in the buffer */
+        false);                 /* normalized flag */
+
+    particles.vbo = gl::CreateBuffer(GL_ARRAY_BUFFER, pos_size, GL_DYNAMIC_DRAW);
+    gl::BindBuffer(GL_ARRAY_BUFFER, particles.vbo);
+    glBufferSubData(GL_ARRAY_BUFFER, 0, pos_size, pos_data.data());
+
+    gl::EnableAttribute(particles.program, "a_pos");
+    gl::AttributePointer(
+        particles.program,
+        "a_pos",
+        GL_FLOAT_VEC4,
+        4 * sizeof(GLfloat),    /* offset between consecutive attributes */
+        0,                      /* offset of first element in the buffer */
+        false);                 /* normalized flag */
+    gl::AttributeDivisor(particles.program, "a_pos", 1);
+
+    gl::BindVertexArray(0);
+    gl::BindBuffer(GL_ARRAY_BUFFER, 0);
+
+    /* Ensure the vertex buffer store is complete before OpenCL uses it. */
+    glFinish();
+
+    /*
+     * Create the OpenCL particle kernels.
+     */
+    cl_context context = clfw::Context();
+    particles.kernels = cl::CreateProgramFromFile(context, "data/particles.cl");
+    cl::BuildProgram(particles.kernels, clfw::Device());
+
+    particles.integrate = cl::CreateKernel(particles.kernels, "integrate");
+    particles.bin_clear = cl::CreateKernel(particles.kernels, "bin_clear");
+    particles.bin_count = cl::CreateKernel(particles.kernels, "bin_count");
+    particles.bin_scan = cl::CreateKernel(particles.kernels, "bin_scan");
+    particles.bin_scatter = cl::CreateKernel(particles.kernels, "bin_scatter");
+
+    /*
+     * Create the OpenCL buffers. The positions are shared with the vertex
+     * buffer if possible, otherwise they live on the device and are uploaded
+     * into the vertex buffer after each update.
+     */
+    if (is_shared) {
+        particles.pos = cl::CreateFromGLBuffer(
+            context, CL_MEM_READ_WRITE, particles.vbo);
+        particles.session = cl::GLSession::Create(
+            context, clfw::Device(), clfw::Queue());
+        cl::GLSession::Attach(particles.session, particles.pos);
+    } else {
+        particles.pos = cl::CreateBuffer(
+            context, CL_MEM_READ_WRITE, pos_size, NULL);
+        particles.staging.resize(n_particles);
+        cl::EnqueueWriteBuffer(clfw::Queue(), particles.pos, CL_TRUE, 0,
+            pos_size, (void *) pos_data.data());
+    }
+
+    particles.vel = cl::CreateBuffer(
+        context, CL_MEM_READ_WRITE, pos_size, NULL);
+    particles.pos_sorted = cl::CreateBuffer(
+        context, CL_MEM_READ_WRITE, pos_size, NULL);
+    particles.vel_sorted = cl::CreateBuffer(
+        context, CL_MEM_READ_WRITE, pos_size, NULL);
+    particles.cell = cl::CreateBuffer(
+        context, CL_MEM_READ_WRITE, n_particles * sizeof(cl_uint), NULL);
+    particles.count = cl::CreateBuffer(
+        context, CL_MEM_READ_WRITE, particles.n_cells * sizeof(cl_uint), NULL);
+    particles.offset = cl::CreateBuffer(
+        context, CL_MEM_READ_WRITE, particles.n_cells * sizeof(cl_uint), NULL);
+
+    cl::EnqueueWriteBuffer(clfw::Queue(), particles.vel, CL_TRUE, 0,
+        pos_size, (void *) vel_data.data());
+
+    return particles;
+}
+
+/**
+ * @brief Destroy the particle engine.
+ */
+void Particles::Destroy(Particles &particles)
+{
+    cl::Finish(clfw::Queue());
+    if (particles.is_shared) {
+        cl::GLSession::Destroy(particles.session);
+    }
+
+    cl::ReleaseMemObject(particles.offset);
+    cl::ReleaseMemObject(particles.count);
+    cl::ReleaseMemObject(particles.cell);
+    cl::ReleaseMemObject(particles.vel_sorted);
+    cl::ReleaseMemObject(particles.pos_sorted);
+    cl::ReleaseMemObject(particles.vel);
+    cl::ReleaseMemObject(particles.pos);
+
+    cl::ReleaseKernel(particles.bin_scatter);
+    cl::ReleaseKernel(particles.bin_scan);
+    cl::ReleaseKernel(particles.bin_count);
+    cl::ReleaseKernel(particles.bin_clear);
+    cl::ReleaseKernel(particles.integrate);
+    cl::ReleaseProgram(particles.kernels);
+
+    gl::DestroyBuffer(particles.vbo);
+    gl::DestroyBuffer(particles.quad);
+    gl::DestroyVertexArray(particles.vao);
+    gl::DestroyProgram(particles.program);
+}
+
+/**
+ * @brief Handle the event in the particle engine.
+ */
+void Particles::Handle(glfw::Event &event)
+{}
+
+/**
+ * @brief Integrate, bin and sort the particles on the device.
+ */
+void Particles::Update(const float dt)
+{
+    cl_command_queue queue = clfw::Queue();
+    cl_ulong n = n_particles;
+
+    cl::NDRange local_ws  = cl::NDRange::Make(Params::kWorkGroupSize1d);
+    cl::NDRange global_ws = cl::NDRange::Make(
+        cl::NDRange::Roundup(n_particles, Params::kWorkGroupSize1d));
+    cl::NDRange global_cells_ws = cl::NDRange::Make(
+        cl::NDRange::Roundup(n_cells, Params::kWorkGroupSize1d));
+
+    if (is_shared) {
+        cl::GLSession::Acquire(session);
+    }
+
+    /* Integrate the particles in place. */
+    cl::SetKernelArg(integrate, 0, sizeof(cl_ulong), &n);
+    cl::SetKernelArg(integrate, 1, sizeof(cl_float), &dt);
+    cl::SetKernelArg(integrate, 2, sizeof(cl_mem), &pos);
+    cl::SetKernelArg(integrate, 3, sizeof(cl_mem), &vel);
+    cl::EnqueueNDRangeKernel(
+        queue, integrate, cl::NDRange::Null, global_ws, local_ws);
+
+    /* Count the particles in each grid cell. */
+    cl::SetKernelArg(bin_clear, 0, sizeof(cl_uint), &n_cells);
+    cl::SetKernelArg(bin_clear, 1, sizeof(cl_mem), &count);
+    cl::EnqueueNDRangeKernel(
+        queue, bin_clear, cl::NDRange::Null, global_cells_ws, local_ws);
+
+    cl::SetKernelArg(bin_count, 0, sizeof(cl_ulong), &n);
+    cl::SetKernelArg(bin_count, 1, sizeof(cl_uint), &n_side);
+    cl::SetKernelArg(bin_count, 2, sizeof(cl_mem), &pos);
+    cl::SetKernelArg(bin_count, 3, sizeof(cl_mem), &cell);
+    cl::SetKernelArg(bin_count, 4, sizeof(cl_mem), &count);
+    cl::EnqueueNDRangeKernel(
+        queue, bin_count, cl::NDRange::Null, global_ws, local_ws);
+
+    /* Compute the first particle of each cell in a single work-group. */
+    cl::SetKernelArg(bin_scan, 0, sizeof(cl_uint), &n_cells);
+    cl::SetKernelArg(bin_scan, 1, sizeof(cl_mem), &count);
+    cl::SetKernelArg(bin_scan, 2, sizeof(cl_mem), &offset);
+    cl::SetKernelArg(bin_scan, 3, Params::kWorkGroupSize1d * sizeof(cl_uint), NULL);
+    cl::EnqueueNDRangeKernel(
+        queue, bin_scan, cl::NDRange::Null, local_ws, local_ws);
+
+    /* Scatter the particles in cell order and copy them back. */
+    cl::SetKernelArg(bin_scatter, 0, sizeof(cl_ulong), &n);
+    cl::SetKernelArg(bin_scatter, 1, sizeof(cl_mem), &pos);
+    cl::SetKernelArg(bin_scatter, 2, sizeof(cl_mem), &vel);
+    cl::SetKernelArg(bin_scatter, 3, sizeof(cl_mem), &cell);
+    cl::SetKernelArg(bin_scatter, 4, sizeof(cl_mem), &offset);
+    cl::SetKernelArg(bin_scatter, 5, sizeof(cl_mem), &pos_sorted);
+    cl::SetKernelArg(bin_scatter, 6, sizeof(cl_mem), &vel_sorted);
+    cl::EnqueueNDRangeKernel(
+        queue, bin_scatter, cl::NDRange::Null, global_ws, local_ws);
+
+    cl::EnqueueCopyBuffer(
+        queue, pos_sorted, pos, 0, 0, n_particles * sizeof(cl_float4));
+    std::swap(vel, vel_sorted);
+
+    /* Hand the positions over to OpenGL. */
+    if (is_shared) {
+        cl::GLSession::Release(session);
+    } else {
+        cl::EnqueueReadBuffer(queue, pos_sorted, CL_TRUE, 0,
+            n_particles * sizeof(cl_float4), (void *) staging.data());
+        gl::BindBuffer(GL_ARRAY_BUFFER, vbo);
+        glBufferSubData(GL_ARRAY_BUFFER, 0,
+            n_particles * sizeof(cl_float4), staging.data());
+        gl::BindBuffer(GL_ARRAY_BUFFER, 0);
+    }
+
+    /* Update the modelviewprojection matrix */
+    std::array<GLfloat,2> fbsize = {};
+    glfw::GetFramebufferSize(fbsize);
+    float ratio = fbsize[0] / fbsize[1];
+    mvp = math::lookat(
+        math::vec3f{0.0f, 0.0f, 3.0f},
+        math::vec3f{0.0f, 0.0f, 0.0f},
+        math::vec3f{0.0f, 1.0f, 0.0f});
+    mvp = math::perspective(mvp, (float) (0.25 * M_PI), ratio, 0.1f, 10.0f);
+}
+
+/**
+ * @brief Render the particles as instanced quads.
+ */
+void Particles::Render(void)
+{
+    /* Specify draw state modes. */
+    glPolygonMode(GL_FRONT_AND_BACK, GL_FILL);
+    gl::Disable(GL_CULL_FACE);
+    gl::Enable(GL_DEPTH_TEST);
+    gl::DepthFunc(GL_LESS);
+
+    /* Bind the shader program object and draw the particle instances. */
+    gl::UseProgram(program);
+    gl::SetUniformMatrix(program, "u_mvp", GL_FLOAT_MAT4, true, mvp.data);
+    gl::SetUniform(program, "u_size", GL_FLOAT, &kParticleSize);
+
+    gl::BindVertexArray(vao);
+    glDrawArraysInstanced(GL_TRIANGLE_STRIP, 0, 4, (GLsizei) n_particles);
+    gl::BindVertexArray(0);
+
+    gl::UseProgram(0);
+}
@@ -0,0 +1,69 @@
+/*
+ * particles.hpp
+ *
+ * Copyright (c) 2020 Carlos Braga
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the MIT License.
+ *
+ * See accompanying LICENSE.md or https://opensource.org/licenses/MIT.
+ */
+
+#ifndef TEST_ITO_OPENCL_PARTICLES_H_
+#define TEST_ITO_OPENCL_PARTICLES_H_
+
+#include <vector>
+#include "ito/opengl.hpp"
+#include "ito/opencl.hpp"
+
+/**
+ * Particles
+ * @brief Particle engine integrating positions on the OpenCL device and
+ * drawing them as instanced quads from an OpenGL vertex buffer.
+ *
+ * Each frame the particles are integrated, binned into a uniform grid with a
+ * counting sort, and scattered in cell order into the shared vertex buffer.
+ * If the device supports cl_khr_gl_sharing, the vertex buffer is shared with
+ * OpenCL and the frame has no host round-trips. Otherwise, the sorted
+ * positions are read back and uploaded into the vertex buffer.
+ */
+struct Particles {
+    /* Particle engine parameters */
+    size_t n_particles;                 /* number of particles */
+    cl_uint n_side;                     /* grid cells along each dimension */
+    cl_uint n_cells;                    /* total number of grid cells */
+    bool is_shared;                     /* vertex buffer shared with OpenCL */
+
+    /* OpenGL render objects */
+    GLuint program;                     /* shader program object */
+    GLuint vao;                         /* vertex array object */
+    GLuint quad;                        /* instance geometry vertex buffer */
+    GLuint vbo;                         /* instance position vertex buffer */
+    ito::math::mat4f mvp;               /* modelviewprojection matrix */
+
+    /* OpenCL compute objects */
+    cl_program kernels;                 /* particle kernels program */
+    cl_kernel integrate;                /* integrate positions and velocities */
+    cl_kernel bin_clear;                /* clear the grid cell counters */
+    cl_kernel bin_count;                /* count the particles in each cell */
+    cl_kernel bin_scan;                 /* prefix sum of the cell counters */
+    cl_kernel bin_scatter;              /* scatter the particles in cell order */
+    cl_mem pos;                         /* positions, shared with vbo */
+    cl_mem vel;                         /* velocities */
+    cl_mem pos_sorted;                  /* positions in cell order */
+    cl_mem vel_sorted;                  /* velocities in cell order */
+    cl_mem cell;                        /* cell index of each particle */
+    cl_mem count;                       /* number of particles in each cell */
+    cl_mem offset;                      /* first particle in each cell */
+    ito::cl::GLSession session;         /* shared objects session */
+    std::vector<cl_float4> staging;     /* host positions if not shared */
+
+    void Handle(ito::glfw::Event &event);
+    void Update(const float dt);
+    void Render(void);
+
+    static Particles Create(const size_t n_particles, const bool is_shared);
+    static void Destroy(Particles &particles);
+};
+
+#endif /* TEST_ITO_OPENCL_PARTICLES_H_ */
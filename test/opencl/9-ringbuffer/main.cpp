@@ -0,0 +1,148 @@
+/*
+ * main.cpp
+ *
+ * Copyright (c) 2020 Carlos Braga
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the MIT License.
+ *
+ * See accompanying LICENSE.md or https://opensource.org/licenses/MIT.
+ */
+
+#include <vector>
+#include <chrono>
+#include <cmath>
+#include "../params.hpp"
+
+using namespace ito;
+
+/** ---------------------------------------------------------------------------
+ * Program filter kernel source.
+ */
+const std::string filter_source = ito_strify(
+__kernel void filter(
+    const unsigned long n_samples,
+    const float alpha,
+    __global const float *samples,
+    __global float *state)
+{
+    const size_t ix = get_global_id(0);
+    if (ix < n_samples) {
+       state[ix] = mix(state[ix], samples[ix], alpha);
+    }
+});
+
+/** ---------------------------------------------------------------------------
+ * @brief Fill the frame samples on the host.
+ */
+static void Produce(float *samples, const size_t n_samples, const size_t frame)
+{
+    for (size_t i = 0; i < n_samples; ++i) {
+        samples[i] = std::sin(0.001f * (float) (i + frame));
+    }
+}
+
+/** ---------------------------------------------------------------------------
+ * main
+ */
+int main(int argc, char const *argv[])
+{
+    /* Initialize OpenCL context on the specified device. */
+    clfw::Init(CL_DEVICE_TYPE_GPU, Params::kDeviceIndex);
+    std::cout << clfw::InfoString() << "\n";
+
+    cl_context context = clfw::Context();
+    cl_device_id device = clfw::Device();
+    cl_command_queue queue = clfw::Queue();
+
+    cl_program program = cl::CreateProgramWithSource(context, filter_source);
+    cl::BuildProgram(program, device);
+    cl_kernel kernel = cl::CreateKernel(program, "filter");
+
+    const size_t n_samples = 1 << 20;
+    const size_t n_frames = 200;
+    const size_t n_slots = 3;
+    const cl_float alpha = 0.1f;
+
+    cl_mem state = cl::CreateBuffer(
+        context,
+        CL_MEM_READ_WRITE,
+        n_samples * sizeof(float),
+        (void *) NULL);
+
+    cl_ulong n = n_samples;
+    cl::SetKernelArg(kernel, 0, sizeof(cl_ulong), &n);
+    cl::SetKernelArg(kernel, 1, sizeof(cl_float), &alpha);
+    cl::SetKernelArg(kernel, 3, sizeof(cl_mem), &state);
+
+    cl::NDRange local_ws  = cl::NDRange::Make(Params::kWorkGroupSize1d);
+    cl::NDRange global_ws = cl::NDRange::Make(
+        cl::NDRange::Roundup(n_samples, Params::kWorkGroupSize1d));
+
+    /*
+     * Stream the samples with a blocking write into a single buffer.
+     */
+    {
+        std::vector<float> samples(n_samples);
+        cl_mem buffer = cl::CreateBuffer(
+            context,
+            CL_MEM_READ_ONLY,
+            n_samples * sizeof(float),
+            (void *) NULL);
+        cl::SetKernelArg(kernel, 2, sizeof(cl_mem), &buffer);
+
+        auto tic = std::chrono::high_resolution_clock::now();
+        for (size_t frame = 0; frame < n_frames; ++frame) {
+            Produce(samples.data(), n_samples, frame);
+            cl::EnqueueWriteBuffer(queue, buffer, CL_TRUE, 0,
+                n_samples * sizeof(float), (void *) samples.data());
+            cl::EnqueueNDRangeKernel(
+                queue, kernel, cl::NDRange::Null, global_ws, local_ws);
+        }
+        cl::Finish(queue);
+        auto toc = std::chrono::high_resolution_clock::now();
+
+        std::chrono::duration<double,std::ratio<1,1000>> msec = toc-tic;
+        std::printf("write buffer elapsed time %lf\n", msec.count());
+        cl::ReleaseMemObject(buffer);
+    }
+
+    /*
+     * Stream the samples through the ring buffer slots.
+     */
+    {
+        cl::RingBuffer ring = cl::RingBuffer::Create(
+            context, device, n_samples * sizeof(float), n_slots);
+
+        auto tic = std::chrono::high_resolution_clock::now();
+        for (size_t frame = 0; frame < n_frames; ++frame) {
+            float *samples = (float *) cl::RingBuffer::Begin(ring);
+            Produce(samples, n_samples, frame);
+            cl_mem slot = cl::RingBuffer::End(ring, queue);
+
+            cl_event event;
+            cl::SetKernelArg(kernel, 2, sizeof(cl_mem), &slot);
+            cl::EnqueueNDRangeKernel(
+                queue, kernel, cl::NDRange::Null, global_ws, local_ws,
+                NULL, &event);
+            cl::RingBuffer::Fence(ring, event);
+            cl::ReleaseEvent(event);
+            cl::Flush(queue);
+        }
+        cl::Finish(queue);
+        auto toc = std::chrono::high_resolution_clock::now();
+
+        std::chrono::duration<double,std::ratio<1,1000>> msec = toc-tic;
+        std::printf("ring buffer elapsed time %lf\n", msec.count());
+        cl::RingBuffer::Destroy(ring);
+    }
+
+    cl::ReleaseMemObject(state);
+    cl::ReleaseKernel(kernel);
+    cl::ReleaseProgram(program);
+
+    /* Terminate OpenCL context. */
+    clfw::Terminate();
+
+    exit(EXIT_SUCCESS);
+}
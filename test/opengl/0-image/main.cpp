@@ -9,6 +9,8 @@
  * See accompanying LICENSE.md or https://opensource.org/licenses/MIT.
  */
 
+#include <algorithm>
+#include <cmath>
 #include "ito/opengl.hpp"
 
 using namespace ito;
@@ -35,6 +37,150 @@ static const std::vector<std::string> kImageFilenames = {
     "monarch_512.png",
     "pool_512.png"};
 
+/*
+ * Compressed image error bounds. Blocks of a single colour only lose the
+ * RGB565 rounding, and the alpha error is at most half the step of the
+ * widest alpha palette, 255/14.
+ */
+static const double kMaxFlatError = 4.0;
+static const double kMaxAlphaError = 19.0;
+static const double kMaxRmsError = 12.0;
+
+/** ---------------------------------------------------------------------------
+ * @brief Decode the 4x4 colour block of a BC1 or BC3 block into RGBA pixels.
+ * The three colour palette with transparent black is only used by BC1.
+ */
+static void DecodeColorBlock(
+    const uint8_t *in,
+    const bool is_bc1,
+    uint8_t out[16][4])
+{
+    uint16_t c[2] = {
+        (uint16_t) (in[0] | (in[1] << 8)),
+        (uint16_t) (in[2] | (in[3] << 8))};
+
+    int32_t palette[4][4];
+    for (uint32_t k = 0; k < 2; ++k) {
+        uint32_t r = (c[k] >> 11) & 31;
+        uint32_t g = (c[k] >> 5) & 63;
+        uint32_t b = c[k] & 31;
+        palette[k][0] = (r << 3) | (r >> 2);
+        palette[k][1] = (g << 2) | (g >> 4);
+        palette[k][2] = (b << 3) | (b >> 2);
+        palette[k][3] = 255;
+    }
+    for (uint32_t ch = 0; ch < 3; ++ch) {
+        int32_t p0 = palette[0][ch];
+        int32_t p1 = palette[1][ch];
+        if (c[0] > c[1] || !is_bc1) {
+            palette[2][ch] = (2 * p0 + p1) / 3;
+            palette[3][ch] = (p0 + 2 * p1) / 3;
+        } else {
+            palette[2][ch] = (p0 + p1) / 2;
+            palette[3][ch] = 0;
+        }
+    }
+    palette[2][3] = 255;
+    palette[3][3] = (c[0] > c[1] || !is_bc1) ? 255 : 0;
+
+    uint32_t bits = in[4] | (in[5] << 8) | (in[6] << 16) | (in[7] << 24);
+    for (uint32_t i = 0; i < 16; ++i) {
+        uint32_t index = (bits >> (2 * i)) & 3;
+        for (uint32_t ch = 0; ch < 4; ++ch) {
+            out[i][ch] = (uint8_t) palette[index][ch];
+        }
+    }
+}
+
+/**
+ * @brief Decode the alpha channel of a BC3 block.
+ */
+static void DecodeAlphaBlock(const uint8_t *in, uint8_t out[16][4])
+{
+    int32_t a0 = in[0];
+    int32_t a1 = in[1];
+    int32_t palette[8] = {a0, a1};
+    for (int32_t k = 2; k < 8; ++k) {
+        palette[k] = (a0 > a1)
+            ? ((8 - k) * a0 + (k - 1) * a1) / 7
+            : (k < 6 ? ((6 - k) * a0 + (k - 1) * a1) / 5 : (k == 6 ? 0 : 255));
+    }
+
+    uint64_t bits = 0;
+    for (uint32_t k = 0; k < 6; ++k) {
+        bits |= (uint64_t) in[2 + k] << (8 * k);
+    }
+    for (uint32_t i = 0; i < 16; ++i) {
+        out[i][3] = (uint8_t) palette[(bits >> (3 * i)) & 7];
+    }
+}
+
+/**
+ * @brief Decode the base level of a compressed image and compare it with the
+ * source image. Return the maximum colour error over blocks of a single
+ * colour, the maximum alpha error of BC3 images, and the root mean square
+ * colour error.
+ */
+static void CompressedError(
+    const gl::CompressedImage &compressed,
+    const gl::Image &image,
+    double &max_flat_error,
+    double &max_alpha_error,
+    double &rms_error)
+{
+    const bool is_bc1 =
+        compressed.internalformat == GL_COMPRESSED_RGB_S3TC_DXT1_EXT;
+    const uint32_t n_bytes = image.bpp >> 3;
+    const gl::CompressedImage::Level &level = compressed.levels[0];
+    const uint32_t n_blocks_x = (level.width + 3) / 4;
+    const uint32_t n_blocks_y = (level.height + 3) / 4;
+
+    max_flat_error = 0.0;
+    max_alpha_error = 0.0;
+    rms_error = 0.0;
+    for (uint32_t by = 0; by < n_blocks_y; ++by) {
+        for (uint32_t bx = 0; bx < n_blocks_x; ++bx) {
+            const uint8_t *in = &compressed.data[level.offset +
+                (by * n_blocks_x + bx) * compressed.block_size];
+            uint8_t block[16][4];
+            uint8_t alpha[16][4];
+            if (!is_bc1) {
+                DecodeAlphaBlock(in, alpha);
+                in += 8;
+            }
+            DecodeColorBlock(in, is_bc1, block);
+
+            /* Source pixels, replicating the edge pixels as the encoder. */
+            int32_t src[16][4];
+            bool is_flat = true;
+            for (uint32_t i = 0; i < 16; ++i) {
+                uint32_t x = std::min(4 * bx + (i % 4), level.width - 1);
+                uint32_t y = std::min(4 * by + (i / 4), level.height - 1);
+                const uint8_t *px = image(x, y);
+                for (uint32_t ch = 0; ch < 4; ++ch) {
+                    src[i][ch] = ch < n_bytes ? px[ch] : (ch == 3 ? 255 : 0);
+                    is_flat = is_flat && (ch == 3 || src[i][ch] == src[0][ch]);
+                }
+            }
+
+            for (uint32_t i = 0; i < 16; ++i) {
+                for (uint32_t ch = 0; ch < 3; ++ch) {
+                    double err = std::abs(block[i][ch] - src[i][ch]);
+                    if (is_flat) {
+                        max_flat_error = std::max(max_flat_error, err);
+                    }
+                    rms_error += err * err;
+                }
+                if (!is_bc1) {
+                    double err = std::abs(alpha[i][3] - src[i][3]);
+                    max_alpha_error = std::max(max_alpha_error, err);
+                }
+            }
+        }
+    }
+    rms_error = std::sqrt(rms_error / (48.0 * n_blocks_x * n_blocks_y));
+}
+
 /** ---------------------------------------------------------------------------
  * main test client
  */
@@ -131,5 +277,97 @@ int main(int argc, char const *argv[])
         }
     }
 
+    /* ---- Test png image save and load --------------------------------------
+     */
+    {
+        for (auto &filename : kImageFilenames) {
+            std::string out_png = "out." + filename + ".roundtrip.png";
+
+            gl::Image image = gl::Image::Load(kReadPrefix + filename);
+            gl::Image::SavePng(image, kWritePrefix + out_png);
+            gl::Image png = gl::Image::Load(kWritePrefix + out_png);
+            ito_assert(png.width == image.width &&
+                png.height == image.height &&
+                png.bpp == image.bpp, "png image layout mismatch");
+            ito_assert(png.bitmap == image.bitmap, "png image mismatch");
+
+            gl::Image::SavePng(image, kWritePrefix + out_png, true);
+            gl::Image flip = gl::Image::Load(kWritePrefix + out_png, true);
+            ito_assert(flip.bitmap == image.bitmap, "png image flip mismatch");
+        }
+    }
+
+    /* ---- Test raw image save and load --------------------------------------
+     */
+    {
+        for (auto &filename : kImageFilenames) {
+            std::string out_pam = "out." + filename + ".pam";
+            std::string out_raw = "out." + filename + ".raw";
+
+            gl::Image image = gl::Image::Load(kReadPrefix + filename);
+            gl::Image::SavePam(image, kWritePrefix + out_pam);
+            gl::Image::SaveRaw(image, kWritePrefix + out_raw);
+
+            gl::Image raw = gl::Image::Load(kWritePrefix + out_raw, false);
+            ito_assert(raw.bitmap == image.bitmap, "raw image mismatch");
+            std::cout << gl::Image::InfoString(raw, out_raw.c_str()) << "\n";
+        }
+    }
+
+    /* ---- Test compressed image save and load -------------------------------
+     */
+    {
+        for (auto &filename : kImageFilenames) {
+            std::string out_bc1 = "out." + filename + ".bc1.ktx";
+            std::string out_bc3 = "out." + filename + ".bc3.ktx";
+
+            gl::Image image = gl::Image::Load(kReadPrefix + filename);
+            gl::CompressedImage bc1 = gl::CompressedImage::Create(
+                image, GL_COMPRESSED_RGB_S3TC_DXT1_EXT);
+            gl::CompressedImage bc3 = gl::CompressedImage::Create(
+                image, GL_COMPRESSED_RGBA_S3TC_DXT5_EXT);
+            gl::CompressedImage::Save(bc1, kWritePrefix + out_bc1);
+            gl::CompressedImage::Save(bc3, kWritePrefix + out_bc3);
+
+            gl::CompressedImage ktx = gl::CompressedImage::Load(
+                kWritePrefix + out_bc3);
+            ito_assert(ktx.data == bc3.data, "compressed image mismatch");
+            std::cout << gl::CompressedImage::InfoString(ktx, out_bc3.c_str())
+                      << "\n";
+
+            for (auto &compressed : {bc1, bc3}) {
+                double max_flat_error, max_alpha_error, rms_error;
+                CompressedError(compressed, image,
+                    max_flat_error, max_alpha_error, rms_error);
+                std::cout << ito::str::format(
+                    "flat error %.1lf, alpha error %.1lf, rms error %.2lf\n",
+                    max_flat_error, max_alpha_error, rms_error);
+                ito_assert(max_flat_error <= kMaxFlatError &&
+                    max_alpha_error <= kMaxAlphaError &&
+                    rms_error <= kMaxRmsError, "compressed image error");
+            }
+        }
+
+        /* Alpha varying in every block, with colour gradients. */
+        gl::Image image = gl::Image::Create(61, 37, 32);
+        for (uint32_t y = 0; y < image.height; ++y) {
+            for (uint32_t x = 0; x < image.width; ++x) {
+                uint8_t *px = &image.bitmap[y * image.pitch + 4 * x];
+                px[0] = (uint8_t) (4 * x);
+                px[1] = (uint8_t) (6 * y);
+                px[2] = (uint8_t) (255 - 4 * x);
+                px[3] = (uint8_t) (13 * (37 * x + 101 * y));
+            }
+        }
+        gl::CompressedImage bc3 = gl::CompressedImage::Create(
+            image, GL_COMPRESSED_RGBA_S3TC_DXT5_EXT);
+        double max_flat_error, max_alpha_error, rms_error;
+        CompressedError(bc3, image,
+            max_flat_error, max_alpha_error, rms_error);
+        ito_assert(max_flat_error <= kMaxFlatError &&
+            max_alpha_error <= kMaxAlphaError &&
+            rms_error <= kMaxRmsError, "compressed image alpha error");
+    }
+
     exit(EXIT_SUCCESS);
 }
@@ -0,0 +1,16 @@
+#version 330 core
+
+in vec4 vert_wave_normal;
+in vec4 vert_wave_color;
+in vec2 vert_wave_texcoord;
+
+out vec4 frag_color;
+
+/*
+ * fragment shader main
+ */
+void main(void)
+{
+    float shade = 0.5 + 0.5 * abs(vert_wave_normal.z);
+    frag_color = vec4(shade * vert_wave_color.rgb, 1.0);
+}
@@ -0,0 +1,23 @@
+#version 330 core
+
+uniform mat4 u_mvp;
+
+layout (location = 0) in vec3 wave_position;
+layout (location = 1) in vec3 wave_normal;
+layout (location = 2) in vec3 wave_color;
+layout (location = 3) in vec2 wave_texcoord;
+
+out vec4 vert_wave_normal;
+out vec4 vert_wave_color;
+out vec2 vert_wave_texcoord;
+
+/*
+ * vertex shader main
+ */
+void main(void)
+{
+    gl_Position = u_mvp * vec4(wave_position, 1.0);
+    vert_wave_normal = vec4(wave_normal, 1.0);
+    vert_wave_color = vec4(wave_color, 1.0);
+    vert_wave_texcoord = wave_texcoord;
+}
@@ -0,0 +1,178 @@
+/*
+ * wave.cpp
+ *
+ * Copyright (c) 2020 Carlos Braga
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the MIT License.
+ *
+ * See accompanying LICENSE.md or https://opensource.org/licenses/MIT.
+ */
+
+#include <cmath>
+#include "ito/opengl.hpp"
+#include "wave.hpp"
+
+using namespace ito;
+
+/**
+ * @brief Wave constant parameters.
+ */
+static const size_t kMeshNodes = 512;
+static const size_t kBandRows = 64;
+static const GLfloat kAmplitude = 0.2f;
+
+/**
+ * @brief Set the height and normal of the vertices in the rows [lo, hi) with
+ * the wave band starting at the specified row.
+ */
+static void SetRows(
+    std::vector<gl::Mesh::Vertex> &vertices,
+    const size_t lo,
+    const size_t hi,
+    const size_t row)
+{
+    const GLfloat dy = 2.0f / (GLfloat) (kMeshNodes - 1);
+    for (size_t j = lo; j < hi; ++j) {
+        GLfloat z = 0.0f;
+        GLfloat dzdy = 0.0f;
+        if (j >= row && j < row + kBandRows) {
+            GLfloat phase = M_PI * (GLfloat) (j - row) / (GLfloat) kBandRows;
+            z = kAmplitude * std::sin(phase);
+            dzdy = kAmplitude * std::cos(phase) * M_PI / (kBandRows * dy);
+        }
+
+        GLfloat norm = 1.0f / std::sqrt(1.0f + dzdy * dzdy);
+        for (size_t i = 0; i < kMeshNodes; ++i) {
+            gl::Mesh::Vertex &vertex = vertices[i + j * kMeshNodes];
+            vertex.position[2] = z;
+            vertex.normal[0] = 0.0f;
+            vertex.normal[1] = -dzdy * norm;
+            vertex.normal[2] = norm;
+        }
+    }
+}
+
+/**
+ * @brief Create a new wave.
+ */
+Wave Wave::Create()
+{
+    Wave wave;
+
+    /*
+     * Create the shader program object.
+     */
+    std::vector<GLuint> shaders{
+        gl::CreateShader(GL_VERTEX_SHADER, "data/wave.vert"),
+        gl::CreateShader(GL_FRAGMENT_SHADER, "data/wave.frag")};
+    wave.program = gl::CreateProgram(shaders);
+    gl::DestroyShader(shaders);
+    std::cout << gl::GetProgramInfoString(wave.program) << "\n";
+
+    /*
+     * Create a plane mesh in the xy-plane with streaming vertex data.
+     */
+    std::vector<gl::Mesh::Vertex> vertices(kMeshNodes * kMeshNodes);
+    const GLfloat du = 1.0f / (GLfloat) (kMeshNodes - 1);
+    for (size_t j = 0; j < kMeshNodes; ++j) {
+        for (size_t i = 0; i < kMeshNodes; ++i) {
+            gl::Mesh::Vertex &vertex = vertices[i + j * kMeshNodes];
+            vertex.position[0] = -1.0f + 2.0f * (GLfloat) i * du;
+            vertex.position[1] = -1.0f + 2.0f * (GLfloat) j * du;
+            vertex.color[0] = (GLfloat) i * du;
+            vertex.color[1] = (GLfloat) j * du;
+            vertex.color[2] = 1.0f;
+            vertex.texcoord[0] = (GLfloat) i * du;
+            vertex.texcoord[1] = (GLfloat) j * du;
+        }
+    }
+    wave.row = 0;
+    SetRows(vertices, 0, kMeshNodes, wave.row);
+
+    wave.mesh = gl::Mesh::Create(
+        wave.program,
+        "wave",
+        vertices,
+        gl::Mesh::Grid(kMeshNodes, kMeshNodes),
+        GL_STREAM_DRAW);
+    std::printf("wave stream persistent %d\n", wave.mesh.stream.is_persistent);
+
+    return wave;
+}
+
+/**
+ * @brief Destroy the wave.
+ */
+void Wave::Destroy(Wave &wave)
+{
+    gl::Mesh::Destroy(wave.mesh);
+    gl::DestroyProgram(wave.program);
+}
+
+/**
+ * @brief Handle the event in the wave.
+ */
+void Wave::Handle(glfw::Event &event)
+{}
+
+/**
+ * @brief Update the wave.
+ */
+void Wave::Update(void)
+{
+    /*
+     * Move the wave band by one row and update only the vertex rows it left
+     * and entered. Update the whole mesh when the band wraps around.
+     */
+    size_t next = (row + 1) % (kMeshNodes - kBandRows);
+    if (next > row) {
+        size_t lo = row;
+        size_t hi = next + kBandRows;
+        SetRows(mesh.vertices, lo, hi, next);
+        gl::Mesh::Update(mesh, lo * kMeshNodes, (hi - lo) * kMeshNodes);
+    } else {
+        SetRows(mesh.vertices, 0, kMeshNodes, next);
+        gl::Mesh::Update(mesh);
+    }
+    row = next;
+
+    /* Update the modelviewprojection matrix */
+    math::mat4f m = math::mat4f::eye;
+    m = math::rotate(m, math::vec3f{1.0f, 0.0f, 0.0f}, (float) (-0.3*M_PI));
+    m = math::scale(m, math::vec3f{0.7f, 0.7f, 0.7f});
+
+    std::array<GLfloat,2> fbsize = {};
+    glfw::GetFramebufferSize(fbsize);
+    float ratio = fbsize[0] / fbsize[1];
+
+    math::mat4f p = math::ortho(-ratio, ratio, -1.0f, 1.0f, -1.0f, 1.0f);
+    mvp = math::dot(p, m);
+}
+
+/**
+ * @brief Render the wave.
+ */
+void Wave::Render(void)
+{
+    GLFWwindow *window = glfw::Window();
+    if (window == nullptr) {
+        return;
+    }
+
+    /* Specify draw state modes. */
+    glPolygonMode(GL_FRONT_AND_BACK, GL_FILL);
+    gl::Disable(GL_CULL_FACE);
+    gl::Enable(GL_DEPTH_TEST);
+    gl::DepthFunc(GL_LESS);
+
+    /* Bind the shader program object. */
+    gl::UseProgram(program);
+
+    /* Set uniform and draw. */
+    gl::SetUniformMatrix(program, "u_mvp", GL_FLOAT_MAT4, true, mvp.data);
+    gl::Mesh::Render(mesh);
+
+    /* Unbind the shader program object. */
+    gl::UseProgram(0);
+}
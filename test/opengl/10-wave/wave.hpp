@@ -0,0 +1,31 @@
+/*
+ * wave.hpp
+ *
+ * Copyright (c) 2020 Carlos Braga
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the MIT License.
+ *
+ * See accompanying LICENSE.md or https://opensource.org/licenses/MIT.
+ */
+
+#ifndef TEST_ITO_OPENGL_WAVE_H_
+#define TEST_ITO_OPENGL_WAVE_H_
+
+#include "ito/opengl.hpp"
+
+struct Wave {
+    GLuint program;                 /* shader program object */
+    ito::gl::Mesh mesh;             /* streaming wave mesh */
+    size_t row;                     /* first row of the wave band */
+    ito::math::mat4f mvp;           /* modelviewprojection */
+
+    void Handle(ito::glfw::Event &event);
+    void Update(void);
+    void Render(void);
+
+    static Wave Create(void);
+    static void Destroy(Wave &wave);
+};
+
+#endif /* TEST_ITO_OPENGL_WAVE_H_ */
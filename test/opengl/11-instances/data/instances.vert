@@ -0,0 +1,25 @@
+#version 330 core
+
+uniform mat4 u_mvp;
+
+layout (location = 0) in vec3 shape_position;
+layout (location = 1) in vec3 shape_normal;
+layout (location = 2) in vec3 shape_color;
+layout (location = 3) in vec2 shape_texcoord;
+layout (location = 4) in mat4 shape_instance_transform;
+layout (location = 8) in vec4 shape_instance_color;
+
+out vec4 vert_shape_normal;
+out vec4 vert_shape_color;
+out vec2 vert_shape_texcoord;
+
+/*
+ * vertex shader main
+ */
+void main(void)
+{
+    gl_Position = u_mvp * shape_instance_transform * vec4(shape_position, 1.0);
+    vert_shape_normal = shape_instance_transform * vec4(shape_normal, 0.0);
+    vert_shape_color = mix(vec4(shape_color, 1.0), shape_instance_color, 0.8);
+    vert_shape_texcoord = shape_texcoord;
+}
@@ -0,0 +1,209 @@
+/*
+ * instances.cpp
+ *
+ * Copyright (c) 2020 Carlos Braga
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the MIT License.
+ *
+ * See accompanying LICENSE.md or https://opensource.org/licenses/MIT.
+ */
+
+#include "ito/opengl.hpp"
+#include "instances.hpp"
+
+using namespace ito;
+
+/**
+ * @brief Number of instances along each dimension.
+ */
+static const size_t kNumCells = 24;
+
+/**
+ * @brief Render modes, toggled with space.
+ */
+enum {
+    kModeMeshes = 0,
+    kModeBatch,
+    kModeQueue,
+    kNumModes
+};
+
+/**
+ * @brief Create the instances.
+ */
+Instances Instances::Create()
+{
+    Instances instances;
+
+    /*
+     * Create the shader program object.
+     */
+    std::vector<GLuint> shaders{
+        gl::CreateShader(GL_VERTEX_SHADER, "data/instances.vert"),
+        gl::CreateShader(GL_FRAGMENT_SHADER, "data/instances.frag")};
+    instances.program = gl::CreateProgram(shaders);
+    gl::DestroyShader(shaders);
+    std::cout << gl::GetProgramInfoString(instances.program) << "\n";
+
+    /*
+     * Create the sphere and plane meshes and merge them in a batch.
+     */
+    instances.meshes.push_back(gl::Mesh::Sphere(
+        instances.program, "shape", 16, 16, 1.0, 0.0, M_PI, -M_PI, M_PI));
+    instances.meshes.push_back(gl::Mesh::Plane(
+        instances.program, "shape", 2, 2, -1.0, 1.0, -1.0, 1.0));
+    instances.batch = gl::MeshBatch::Create(
+        instances.program, "shape", instances.meshes);
+    instances.mode = kModeBatch;
+    std::printf("multi draw indirect %d\n", instances.batch.is_indirect);
+
+    /*
+     * Place the instances on a lattice, alternating between the meshes.
+     */
+    std::vector<std::vector<gl::Mesh::Instance>> &lists = instances.lists;
+    lists.resize(instances.meshes.size());
+    const GLfloat scale = 1.0f / static_cast<GLfloat>(kNumCells);
+    for (size_t i = 0; i < kNumCells; ++i) {
+        for (size_t j = 0; j < kNumCells; ++j) {
+            for (size_t k = 0; k < kNumCells; ++k) {
+                math::vec3f o{
+                    -1.0f + scale * static_cast<GLfloat>(2*i + 1),
+                    -1.0f + scale * static_cast<GLfloat>(2*j + 1),
+                    -1.0f + scale * static_cast<GLfloat>(2*k + 1)};
+                math::vec4f color{
+                    scale * static_cast<GLfloat>(i),
+                    scale * static_cast<GLfloat>(j),
+                    scale * static_cast<GLfloat>(k),
+                    1.0f};
+
+                math::mat4f m = math::mat4f::eye;
+                m = math::scale(m, math::vec3f{0.4f*scale, 0.4f*scale, 0.4f*scale});
+                m = math::translate(m, o);
+
+                size_t ix = (i + j + k) % lists.size();
+                lists[ix].push_back(gl::Mesh::Instance::Make(m, color));
+            }
+        }
+    }
+
+    for (size_t i = 0; i < instances.meshes.size(); ++i) {
+        gl::Mesh::SetInstances(instances.meshes[i], instances.program, lists[i]);
+    }
+    gl::MeshBatch::SetInstances(instances.batch, lists);
+
+    /*
+     * Create the render queue and its own copies of the meshes, since the
+     * queue points the mesh instance attributes to its instance buffer.
+     */
+    instances.queue_meshes.push_back(gl::Mesh::Sphere(
+        instances.program, "shape", 16, 16, 1.0, 0.0, M_PI, -M_PI, M_PI));
+    instances.queue_meshes.push_back(gl::Mesh::Plane(
+        instances.program, "shape", 2, 2, -1.0, 1.0, -1.0, 1.0));
+    instances.queue = gl::RenderQueue::Create();
+
+    return instances;
+}
+
+/**
+ * @brief Destroy the instances.
+ */
+void Instances::Destroy(Instances &instances)
+{
+    gl::RenderQueue::Destroy(instances.queue);
+    for (auto &mesh : instances.queue_meshes) {
+        gl::Mesh::Destroy(mesh);
+    }
+    gl::MeshBatch::Destroy(instances.batch);
+    for (auto &mesh : instances.meshes) {
+        gl::Mesh::Destroy(mesh);
+    }
+    gl::DestroyProgram(instances.program);
+}
+
+/**
+ * @brief Handle the event in the instances, cycle the render mode with space.
+ */
+void Instances::Handle(glfw::Event &event)
+{
+    if (event.type == glfw::Event::Key &&
+        event.key.code == GLFW_KEY_SPACE &&
+        event.key.action == GLFW_PRESS) {
+        mode = (mode + 1) % kNumModes;
+        std::printf("mode %lu\n", (unsigned long) mode);
+    }
+}
+
+/**
+ * @brief Update the instances.
+ */
+void Instances::Update(void)
+{
+    /* Update the modelviewprojection matrix */
+    float time = (float) glfwGetTime();
+    float ang_x = 0.3 * time;
+    float ang_y = 0.2 * time;
+
+    math::mat4f m = math::mat4f::eye;
+    m = math::rotate(m, math::vec3f{0.0f, 1.0f, 0.0f}, ang_y);
+    m = math::rotate(m, math::vec3f{1.0f, 0.0f, 0.0f}, ang_x);
+    m = math::scale(m, math::vec3f{0.5f, 0.5f, 0.5f});
+
+    std::array<GLfloat,2> fbsize = {};
+    glfw::GetFramebufferSize(fbsize);
+    float ratio = fbsize[0] / fbsize[1];
+
+    math::mat4f p = math::ortho(-ratio, ratio, -1.0f, 1.0f, -1.0f, 1.0f);
+    mvp = math::dot(p, m);
+}
+
+/**
+ * @brief Render the instances.
+ */
+void Instances::Render(void)
+{
+    GLFWwindow *window = glfw::Window();
+    if (window == nullptr) {
+        return;
+    }
+
+    /* Specify draw state modes. */
+    glPolygonMode(GL_FRONT_AND_BACK, GL_FILL);
+    gl::Disable(GL_CULL_FACE);
+    gl::Enable(GL_DEPTH_TEST);
+    gl::DepthFunc(GL_LESS);
+
+    /* Bind the shader program object. */
+    gl::UseProgram(program);
+    gl::SetUniformMatrix(program, "u_mvp", GL_FLOAT_MAT4, true, mvp.data);
+
+    /*
+     * Draw all instances with one call, one call per mesh, or submit each
+     * instance to the queue, which merges them into one call per mesh.
+     */
+    if (mode == kModeBatch) {
+        gl::MeshBatch::Render(batch);
+    } else if (mode == kModeMeshes) {
+        for (auto &mesh : meshes) {
+            gl::Mesh::RenderInstanced(mesh);
+        }
+    } else {
+        for (size_t i = 0; i < queue_meshes.size(); ++i) {
+            for (auto &instance : lists[i]) {
+                /* Depth of the instance origin in clip space. */
+                math::vec4f o{
+                    instance.transform[12],
+                    instance.transform[13],
+                    instance.transform[14],
+                    1.0f};
+                GLfloat depth = 0.5f * (math::dot(mvp, o)[2] + 1.0f);
+                gl::RenderQueue::Submit(
+                    queue, queue_meshes[i], program, {}, instance, depth);
+            }
+        }
+        gl::RenderQueue::Execute(queue);
+    }
+
+    /* Unbind the shader program object. */
+    gl::UseProgram(0);
+}
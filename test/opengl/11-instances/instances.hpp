@@ -0,0 +1,36 @@
+/*
+ * instances.hpp
+ *
+ * Copyright (c) 2020 Carlos Braga
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the MIT License.
+ *
+ * See accompanying LICENSE.md or https://opensource.org/licenses/MIT.
+ */
+
+#ifndef TEST_ITO_OPENGL_INSTANCES_H_
+#define TEST_ITO_OPENGL_INSTANCES_H_
+
+#include <vector>
+#include "ito/opengl.hpp"
+
+struct Instances {
+    GLuint program;                         /* shader program object */
+    std::vector<ito::gl::Mesh> meshes;      /* sphere and plane meshes */
+    ito::gl::MeshBatch batch;               /* merged meshes */
+    std::vector<ito::gl::Mesh> queue_meshes;    /* meshes drawn by the queue */
+    ito::gl::RenderQueue queue;             /* sorted draw items */
+    std::vector<std::vector<ito::gl::Mesh::Instance>> lists;
+    size_t mode;                            /* meshes, batch or queue */
+    ito::math::mat4f mvp;                   /* modelviewprojection */
+
+    void Handle(ito::glfw::Event &event);
+    void Update(void);
+    void Render(void);
+
+    static Instances Create(void);
+    static void Destroy(Instances &instances);
+};
+
+#endif /* TEST_ITO_OPENGL_INSTANCES_H_ */
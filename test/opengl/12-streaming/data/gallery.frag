@@ -0,0 +1,15 @@
+#version 330 core
+
+uniform sampler2D u_texsampler;
+
+in vec2 vert_tile_texcoord;
+
+out vec4 frag_color;
+
+/*
+ * fragment shader main
+ */
+void main(void)
+{
+    frag_color = texture(u_texsampler, vert_tile_texcoord);
+}
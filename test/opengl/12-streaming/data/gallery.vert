@@ -0,0 +1,19 @@
+#version 330 core
+
+uniform mat4 u_mvp;
+
+layout (location = 0) in vec3 tile_position;
+layout (location = 1) in vec3 tile_normal;
+layout (location = 2) in vec3 tile_color;
+layout (location = 3) in vec2 tile_texcoord;
+
+out vec2 vert_tile_texcoord;
+
+/*
+ * vertex shader main
+ */
+void main(void)
+{
+    gl_Position = u_mvp * vec4(tile_position, 1.0);
+    vert_tile_texcoord = tile_texcoord;
+}
@@ -0,0 +1,146 @@
+/*
+ * gallery.cpp
+ *
+ * Copyright (c) 2020 Carlos Braga
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the MIT License.
+ *
+ * See accompanying LICENSE.md or https://opensource.org/licenses/MIT.
+ */
+
+#include "ito/opengl.hpp"
+#include "gallery.hpp"
+
+using namespace ito;
+
+/**
+ * @brief Gallery constant parameters.
+ */
+static const std::vector<std::string> kImageFilenames = {
+    "../common/baboon_512.png",
+    "../common/fruits_512.png",
+    "../common/monarch_512.png",
+    "../common/pool_512.png",
+    "../common/equirectangular.png",
+    "../common/color-wheel-rgb.png",
+    "../common/color-wheel-rgba.png",
+    "../common/color-wheel-80x80-rgba.png"};
+static const size_t kNumCols = 4;
+static const size_t kNumRows = 2;
+static const GLsizeiptr kUploadBudget = 512 * 1024;
+
+/**
+ * @brief Create a new gallery.
+ */
+Gallery Gallery::Create()
+{
+    Gallery gallery;
+
+    /*
+     * Create the shader program object.
+     */
+    std::vector<GLuint> shaders{
+        gl::CreateShader(GL_VERTEX_SHADER, "data/gallery.vert"),
+        gl::CreateShader(GL_FRAGMENT_SHADER, "data/gallery.frag")};
+    gallery.program = gl::CreateProgram(shaders);
+    gl::DestroyShader(shaders);
+    std::cout << gl::GetProgramInfoString(gallery.program) << "\n";
+
+    /*
+     * Create the texture stream and queue the tile images. Each tile shows
+     * a placeholder until its image is decoded and uploaded.
+     */
+    gallery.stream = gl::TextureStream::Create(kUploadBudget);
+    for (auto &filename : kImageFilenames) {
+        gallery.textures.push_back(gl::TextureStream::Load(
+            gallery.stream, filename));
+    }
+
+    /*
+     * Create a mesh over a rectangle.
+     */
+    gallery.mesh = gl::Mesh::Plane(
+        gallery.program,            /* shader program object */
+        "tile",                     /* vertex attributes prefix */
+        2,                          /* n1 vertices */
+        2,                          /* n2 vertices */
+        -1.0,                       /* xlo */
+         1.0,                       /* xhi */
+        -1.0,                       /* ylo */
+         1.0);                      /* yhi */
+
+    return gallery;
+}
+
+/**
+ * @brief Destroy the gallery.
+ */
+void Gallery::Destroy(Gallery &gallery)
+{
+    gl::Mesh::Destroy(gallery.mesh);
+    gl::TextureStream::Destroy(gallery.stream);
+    gl::DestroyProgram(gallery.program);
+}
+
+/**
+ * @brief Handle the event in the gallery.
+ */
+void Gallery::Handle(glfw::Event &event)
+{}
+
+/**
+ * @brief Update the gallery, uploading the decoded images within the frame
+ * budget.
+ */
+void Gallery::Update(void)
+{
+    gl::TextureStream::Update(stream);
+
+    std::array<GLfloat,2> fbsize = {};
+    glfw::GetFramebufferSize(fbsize);
+    float ratio = fbsize[0] / fbsize[1];
+    proj = math::ortho(-ratio, ratio, -1.0f, 1.0f, -1.0f, 1.0f);
+}
+
+/**
+ * @brief Render the gallery tiles.
+ */
+void Gallery::Render(void)
+{
+    GLFWwindow *window = glfw::Window();
+    if (window == nullptr) {
+        return;
+    }
+
+    /* Specify draw state modes. */
+    glPolygonMode(GL_FRONT_AND_BACK, GL_FILL);
+    gl::Disable(GL_CULL_FACE);
+    gl::Disable(GL_DEPTH_TEST);
+
+    /* Bind the shader program object. */
+    gl::UseProgram(program);
+
+    GLenum texunit = 0;
+    gl::SetUniform(program, "u_texsampler", GL_SAMPLER_2D, &texunit);
+
+    /* Draw each tile on a lattice with its texture or the placeholder. */
+    const GLfloat scale = 0.45f;
+    for (size_t i = 0; i < textures.size(); ++i) {
+        GLfloat x = -1.5f + static_cast<GLfloat>(i % kNumCols);
+        GLfloat y =  0.5f - static_cast<GLfloat>((i / kNumCols) % kNumRows);
+
+        math::mat4f m = math::mat4f::eye;
+        m = math::scale(m, math::vec3f{scale, scale, 1.0f});
+        m = math::translate(m, math::vec3f{x, y, 0.0f});
+        math::mat4f mvp = math::dot(proj, m);
+        gl::SetUniformMatrix(program, "u_mvp", GL_FLOAT_MAT4, true, mvp.data);
+
+        gl::ActiveBindTexture(GL_TEXTURE_2D, texunit,
+            gl::TextureStream::Texture(stream, textures[i]));
+        gl::Mesh::Render(mesh);
+    }
+
+    /* Unbind the shader program object. */
+    gl::UseProgram(0);
+}
@@ -0,0 +1,33 @@
+/*
+ * gallery.hpp
+ *
+ * Copyright (c) 2020 Carlos Braga
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the MIT License.
+ *
+ * See accompanying LICENSE.md or https://opensource.org/licenses/MIT.
+ */
+
+#ifndef TEST_ITO_OPENGL_GALLERY_H_
+#define TEST_ITO_OPENGL_GALLERY_H_
+
+#include <vector>
+#include "ito/opengl.hpp"
+
+struct Gallery {
+    GLuint program;                     /* shader program object */
+    ito::gl::Mesh mesh;                 /* tile mesh */
+    ito::gl::TextureStream stream;      /* streamed tile textures */
+    std::vector<size_t> textures;       /* tile texture ids */
+    ito::math::mat4f proj;              /* projection matrix */
+
+    void Handle(ito::glfw::Event &event);
+    void Update(void);
+    void Render(void);
+
+    static Gallery Create(void);
+    static void Destroy(Gallery &gallery);
+};
+
+#endif /* TEST_ITO_OPENGL_GALLERY_H_ */
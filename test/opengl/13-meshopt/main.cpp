@@ -0,0 +1,221 @@
+/*
+ * main.cpp
+ *
+ * Copyright (c) 2020 Carlos Braga
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the MIT License.
+ *
+ * See accompanying LICENSE.md or https://opensource.org/licenses/MIT.
+ */
+
+#include "ito/opengl.hpp"
+
+using namespace ito;
+
+/** ---------------------------------------------------------------------------
+ * @brief Constants and globals.
+ */
+static const std::string kModelFilename = "../common/bunny.ply";
+static const size_t kCacheSize = 16;
+static const size_t kMeshNodes = 128;
+static const size_t kLodLevels = 5;
+static const GLfloat kViewportHeight = 800.0f;
+static const GLfloat kLodThreshold = 1.0f;
+
+/**
+ * @brief Print the vertex cache statistics of the faces.
+ */
+static gl::MeshOptimizer::Stats Report(
+    const std::vector<gl::Mesh::Vertex> &vertices,
+    const std::vector<gl::Mesh::Face> &faces,
+    const char *comment)
+{
+    gl::MeshOptimizer::Stats stats = gl::MeshOptimizer::CacheStats(
+        faces, vertices.size(), kCacheSize);
+    std::cout << gl::MeshOptimizer::InfoString(stats, comment) << "\n";
+    return stats;
+}
+
+/**
+ * @brief Return the number of faces shaded against their vertex normals, with
+ * a face normal opposite to the sum of the normals of its vertices.
+ */
+static size_t CountFlipped(
+    const std::vector<gl::Mesh::Vertex> &vertices,
+    const std::vector<gl::Mesh::Face> &faces)
+{
+    size_t n_flipped = 0;
+    for (auto &face : faces) {
+        const GLfloat *p0 = vertices[face.index[0]].position;
+        const GLfloat *p1 = vertices[face.index[1]].position;
+        const GLfloat *p2 = vertices[face.index[2]].position;
+        math::vec3f u{p1[0] - p0[0], p1[1] - p0[1], p1[2] - p0[2]};
+        math::vec3f v{p2[0] - p0[0], p2[1] - p0[1], p2[2] - p0[2]};
+        math::vec3f n = math::cross(u, v);
+
+        double shading = 0.0;
+        for (auto &index : face.index) {
+            const GLfloat *normal = vertices[index].normal;
+            shading += n.x * normal[0] + n.y * normal[1] + n.z * normal[2];
+        }
+        n_flipped += (shading < 0.0);
+    }
+    return n_flipped;
+}
+
+/**
+ * @brief Simplify the faces to a chain of levels of detail. Check that each
+ * level reaches its target number of faces, with no more flipped faces than
+ * the full resolution faces, and that the selected level is coarser as the
+ * mesh moves away from the eye.
+ */
+static void TestSimplify(
+    const std::vector<gl::Mesh::Vertex> &vertices,
+    const std::vector<gl::Mesh::Face> &faces,
+    const char *comment)
+{
+    std::vector<size_t> targets;
+    for (size_t i = 1; i < kLodLevels; ++i) {
+        targets.push_back(faces.size() >> i);
+    }
+    std::vector<float> errors;
+    std::vector<std::vector<gl::Mesh::Face>> simplified =
+        gl::MeshOptimizer::Simplify(vertices, faces, targets, &errors);
+
+    size_t n_flipped = CountFlipped(vertices, faces);
+    for (size_t i = 0; i < simplified.size(); ++i) {
+        std::cout << ito::str::format(
+            "%s target %zu, faces %zu, error %f\n",
+            comment, targets[i], simplified[i].size(), errors[i]);
+        ito_assert(simplified[i].size() <= targets[i], "simplify target");
+        ito_assert(CountFlipped(vertices, simplified[i]) <= n_flipped,
+            "simplify flipped faces");
+        ito_assert(i == 0 || errors[i] >= errors[i - 1], "simplify error");
+    }
+
+    /*
+     * Levels of detail as created by MeshLod, without the mesh objects,
+     * and the bounding sphere about the center of the bounding box.
+     */
+    gl::MeshLod lod;
+    lod.levels.push_back({0, (GLsizei) faces.size(), 0.0f});
+    for (size_t i = 0; i < simplified.size(); ++i) {
+        lod.levels.push_back({0, (GLsizei) simplified[i].size(), errors[i]});
+    }
+
+    math::vec3f lo{
+        vertices[0].position[0],
+        vertices[0].position[1],
+        vertices[0].position[2]};
+    math::vec3f hi = lo;
+    for (auto &vertex : vertices) {
+        math::vec3f p{
+            vertex.position[0], vertex.position[1], vertex.position[2]};
+        lo = math::vec3f{
+            std::min(lo.x, p.x), std::min(lo.y, p.y), std::min(lo.z, p.z)};
+        hi = math::vec3f{
+            std::max(hi.x, p.x), std::max(hi.y, p.y), std::max(hi.z, p.z)};
+    }
+    lod.center = (lo + hi) * 0.5f;
+    lod.radius = 0.0f;
+    for (auto &vertex : vertices) {
+        math::vec3f p{
+            vertex.position[0], vertex.position[1], vertex.position[2]};
+        lod.radius = std::max(lod.radius, math::norm(p - lod.center));
+    }
+
+    /* Move the eye away from the mesh center along the z-axis. */
+    math::mat4f m = math::mat4f::eye;
+    math::mat4f p = math::perspective(
+        (float) (0.25 * M_PI), 1.0f, 0.01f, 1000.0f);
+    size_t level = 0;
+    for (GLfloat distance = 0.5f * lod.radius;
+         distance < 1000.0f * lod.radius;
+         distance *= 1.1f) {
+        math::mat4f v = math::lookat(
+            lod.center + math::vec3f{0.0f, 0.0f, distance},
+            lod.center,
+            math::vec3f{0.0f, 1.0f, 0.0f});
+        size_t next = gl::MeshLod::Select(
+            lod, m, v, p, kViewportHeight, kLodThreshold);
+        ito_assert(next >= level, "level of detail is not monotonic");
+        level = next;
+    }
+    ito_assert(level + 1 == lod.levels.size(), "coarsest level not selected");
+}
+
+/** ---------------------------------------------------------------------------
+ * main test client
+ */
+int main(int argc, char const *argv[])
+{
+    /* ---- Test the optimization passes on the bunny meshes ------------------
+     */
+    {
+        Assimp::Importer importer;
+        const aiScene* scene = importer.ReadFile(
+            kModelFilename,
+            aiProcess_Triangulate       |
+            aiProcess_GenSmoothNormals  |
+            aiProcess_CalcTangentSpace);
+        ito_assert(scene != NULL, importer.GetErrorString());
+
+        for (size_t i = 0; i < scene->mNumMeshes; ++i) {
+            std::vector<gl::Mesh::Vertex> vertices;
+            std::vector<gl::Mesh::Face> faces;
+            if (!gl::Mesh::Process(scene->mMeshes[i], vertices, faces)) {
+                continue;
+            }
+            gl::MeshOptimizer::Stats before = Report(vertices, faces, "import");
+
+            size_t n_welded = gl::MeshOptimizer::WeldVertices(vertices, faces);
+            std::cout << "welded vertices: " << n_welded << "\n";
+            Report(vertices, faces, "weld");
+
+            std::vector<gl::Mesh::Face> cache_faces = faces;
+            gl::MeshOptimizer::OptimizeVertexCache(
+                cache_faces, vertices.size(), kCacheSize);
+            gl::MeshOptimizer::Stats tipsify = Report(
+                vertices, cache_faces, "vertex cache");
+
+            gl::MeshOptimizer::OptimizeOverdraw(vertices, faces, kCacheSize);
+            Report(vertices, faces, "overdraw");
+
+            gl::MeshOptimizer::OptimizeVertexFetch(vertices, faces);
+            gl::MeshOptimizer::Stats after = Report(
+                vertices, faces, "vertex fetch");
+
+            ito_assert(tipsify.acmr < before.acmr, "vertex cache ordering");
+            ito_assert(after.n_faces == tipsify.n_faces, "faces lost");
+
+            TestSimplify(vertices, faces, "bunny");
+        }
+    }
+
+    /* ---- Test the optimization passes on a plane grid ----------------------
+     */
+    {
+        std::vector<gl::Mesh::Face> faces = gl::Mesh::Grid(
+            kMeshNodes, kMeshNodes);
+        std::vector<gl::Mesh::Vertex> vertices(kMeshNodes * kMeshNodes);
+        for (size_t j = 0; j < kMeshNodes; ++j) {
+            for (size_t i = 0; i < kMeshNodes; ++i) {
+                gl::Mesh::Vertex &vertex = vertices[j * kMeshNodes + i];
+                vertex = {};
+                vertex.position[0] = (GLfloat) i / (kMeshNodes - 1);
+                vertex.position[1] = (GLfloat) j / (kMeshNodes - 1);
+                vertex.normal[2] = 1.0f;
+            }
+        }
+        gl::MeshOptimizer::Stats before = Report(vertices, faces, "grid");
+
+        gl::MeshOptimizer::Optimize(vertices, faces, kCacheSize);
+        gl::MeshOptimizer::Stats after = Report(vertices, faces, "optimized");
+        ito_assert(after.acmr < before.acmr, "grid vertex cache ordering");
+
+        TestSimplify(vertices, faces, "grid");
+    }
+
+    exit(EXIT_SUCCESS);
+}
@@ -0,0 +1,7 @@
+#version 330 core
+
+/*
+ * fragment shader main
+ */
+void main(void)
+{}
@@ -0,0 +1,15 @@
+#version 330 core
+
+uniform mat4 u_mvp;
+
+layout (location = 0) in vec3 shape_position;
+
+invariant gl_Position;
+
+/*
+ * vertex shader main
+ */
+void main(void)
+{
+    gl_Position = u_mvp * vec4(shape_position, 1.0);
+}
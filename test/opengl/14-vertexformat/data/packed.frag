@@ -0,0 +1,16 @@
+#version 330 core
+
+in vec4 vert_shape_normal;
+in vec2 vert_shape_texcoord;
+
+out vec4 frag_color;
+
+/*
+ * fragment shader main
+ */
+void main(void)
+{
+    vec3 normal = normalize(vert_shape_normal.xyz);
+    float shade = 0.4 + 0.6 * abs(normal.z);
+    frag_color = vec4(shade * (0.5 + 0.5 * normal), 1.0);
+}
@@ -0,0 +1,23 @@
+#version 330 core
+
+uniform mat4 u_mvp;
+uniform mat4 u_model;
+
+layout (location = 0) in vec3 shape_position;
+layout (location = 1) in vec4 shape_normal;
+layout (location = 2) in vec2 shape_texcoord;
+
+out vec4 vert_shape_normal;
+out vec2 vert_shape_texcoord;
+
+invariant gl_Position;
+
+/*
+ * vertex shader main
+ */
+void main(void)
+{
+    gl_Position = u_mvp * vec4(shape_position, 1.0);
+    vert_shape_normal = u_model * vec4(shape_normal.xyz, 0.0);
+    vert_shape_texcoord = shape_texcoord;
+}
@@ -0,0 +1,230 @@
+/*
+ * packed.cpp
+ *
+ * Copyright (c) 2020 Carlos Braga
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the MIT License.
+ *
+ * See accompanying LICENSE.md or https://opensource.org/licenses/MIT.
+ */
+
+#include "ito/opengl.hpp"
+#include "packed.hpp"
+
+using namespace ito;
+
+/**
+ * @brief Packed constant parameters.
+ */
+static const std::string kModelFilename = "../common/bunny.ply";
+
+/**
+ * @brief Load the vertex and face data of the bunny, and of a ground plane
+ * under it.
+ */
+static void LoadModel(
+    std::vector<std::vector<gl::Mesh::Vertex>> &vertices,
+    std::vector<std::vector<gl::Mesh::Face>> &faces)
+{
+    Assimp::Importer importer;
+    const aiScene* scene = importer.ReadFile(
+        kModelFilename,
+        aiProcess_Triangulate       |
+        aiProcess_GenSmoothNormals  |
+        aiProcess_CalcTangentSpace);
+    ito_assert(scene != NULL, importer.GetErrorString());
+
+    GLfloat ymin = 0.0f;
+    for (size_t i = 0; i < scene->mNumMeshes; ++i) {
+        std::vector<gl::Mesh::Vertex> mesh_vertices;
+        std::vector<gl::Mesh::Face> mesh_faces;
+        if (gl::Mesh::Process(scene->mMeshes[i], mesh_vertices, mesh_faces)) {
+            gl::MeshOptimizer::Optimize(mesh_vertices, mesh_faces);
+            for (auto &vertex : mesh_vertices) {
+                ymin = std::min(ymin, vertex.position[1]);
+            }
+            vertices.push_back(std::move(mesh_vertices));
+            faces.push_back(std::move(mesh_faces));
+        }
+    }
+
+    /* Ground plane in the xz-plane, with normals along the y-axis. */
+    std::vector<gl::Mesh::Vertex> plane(4);
+    for (size_t k = 0; k < plane.size(); ++k) {
+        GLfloat u = (GLfloat) (k % 2);
+        GLfloat v = (GLfloat) (k / 2);
+        plane[k] = {
+            {0.2f * (2.0f * u - 1.0f), ymin, 0.2f * (1.0f - 2.0f * v)},
+            {0.0f, 1.0f, 0.0f},
+            {1.0f, 1.0f, 1.0f},
+            {u, v}};
+    }
+    vertices.push_back(std::move(plane));
+    faces.push_back(gl::Mesh::Grid(2, 2));
+}
+
+/**
+ * @brief Create the packed meshes.
+ */
+Packed Packed::Create()
+{
+    Packed packed;
+
+    /*
+     * Create the shading and the depth only shader program objects.
+     */
+    std::vector<GLuint> shaders{
+        gl::CreateShader(GL_VERTEX_SHADER, "data/packed.vert"),
+        gl::CreateShader(GL_FRAGMENT_SHADER, "data/packed.frag")};
+    packed.program = gl::CreateProgram(shaders);
+    gl::DestroyShader(shaders);
+    std::cout << gl::GetProgramInfoString(packed.program) << "\n";
+
+    std::vector<GLuint> depth_shaders{
+        gl::CreateShader(GL_VERTEX_SHADER, "data/depth.vert"),
+        gl::CreateShader(GL_FRAGMENT_SHADER, "data/depth.frag")};
+    packed.depth_program = gl::CreateProgram(depth_shaders);
+    gl::DestroyShader(depth_shaders);
+
+    /*
+     * Pack the meshes in the compact and in the standard vertex formats.
+     * The meshes with the same format share their vertex arrays.
+     */
+    std::vector<std::vector<gl::Mesh::Vertex>> vertices;
+    std::vector<std::vector<gl::Mesh::Face>> faces;
+    LoadModel(vertices, faces);
+
+    packed.formats.push_back(gl::VertexFormat::Compact());
+    packed.formats.push_back(gl::VertexFormat::Standard());
+    for (auto &format : packed.formats) {
+        std::cout << gl::VertexFormat::InfoString(format) << "\n";
+        std::vector<gl::PackedMesh> meshes;
+        for (size_t i = 0; i < vertices.size(); ++i) {
+            meshes.push_back(gl::PackedMesh::Create(
+                "shape",
+                format,
+                gl::Mesh::View::Make(vertices[i], faces[i])));
+        }
+        packed.meshes.push_back(meshes);
+    }
+    packed.format = 0;
+    std::printf("separate attribute formats %d\n",
+        gl::VertexFormat::IsBindingSupported());
+
+    /* Create the timer of the depth and of the shading passes. */
+    packed.timer = gl::GpuTimer::Create();
+    std::printf("timestamp queries %d\n", packed.timer.is_supported);
+
+    return packed;
+}
+
+/**
+ * @brief Destroy the packed meshes.
+ */
+void Packed::Destroy(Packed &packed)
+{
+    for (auto &meshes : packed.meshes) {
+        for (auto &mesh : meshes) {
+            gl::PackedMesh::Destroy(mesh);
+        }
+    }
+    gl::VertexFormat::DestroyVertexArrays();
+    gl::GpuTimer::WriteTrace(packed.timer, "/tmp/vertexformat.trace.json");
+    gl::GpuTimer::Destroy(packed.timer);
+    gl::DestroyProgram(packed.depth_program);
+    gl::DestroyProgram(packed.program);
+}
+
+/**
+ * @brief Handle the event in the packed meshes, cycle the format with space.
+ */
+void Packed::Handle(glfw::Event &event)
+{
+    if (event.type == glfw::Event::Key &&
+        event.key.code == GLFW_KEY_SPACE &&
+        event.key.action == GLFW_PRESS) {
+        format = (format + 1) % formats.size();
+        std::printf("format %lu, %d bytes per vertex\n",
+            (unsigned long) format,
+            gl::VertexFormat::VertexSize(formats[format]));
+    }
+}
+
+/**
+ * @brief Update the packed meshes.
+ */
+void Packed::Update(void)
+{
+    /* Update the model and the view projection matrices. */
+    float time = (float) glfwGetTime();
+    model = math::mat4f::eye;
+    model = math::rotate(model, math::vec3f{0.0f, 1.0f, 0.0f}, 0.4f * time);
+    model = math::scale(model, math::vec3f{5.0f, 5.0f, 5.0f});
+
+    std::array<GLfloat,2> fbsize = {};
+    glfw::GetFramebufferSize(fbsize);
+    float ratio = fbsize[0] / fbsize[1];
+
+    math::mat4f v = math::lookat(
+        math::vec3f{0.0f, 1.0f, 2.5f},
+        math::vec3f{0.0f, 0.4f, 0.0f},
+        math::vec3f{0.0f, 1.0f, 0.0f});
+    math::mat4f p = math::perspective((float) (0.25 * M_PI), ratio, 0.1f, 10.0f);
+    viewproj = math::dot(p, v);
+}
+
+/**
+ * @brief Render the packed meshes, with a depth only pass fetching the
+ * positions stream, followed by a shading pass on the visible fragments.
+ */
+void Packed::Render(void)
+{
+    GLFWwindow *window = glfw::Window();
+    if (window == nullptr) {
+        return;
+    }
+
+    math::mat4f mvp = math::dot(viewproj, model);
+    gl::GpuTimer::BeginFrame(timer);
+
+    /* Specify draw state modes. */
+    glPolygonMode(GL_FRONT_AND_BACK, GL_FILL);
+    gl::Disable(GL_CULL_FACE);
+    gl::Enable(GL_DEPTH_TEST);
+
+    /* Depth only pass. */
+    gl::GpuTimer::Begin(timer, "depth");
+    glColorMask(GL_FALSE, GL_FALSE, GL_FALSE, GL_FALSE);
+    gl::DepthMask(GL_TRUE);
+    gl::DepthFunc(GL_LESS);
+    gl::UseProgram(depth_program);
+    gl::SetUniformMatrix(depth_program, "u_mvp", GL_FLOAT_MAT4, true, mvp.data);
+    for (auto &mesh : meshes[format]) {
+        gl::PackedMesh::Render(mesh, depth_program);
+    }
+    gl::GpuTimer::End(timer);
+
+    /* Shading pass. */
+    gl::GpuTimer::Begin(timer, "shade");
+    glColorMask(GL_TRUE, GL_TRUE, GL_TRUE, GL_TRUE);
+    gl::DepthMask(GL_FALSE);
+    gl::DepthFunc(GL_LEQUAL);
+    gl::UseProgram(program);
+    gl::SetUniformMatrix(program, "u_mvp", GL_FLOAT_MAT4, true, mvp.data);
+    gl::SetUniformMatrix(program, "u_model", GL_FLOAT_MAT4, true, model.data);
+    for (auto &mesh : meshes[format]) {
+        gl::PackedMesh::Render(mesh, program);
+    }
+    gl::GpuTimer::End(timer);
+
+    /* Restore the depth writes and unbind the shader program object. */
+    gl::DepthMask(GL_TRUE);
+    gl::UseProgram(0);
+
+    /* End the frame and print the pass statistics every few frames. */
+    gl::GpuTimer::EndFrame(timer);
+    if (timer.n_frames % 256 == 0) {
+        std::cout << gl::GpuTimer::InfoString(timer) << "\n";
+    }
+}
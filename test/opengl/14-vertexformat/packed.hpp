@@ -0,0 +1,36 @@
+/*
+ * packed.hpp
+ *
+ * Copyright (c) 2020 Carlos Braga
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the MIT License.
+ *
+ * See accompanying LICENSE.md or https://opensource.org/licenses/MIT.
+ */
+
+#ifndef TEST_ITO_OPENGL_PACKED_H_
+#define TEST_ITO_OPENGL_PACKED_H_
+
+#include <vector>
+#include "ito/opengl.hpp"
+
+struct Packed {
+    GLuint program;                         /* shading program object */
+    GLuint depth_program;                   /* depth only program object */
+    std::vector<ito::gl::VertexFormat> formats;     /* vertex formats */
+    std::vector<std::vector<ito::gl::PackedMesh>> meshes;   /* per format */
+    size_t format;                          /* current vertex format */
+    ito::math::mat4f model;                 /* model transform */
+    ito::math::mat4f viewproj;              /* view projection transform */
+    ito::gl::GpuTimer timer;                /* pass gpu and cpu timer */
+
+    void Handle(ito::glfw::Event &event);
+    void Update(void);
+    void Render(void);
+
+    static Packed Create(void);
+    static void Destroy(Packed &packed);
+};
+
+#endif /* TEST_ITO_OPENGL_PACKED_H_ */
@@ -0,0 +1,29 @@
+#version 330 core
+
+uniform sampler2D u_texsampler;
+uniform vec2 u_direction;
+
+in vec4 vert_quad_normal;
+in vec4 vert_quad_color;
+in vec2 vert_quad_texcoord;
+
+out vec4 frag_color;
+
+/*
+ * fragment shader main
+ */
+void main(void)
+{
+    const float weight[5] = float[](
+        0.2270270270, 0.1945945946, 0.1216216216, 0.0540540541, 0.0162162162);
+
+    vec2 offset = u_direction / vec2(textureSize(u_texsampler, 0));
+    vec3 color = weight[0] * texture(u_texsampler, vert_quad_texcoord).rgb;
+    for (int i = 1; i < 5; ++i) {
+        color += weight[i] * texture(u_texsampler,
+            vert_quad_texcoord + float(i) * offset).rgb;
+        color += weight[i] * texture(u_texsampler,
+            vert_quad_texcoord - float(i) * offset).rgb;
+    }
+    frag_color = vec4(color, 1.0);
+}
@@ -0,0 +1,20 @@
+#version 330 core
+
+uniform sampler2D u_texsampler;
+uniform float u_threshold;
+
+in vec4 vert_quad_normal;
+in vec4 vert_quad_color;
+in vec2 vert_quad_texcoord;
+
+out vec4 frag_color;
+
+/*
+ * fragment shader main
+ */
+void main(void)
+{
+    vec3 color = texture(u_texsampler, vert_quad_texcoord).rgb;
+    float luminance = dot(color, vec3(0.2126, 0.7152, 0.0722));
+    frag_color = vec4(color * step(u_threshold, luminance), 1.0);
+}
@@ -0,0 +1,21 @@
+#version 330 core
+
+uniform sampler2D u_scene;
+uniform sampler2D u_bloom;
+uniform float u_strength;
+
+in vec4 vert_quad_normal;
+in vec4 vert_quad_color;
+in vec2 vert_quad_texcoord;
+
+out vec4 frag_color;
+
+/*
+ * fragment shader main
+ */
+void main(void)
+{
+    vec3 scene = texture(u_scene, vert_quad_texcoord).rgb;
+    vec3 bloom = texture(u_bloom, vert_quad_texcoord).rgb;
+    frag_color = vec4(scene + u_strength * bloom, 1.0);
+}
@@ -0,0 +1,35 @@
+#version 330 core
+
+uniform sampler2D u_texsampler;
+
+in vec4 vert_quad_normal;
+in vec4 vert_quad_color;
+in vec2 vert_quad_texcoord;
+
+out vec4 frag_color;
+
+/*
+ * Luminance of the texel at an offset from the fragment texel.
+ */
+float luminance(ivec2 offset)
+{
+    ivec2 size = textureSize(u_texsampler, 0);
+    ivec2 texel = ivec2(vert_quad_texcoord * vec2(size)) + offset;
+    texel = clamp(texel, ivec2(0), size - 1);
+    vec3 color = texelFetch(u_texsampler, texel, 0).rgb;
+    return dot(color, vec3(0.2126, 0.7152, 0.0722));
+}
+
+/*
+ * fragment shader main
+ */
+void main(void)
+{
+    float gx = luminance(ivec2( 1, -1)) + 2.0 * luminance(ivec2( 1, 0)) +
+               luminance(ivec2( 1,  1)) - luminance(ivec2(-1, -1)) -
+               2.0 * luminance(ivec2(-1, 0)) - luminance(ivec2(-1,  1));
+    float gy = luminance(ivec2(-1,  1)) + 2.0 * luminance(ivec2( 0, 1)) +
+               luminance(ivec2( 1,  1)) - luminance(ivec2(-1, -1)) -
+               2.0 * luminance(ivec2( 0, -1)) - luminance(ivec2( 1, -1));
+    frag_color = vec4(vec3(length(vec2(gx, gy))), 1.0);
+}
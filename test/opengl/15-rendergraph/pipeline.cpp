@@ -0,0 +1,323 @@
+/*
+ * pipeline.cpp
+ *
+ * Copyright (c) 2020 Carlos Braga
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the MIT License.
+ *
+ * See accompanying LICENSE.md or https://opensource.org/licenses/MIT.
+ */
+
+#include <string>
+#include <vector>
+#include "ito/opengl.hpp"
+#include "pipeline.hpp"
+
+using namespace ito;
+
+/**
+ * @brief Pipeline constant parameters.
+ */
+static const std::string kImageFilename = "../common/equirectangular.png";
+static const size_t kMeshNodes = 256;
+static const GLfloat kThreshold = 0.6f;
+static const GLfloat kStrength = 1.5f;
+
+/**
+ * @brief Set the sampler uniform with the texture unit and bind the texture.
+ */
+static void BindSampler(
+    const GLuint program,
+    const char *name,
+    const GLenum texunit,
+    const GLuint texture)
+{
+    gl::SetUniform(program, name, GL_SAMPLER_2D, &texunit);
+    gl::ActiveBindTexture(GL_TEXTURE_2D, GL_TEXTURE0 + texunit, texture);
+}
+
+/**
+ * @brief Create a shader program object from a vertex and a fragment shader.
+ */
+static GLuint CreateProgram(const char *vertex, const char *fragment)
+{
+    std::vector<GLuint> shaders{
+        gl::CreateShader(GL_VERTEX_SHADER, vertex),
+        gl::CreateShader(GL_FRAGMENT_SHADER, fragment)};
+    GLuint program = gl::CreateProgram(shaders);
+    gl::DestroyShader(shaders);
+    std::cout << gl::GetProgramInfoString(program) << "\n";
+    return program;
+}
+
+/**
+ * @brief Create the pipeline. The render graph is built on the first render,
+ * once the pipeline has its final address.
+ */
+Pipeline Pipeline::Create()
+{
+    Pipeline pipeline;
+
+    /*
+     * Create the sphere drawable.
+     */
+    {
+        pipeline.sphere.program = CreateProgram(
+            "data/sphere.vert", "data/sphere.frag");
+
+        /* Load the 2d-image from the specified filename. */
+        gl::Image image = gl::Image::Load(kImageFilename);
+        pipeline.sphere.texture = gl::CreateTexture2d(
+            GL_RGBA8,                   /* internal format */
+            image.width,                /* texture width */
+            image.height,               /* texture height */
+            image.format,               /* pixel format */
+            GL_UNSIGNED_BYTE,           /* pixel type */
+            &image.bitmap[0]);          /* pixel data */
+        gl::BindTexture(GL_TEXTURE_2D, pipeline.sphere.texture);
+        gl::SetTextureMipmap(GL_TEXTURE_2D);
+        gl::SetTextureWrap(GL_TEXTURE_2D, GL_CLAMP_TO_EDGE, GL_CLAMP_TO_EDGE);
+        gl::SetTextureFilter(GL_TEXTURE_2D, GL_LINEAR, GL_LINEAR);
+        gl::BindTexture(GL_TEXTURE_2D, 0);
+
+        /* Create a mesh over a sphere. */
+        pipeline.sphere.mesh = gl::Mesh::Sphere(
+            pipeline.sphere.program,    /* shader program object */
+            "sphere",                   /* vertex attributes prefix */
+            kMeshNodes,                 /* n1 vertices */
+            kMeshNodes,                 /* n2 vertices */
+            1.0,                        /* radius */
+            0.0,                        /* theta_lo */
+            M_PI,                       /* theta_hi */
+            -M_PI,                      /* phi_lo */
+            M_PI);                      /* phi_hi */
+        pipeline.sphere.mvp = math::mat4f::eye;
+    }
+
+    /*
+     * Create the post-processing programs, sharing the quad vertex shader
+     * and the quad mesh.
+     */
+    {
+        pipeline.post.bright = CreateProgram(
+            "data/quad.vert", "data/bright.frag");
+        pipeline.post.blur = CreateProgram(
+            "data/quad.vert", "data/blur.frag");
+        pipeline.post.edges = CreateProgram(
+            "data/quad.vert", "data/edges.frag");
+        pipeline.post.composite = CreateProgram(
+            "data/quad.vert", "data/composite.frag");
+
+        pipeline.post.quad = gl::Mesh::Plane(
+            pipeline.post.composite,    /* shader program object */
+            "quad",                     /* vertex attributes prefix */
+            2,                          /* n1 vertices */
+            2,                          /* n2 vertices */
+            -1.0,                       /* xlo */
+             1.0,                       /* xhi */
+            -1.0,                       /* ylo */
+             1.0);                      /* yhi */
+    }
+
+    /*
+     * Create the pool of the transient targets of the window size.
+     */
+    std::array<GLint,2> fbsize = {};
+    glfw::GetFramebufferSize(fbsize);
+    pipeline.pool = gl::FramebufferPool::Create(fbsize[0], fbsize[1]);
+    pipeline.graph = {};
+    pipeline.is_edges = false;
+    pipeline.is_dirty = true;
+
+    return pipeline;
+}
+
+/**
+ * @brief Destroy the pipeline.
+ */
+void Pipeline::Destroy(Pipeline &pipeline)
+{
+    gl::RenderGraph::Destroy(pipeline.graph);
+    gl::FramebufferPool::Destroy(pipeline.pool);
+
+    gl::Mesh::Destroy(pipeline.post.quad);
+    gl::DestroyProgram(pipeline.post.composite);
+    gl::DestroyProgram(pipeline.post.edges);
+    gl::DestroyProgram(pipeline.post.blur);
+    gl::DestroyProgram(pipeline.post.bright);
+
+    gl::Mesh::Destroy(pipeline.sphere.mesh);
+    gl::DestroyTexture(pipeline.sphere.texture);
+    gl::DestroyProgram(pipeline.sphere.program);
+}
+
+/**
+ * @brief Build the render graph. The scene is rendered into a transient
+ * target, followed by a bloom chain of half size targets, and composited into
+ * the window framebuffer. The edges pass is culled unless the edges are
+ * presented, in which case the bloom chain is culled instead.
+ */
+void Pipeline::Build(void)
+{
+    using gl::FramebufferPool;
+    using gl::RenderGraph;
+
+    RenderGraph::Destroy(graph);
+    graph = RenderGraph::Create(pool);
+
+    size_t window = RenderGraph::ImportTarget(graph, "window", {});
+    size_t scene = RenderGraph::CreateTarget(graph, "scene",
+        FramebufferPool::Desc::Relative(
+            1.0f, {GL_RGBA8}, GL_DEPTH_COMPONENT24));
+    size_t bright = RenderGraph::CreateTarget(graph, "bright",
+        FramebufferPool::Desc::Relative(0.5f, {GL_RGBA8}));
+    size_t blur_h = RenderGraph::CreateTarget(graph, "blur_h",
+        FramebufferPool::Desc::Relative(0.5f, {GL_RGBA8}));
+    size_t blur_v = RenderGraph::CreateTarget(graph, "blur_v",
+        FramebufferPool::Desc::Relative(0.5f, {GL_RGBA8}));
+    size_t edges = RenderGraph::CreateTarget(graph, "edges",
+        FramebufferPool::Desc::Relative(1.0f, {GL_RGBA8}));
+
+    /* Render the sphere into the scene target. */
+    RenderGraph::AddPass(graph, "scene",
+        {},
+        {RenderGraph::Write(scene)},
+        [this] (const RenderGraph &graph) {
+            glfw::ClearBuffers(0.0f, 0.0f, 0.0f, 1.0f, 1.0f);
+            gl::Enable(GL_DEPTH_TEST);
+            gl::DepthFunc(GL_LESS);
+            gl::UseProgram(sphere.program);
+            gl::SetUniformMatrix(sphere.program, "u_mvp", GL_FLOAT_MAT4, true,
+                sphere.mvp.data);
+            BindSampler(sphere.program, "u_texsampler", 0, sphere.texture);
+            gl::Mesh::Render(sphere.mesh);
+            gl::UseProgram(0);
+        });
+
+    /* Extract the bright texels of the scene. */
+    RenderGraph::AddPass(graph, "bright",
+        {RenderGraph::Read(scene)},
+        {RenderGraph::Write(bright)},
+        [this, scene] (const RenderGraph &graph) {
+            gl::Disable(GL_DEPTH_TEST);
+            gl::UseProgram(post.bright);
+            gl::SetUniform(post.bright, "u_threshold", GL_FLOAT, &kThreshold);
+            BindSampler(post.bright, "u_texsampler", 0,
+                RenderGraph::GetTexture(graph, scene));
+            gl::Mesh::Render(post.quad);
+            gl::UseProgram(0);
+        });
+
+    /* Blur the bright texels, horizontally and then vertically. */
+    std::vector<std::array<size_t,2>> blurs{{bright, blur_h}, {blur_h, blur_v}};
+    for (size_t i = 0; i < blurs.size(); ++i) {
+        size_t source = blurs[i][0];
+        GLfloat direction[2] = {(GLfloat) (1 - i), (GLfloat) i};
+        RenderGraph::AddPass(graph, i == 0 ? "blur_h" : "blur_v",
+            {RenderGraph::Read(source)},
+            {RenderGraph::Write(blurs[i][1])},
+            [this, source, direction] (const RenderGraph &graph) {
+                gl::Disable(GL_DEPTH_TEST);
+                gl::UseProgram(post.blur);
+                gl::SetUniform(post.blur, "u_direction", GL_FLOAT_VEC2,
+                    direction);
+                BindSampler(post.blur, "u_texsampler", 0,
+                    RenderGraph::GetTexture(graph, source));
+                gl::Mesh::Render(post.quad);
+                gl::UseProgram(0);
+            });
+    }
+
+    /* Detect the edges of the scene. */
+    RenderGraph::AddPass(graph, "edges",
+        {RenderGraph::Read(scene)},
+        {RenderGraph::Write(edges)},
+        [this, scene] (const RenderGraph &graph) {
+            gl::Disable(GL_DEPTH_TEST);
+            gl::UseProgram(post.edges);
+            BindSampler(post.edges, "u_texsampler", 0,
+                RenderGraph::GetTexture(graph, scene));
+            gl::Mesh::Render(post.quad);
+            gl::UseProgram(0);
+        });
+
+    /* Composite the scene and the bloom, or present the edges. */
+    size_t color = is_edges ? edges : scene;
+    size_t bloom = is_edges ? edges : blur_v;
+    GLfloat strength = is_edges ? 0.0f : kStrength;
+    RenderGraph::AddPass(graph, "present",
+        {RenderGraph::Read(color), RenderGraph::Read(bloom)},
+        {RenderGraph::Write(window)},
+        [this, color, bloom, strength] (const RenderGraph &graph) {
+            gl::Disable(GL_DEPTH_TEST);
+            gl::UseProgram(post.composite);
+            gl::SetUniform(post.composite, "u_strength", GL_FLOAT, &strength);
+            BindSampler(post.composite, "u_scene", 0,
+                RenderGraph::GetTexture(graph, color));
+            BindSampler(post.composite, "u_bloom", 1,
+                RenderGraph::GetTexture(graph, bloom));
+            gl::Mesh::Render(post.quad);
+            gl::UseProgram(0);
+        });
+
+    RenderGraph::Compile(graph);
+    std::cout << RenderGraph::InfoString(graph) << "\n";
+    is_dirty = false;
+}
+
+/**
+ * @brief Handle the event in the pipeline, toggle the edges with space.
+ */
+void Pipeline::Handle(glfw::Event &event)
+{
+    gl::FramebufferPool::Handle(pool, event);
+
+    if (event.type == glfw::Event::Key &&
+        event.key.code == GLFW_KEY_SPACE &&
+        event.key.action == GLFW_PRESS) {
+        is_edges = !is_edges;
+        is_dirty = true;
+    }
+}
+
+/**
+ * @brief Update the pipeline.
+ */
+void Pipeline::Update(void)
+{
+    float time = (float) glfwGetTime();
+
+    math::mat4f m = math::mat4f::eye;
+    m = math::rotate(m, math::vec3f{0.0f, 1.0f, 0.0f}, 0.5f * time);
+    m = math::rotate(m, math::vec3f{1.0f, 0.0f, 0.0f}, 0.2f);
+
+    std::array<GLfloat,2> fbsize = {};
+    glfw::GetFramebufferSize(fbsize);
+    float ratio = fbsize[0] / fbsize[1];
+
+    math::mat4f proj = math::ortho(-ratio, ratio, -1.0f, 1.0f, -1.0f, 1.0f);
+    sphere.mvp = math::dot(proj, m);
+}
+
+/**
+ * @brief Render the pipeline, executing the passes of the render graph.
+ */
+void Pipeline::Render(void)
+{
+    GLFWwindow *window = glfw::Window();
+    if (window == nullptr) {
+        return;
+    }
+
+    if (is_dirty) {
+        Build();
+    }
+
+    /* Specify draw state modes. */
+    glPolygonMode(GL_FRONT_AND_BACK, GL_FILL);
+    gl::Disable(GL_CULL_FACE);
+
+    gl::FramebufferPool::BeginFrame(pool);
+    gl::RenderGraph::Execute(graph);
+}
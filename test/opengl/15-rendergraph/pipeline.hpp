@@ -0,0 +1,50 @@
+/*
+ * pipeline.hpp
+ *
+ * Copyright (c) 2020 Carlos Braga
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the MIT License.
+ *
+ * See accompanying LICENSE.md or https://opensource.org/licenses/MIT.
+ */
+
+#ifndef TEST_ITO_OPENGL_PIPELINE_H_
+#define TEST_ITO_OPENGL_PIPELINE_H_
+
+#include "ito/opengl.hpp"
+
+struct Pipeline {
+    /* Sphere drawable */
+    struct {
+        GLuint program;             /* shader program object */
+        GLuint texture;             /* sphere texture */
+        ito::gl::Mesh mesh;         /* sphere mesh */
+        ito::math::mat4f mvp;       /* sphere mvp matrix */
+    } sphere;
+
+    /* Post-processing passes */
+    struct {
+        GLuint bright;              /* bright pass program object */
+        GLuint blur;                /* separable blur program object */
+        GLuint edges;               /* edge detection program object */
+        GLuint composite;           /* composite program object */
+        ito::gl::Mesh quad;         /* fullscreen quad mesh */
+    } post;
+
+    /* Render graph */
+    ito::gl::FramebufferPool pool;  /* pool of transient targets */
+    ito::gl::RenderGraph graph;     /* render graph of the passes */
+    bool is_edges;                  /* present the edges or the bloom */
+    bool is_dirty;                  /* rebuild the render graph */
+
+    void Build(void);
+    void Handle(ito::glfw::Event &event);
+    void Update(void);
+    void Render(void);
+
+    static Pipeline Create(void);
+    static void Destroy(Pipeline &pipeline);
+};
+
+#endif /* TEST_ITO_OPENGL_PIPELINE_H_ */
@@ -0,0 +1,17 @@
+#version 330 core
+
+in vec2 vert_uv;
+in vec4 vert_col;
+out vec4 frag_col;
+
+/*
+ * fragment shader main
+ * Discard the quad fragments outside the particle disk.
+ */
+void main(void)
+{
+    if (dot(vert_uv, vert_uv) > 1.0) {
+        discard;
+    }
+    frag_col = vert_col;
+}
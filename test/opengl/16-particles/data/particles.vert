@@ -0,0 +1,21 @@
+#version 330 core
+
+uniform mat4 u_mvp;
+uniform float u_size;
+
+layout (location = 0) in vec2 a_corner;
+layout (location = 1) in vec4 a_pos;
+out vec2 vert_uv;
+out vec4 vert_col;
+
+/*
+ * vertex shader main
+ * Draw each particle as a screen aligned quad centred at the particle position.
+ */
+void main(void)
+{
+    gl_Position = u_mvp * vec4(a_pos.xyz, 1.0);
+    gl_Position.xy += u_size * a_corner * gl_Position.w;
+    vert_uv = a_corner;
+    vert_col = vec4(0.5 * (a_pos.xyz + 1.0), 1.0);
+}
@@ -0,0 +1,150 @@
+/*
+ * main.cpp
+ *
+ * Copyright (c) 2020 Carlos Braga
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the MIT License.
+ *
+ * See accompanying LICENSE.md or https://opensource.org/licenses/MIT.
+ */
+
+#include <chrono>
+#include <cstring>
+#include "ito/opengl.hpp"
+#include "particles.hpp"
+
+using namespace ito;
+
+/** ---------------------------------------------------------------------------
+ * @brief Constants and globals.
+ */
+static const int kWidth = 800;
+static const int kHeight = 800;
+static const char kTitle[] = "Test compute particles";
+static const double kTimeout = 0.001;
+static const float kTimestep = 0.005f;
+
+static const size_t kNumParticles = 100000;
+static const size_t kNumBenchFrames = 100;
+static const size_t kNumBenchWarmup = 10;
+
+Particles gParticles;
+
+/** ---------------------------------------------------------------------------
+ * @brief Handle events.
+ */
+static void Handle(void)
+{
+    /* Poll events and handle. */
+    glfw::PollEvent(kTimeout);
+    while (glfw::HasEvent()) {
+        glfw::Event event = glfw::PopEvent();
+
+        if (event.type == glfw::Event::FramebufferSize) {
+            int w = event.framebuffersize.width;
+            int h = event.framebuffersize.height;
+            glfw::SetViewport({0, 0, w, h});
+        }
+
+        if ((event.type == glfw::Event::WindowClose) ||
+            (event.type == glfw::Event::Key &&
+             event.key.code == GLFW_KEY_ESCAPE)) {
+            glfw::Close();
+        }
+
+        gParticles.Handle(event);
+    }
+}
+
+/** ---------------------------------------------------------------------------
+ * @brief Update state.
+ */
+static void Update(void)
+{
+    gParticles.Update(kTimestep);
+}
+
+/** ---------------------------------------------------------------------------
+ * @brief Draw and swap buffers.
+ */
+static void Render(void)
+{
+    glfw::ClearBuffers(0.0f, 0.0f, 0.0f, 1.0f, 1.0f);
+    gParticles.Render();
+    glfw::SwapBuffers();
+}
+
+/** ---------------------------------------------------------------------------
+ * @brief Run the particle engine offscreen and print the frame time for an
+ * increasing number of particles, as in the opencl particles example.
+ */
+static void Benchmark(void)
+{
+    for (size_t n_particles : {100000, 1000000, 10000000}) {
+        gParticles = Particles::Create(n_particles);
+
+        for (size_t i = 0; i < kNumBenchWarmup; ++i) {
+            Update();
+            Render();
+        }
+        glFinish();
+
+        auto tic = std::chrono::high_resolution_clock::now();
+        for (size_t i = 0; i < kNumBenchFrames; ++i) {
+            Update();
+            Render();
+        }
+        glFinish();
+        auto toc = std::chrono::high_resolution_clock::now();
+
+        std::chrono::duration<double,std::ratio<1,1000>> msec = toc-tic;
+        std::printf("particles %lu compute frame time %lf\n",
+            n_particles, msec.count() / kNumBenchFrames);
+
+        Particles::Destroy(gParticles);
+    }
+}
+
+/** ---------------------------------------------------------------------------
+ * main test client
+ * Run with the "bench" argument to measure the frame time offscreen.
+ */
+int main(int argc, char const *argv[])
+{
+    bool bench = (argc > 1 && std::strcmp(argv[1], "bench") == 0);
+
+    /*
+     * Initalize GLFW library and create an OpenGL 4.3 context, the first
+     * version with compute shaders in core.
+     */
+    glfw::Init(kWidth, kHeight, kTitle, 4, 3, bench);
+    glfw::EnableEvent(
+        glfw::Event::FramebufferSize |
+        glfw::Event::WindowClose     |
+        glfw::Event::Key);
+
+    if (!gl::Compute::IsSupported()) {
+        std::cerr << "compute shaders are not supported\n";
+        glfw::Terminate();
+        exit(EXIT_SUCCESS);
+    }
+
+    if (bench) {
+        Benchmark();
+    } else {
+        /* Render loop: handle events, update state, and render. */
+        gParticles = Particles::Create(kNumParticles);
+        while (glfw::IsOpen()) {
+            Handle();
+            Update();
+            Render();
+        }
+        Particles::Destroy(gParticles);
+    }
+
+    /* Terminate GLFW library and destroy OpenGL context. */
+    glfw::Terminate();
+
+    exit(EXIT_SUCCESS);
+}
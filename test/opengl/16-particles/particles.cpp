@@ -0,0 +1,206 @@
+/*
+ * particles.cpp
+ *
+ * Copyright (c) 2020 Carlos Braga
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the MIT License.
+ *
+ * See accompanying LICENSE.md or https://opensource.org/licenses/MIT.
+ */
+
+#include <random>
+#include "particles.hpp"
+
+using namespace ito;
+
+/**
+ * @brief Particle quad size.
+ */
+static const GLfloat kParticleSize = 0.004f;
+
+/**
+ * @brief Create a new particle engine.
+ */
+Particles Particles::Create(const size_t n_particles)
+{
+    Particles particles;
+    particles.n_particles = n_particles;
+    particles.mvp = math::mat4f::eye;
+
+    /*
+     * Initial particle positions and velocities.
+     */
+    std::vector<math::vec4f> pos_data(n_particles);
+    std::vector<math::vec4f> vel_data(n_particles);
+    {
+        std::mt19937 engine(1);
+        std::uniform_real_distribution<float> uniform(-1.0f, 1.0f);
+        for (size_t i = 0; i < n_particles; ++i) {
+            pos_data[i] = math::vec4f{
+                uniform(engine),
+                uniform(engine),
+                uniform(engine),
+                1.0f};
+            vel_data[i] = math::vec4f{
+                -pos_data[i].y,
+                 pos_data[i].x,
+                 0.1f * uniform(engine),
+                 0.0f};
+        }
+    }
+    const GLsizeiptr pos_size = n_particles * sizeof(math::vec4f);
+
+    /*
+     * Particle shader program object.
+     */
+    std::vector<GLuint> shaders{
+        gl::CreateShader(GL_VERTEX_SHADER, "data/particles.vert"),
+        gl::CreateShader(GL_FRAGMENT_SHADER, "data/particles.frag")};
+    particles.program = gl::CreateProgram(shaders);
+    gl::DestroyShader(shaders);
+    std::cout << gl::GetProgramInfoString(particles.program) << "\n";
+
+    /*
+     * Create vertex array object with the quad corners as per-vertex
+     * attributes and the particle positions as per-instance attributes.
+     */
+    particles.vao = gl::CreateVertexArray();
+    gl::BindVertexArray(particles.vao);
+
+    const std::vector<GLfloat> quad_data = {
+        -1.0f, -1.0f,
+         1.0f, -1.0f,
+        -1.0f,  1.0f,
+         1.0f,  1.0f};
+    const GLsizeiptr quad_size = quad_data.size() * sizeof(GLfloat);
+    particles.quad = gl::CreateBuffer(
+        GL_ARRAY_BUFFER, quad_size, GL_STATIC_DRAW, quad_data.data());
+
+    gl::EnableAttribute(particles.program, "a_corner");
+    gl::AttributePointer(
+        particles.program,
+        "a_corner",
+        GL_FLOAT_VEC2,
+        2 * sizeof(GLfloat),    /* offset between consecutive attributes */
+        0,                      /* offset of first element in the buffer */
+        false);                 /* normalized flag */
+
+    particles.vbo = gl::CreateBuffer(
+        GL_ARRAY_BUFFER, pos_size, GL_DYNAMIC_COPY, pos_data.data());
+
+    gl::EnableAttribute(particles.program, "a_pos");
+    gl::AttributePointer(
+        particles.program,
+        "a_pos",
+        GL_FLOAT_VEC4,
+        4 * sizeof(GLfloat),    /* offset between consecutive attributes */
+        0,                      /* offset of first element in the buffer */
+        false);                 /* normalized flag */
+    gl::AttributeDivisor(particles.program, "a_pos", 1);
+
+    gl::BindVertexArray(0);
+    gl::BindBuffer(GL_ARRAY_BUFFER, 0);
+
+    /*
+     * Create the compute program integrating the particles, and the velocity
+     * storage buffer. The positions are read and written in the vertex buffer.
+     */
+    particles.integrate = gl::Compute::Create("data/particles.comp");
+    std::cout << gl::Compute::InfoString(particles.integrate, "integrate");
+    particles.vel = gl::Compute::CreateStorageBuffer(
+        pos_size, GL_DYNAMIC_COPY, vel_data.data());
+
+    /*
+     * Resolve the uniform handles of both programs once.
+     */
+    particles.draw_uniforms = gl::Reflection::Create(particles.program);
+    particles.u_mvp = gl::Reflection::Uniform(particles.draw_uniforms, "u_mvp");
+    particles.u_size = gl::Reflection::Uniform(
+        particles.draw_uniforms, "u_size");
+
+    particles.step_uniforms = gl::Reflection::Create(
+        particles.integrate.program);
+    particles.u_n_particles = gl::Reflection::Uniform(
+        particles.step_uniforms, "u_n_particles");
+    particles.u_dt = gl::Reflection::Uniform(particles.step_uniforms, "u_dt");
+
+    return particles;
+}
+
+/**
+ * @brief Destroy the particle engine.
+ */
+void Particles::Destroy(Particles &particles)
+{
+    gl::DestroyBuffer(particles.vel);
+    gl::Compute::Destroy(particles.integrate);
+
+    gl::DestroyBuffer(particles.vbo);
+    gl::DestroyBuffer(particles.quad);
+    gl::DestroyVertexArray(particles.vao);
+    gl::DestroyProgram(particles.program);
+}
+
+/**
+ * @brief Handle the event in the particle engine.
+ */
+void Particles::Handle(glfw::Event &event)
+{}
+
+/**
+ * @brief Integrate the particles in place in the vertex buffer.
+ */
+void Particles::Update(const float dt)
+{
+    GLuint n = n_particles;
+
+    gl::Reflection::Set(step_uniforms, u_n_particles, n);
+    gl::Reflection::Set(step_uniforms, u_dt, dt);
+
+    gl::Compute::BindStorageBuffer(0, vbo);
+    gl::Compute::BindStorageBuffer(1, vel);
+    gl::Compute::Dispatch(integrate, n);
+    gl::BindBuffer(GL_SHADER_STORAGE_BUFFER, 0);
+    gl::UseProgram(0);
+
+    /* Update the modelviewprojection matrix */
+    std::array<GLfloat,2> fbsize = {};
+    glfw::GetFramebufferSize(fbsize);
+    float ratio = fbsize[0] / fbsize[1];
+    mvp = math::lookat(
+        math::vec3f{0.0f, 0.0f, 3.0f},
+        math::vec3f{0.0f, 0.0f, 0.0f},
+        math::vec3f{0.0f, 1.0f, 0.0f});
+    mvp = math::perspective(mvp, (float) (0.25 * M_PI), ratio, 0.1f, 10.0f);
+}
+
+/**
+ * @brief Render the particles as instanced quads.
+ */
+void Particles::Render(void)
+{
+    /* Specify draw state modes. */
+    glPolygonMode(GL_FRONT_AND_BACK, GL_FILL);
+    gl::Disable(GL_CULL_FACE);
+    gl::Enable(GL_DEPTH_TEST);
+    gl::DepthFunc(GL_LESS);
+
+    /*
+     * Make the positions written by the compute shader visible to the draw,
+     * and to the storage reads of the next frame dispatch.
+     */
+    gl::Compute::Barrier(integrate,
+        GL_VERTEX_ATTRIB_ARRAY_BARRIER_BIT | GL_SHADER_STORAGE_BARRIER_BIT);
+
+    /* Bind the shader program object and draw the particle instances. */
+    gl::UseProgram(program);
+    gl::Reflection::Set(draw_uniforms, u_mvp, mvp);
+    gl::Reflection::Set(draw_uniforms, u_size, kParticleSize);
+
+    gl::BindVertexArray(vao);
+    glDrawArraysInstanced(GL_TRIANGLE_STRIP, 0, 4, (GLsizei) n_particles);
+    gl::BindVertexArray(0);
+
+    gl::UseProgram(0);
+}
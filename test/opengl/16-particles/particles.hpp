@@ -0,0 +1,58 @@
+/*
+ * particles.hpp
+ *
+ * Copyright (c) 2020 Carlos Braga
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the MIT License.
+ *
+ * See accompanying LICENSE.md or https://opensource.org/licenses/MIT.
+ */
+
+#ifndef TEST_ITO_OPENGL_PARTICLES_H_
+#define TEST_ITO_OPENGL_PARTICLES_H_
+
+#include "ito/opengl.hpp"
+
+/**
+ * Particles
+ * @brief Particle engine integrating positions with a compute shader and
+ * drawing them as instanced quads from the same vertex buffer.
+ *
+ * The vertex buffer sourcing the particle instances is bound as a shader
+ * storage buffer and updated in place, followed by a vertex attribute and
+ * shader storage barrier before the draw call. There is no host round-trip
+ * and no OpenCL context sharing, as in the opencl particles example.
+ */
+struct Particles {
+    /* Particle engine parameters */
+    size_t n_particles;                 /* number of particles */
+
+    /* OpenGL render objects */
+    GLuint program;                     /* shader program object */
+    GLuint vao;                         /* vertex array object */
+    GLuint quad;                        /* instance geometry vertex buffer */
+    GLuint vbo;                         /* instance position vertex buffer */
+    ito::math::mat4f mvp;               /* modelviewprojection matrix */
+
+    /* OpenGL compute objects */
+    ito::gl::Compute integrate;         /* integrate positions and velocities */
+    GLuint vel;                         /* velocity storage buffer */
+
+    /* Uniform reflections and handles */
+    ito::gl::Reflection draw_uniforms;  /* particle program uniforms */
+    ito::gl::Reflection step_uniforms;  /* integrate program uniforms */
+    ito::gl::Reflection::Handle u_mvp;
+    ito::gl::Reflection::Handle u_size;
+    ito::gl::Reflection::Handle u_n_particles;
+    ito::gl::Reflection::Handle u_dt;
+
+    void Handle(ito::glfw::Event &event);
+    void Update(const float dt);
+    void Render(void);
+
+    static Particles Create(const size_t n_particles);
+    static void Destroy(Particles &particles);
+};
+
+#endif /* TEST_ITO_OPENGL_PARTICLES_H_ */
@@ -0,0 +1,46 @@
+/*
+ * main.cpp
+ *
+ * Copyright (c) 2020 Carlos Braga
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the MIT License.
+ *
+ * See accompanying LICENSE.md or https://opensource.org/licenses/MIT.
+ */
+
+#include "ito/opengl.hpp"
+
+#include "test-framebufferpool.hpp"
+#include "test-reflection.hpp"
+#include "test-rendergraph.hpp"
+
+using namespace ito;
+
+/** ---------------------------------------------------------------------------
+ * @brief Constants and globals.
+ */
+static const int kWidth = 256;
+static const int kHeight = 256;
+static const char kTitle[] = "Test opengl";
+
+/** ---- OpenGL Tests ---------------------------------------------------------
+ * main test client
+ * Run the non-interactive tests in an offscreen OpenGL context.
+ */
+int main(int argc, char const *argv[])
+{
+    glfw::Init(kWidth, kHeight, kTitle, 3, 3, true);
+
+    try {
+        test_opengl_reflection();
+        test_opengl_framebufferpool();
+        test_opengl_rendergraph();
+    } catch (std::exception& e) {
+        ito_throw(ito::str::format("%s\nFAIL", e.what()));
+    }
+
+    glfw::Terminate();
+
+    exit(EXIT_SUCCESS);
+}
@@ -0,0 +1,167 @@
+/*
+ * test-framebufferpool.cpp
+ *
+ * Copyright (c) 2020 Carlos Braga
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the MIT License.
+ *
+ * See accompanying LICENSE.md or https://opensource.org/licenses/MIT.
+ */
+
+#include <algorithm>
+#include "ito/opengl.hpp"
+#include "test-framebufferpool.hpp"
+
+using namespace ito;
+
+/** ---------------------------------------------------------------------------
+ * @brief Does the pool hold a texture, and is any cached framebuffer object
+ * attached to it?
+ */
+static bool HasTexture(const gl::FramebufferPool &pool, const GLuint id)
+{
+    for (auto &texture : pool.textures) {
+        if (texture.id == id) {
+            return true;
+        }
+    }
+    return false;
+}
+
+static bool HasAttachment(const gl::FramebufferPool &pool, const GLuint id)
+{
+    for (auto &it : pool.framebuffers) {
+        const std::vector<GLuint> &key = it.first;
+        if (std::find(key.begin() + 1, key.end(), id) != key.end()) {
+            return true;
+        }
+    }
+    return false;
+}
+
+/** ---- FramebufferPool ------------------------------------------------------
+ */
+void test_opengl_framebufferpool(void)
+{
+    const size_t n_frames = 2;
+    gl::FramebufferPool pool = gl::FramebufferPool::Create(256, 256, n_frames);
+    gl::FramebufferPool::Desc desc = gl::FramebufferPool::Desc::Absolute(
+        64, 64, {GL_RGBA8}, GL_DEPTH_COMPONENT24);
+    gl::FramebufferPool::Desc half = gl::FramebufferPool::Desc::Relative(
+        0.5f, {GL_RGBA8});
+
+    /*
+     * Targets with overlapping lifetimes get distinct textures, a target
+     * acquired after a release aliases the released textures and reuses
+     * the cached framebuffer object. Creating a framebuffer object keeps the
+     * framebuffer bindings of the caller.
+     */
+    gl::FramebufferPool::BeginFrame(pool);
+    gl::FramebufferPool::Target a = gl::FramebufferPool::Acquire(pool, desc);
+    gl::BindFramebuffer(GL_DRAW_FRAMEBUFFER, a.framebuffer);
+    gl::FramebufferPool::Target b = gl::FramebufferPool::Acquire(pool, desc);
+    {
+        ito_assert(
+            gl::GetFramebufferBinding(GL_DRAW_FRAMEBUFFER) == a.framebuffer &&
+            gl::GetFramebufferBinding(GL_READ_FRAMEBUFFER) ==
+                gl::GetDefaultFramebuffer(),
+            "framebuffer bindings are not restored");
+        gl::BindFramebuffer(GL_DRAW_FRAMEBUFFER, 0);
+
+        ito_assert(a.width == 64 && a.height == 64, "invalid target size");
+        ito_assert(a.color_textures.size() == 1 && a.depth_texture != 0,
+            "invalid target attachments");
+        ito_assert(a.color_textures[0] != b.color_textures[0] &&
+            a.depth_texture != b.depth_texture,
+            "overlapping targets alias the same textures");
+        ito_assert(a.framebuffer != b.framebuffer,
+            "overlapping targets share a framebuffer");
+        ito_assert(pool.n_created == 4, "invalid number of created textures");
+
+        gl::FramebufferPool::Release(pool, a);
+        gl::FramebufferPool::Target c = gl::FramebufferPool::Acquire(
+            pool, desc);
+        ito_assert(c.color_textures[0] == a.color_textures[0] &&
+            c.depth_texture == a.depth_texture,
+            "released textures are not reused");
+        ito_assert(c.framebuffer == a.framebuffer,
+            "cached framebuffer is not reused");
+        ito_assert(pool.n_created == 4, "released textures are recreated");
+        ito_assert(pool.framebuffers.size() == 2,
+            "invalid number of cached framebuffers");
+
+        bool is_thrown = false;
+        gl::FramebufferPool::Release(pool, c);
+        try {
+            gl::FramebufferPool::Release(pool, c);
+        } catch (std::exception &e) {
+            is_thrown = true;
+        }
+        ito_assert(is_thrown, "double release is not detected");
+    }
+
+    /*
+     * Window relative targets are scaled by the window size, and the free
+     * relative textures are destroyed with their framebuffer objects on a
+     * FramebufferSize event. Held and absolute textures are kept.
+     */
+    {
+        gl::FramebufferPool::Target r = gl::FramebufferPool::Acquire(
+            pool, half);
+        ito_assert(r.width == 128 && r.height == 128,
+            "invalid relative target size");
+        ito_assert(r.depth_texture == 0, "invalid relative target depth");
+        GLuint r_color = r.color_textures[0];
+        GLuint r_framebuffer = r.framebuffer;
+        gl::FramebufferPool::Release(pool, r);
+
+        glfw::Event event(glfw::Event::FramebufferSize);
+        event.framebuffersize.width = 512;
+        event.framebuffersize.height = 512;
+        gl::FramebufferPool::Handle(pool, event);
+
+        ito_assert(!HasTexture(pool, r_color) && !HasAttachment(pool, r_color),
+            "free relative texture is not purged on resize");
+        ito_assert(!glIsFramebuffer(r_framebuffer),
+            "framebuffer of a purged texture is not destroyed");
+        ito_assert(HasTexture(pool, a.color_textures[0]) &&
+            HasTexture(pool, b.color_textures[0]),
+            "absolute textures are purged on resize");
+
+        r = gl::FramebufferPool::Acquire(pool, half);
+        ito_assert(r.width == 256 && r.height == 256,
+            "relative target is not resized");
+        gl::FramebufferPool::Release(pool, r);
+    }
+
+    /*
+     * Free textures unused for more than n_frames frames are destroyed at
+     * the beginning of a frame, together with the framebuffer objects they
+     * are attached to. Textures held by a target are kept.
+     */
+    {
+        for (size_t i = 0; i <= n_frames; ++i) {
+            gl::FramebufferPool::BeginFrame(pool);
+        }
+        ito_assert(!HasTexture(pool, a.color_textures[0]) &&
+            !HasAttachment(pool, a.color_textures[0]),
+            "unused texture is not purged");
+        ito_assert(!glIsFramebuffer(a.framebuffer),
+            "framebuffer of an unused texture is not destroyed");
+        ito_assert(HasTexture(pool, b.color_textures[0]) &&
+            HasTexture(pool, b.depth_texture),
+            "held textures are purged");
+        ito_assert(pool.textures.size() == 2 && pool.framebuffers.size() == 1,
+            "invalid pool size after purge");
+
+        gl::FramebufferPool::Release(pool, b);
+        for (size_t i = 0; i <= n_frames; ++i) {
+            gl::FramebufferPool::BeginFrame(pool);
+        }
+        ito_assert(pool.textures.empty() && pool.framebuffers.empty(),
+            "pool is not empty after purge");
+    }
+
+    gl::FramebufferPool::Destroy(pool);
+}
@@ -0,0 +1,17 @@
+/*
+ * test-framebufferpool.hpp
+ *
+ * Copyright (c) 2020 Carlos Braga
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the MIT License.
+ *
+ * See accompanying LICENSE.md or https://opensource.org/licenses/MIT.
+ */
+
+#ifndef TEST_OPENGL_FRAMEBUFFERPOOL_H_
+#define TEST_OPENGL_FRAMEBUFFERPOOL_H_
+
+void test_opengl_framebufferpool(void);
+
+#endif /* TEST_OPENGL_FRAMEBUFFERPOOL_H_ */
@@ -0,0 +1,154 @@
+/*
+ * test-reflection.cpp
+ *
+ * Copyright (c) 2020 Carlos Braga
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the MIT License.
+ *
+ * See accompanying LICENSE.md or https://opensource.org/licenses/MIT.
+ */
+
+#include "ito/opengl.hpp"
+#include "test-reflection.hpp"
+
+using namespace ito;
+
+/** ---------------------------------------------------------------------------
+ * @brief Shader sources with scalar, matrix, sampler and array uniforms.
+ */
+static const std::string kVertexSource = R"(
+#version 330 core
+uniform mat4 u_mvp;
+uniform vec4 u_colors[4];
+uniform float u_weights[3];
+layout (location = 0) in vec4 a_pos;
+out vec4 vert_col;
+void main(void)
+{
+    float w = u_weights[0] + u_weights[1] + u_weights[2];
+    gl_Position = u_mvp * a_pos;
+    vert_col = w * u_colors[gl_VertexID % 4];
+}
+)";
+
+static const std::string kFragmentSource = R"(
+#version 330 core
+uniform sampler2D u_texture;
+uniform float u_alpha;
+in vec4 vert_col;
+out vec4 frag_col;
+void main(void)
+{
+    frag_col = u_alpha * vert_col * texture(u_texture, vec2(0.5));
+}
+)";
+
+/** ---- Reflection -----------------------------------------------------------
+ */
+void test_opengl_reflection(void)
+{
+    std::vector<GLuint> shaders{
+        gl::CreateShader(gl::Shader(GL_VERTEX_SHADER, kVertexSource)),
+        gl::CreateShader(gl::Shader(GL_FRAGMENT_SHADER, kFragmentSource))};
+    GLuint program = gl::CreateProgram(shaders);
+    gl::DestroyShader(shaders);
+
+    gl::Reflection reflection = gl::Reflection::Create(program);
+    gl::Reflection::Handle u_mvp = gl::Reflection::Uniform(reflection, "u_mvp");
+    gl::Reflection::Handle u_colors = gl::Reflection::Uniform(
+        reflection, "u_colors");
+    gl::Reflection::Handle u_weights = gl::Reflection::Uniform(
+        reflection, "u_weights");
+    gl::Reflection::Handle u_texture = gl::Reflection::Uniform(
+        reflection, "u_texture");
+    gl::Reflection::Handle u_alpha = gl::Reflection::Uniform(
+        reflection, "u_alpha");
+
+    /*
+     * Handles of active uniforms, array uniforms with and without suffix.
+     */
+    {
+        ito_assert(u_mvp.index != -1 && u_mvp.type == GL_FLOAT_MAT4,
+            "invalid matrix handle");
+        ito_assert(u_colors.index != -1 && u_colors.count == 4,
+            "invalid array handle");
+        gl::Reflection::Handle u_colors0 = gl::Reflection::Uniform(
+            reflection, "u_colors[0]");
+        ito_assert(u_colors0.index == u_colors.index,
+            "array handle name mismatch");
+        ito_assert(gl::Reflection::Uniform(reflection, "u_none").index == -1,
+            "invalid inactive handle");
+        ito_assert(gl::Reflection::Attribute(reflection, "a_pos") == 0,
+            "invalid attribute location");
+    }
+
+    /*
+     * Typed setters bind the program and update the uniforms.
+     */
+    {
+        gl::UseProgram(0);
+        math::mat4f mvp = math::mat4f::eye;
+        mvp.xw = 2.0f;
+        ito_assert(gl::Reflection::Set(reflection, u_mvp, mvp),
+            "failed to set matrix uniform");
+
+        GLint current = 0;
+        glGetIntegerv(GL_CURRENT_PROGRAM, &current);
+        ito_assert((GLuint) current == program, "program is not bound");
+
+        GLfloat value[16];
+        glGetUniformfv(program, u_mvp.location, value);
+        ito_assert(value[12] == 2.0f, "matrix uniform is not transposed");
+
+        ito_assert(gl::Reflection::Set(reflection, u_texture, (GLint) 3),
+            "failed to set sampler uniform");
+        GLint unit = 0;
+        glGetUniformiv(program, u_texture.location, &unit);
+        ito_assert(unit == 3, "sampler uniform mismatch");
+
+        std::vector<math::vec4f> colors{
+            math::vec4f{1.0f, 0.0f, 0.0f, 1.0f},
+            math::vec4f{0.0f, 1.0f, 0.0f, 1.0f},
+            math::vec4f{0.0f, 0.0f, 1.0f, 1.0f},
+            math::vec4f{1.0f, 1.0f, 1.0f, 0.5f}};
+        ito_assert(gl::Reflection::Set(reflection, u_colors, colors),
+            "failed to set array uniform");
+        GLint location = glGetUniformLocation(program, "u_colors[3]");
+        glGetUniformfv(program, location, value);
+        ito_assert(value[0] == 1.0f && value[3] == 0.5f,
+            "array uniform mismatch");
+    }
+
+    /*
+     * Type and count mismatches are rejected, redundant updates are elided.
+     */
+    {
+        size_t n_updates = reflection.n_updates;
+        ito_assert(!gl::Reflection::Set(reflection, u_alpha, (GLint) 1),
+            "type mismatch accepted");
+        ito_assert(!gl::Reflection::Set(reflection, u_mvp, 1.0f),
+            "type mismatch accepted");
+        ito_assert(!gl::Reflection::Set(
+            reflection, u_weights, std::vector<GLfloat>(4, 1.0f)),
+            "count mismatch accepted");
+        ito_assert(reflection.n_updates == n_updates,
+            "rejected updates were issued");
+
+        ito_assert(gl::Reflection::Set(reflection, u_alpha, 0.5f),
+            "failed to set scalar uniform");
+        ito_assert(gl::Reflection::Set(reflection, u_alpha, 0.5f),
+            "failed to set scalar uniform");
+        ito_assert(reflection.n_updates == n_updates + 1 &&
+            reflection.n_elided == 1, "redundant update was not elided");
+
+        gl::Reflection::Invalidate(reflection);
+        ito_assert(gl::Reflection::Set(reflection, u_alpha, 0.5f),
+            "failed to set scalar uniform");
+        ito_assert(reflection.n_updates == n_updates + 2,
+            "invalidated update was elided");
+    }
+
+    gl::UseProgram(0);
+    gl::DestroyProgram(program);
+}
@@ -0,0 +1,242 @@
+/*
+ * test-rendergraph.cpp
+ *
+ * Copyright (c) 2020 Carlos Braga
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the MIT License.
+ *
+ * See accompanying LICENSE.md or https://opensource.org/licenses/MIT.
+ */
+
+#include "ito/opengl.hpp"
+#include "test-rendergraph.hpp"
+
+using namespace ito;
+
+/** ---------------------------------------------------------------------------
+ * @brief Return the names of the kept passes in execution order.
+ */
+static std::vector<std::string> PassOrder(const gl::RenderGraph &graph)
+{
+    std::vector<std::string> names;
+    for (auto &p : graph.order) {
+        names.push_back(graph.passes[p].name);
+    }
+    return names;
+}
+
+/** ---- RenderGraph ----------------------------------------------------------
+ */
+void test_opengl_rendergraph(void)
+{
+    using gl::RenderGraph;
+
+    gl::FramebufferPool pool = gl::FramebufferPool::Create(256, 256);
+    gl::FramebufferPool::Desc desc = gl::FramebufferPool::Desc::Absolute(
+        16, 16, {GL_RGBA8});
+
+    std::vector<std::string> executed;
+    auto Record = [&executed] (const std::string &name) {
+        return [&executed, name] (const RenderGraph &graph) {
+            executed.push_back(name);
+        };
+    };
+
+    /*
+     * Ping-pong over two imported targets, A to B, B to A and A to B. Each
+     * pass reads the version written by the previous pass.
+     */
+    {
+        gl::FramebufferPool::Target a = gl::FramebufferPool::Acquire(
+            pool, desc);
+        gl::FramebufferPool::Target b = gl::FramebufferPool::Acquire(
+            pool, desc);
+
+        RenderGraph graph = RenderGraph::Create(pool);
+        size_t res_a = RenderGraph::ImportTarget(graph, "a", a);
+        size_t res_b = RenderGraph::ImportTarget(graph, "b", b);
+        RenderGraph::AddPass(graph, "a to b",
+            {RenderGraph::Read(res_a)}, {RenderGraph::Write(res_b)},
+            Record("a to b"));
+        RenderGraph::AddPass(graph, "b to a",
+            {RenderGraph::Read(res_b)}, {RenderGraph::Write(res_a)},
+            Record("b to a"));
+        RenderGraph::AddPass(graph, "a to b again",
+            {RenderGraph::Read(res_a)}, {RenderGraph::Write(res_b)},
+            Record("a to b again"));
+        RenderGraph::Compile(graph);
+
+        std::vector<std::string> expected{"a to b", "b to a", "a to b again"};
+        ito_assert(PassOrder(graph) == expected, "invalid ping-pong order");
+
+        RenderGraph::Destroy(graph);
+        gl::FramebufferPool::Release(pool, a);
+        gl::FramebufferPool::Release(pool, b);
+    }
+
+    /*
+     * A pass reading a history target runs before a later pass overwriting
+     * it, and reads the version of the previous frame.
+     */
+    {
+        gl::FramebufferPool::Target history = gl::FramebufferPool::Acquire(
+            pool, desc);
+        gl::FramebufferPool::Target screen = gl::FramebufferPool::Acquire(
+            pool, desc);
+
+        RenderGraph graph = RenderGraph::Create(pool);
+        size_t res_history = RenderGraph::ImportTarget(
+            graph, "history", history);
+        size_t res_screen = RenderGraph::ImportTarget(
+            graph, "screen", screen);
+        RenderGraph::AddPass(graph, "reproject",
+            {RenderGraph::Read(res_history)},
+            {RenderGraph::Write(res_screen)},
+            Record("reproject"));
+        RenderGraph::AddPass(graph, "update history",
+            {}, {RenderGraph::Write(res_history)},
+            Record("update history"));
+        RenderGraph::Compile(graph);
+
+        std::vector<std::string> expected{"reproject", "update history"};
+        ito_assert(PassOrder(graph) == expected, "invalid history order");
+
+        RenderGraph::Destroy(graph);
+        gl::FramebufferPool::Release(pool, history);
+        gl::FramebufferPool::Release(pool, screen);
+    }
+
+    /*
+     * Multiple writers of a transient target, a storage buffer written by a
+     * compute pass, and culled passes: a writer whose version is overwritten
+     * before it is read, and a debug branch whose output is never read.
+     */
+    {
+        gl::FramebufferPool::Target history = gl::FramebufferPool::Acquire(
+            pool, desc);
+        gl::FramebufferPool::Target screen = gl::FramebufferPool::Acquire(
+            pool, desc);
+        GLuint buffer = gl::CreateBuffer(
+            GL_ARRAY_BUFFER, 64, GL_DYNAMIC_COPY, nullptr);
+        gl::BindBuffer(GL_ARRAY_BUFFER, 0);
+
+        RenderGraph graph = RenderGraph::Create(pool);
+        size_t res_history = RenderGraph::ImportTarget(
+            graph, "history", history);
+        size_t res_screen = RenderGraph::ImportTarget(
+            graph, "screen", screen);
+        size_t res_particles = RenderGraph::ImportBuffer(
+            graph, "particles", buffer);
+        size_t res_scene = RenderGraph::CreateTarget(graph, "scene", desc);
+        size_t res_debug = RenderGraph::CreateTarget(graph, "debug", desc);
+        size_t res_view = RenderGraph::CreateTarget(graph, "view", desc);
+
+        RenderGraph::AddPass(graph, "prepass",
+            {}, {RenderGraph::Write(res_scene)},
+            Record("prepass"));
+        RenderGraph::AddPass(graph, "simulate",
+            {}, {RenderGraph::Write(res_particles, true)},
+            Record("simulate"));
+        RenderGraph::AddPass(graph, "scene",
+            {RenderGraph::Read(res_particles,
+                GL_VERTEX_ATTRIB_ARRAY_BARRIER_BIT),
+             RenderGraph::Read(res_history)},
+            {RenderGraph::Write(res_scene)},
+            [&] (const RenderGraph &graph) {
+                ito_assert(RenderGraph::GetBuffer(graph, res_particles) ==
+                    buffer, "invalid imported buffer");
+                ito_assert(RenderGraph::GetTexture(graph, res_scene) != 0,
+                    "transient target is not acquired");
+                executed.push_back("scene");
+            });
+        RenderGraph::AddPass(graph, "history",
+            {RenderGraph::Read(res_scene)},
+            {RenderGraph::Write(res_history)},
+            Record("history"));
+        RenderGraph::AddPass(graph, "overlay",
+            {RenderGraph::Read(res_scene)},
+            {RenderGraph::Write(res_scene)},
+            Record("overlay"));
+        RenderGraph::AddPass(graph, "debug",
+            {RenderGraph::Read(res_scene)},
+            {RenderGraph::Write(res_debug)},
+            Record("debug"));
+        RenderGraph::AddPass(graph, "debug view",
+            {RenderGraph::Read(res_debug)},
+            {RenderGraph::Write(res_view)},
+            Record("debug view"));
+        RenderGraph::AddPass(graph, "present",
+            {RenderGraph::Read(res_scene)},
+            {RenderGraph::Write(res_screen)},
+            Record("present"));
+        RenderGraph::Compile(graph);
+
+        std::vector<std::string> expected{
+            "simulate", "scene", "history", "overlay", "present"};
+        ito_assert(PassOrder(graph) == expected, "invalid multi-writer order");
+        ito_assert(graph.passes[0].is_culled, "overwritten pass is kept");
+        ito_assert(graph.passes[5].is_culled && graph.passes[6].is_culled,
+            "unused branch is kept");
+        ito_assert(graph.resources[res_scene].first == 1 &&
+            graph.resources[res_scene].last == 4,
+            "invalid transient lifetime");
+        ito_assert(graph.resources[res_debug].first == expected.size(),
+            "culled transient is used");
+
+        /*
+         * Execute the kept passes, with a barrier before the first read of
+         * the storage writes, and release the transients to the pool.
+         */
+        RenderGraph::Execute(graph);
+        ito_assert(executed == expected, "invalid execution order");
+        ito_assert(graph.passes[2].barrier ==
+            GL_VERTEX_ATTRIB_ARRAY_BARRIER_BIT, "invalid barrier bits");
+        ito_assert(graph.passes[3].barrier == 0 &&
+            graph.passes[7].barrier == 0, "barrier is issued twice");
+        for (auto &texture : pool.textures) {
+            if (texture.id != history.color_textures[0] &&
+                texture.id != screen.color_textures[0]) {
+                ito_assert(texture.is_free, "transient target is not released");
+            }
+        }
+
+        RenderGraph::Destroy(graph);
+        gl::DestroyBuffer(buffer);
+        gl::FramebufferPool::Release(pool, history);
+        gl::FramebufferPool::Release(pool, screen);
+    }
+
+    /*
+     * A render target write after image stores to the same target, and
+     * image stores after a render target write. Only the write following
+     * the incoherent stores gets a barrier.
+     */
+    {
+        gl::FramebufferPool::Target image = gl::FramebufferPool::Acquire(
+            pool, desc);
+
+        RenderGraph graph = RenderGraph::Create(pool);
+        size_t res_image = RenderGraph::ImportTarget(graph, "image", image);
+        RenderGraph::AddPass(graph, "compute",
+            {}, {RenderGraph::Write(res_image, true)},
+            Record("compute"));
+        RenderGraph::AddPass(graph, "raster",
+            {}, {RenderGraph::Write(res_image)},
+            Record("raster"));
+        RenderGraph::AddPass(graph, "compute again",
+            {}, {RenderGraph::Write(res_image, true)},
+            Record("compute again"));
+        RenderGraph::Execute(graph);
+
+        ito_assert(graph.passes[0].barrier == 0 &&
+            graph.passes[1].barrier == GL_FRAMEBUFFER_BARRIER_BIT &&
+            graph.passes[2].barrier == 0,
+            "invalid write after write barrier bits");
+
+        RenderGraph::Destroy(graph);
+        gl::FramebufferPool::Release(pool, image);
+    }
+
+    gl::FramebufferPool::Destroy(pool);
+}
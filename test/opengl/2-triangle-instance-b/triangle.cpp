@@ -75,7 +75,7 @@ Triangle Triangle::Create()
      * Create vertex array object.
      */
     triangle.vao = gl::CreateVertexArray();
-    glBindVertexArray(triangle.vao);
+    gl::BindVertexArray(triangle.vao);
 
     /*
      * Create buffer storage for vertex position and color attributes.
@@ -85,7 +85,7 @@ Triangle Triangle::Create()
         GL_ARRAY_BUFFER,
         vertex_data_size,
         GL_STATIC_DRAW);
-    glBindBuffer(GL_ARRAY_BUFFER, triangle.vbo);
+    gl::BindBuffer(GL_ARRAY_BUFFER, triangle.vbo);
     glBufferSubData(
         GL_ARRAY_BUFFER,        /* target binding point */
         0,                      /* offset in data store */
@@ -118,7 +118,7 @@ Triangle Triangle::Create()
     /*
      * Unbind vertex array object.
      */
-    glBindVertexArray(0);
+    gl::BindVertexArray(0);
 
     return triangle;
 }
@@ -176,18 +176,18 @@ void Triangle::Render(void)
     /* Specify draw state modes. */
     glPolygonMode(GL_FRONT_AND_BACK, GL_FILL);
 
-    glDisable(GL_CULL_FACE);
+    gl::Disable(GL_CULL_FACE);
     glCullFace(GL_BACK);
     glFrontFace(GL_CCW);
 
-    glEnable(GL_DEPTH_TEST);
-    glDepthFunc(GL_LESS);
+    gl::Enable(GL_DEPTH_TEST);
+    gl::DepthFunc(GL_LESS);
 
     /* Bind the shader program object. */
-    glUseProgram(program);
+    gl::UseProgram(program);
 
     /* Get window dimensions and set corresponding uniforms. */
-    glBindVertexArray(vao);
+    gl::BindVertexArray(vao);
 
     for (size_t i = 0; i < offset.size(); ++i) {
         gl::SetUniform(
@@ -205,8 +205,8 @@ void Triangle::Render(void)
         3,                      /* number of indices to be rendered */
         offset.size());         /* number of instances to be rendered */
 
-    glBindVertexArray(0);
+    gl::BindVertexArray(0);
 
     /* Unbind the shader program object. */
-    glUseProgram(0);
+    gl::UseProgram(0);
 }
@@ -76,7 +76,7 @@ Triangle Triangle::Create()
      * Create vertex array object.
      */
     triangle.vao = gl::CreateVertexArray();
-    glBindVertexArray(triangle.vao);
+    gl::BindVertexArray(triangle.vao);
 
     /*
      * Create a buffer storage for the vertex position and color attributes.
@@ -86,7 +86,7 @@ Triangle Triangle::Create()
         GL_ARRAY_BUFFER,
         vertex_data_size,
         GL_STREAM_DRAW);
-    glBindBuffer(GL_ARRAY_BUFFER, triangle.vbo);
+    gl::BindBuffer(GL_ARRAY_BUFFER, triangle.vbo);
     glBufferSubData(
         GL_ARRAY_BUFFER,            /* target binding point */
         0,                          /* offset in data store */
@@ -124,7 +124,7 @@ Triangle Triangle::Create()
         GL_ARRAY_BUFFER,
         offset_data_size,
         GL_STREAM_DRAW);
-    glBindBuffer(GL_ARRAY_BUFFER, triangle.offset.vbo);
+    gl::BindBuffer(GL_ARRAY_BUFFER, triangle.offset.vbo);
     glBufferSubData(
         GL_ARRAY_BUFFER,                /* target binding point */
         0,                              /* offset in data store */
@@ -144,7 +144,7 @@ Triangle Triangle::Create()
     /*
      * Unbind vertex array object.
      */
-    glBindVertexArray(0);
+    gl::BindVertexArray(0);
 
     return triangle;
 }
@@ -202,24 +202,24 @@ void Triangle::Render(void)
     /* Specify draw state modes. */
     glPolygonMode(GL_FRONT_AND_BACK, GL_FILL);
 
-    glDisable(GL_CULL_FACE);
+    gl::Disable(GL_CULL_FACE);
     glCullFace(GL_BACK);
     glFrontFace(GL_CCW);
 
-    glEnable(GL_DEPTH_TEST);
-    glDepthFunc(GL_LESS);
+    gl::Enable(GL_DEPTH_TEST);
+    gl::DepthFunc(GL_LESS);
 
     /* Bind the shader program object. */
-    glUseProgram(program);
+    gl::UseProgram(program);
 
     /* Get window dimensions and set corresponding uniforms. */
-    glBindVertexArray(vao);
+    gl::BindVertexArray(vao);
     gl::SetUniformMatrix(program, "u_mvp", GL_FLOAT_MAT4, true, mvp.data);
 
     /* Draw multiple instances of a range of elements. */
     glDrawArraysInstanced(GL_TRIANGLES, 0, 3, offset.data.size());
-    glBindVertexArray(0);
+    gl::BindVertexArray(0);
 
     /* Unbind the shader program object. */
-    glUseProgram(0);
+    gl::UseProgram(0);
 }
\ No newline at end of file
@@ -56,7 +56,7 @@ Triangle Triangle::Create()
      * Create vertex array object.
      */
     triangle.vao = gl::CreateVertexArray();
-    glBindVertexArray(triangle.vao);
+    gl::BindVertexArray(triangle.vao);
 
     /*
      * Create buffer storage for vertex position and color attributes.
@@ -65,7 +65,7 @@ Triangle Triangle::Create()
         GL_ARRAY_BUFFER,
         vertex_data_size,
         GL_STATIC_DRAW);
-    glBindBuffer(GL_ARRAY_BUFFER, triangle.vbo);
+    gl::BindBuffer(GL_ARRAY_BUFFER, triangle.vbo);
     glBufferSubData(
         GL_ARRAY_BUFFER,        /* target binding point */
         0,                      /* offset in data store */
@@ -98,7 +98,7 @@ Triangle Triangle::Create()
     /*
      * Unbind vertex array object.
      */
-    glBindVertexArray(0);
+    gl::BindVertexArray(0);
 
     return triangle;
 }
@@ -138,18 +138,18 @@ void Triangle::Render(void)
     /* Specify draw state modes. */
     glPolygonMode(GL_FRONT_AND_BACK, GL_FILL);
 
-    glDisable(GL_CULL_FACE);
+    gl::Disable(GL_CULL_FACE);
     glCullFace(GL_BACK);
     glFrontFace(GL_CCW);
 
-    glEnable(GL_DEPTH_TEST);
-    glDepthFunc(GL_LESS);
+    gl::Enable(GL_DEPTH_TEST);
+    gl::DepthFunc(GL_LESS);
 
     /* Bind the shader program object. */
-    glUseProgram(program);
+    gl::UseProgram(program);
 
     /* Get window dimensions and set corresponding uniforms. */
-    glBindVertexArray(vao);
+    gl::BindVertexArray(vao);
 
     std::array<GLfloat,2> fbsize = {};
     glfw::GetFramebufferSize(fbsize);
@@ -161,8 +161,8 @@ void Triangle::Render(void)
         0,                      /* starting index in the enabled arrays */
         3);                     /* number of indices to be rendered */
 
-    glBindVertexArray(0);
+    gl::BindVertexArray(0);
 
     /* Unbind the shader program object. */
-    glUseProgram(0);
+    gl::UseProgram(0);
 }
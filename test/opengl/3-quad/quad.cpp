@@ -60,12 +60,6 @@ Quad Quad::Create()
     gl::DestroyShader(shaders);
     std::cout << gl::GetProgramInfoString(quad.program) << "\n";
 
-    /*
-     * Create vertex array object.
-     */
-    quad.vao = gl::CreateVertexArray();
-    glBindVertexArray(quad.vao);
-
     /*
      * Create a buffer storage for the vertex position and color attributes.
      */
@@ -73,7 +67,7 @@ Quad Quad::Create()
         GL_ARRAY_BUFFER,
         vertex_data_size,
         GL_STATIC_DRAW);
-    glBindBuffer(GL_ARRAY_BUFFER, quad.vbo);
+    gl::BindBuffer(GL_ARRAY_BUFFER, quad.vbo);
     glBufferSubData(
         GL_ARRAY_BUFFER,            /* target binding point */
         0,                          /* offset in data store */
@@ -87,13 +81,21 @@ Quad Quad::Create()
         GL_ELEMENT_ARRAY_BUFFER,
         index_data_size,
         GL_STATIC_DRAW);
-    glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, quad.ebo);
+    gl::BindBuffer(GL_ELEMENT_ARRAY_BUFFER, quad.ebo);
     glBufferSubData(
         GL_ELEMENT_ARRAY_BUFFER,    /* target binding point */
         0,                          /* offset in data store */
         index_data_size,            /* data store size in bytes */
         index_data.data());         /* pointer to data source */
 
+    /*
+     * Create vertex array object and bind the buffers to it.
+     */
+    quad.vao = gl::CreateVertexArray();
+    gl::BindVertexArray(quad.vao);
+    gl::BindBuffer(GL_ARRAY_BUFFER, quad.vbo);
+    gl::BindBuffer(GL_ELEMENT_ARRAY_BUFFER, quad.ebo);
+
     /*
      * Specify how OpenGL interprets the vertex attributes.
      */
@@ -120,7 +122,7 @@ Quad Quad::Create()
     /*
      * Unbind vertex array object.
      */
-    glBindVertexArray(0);
+    gl::BindVertexArray(0);
 
     return quad;
 }
@@ -178,18 +180,18 @@ void Quad::Render(void)
     /* Specify draw state modes. */
     glPolygonMode(GL_FRONT_AND_BACK, GL_FILL);
 
-    glDisable(GL_CULL_FACE);
+    gl::Disable(GL_CULL_FACE);
     glCullFace(GL_BACK);
     glFrontFace(GL_CCW);
 
-    glEnable(GL_DEPTH_TEST);
-    glDepthFunc(GL_LESS);
+    gl::Enable(GL_DEPTH_TEST);
+    gl::DepthFunc(GL_LESS);
 
     /* Bind the shader program object. */
-    glUseProgram(program);
+    gl::UseProgram(program);
 
     /* Get window dimensions and set corresponding uniforms. */
-    glBindVertexArray(vao);
+    gl::BindVertexArray(vao);
 
     std::array<GLfloat,2> fbsize = {};
     glfw::GetFramebufferSize(fbsize);
@@ -203,8 +205,8 @@ void Quad::Render(void)
         GL_UNSIGNED_INT,    /* type of the values in indices */
         (GLvoid *) 0);      /* offset of the first index in array */
 
-    glBindVertexArray(0);
+    gl::BindVertexArray(0);
 
     /* Unbind the shader program object. */
-    glUseProgram(0);
+    gl::UseProgram(0);
 }
@@ -18,6 +18,7 @@ using namespace ito;
  * @brief Quad constant parameters.
  */
 static const std::string kImageFilename = "../common/baboon_512.png";
+static const std::string kCacheFilename = "/tmp/baboon_512.bc1.ktx";
 static const size_t kMeshNodes = 1024;
 
 /**
@@ -41,19 +42,34 @@ Quad Quad::Create()
      * Load the 2d-image from the specified filename
      */
     quad.image = gl::Image::Load(kImageFilename, true, 4);
-    quad.texture = gl::CreateTexture2d(
-        GL_RGBA8,                   /* internal format */
-        quad.image.width,           /* texture width */
-        quad.image.height,          /* texture height */
-        quad.image.format,          /* pixel format */
-        GL_UNSIGNED_BYTE,           /* pixel type */
-        &quad.image.bitmap[0]);     /* pixel data */
-
-    glBindTexture(GL_TEXTURE_2D, quad.texture);
-    gl::SetTextureMipmap(GL_TEXTURE_2D);
+    if (gl::CompressedImage::IsSupported()) {
+        /*
+         * Use the BC1 compressed image, and its mipmaps, in the cache file,
+         * encoded from the image file the first time.
+         */
+        gl::CompressedImage compressed = gl::CompressedImage::Cached(
+            kImageFilename,
+            kCacheFilename,
+            GL_COMPRESSED_RGB_S3TC_DXT1_EXT,
+            true);
+        std::cout << gl::CompressedImage::InfoString(compressed, "bc1") << "\n";
+        quad.texture = gl::CompressedImage::Texture(compressed);
+        gl::BindTexture(GL_TEXTURE_2D, quad.texture);
+    } else {
+        quad.texture = gl::CreateTexture2d(
+            GL_RGBA8,                   /* internal format */
+            quad.image.width,           /* texture width */
+            quad.image.height,          /* texture height */
+            quad.image.format,          /* pixel format */
+            GL_UNSIGNED_BYTE,           /* pixel type */
+            &quad.image.bitmap[0]);     /* pixel data */
+        gl::BindTexture(GL_TEXTURE_2D, quad.texture);
+        gl::SetTextureMipmap(GL_TEXTURE_2D);
+    }
+    /* Sample the mipmap chain with trilinear filtering. */
     gl::SetTextureWrap(GL_TEXTURE_2D, GL_CLAMP_TO_EDGE, GL_CLAMP_TO_EDGE);
-    gl::SetTextureFilter(GL_TEXTURE_2D, GL_LINEAR, GL_LINEAR);
-    glBindTexture(GL_TEXTURE_2D, 0);
+    gl::SetTextureFilter(GL_TEXTURE_2D, GL_LINEAR_MIPMAP_LINEAR, GL_LINEAR);
+    gl::BindTexture(GL_TEXTURE_2D, 0);
 
     /*
      * Create a mesh over a rectangle.
@@ -125,15 +141,15 @@ void Quad::Render(void)
     /* Specify draw state modes. */
     glPolygonMode(GL_FRONT_AND_BACK, GL_FILL);
 
-    glDisable(GL_CULL_FACE);
+    gl::Disable(GL_CULL_FACE);
     glCullFace(GL_BACK);
     glFrontFace(GL_CCW);
 
-    glEnable(GL_DEPTH_TEST);
-    glDepthFunc(GL_LESS);
+    gl::Enable(GL_DEPTH_TEST);
+    gl::DepthFunc(GL_LESS);
 
     /* Bind the shader program object. */
-    glUseProgram(program);
+    gl::UseProgram(program);
 
     /* Set window dimensions. */
     std::array<GLfloat,2> fbsize = {};
@@ -151,5 +167,5 @@ void Quad::Render(void)
     gl::Mesh::Render(mesh);
 
     /* Unbind the shader program object. */
-    glUseProgram(0);
+    gl::UseProgram(0);
 }
@@ -52,11 +52,11 @@ Sphere Sphere::Create()
             GL_UNSIGNED_BYTE,           /* pixel type */
             &sphere.image.bitmap[0]);   /* pixel data */
 
-        glBindTexture(GL_TEXTURE_2D, sphere.texture);
+        gl::BindTexture(GL_TEXTURE_2D, sphere.texture);
         gl::SetTextureMipmap(GL_TEXTURE_2D);
         gl::SetTextureWrap(GL_TEXTURE_2D, GL_CLAMP_TO_EDGE, GL_CLAMP_TO_EDGE);
         gl::SetTextureFilter(GL_TEXTURE_2D, GL_LINEAR, GL_LINEAR);
-        glBindTexture(GL_TEXTURE_2D, 0);
+        gl::BindTexture(GL_TEXTURE_2D, 0);
 
         /*
          * Create a sphere mesh and set the mesh vertex attributes in the program.
@@ -130,15 +130,15 @@ void Sphere::Render(void)
     /* Specify draw state modes. */
     glPolygonMode(GL_FRONT_AND_BACK, GL_FILL);
 
-    glDisable(GL_CULL_FACE);
+    gl::Disable(GL_CULL_FACE);
     glCullFace(GL_BACK);
     glFrontFace(GL_CCW);
 
-    glEnable(GL_DEPTH_TEST);
-    glDepthFunc(GL_LESS);
+    gl::Enable(GL_DEPTH_TEST);
+    gl::DepthFunc(GL_LESS);
 
     /* Bind the shader program object. */
-    glUseProgram(program);
+    gl::UseProgram(program);
 
     /* Set window dimensions. */
     std::array<GLfloat,2> fbsize = {};
@@ -156,5 +156,5 @@ void Sphere::Render(void)
     gl::Mesh::Render(mesh);
 
     /* Unbind the shader program object. */
-    glUseProgram(0);
+    gl::UseProgram(0);
 }
@@ -18,7 +18,11 @@ using namespace ito;
  * @brief Bunny constant parameters.
  */
 static const std::string kImageFilename = "../common/bunny.ply";
+static const std::string kCacheFilename = "/tmp/bunny.ply.mesh";
 static const size_t kMeshNodes = 1024;
+static const size_t kLodLevels = 5;
+static const GLfloat kLodThreshold = 1.0f;
+static const GLuint kSceneBinding = 0;
 
 /**
  * @brief Create a new bunny.
@@ -38,9 +42,26 @@ Bunny Bunny::Create()
     std::cout << gl::GetProgramInfoString(bunny.program) << "\n";
 
     /*
-     * Load the bunny model meshes.
+     * Import the bunny model meshes on the cpu, optimized for the vertex
+     * cache, from the mesh cache after the first run, and create their
+     * levels of detail. Only the levels of detail are uploaded.
      */
-    bunny.model = gl::Mesh::Load(bunny.program, "bunny", kImageFilename);
+    std::vector<std::vector<gl::Mesh::Vertex>> vertices;
+    std::vector<std::vector<gl::Mesh::Face>> faces;
+    gl::Mesh::Import(kImageFilename, vertices, faces, kCacheFilename, true);
+    for (size_t i = 0; i < vertices.size(); ++i) {
+        bunny.model.push_back(gl::MeshLod::Create(
+            bunny.program, "bunny", vertices[i], faces[i], kLodLevels));
+        bunny.levels.push_back(0);
+        std::cout << gl::MeshLod::InfoString(bunny.model.back()) << "\n";
+    }
+
+    /*
+     * Create the scene uniform buffer from the program uniform block layout.
+     */
+    gl::BindUniformBlock(bunny.program, "Scene", kSceneBinding);
+    bunny.scene = gl::UniformBuffer::Create(
+        gl::BlockLayout::Create(bunny.program, "Scene"), kSceneBinding);
 
     return bunny;
 }
@@ -50,9 +71,10 @@ Bunny Bunny::Create()
  */
 void Bunny::Destroy(Bunny &bunny)
 {
-    for (auto &mesh : bunny.model) {
-        gl::Mesh::Destroy(mesh);
+    for (auto &lod : bunny.model) {
+        gl::MeshLod::Destroy(lod);
     }
+    gl::UniformBuffer::Destroy(bunny.scene);
     gl::DestroyProgram(bunny.program);
 }
 
@@ -80,12 +102,33 @@ void Bunny::Update(void)
     m = math::rotate(m, math::vec3f{1.0f, 0.0f, 0.0f}, ang_x);
     m = math::scale(m, math::vec3f{5.0f, 5.0f, 5.0f});
 
+    /* Move the camera back and forth along the z-axis. */
+    float distance = 12.0f - 10.0f * std::cos(0.25 * time);
+    math::mat4f v = math::lookat(
+        math::vec3f{0.0f, 0.0f, distance},
+        math::vec3f{0.0f, 0.0f, 0.0f},
+        math::vec3f{0.0f, 1.0f, 0.0f});
+
     std::array<GLfloat,2> fbsize = {};
     glfw::GetFramebufferSize(fbsize);
     float ratio = fbsize[0] / fbsize[1];
 
-    math::mat4f p = math::ortho(-ratio, ratio, -1.0f, 1.0f, -1.0f, 1.0f);
-    mvp = math::dot(p, m);
+    math::mat4f p = math::perspective((float) (0.25 * M_PI), ratio, 0.1f, 100.0f);
+    math::vec4f light = {0.0f, 0.0f, 1.0f, 0.0f};
+    gl::UniformBuffer::Set(scene, "u_mvp", math::dot(p, math::dot(v, m)));
+
+    /* Select the level of detail of each mesh from its projected size. */
+    for (size_t i = 0; i < model.size(); ++i) {
+        size_t level = gl::MeshLod::Select(
+            model[i], m, v, p, fbsize[1], kLodThreshold);
+        if (level != levels[i]) {
+            std::cout << ito::str::format(
+                "distance %f, level %zu, faces %d\n",
+                distance, level, model[i].levels[level].count);
+            levels[i] = level;
+        }
+    }
+    gl::UniformBuffer::Set(scene, "u_light", light);
 }
 
 /**
@@ -101,24 +144,24 @@ void Bunny::Render(void)
     /* Specify draw state modes. */
     glPolygonMode(GL_FRONT_AND_BACK, GL_FILL);
 
-    glDisable(GL_CULL_FACE);
+    gl::Disable(GL_CULL_FACE);
     glCullFace(GL_BACK);
     glFrontFace(GL_CCW);
 
-    glEnable(GL_DEPTH_TEST);
-    glDepthFunc(GL_LESS);
+    gl::Enable(GL_DEPTH_TEST);
+    gl::DepthFunc(GL_LESS);
 
     /* Bind the shader program object. */
-    glUseProgram(program);
+    gl::UseProgram(program);
 
-    /* Set uniform and draw. */
-    gl::SetUniformMatrix(program, "u_mvp", GL_FLOAT_MAT4, true, mvp.data);
+    /* Write the scene uniform block with a single buffer update. */
+    gl::UniformBuffer::Commit(scene);
 
     /* Draw the mesh */
-    for (auto &mesh : model) {
-        gl::Mesh::Render(mesh);
+    for (size_t i = 0; i < model.size(); ++i) {
+        gl::MeshLod::Render(model[i], levels[i]);
     }
 
     /* Unbind the shader program object. */
-    glUseProgram(0);
+    gl::UseProgram(0);
 }
@@ -17,8 +17,9 @@
 
 struct Bunny {
     GLuint program;                         /* shader program object */
-    std::vector<ito::gl::Mesh> model;       /* bunny model */
-    ito::math::mat4f mvp;                   /* modelviewprojection */
+    std::vector<ito::gl::MeshLod> model;    /* bunny model levels of detail */
+    std::vector<size_t> levels;             /* selected level of each mesh */
+    ito::gl::UniformBuffer scene;           /* scene uniform block */
 
     void Handle(ito::glfw::Event &event);
     void Update(void);
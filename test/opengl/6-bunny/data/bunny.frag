@@ -4,6 +4,11 @@ uniform float u_width;
 uniform float u_height;
 uniform sampler2D u_texsampler;
 
+layout (std140) uniform Scene {
+    mat4 u_mvp;
+    vec4 u_light;
+};
+
 in vec4 vert_bunny_normal;
 in vec4 vert_bunny_color;
 in vec2 vert_bunny_texcoord;
@@ -30,5 +35,6 @@ vec3 get_coord (void)
 void main(void)
 {
     vec3 normal = 0.5 + 0.5*vert_bunny_normal.xyz;
-    frag_color = vec4(normal.x, normal.y, normal.z, 1);
+    float shade = 0.5 + 0.5*max(dot(vert_bunny_normal.xyz, u_light.xyz), 0.0);
+    frag_color = vec4(shade * normal, 1);
 }
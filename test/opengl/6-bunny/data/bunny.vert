@@ -1,6 +1,9 @@
 #version 330 core
 
-uniform mat4 u_mvp;
+layout (std140) uniform Scene {
+    mat4 u_mvp;
+    vec4 u_light;
+};
 
 layout (location = 0) in vec3 bunny_position;
 layout (location = 1) in vec3 bunny_normal;
@@ -53,11 +53,11 @@ Panorama Panorama::Create()
             panorama.image.format,              /* pixel format */
             GL_UNSIGNED_BYTE,                   /* pixel type */
             &panorama.image.bitmap[0]);         /* pixel data */
-        glBindTexture(GL_TEXTURE_2D, panorama.texture);
+        gl::BindTexture(GL_TEXTURE_2D, panorama.texture);
         gl::SetTextureMipmap(GL_TEXTURE_2D);
         gl::SetTextureWrap(GL_TEXTURE_2D, GL_CLAMP_TO_EDGE, GL_CLAMP_TO_EDGE);
         gl::SetTextureFilter(GL_TEXTURE_2D, GL_LINEAR, GL_LINEAR);
-        glBindTexture(GL_TEXTURE_2D, 0);
+        gl::BindTexture(GL_TEXTURE_2D, 0);
 
         panorama.mesh = gl::Mesh::Sphere(
             panorama.program,           /* shader program object */
@@ -167,15 +167,15 @@ void Panorama::Render(void)
     /* Specify draw state modes. */
     glPolygonMode(GL_FRONT_AND_BACK, GL_FILL);
 
-    glDisable(GL_CULL_FACE);
+    gl::Disable(GL_CULL_FACE);
     glCullFace(GL_BACK);
     glFrontFace(GL_CCW);
 
-    glEnable(GL_DEPTH_TEST);
-    glDepthFunc(GL_LESS);
+    gl::Enable(GL_DEPTH_TEST);
+    gl::DepthFunc(GL_LESS);
 
     /* Bind the shader program object. */
-    glUseProgram(program);
+    gl::UseProgram(program);
 
     /* Set window dimensions. */
     std::array<GLfloat,2> fbsize = {};
@@ -193,5 +193,5 @@ void Panorama::Render(void)
     gl::Mesh::Render(mesh);
 
     /* Unbind the shader program object. */
-    glUseProgram(0);
+    gl::UseProgram(0);
 }
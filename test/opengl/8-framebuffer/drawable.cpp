@@ -19,6 +19,24 @@ using namespace ito;
  */
 static const std::string kImageFilename = "../common/equirectangular.png";
 static const size_t kMeshNodes = 1024;
+static const std::string kRecordPrefix = {"/tmp/fbo-"};
+
+/**
+ * @brief Save a recorded fbo frame delivered by the readback.
+ */
+static void SaveFrame(
+    const GLsizei width,
+    const GLsizei height,
+    const GLubyte *pixels,
+    uint64_t frame)
+{
+    gl::Image image = gl::Image::Create(width, height, 32);
+    std::memcpy(image.bitmap.data(), pixels, image.size);
+
+    std::string filename = kRecordPrefix + ito::str::format(
+        "%05lu.ppm", (unsigned long) frame);
+    gl::Image::SavePpmb(image, filename, true);
+}
 
 /**
  * @brief Create a new drawable.
@@ -48,11 +66,11 @@ Drawable Drawable::Create()
             image.format,               /* pixel format */
             GL_UNSIGNED_BYTE,           /* pixel type */
             &image.bitmap[0]);          /* pixel data */
-        glBindTexture(GL_TEXTURE_2D, drawable.sphere.texture);
+        gl::BindTexture(GL_TEXTURE_2D, drawable.sphere.texture);
         gl::SetTextureMipmap(GL_TEXTURE_2D);
         gl::SetTextureWrap(GL_TEXTURE_2D, GL_CLAMP_TO_EDGE, GL_CLAMP_TO_EDGE);
         gl::SetTextureFilter(GL_TEXTURE_2D, GL_LINEAR, GL_LINEAR);
-        glBindTexture(GL_TEXTURE_2D, 0);
+        gl::BindTexture(GL_TEXTURE_2D, 0);
 
         /* Create a mesh over a sphere. */
         drawable.sphere.mesh = gl::Mesh::Sphere(
@@ -103,10 +121,10 @@ Drawable Drawable::Create()
      */
     {
         /* Set the fbo size equal to the sphere dimensions. */
-        glBindTexture(GL_TEXTURE_2D, drawable.sphere.texture);
+        gl::BindTexture(GL_TEXTURE_2D, drawable.sphere.texture);
         drawable.fbo.width = gl::GetTextureWidth(GL_TEXTURE_2D);
         drawable.fbo.height = gl::GetTextureHeight(GL_TEXTURE_2D);
-        glBindTexture(GL_TEXTURE_2D, 0);
+        gl::BindTexture(GL_TEXTURE_2D, 0);
 
         /* Create the fbo with color and depth attachments. */
         drawable.fbo.id = gl::CreateFramebuffer(
@@ -121,6 +139,23 @@ Drawable Drawable::Create()
             GL_LINEAR_MIPMAP_LINEAR);
     }
 
+    /*
+     * Create the fbo readback, which saves each recorded frame once its
+     * pixels are available.
+     */
+    {
+        GLsizei width = drawable.fbo.width;
+        GLsizei height = drawable.fbo.height;
+        drawable.readback = gl::Readback::Create(
+            width,
+            height,
+            GL_RGBA,
+            [width, height] (const GLubyte *pixels, uint64_t frame) {
+                SaveFrame(width, height, pixels, frame);
+            });
+        drawable.is_recording = false;
+    }
+
     return drawable;
 }
 
@@ -138,6 +173,10 @@ void Drawable::Destroy(Drawable &drawable)
     gl::Mesh::Destroy(drawable.quad.mesh);
     gl::DestroyProgram(drawable.quad.program);
 
+    /* Save the pending recorded frames and destroy the readback. */
+    gl::Readback::Flush(drawable.readback);
+    gl::Readback::Destroy(drawable.readback);
+
     /* Destroy fbo objects. */
     gl::DestroyTexture(drawable.fbo.color_texture);
     gl::DestroyTexture(drawable.fbo.depth_texture);
@@ -145,10 +184,17 @@ void Drawable::Destroy(Drawable &drawable)
 }
 
 /**
- * @brief Handle the event in the drawable.
+ * @brief Handle the event in the drawable, toggle the fbo recording with space.
  */
 void Drawable::Handle(glfw::Event &event)
-{}
+{
+    if (event.type == glfw::Event::Key &&
+        event.key.code == GLFW_KEY_SPACE &&
+        event.key.action == GLFW_PRESS) {
+        is_recording = !is_recording;
+        std::printf("recording %d\n", is_recording);
+    }
+}
 
 /**
  * @brief Update the drawable.
@@ -211,24 +257,24 @@ void Drawable::Render(void)
     /* Specify draw state modes. */
     glPolygonMode(GL_FRONT_AND_BACK, GL_FILL);
 
-    glDisable(GL_CULL_FACE);
+    gl::Disable(GL_CULL_FACE);
     glCullFace(GL_BACK);
     glFrontFace(GL_CCW);
 
-    glEnable(GL_DEPTH_TEST);
-    glDepthFunc(GL_LESS);
+    gl::Enable(GL_DEPTH_TEST);
+    gl::DepthFunc(GL_LESS);
 
     /* Render into the framebuffer rendertexture */
     {
         /* Bind the framebuffer */
-        glBindFramebuffer(GL_DRAW_FRAMEBUFFER, fbo.id);
+        gl::BindFramebuffer(GL_DRAW_FRAMEBUFFER, fbo.id);
         std::array<GLint, 4> viewport;
         glfw::GetViewport(viewport);
         glfw::SetViewport({0, 0, fbo.width, fbo.height});
         glfw::ClearBuffers(0.5f, 0.5f, 0.5f, 1.0f, 1.0f);
 
         /* Bind the sphere shader */
-        glUseProgram(sphere.program);
+        gl::UseProgram(sphere.program);
 
         /* Set window dimensions. */
         // gl::SetUniform(sphere.program, "u_width", GL_FLOAT, &fbo.width);
@@ -246,10 +292,19 @@ void Drawable::Render(void)
         gl::Mesh::Render(sphere.mesh);
 
         /* Unbind the shader program object. */
-        glUseProgram(0);
+        gl::UseProgram(0);
+
+        /* Read the fbo pixels without waiting for the render to complete. */
+        if (is_recording) {
+            gl::BindFramebuffer(GL_READ_FRAMEBUFFER, fbo.id);
+            gl::Readback::Read(readback, 0, 0);
+            gl::BindFramebuffer(GL_READ_FRAMEBUFFER, 0);
+        } else {
+            gl::Readback::Poll(readback);
+        }
 
         /* Unbind the framebuffer */
-        glBindFramebuffer(GL_DRAW_FRAMEBUFFER, 0);
+        gl::BindFramebuffer(GL_DRAW_FRAMEBUFFER, 0);
         glfw::SetViewport(viewport);
     }
 
@@ -258,7 +313,7 @@ void Drawable::Render(void)
      */
     {
         /* Bind the quad shader */
-        glUseProgram(quad.program);
+        gl::UseProgram(quad.program);
 
         // std::array<GLfloat,2> fbsize = {};
         // glfw::GetFramebufferSize(fbsize);
@@ -277,6 +332,6 @@ void Drawable::Render(void)
         gl::Mesh::Render(quad.mesh);
 
         /* Unbind the shader program object. */
-        glUseProgram(0);
+        gl::UseProgram(0);
     }
 }
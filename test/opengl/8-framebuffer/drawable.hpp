@@ -39,6 +39,10 @@ struct Drawable {
         GLuint id;                  /* framebuffer object id */
     } fbo;
 
+    /* Fbo recording */
+    ito::gl::Readback readback;     /* asynchronous fbo readback */
+    bool is_recording;              /* record the fbo frames */
+
     void Handle(ito::glfw::Event &event);
     void Update(void);
     void Render(void);
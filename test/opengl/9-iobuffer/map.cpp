@@ -12,7 +12,6 @@
 #include <string>
 #include <vector>
 #include "ito/opengl.hpp"
-#include "iobuffer.hpp"
 #include "map.hpp"
 
 using namespace ito;
@@ -27,7 +26,7 @@ static const int kHeight = 1024;
 /**
  * @brief Create a new map.
  * Begin by rendering the image to the map framebuffer.
- * Run the map shader program over a double framebuffer.
+ * Run the map shader program over a chain of pooled framebuffers.
  * End by rendering the map framebuffer to the screen.
  */
 Map Map::Create()
@@ -56,11 +55,11 @@ Map Map::Create()
             GL_UNSIGNED_BYTE,           /* pixel type */
             &image.bitmap[0]);          /* pixel data */
 
-        glBindTexture(GL_TEXTURE_2D, map.begin.texture);
+        gl::BindTexture(GL_TEXTURE_2D, map.begin.texture);
         gl::SetTextureMipmap(GL_TEXTURE_2D);
         gl::SetTextureWrap(GL_TEXTURE_2D, GL_CLAMP_TO_EDGE, GL_CLAMP_TO_EDGE);
         gl::SetTextureFilter(GL_TEXTURE_2D, GL_LINEAR, GL_LINEAR);
-        glBindTexture(GL_TEXTURE_2D, 0);
+        gl::BindTexture(GL_TEXTURE_2D, 0);
 
         /* Create a mesh over a quad. */
         map.begin.quad = gl::Mesh::Plane(
@@ -97,12 +96,19 @@ Map Map::Create()
             -1.0,                       /* ylo */
              1.0);                      /* yhi */
 
-        /* Create the map input/output framebuffer objects. */
-        map.run.read_ix = 0;
-        map.run.write_ix = 1;
+        /*
+         * Create the pool of the map input/output framebuffers, of a fixed
+         * size independent of the window framebuffer size.
+         */
+        std::array<GLint,2> fbsize = {};
+        glfw::GetFramebufferSize(fbsize);
         map.run.iterations = 0;
-        map.run.buffer[0] = IOBuffer::Create(kWidth, kHeight, GL_RGB32F);
-        map.run.buffer[1] = IOBuffer::Create(kWidth, kHeight, GL_RGB32F);
+        map.run.pool = gl::FramebufferPool::Create(fbsize[0], fbsize[1]);
+        map.run.desc = gl::FramebufferPool::Desc::Absolute(
+            kWidth,                     /* framebuffer width */
+            kHeight,                    /* framebuffer height */
+            {GL_RGB32F},                /* color buffer internal format */
+            GL_DEPTH_COMPONENT32F);     /* depth buffer internal format */
     }
 
     /*
@@ -142,8 +148,7 @@ void Map::Destroy(Map &map)
     gl::DestroyProgram(map.end.program);
 
     /* Map run shader */
-    IOBuffer::Destroy(map.run.buffer[0]);
-    IOBuffer::Destroy(map.run.buffer[1]);
+    gl::FramebufferPool::Destroy(map.run.pool);
     gl::Mesh::Destroy(map.run.quad);
     gl::DestroyProgram(map.run.program);
 
@@ -160,6 +165,8 @@ void Map::Handle(glfw::Event &event)
 {
     using glfw::Event;
 
+    gl::FramebufferPool::Handle(run.pool, event);
+
     if (event.type == Event::Key && event.key.code == GLFW_KEY_UP) {
         run.iterations++;
         std::cout << "run.iterations " << run.iterations << "\n";
@@ -171,6 +178,11 @@ void Map::Handle(glfw::Event &event)
         }
         std::cout << "run.iterations " << run.iterations << "\n";
     }
+
+    if (event.type == Event::Key && event.key.code == GLFW_KEY_SPACE &&
+        event.key.action == GLFW_PRESS) {
+        std::cout << gl::FramebufferPool::InfoString(run.pool) << "\n";
+    }
 }
 
 /**
@@ -192,29 +204,29 @@ void Map::Render(void)
     /* Specify draw state modes. */
     glPolygonMode(GL_FRONT_AND_BACK, GL_FILL);
 
-    glDisable(GL_CULL_FACE);
+    gl::Disable(GL_CULL_FACE);
     glCullFace(GL_BACK);
     glFrontFace(GL_CCW);
 
-    glEnable(GL_DEPTH_TEST);
-    glDepthFunc(GL_LESS);
+    gl::Enable(GL_DEPTH_TEST);
+    gl::DepthFunc(GL_LESS);
 
     /*
      * Map begin shader.
      */
+    gl::FramebufferPool::BeginFrame(run.pool);
+    gl::FramebufferPool::Target target =
+        gl::FramebufferPool::Acquire(run.pool, run.desc);
     {
-        /* Swap read/write buffer indices. */
-        std::swap(run.read_ix, run.write_ix);
-
         /* Bind the framebuffer for writing */
-        run.buffer[run.write_ix].bind();
+        gl::BindFramebuffer(GL_DRAW_FRAMEBUFFER, target.framebuffer);
         std::array<GLint, 4> viewport;
         glfw::GetViewport(viewport);
-        glfw::SetViewport({0, 0, kWidth, kHeight});
+        glfw::SetViewport({0, 0, target.width, target.height});
         glfw::ClearBuffers(0.5f, 0.5f, 0.5f, 1.0f, 1.0f);
 
         /* Bind the begin shader */
-        glUseProgram(begin.program);
+        gl::UseProgram(begin.program);
 
         /* Set the sampler uniform with the texture unit and bind the texture */
         GLenum texunit = 0;
@@ -226,67 +238,67 @@ void Map::Render(void)
         gl::Mesh::Render(begin.quad);
 
         /* Unbind the shader program object. */
-        glUseProgram(0);
+        gl::UseProgram(0);
 
         /* Unbind the framebuffer */
-        run.buffer[run.write_ix].unbind();
+        gl::BindFramebuffer(GL_DRAW_FRAMEBUFFER, 0);
         glfw::SetViewport(viewport);
     }
 
     /*
-     * Map run shader.
+     * Map run shader. Each pass reads the previous target and releases it to
+     * the pool, where the next pass acquires it again for writing.
      */
     for (size_t iter = 0; iter < run.iterations; ++iter) {
-        /* Swap read/write buffer indices. */
-        std::swap(run.read_ix, run.write_ix);
+        gl::FramebufferPool::Target source = target;
+        target = gl::FramebufferPool::Acquire(run.pool, run.desc);
 
         /* Bind the framebuffer for writing */
-        run.buffer[run.write_ix].bind();
+        gl::BindFramebuffer(GL_DRAW_FRAMEBUFFER, target.framebuffer);
         std::array<GLint, 4> viewport;
         glfw::GetViewport(viewport);
-        glfw::SetViewport({0, 0, kWidth, kHeight});
+        glfw::SetViewport({0, 0, target.width, target.height});
         glfw::ClearBuffers(0.5f, 0.5f, 0.5f, 1.0f, 1.0f);
 
         /* Bind the begin shader */
-        glUseProgram(run.program);
+        gl::UseProgram(run.program);
 
         /* Set the sampler uniform with the texture unit and bind the texture */
         GLenum texunit = 0;
         gl::SetUniform(run.program, "u_texsampler",  GL_SAMPLER_2D, &texunit);
         gl::ActiveBindTexture(GL_TEXTURE_2D, GL_TEXTURE0 + texunit,
-            run.buffer[run.read_ix].color_texture);
+            source.color_textures[0]);
 
         /* Draw the quad mesh */
         gl::Mesh::Render(begin.quad);
 
         /* Unbind the shader program object. */
-        glUseProgram(0);
+        gl::UseProgram(0);
 
-        /* Unbind the framebuffer */
-        run.buffer[run.write_ix].unbind();
+        /* Unbind the framebuffer and release the source framebuffer */
+        gl::BindFramebuffer(GL_DRAW_FRAMEBUFFER, 0);
         glfw::SetViewport(viewport);
+        gl::FramebufferPool::Release(run.pool, source);
     }
 
     /*
      * Map end shader.
      */
     {
-        /* Swap read/write buffer indices. */
-        std::swap(run.read_ix, run.write_ix);
-
         /* Bind the begin shader */
-        glUseProgram(end.program);
+        gl::UseProgram(end.program);
 
         /* Set the sampler uniform with the texture unit and bind the texture */
         GLenum texunit = 0;
         gl::SetUniform(end.program, "u_texsampler", GL_SAMPLER_2D, &texunit);
         gl::ActiveBindTexture(GL_TEXTURE_2D, GL_TEXTURE0 + texunit,
-            run.buffer[run.read_ix].color_texture);
+            target.color_textures[0]);
 
         /* Draw the quad mesh */
         gl::Mesh::Render(begin.quad);
 
         /* Unbind the shader program object. */
-        glUseProgram(0);
+        gl::UseProgram(0);
     }
+    gl::FramebufferPool::Release(run.pool, target);
 }
@@ -14,7 +14,6 @@
 
 #include <array>
 #include "ito/opengl.hpp"
-#include "iobuffer.hpp"
 
 struct Map {
     /* Map begin shader. */
@@ -28,10 +27,9 @@ struct Map {
     struct {
         GLuint program;
         ito::gl::Mesh quad;
-        size_t read_ix;
-        size_t write_ix;
         size_t iterations;
-        std::array<IOBuffer,2> buffer;
+        ito::gl::FramebufferPool pool;
+        ito::gl::FramebufferPool::Desc desc;
     } run;
 
     /* Map end shader. */
@@ -67,6 +67,8 @@ popd
 
 # -----------------------------------------------------------------------------
 # Test opencl/opengl examples
+# Without a display server, run the examples headless for a number of frames,
+# eg ITO_HEADLESS=egl ITO_FRAMES=600 ./run.sh (or ITO_HEADLESS=osmesa).
 execute() {
     pushd "${1}"
     run make -f ../Makefile clean
@@ -83,6 +85,10 @@ execute 2-context
 execute 3-math
 execute 4-vector
 execute 5-matrix
+execute 6-elementwise
+execute 7-hosttask
+execute 8-particles
+execute 9-ringbuffer
 popd
 
 pushd opengl
@@ -99,4 +105,12 @@ execute 6-bunny
 execute 7-panorama
 execute 8-framebuffer
 execute 9-iobuffer
+execute 10-wave
+execute 11-instances
+execute 12-streaming
+execute 13-meshopt
+execute 14-vertexformat
+execute 15-rendergraph
+execute 16-particles
+execute 17-tests
 popd